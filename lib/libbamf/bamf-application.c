@@ -236,6 +236,72 @@ bamf_application_get_application_type (BamfApplication *application)
   return type;
 }
 
+static GArray *
+xids_for_children (GList *children)
+{
+  GArray *xids;
+  GList *l;
+  guint32 xid;
+
+  xids = g_array_new (FALSE, TRUE, sizeof (guint32));
+
+  for (l = children; l; l = l->next)
+    {
+      if (!BAMF_IS_WINDOW (l->data))
+        continue;
+
+      xid = bamf_window_get_xid (BAMF_WINDOW (l->data));
+      g_array_append_val (xids, xid);
+    }
+
+  return xids;
+}
+
+static GArray *
+xids_for_variant (GVariant *xids_variant)
+{
+  GVariantIter *iter;
+  GArray *xids;
+  guint32 xid;
+
+  g_return_val_if_fail (xids_variant, NULL);
+  g_return_val_if_fail (g_variant_type_equal (g_variant_get_type (xids_variant),
+                                              G_VARIANT_TYPE ("au")), NULL);
+
+  xids = g_array_new (FALSE, TRUE, sizeof (guint32));
+
+  g_variant_get (xids_variant, "au", &iter);
+  while (g_variant_iter_loop (iter, "u", &xid))
+    {
+      g_array_append_val (xids, xid);
+    }
+
+  g_variant_iter_free (iter);
+
+  return xids;
+}
+
+static GList *
+filter_windows (GList *children)
+{
+  GList *l, *next;
+
+  l = children;
+
+  while (l != NULL)
+    {
+      next = l->next;
+
+      if (!BAMF_IS_WINDOW (l->data))
+        {
+          children = g_list_delete_link (children, l);
+        }
+      l = next;
+    }
+
+  return children;
+}
+
 /**
  * bamf_application_get_xids:
  * @application: a #BamfApplication
@@ -248,11 +314,9 @@ GArray *
 bamf_application_get_xids (BamfApplication *application)
 {
   BamfApplicationPrivate *priv;
-  GVariantIter *iter;
   GVariant *xids_variant;
   GArray *xids;
-  GList *children, *l;
-  guint32 xid;
+  GList *children;
   GError *error = NULL;
 
   g_return_val_if_fail (BAMF_IS_APPLICATION (application), FALSE);
@@ -264,20 +328,7 @@ bamf_application_get_xids (BamfApplication *application)
   children = bamf_view_peek_children (BAMF_VIEW (application));
 
   if (children)
-    {
-      xids = g_array_new (FALSE, TRUE, sizeof (guint32));
-
-      for (l = children; l; l = l->next)
-        {
-          if (!BAMF_IS_WINDOW (l->data))
-            continue;
-
-          xid = bamf_window_get_xid (BAMF_WINDOW (l->data));
-          g_array_append_val (xids, xid);
-        }
-
-      return xids;
-    }
+    return xids_for_children (children);
 
   if (!_bamf_dbus_item_application_call_xids_sync (priv->proxy, &xids_variant,
                                                    CANCELLABLE (application), &error))
@@ -288,22 +339,109 @@ bamf_application_get_xids (BamfApplication *application)
       return NULL;
     }
 
-  g_return_val_if_fail (xids_variant, NULL);
-  g_return_val_if_fail (g_variant_type_equal (g_variant_get_type (xids_variant),
-                                              G_VARIANT_TYPE ("au")), NULL);
+  xids = xids_for_variant (xids_variant);
+  g_variant_unref (xids_variant);
 
-  xids = g_array_new (FALSE, TRUE, sizeof (guint32));
+  return xids;
+}
 
-  g_variant_get (xids_variant, "au", &iter);
-  while (g_variant_iter_loop (iter, "u", &xid))
+static void
+on_xids_ready (GObject *proxy, GAsyncResult *res, gpointer data)
+{
+  GTask *task = data;
+  GVariant *xids_variant = NULL;
+  GError *error = NULL;
+
+  if (!_bamf_dbus_item_application_call_xids_finish ((BamfDBusItemApplication *) proxy,
+                                                     &xids_variant, res, &error))
     {
-      g_array_append_val (xids, xid);
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
     }
 
-  g_variant_iter_free (iter);
+  g_task_return_pointer (task, xids_for_variant (xids_variant), (GDestroyNotify) g_array_unref);
   g_variant_unref (xids_variant);
+  g_object_unref (task);
+}
 
-  return xids;
+static void
+on_xids_children_ready (GObject *object, GAsyncResult *res, gpointer data)
+{
+  GTask *task = data;
+  BamfApplication *application = BAMF_APPLICATION (object);
+  GList *children;
+  GError *error = NULL;
+
+  children = bamf_view_get_children_finish (BAMF_VIEW (application), res, &error);
+
+  if (error)
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  if (children || !_bamf_view_remote_ready (BAMF_VIEW (application)))
+    {
+      g_task_return_pointer (task, children ? xids_for_children (children) : NULL,
+                             (GDestroyNotify) g_array_unref);
+      g_list_free (children);
+      g_object_unref (task);
+      return;
+    }
+
+  _bamf_dbus_item_application_call_xids (application->priv->proxy,
+                                         g_task_get_cancellable (task),
+                                         on_xids_ready, task);
+}
+
+/**
+ * bamf_application_get_xids_async:
+ * @application: a #BamfApplication
+ * @cancellable: (allow-none): a #GCancellable or %NULL
+ * @callback: (scope async): a callback to call when the result is ready
+ * @user_data: (closure): data to be sent to the callback
+ *
+ * Asynchronous version of bamf_application_get_xids().
+ *
+ * Since: 0.5.6
+ */
+void
+bamf_application_get_xids_async (BamfApplication *application,
+                                 GCancellable *cancellable,
+                                 GAsyncReadyCallback callback,
+                                 gpointer user_data)
+{
+  GTask *task;
+
+  g_return_if_fail (BAMF_IS_APPLICATION (application));
+
+  task = g_task_new (application, cancellable, callback, user_data);
+  g_task_set_source_tag (task, bamf_application_get_xids_async);
+
+  bamf_view_get_children_async (BAMF_VIEW (application), cancellable,
+                                on_xids_children_ready, task);
+}
+
+/**
+ * bamf_application_get_xids_finish:
+ * @application: a #BamfApplication
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns: (element-type guint32) (transfer full): An array of xids.
+ *
+ * Since: 0.5.6
+ */
+GArray *
+bamf_application_get_xids_finish (BamfApplication *application,
+                                  GAsyncResult *result,
+                                  GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, application), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 /**
@@ -317,27 +455,74 @@ bamf_application_get_xids (BamfApplication *application)
 GList *
 bamf_application_get_windows (BamfApplication *application)
 {
-  GList *children, *l, *next;
-  BamfView *view;
-
   g_return_val_if_fail (BAMF_IS_APPLICATION (application), NULL);
 
-  children = bamf_view_get_children (BAMF_VIEW (application));
-  l = children;
+  return filter_windows (bamf_view_get_children (BAMF_VIEW (application)));
+}
 
-  while (l != NULL)
-    {
-      view = l->data;
-      next = l->next;
+static void
+on_windows_children_ready (GObject *object, GAsyncResult *res, gpointer data)
+{
+  GTask *task = data;
+  GList *children;
+  GError *error = NULL;
 
-      if (!BAMF_IS_WINDOW (view))
-        {
-          children = g_list_delete_link (children, l);
-        }
-      l = next;
-    }
+  children = bamf_view_get_children_finish (BAMF_VIEW (object), res, &error);
 
-  return children;
+  if (error)
+    g_task_return_error (task, error);
+  else
+    g_task_return_pointer (task, filter_windows (children), (GDestroyNotify) g_list_free);
+
+  g_object_unref (task);
+}
+
+/**
+ * bamf_application_get_windows_async:
+ * @application: a #BamfApplication
+ * @cancellable: (allow-none): a #GCancellable or %NULL
+ * @callback: (scope async): a callback to call when the result is ready
+ * @user_data: (closure): data to be sent to the callback
+ *
+ * Asynchronous version of bamf_application_get_windows().
+ *
+ * Since: 0.5.6
+ */
+void
+bamf_application_get_windows_async (BamfApplication *application,
+                                    GCancellable *cancellable,
+                                    GAsyncReadyCallback callback,
+                                    gpointer user_data)
+{
+  GTask *task;
+
+  g_return_if_fail (BAMF_IS_APPLICATION (application));
+
+  task = g_task_new (application, cancellable, callback, user_data);
+  g_task_set_source_tag (task, bamf_application_get_windows_async);
+
+  bamf_view_get_children_async (BAMF_VIEW (application), cancellable,
+                                on_windows_children_ready, task);
+}
+
+/**
+ * bamf_application_get_windows_finish:
+ * @application: a #BamfApplication
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns: (element-type Bamf.Window) (transfer container): A list of #BamfWindow's.
+ *
+ * Since: 0.5.6
+ */
+GList *
+bamf_application_get_windows_finish (BamfApplication *application,
+                                     GAsyncResult *result,
+                                     GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, application), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 /**
@@ -570,22 +755,61 @@ bamf_application_dispose (GObject *object)
     G_OBJECT_CLASS (bamf_application_parent_class)->dispose (object);
 }
 
+static void
+bamf_application_load_state (BamfApplication *self, GVariant *properties)
+{
+  BamfApplicationPrivate *priv = self->priv;
+  const gchar *desktop_file, *type;
+  gboolean show_stubs;
+  gchar **mimes;
+
+  if (g_variant_lookup (properties, "DesktopFile", "&s", &desktop_file) && desktop_file[0] != '\0')
+    {
+      g_free (priv->desktop_file);
+      priv->desktop_file = g_strdup (desktop_file);
+    }
+
+  if (g_variant_lookup (properties, "ApplicationType", "&s", &type))
+    {
+      g_free (priv->application_type);
+      priv->application_type = g_strdup (type);
+    }
+
+  if (g_variant_lookup (properties, "SupportedMimeTypes", "^as", &mimes))
+    {
+      g_strfreev (priv->cached_mimes);
+      priv->cached_mimes = mimes;
+    }
+
+  if (g_variant_lookup (properties, "ShowStubs", "b", &show_stubs))
+    priv->show_stubs = show_stubs ? 1 : 0;
+}
+
 static void
 bamf_application_set_path (BamfView *view, const char *path)
 {
   BamfApplication *self;
   BamfApplicationPrivate *priv;
+  const BamfFactoryViewState *state;
   GError *error = NULL;
 
   self = BAMF_APPLICATION (view);
   priv = self->priv;
 
   bamf_application_unset_proxy (self);
-  priv->proxy = _bamf_dbus_item_application_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
-                                                                    G_DBUS_PROXY_FLAGS_NONE,
-                                                                    BAMF_DBUS_SERVICE_NAME,
-                                                                    path, CANCELLABLE (view),
-                                                                    &error);
+
+  priv->proxy = (BamfDBusItemApplication *) _bamf_factory_steal_view_proxy (_bamf_factory_get_default (), path,
+                                                                             BAMF_DBUS_ITEM_TYPE_APPLICATION_PROXY);
+
+  if (!priv->proxy)
+    {
+      /* The interface has no properties, no need to ask the daemon for them */
+      priv->proxy = _bamf_dbus_item_application_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
+                                                                        G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
+                                                                        BAMF_DBUS_SERVICE_NAME,
+                                                                        path, CANCELLABLE (view),
+                                                                        &error);
+    }
 
   if (!G_IS_DBUS_PROXY (priv->proxy))
     {
@@ -602,6 +826,11 @@ bamf_application_set_path (BamfView *view, const char *path)
   g_signal_connect (priv->proxy, "supported-mime-types-changed",
                     G_CALLBACK (bamf_application_on_supported_mime_types_changed), view);
 
+  state = _bamf_factory_peek_view_state (_bamf_factory_get_default (), path);
+
+  if (state)
+    bamf_application_load_state (self, state->properties);
+
   GList *children, *l;
   children = bamf_view_peek_children (view);
 
@@ -98,6 +98,24 @@ gboolean          bamf_application_get_show_menu_stubs  (BamfApplication *applic
 BamfWindow      * bamf_application_get_window_for_xid   (BamfApplication *application,
                                                          guint32 xid);
 
+void              bamf_application_get_windows_async    (BamfApplication *application,
+                                                         GCancellable *cancellable,
+                                                         GAsyncReadyCallback callback,
+                                                         gpointer user_data);
+
+GList           * bamf_application_get_windows_finish   (BamfApplication *application,
+                                                         GAsyncResult *result,
+                                                         GError **error);
+
+void              bamf_application_get_xids_async       (BamfApplication *application,
+                                                         GCancellable *cancellable,
+                                                         GAsyncReadyCallback callback,
+                                                         gpointer user_data);
+
+GArray          * bamf_application_get_xids_finish      (BamfApplication *application,
+                                                         GAsyncResult *result,
+                                                         GError **error);
+
 
 /* Deprecated symbols */
 G_GNUC_DEPRECATED
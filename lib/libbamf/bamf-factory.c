@@ -48,13 +48,21 @@ G_DEFINE_TYPE (BamfFactory, bamf_factory, G_TYPE_OBJECT);
 struct _BamfFactoryPrivate
 {
   GHashTable *open_views;
+  GHashTable *view_states;
   GList *allocated_views;
+  GHashTable *view_proxies;
+  BamfDBusMatcher *matcher_proxy;
+  gpointer state_request;
+  gboolean state_requested;
+  guint view_states_idle;
+  guint n_preparing;
 };
 
 static BamfFactory *static_factory = NULL;
 
 static void on_view_weak_unref (BamfFactory *self, BamfView *view_was_here);
 static void on_view_closed (BamfView *view, BamfFactory *self);
+static void bamf_factory_load_state (BamfFactory *factory);
 
 static void
 bamf_factory_dispose (GObject *object)
@@ -95,6 +103,16 @@ bamf_factory_finalize (GObject *object)
       self->priv->open_views = NULL;
     }
 
+  if (self->priv->view_states_idle)
+    g_source_remove (self->priv->view_states_idle);
+
+  if (self->priv->matcher_proxy)
+    g_object_remove_weak_pointer (G_OBJECT (self->priv->matcher_proxy),
+                                  (gpointer *) &self->priv->matcher_proxy);
+
+  g_hash_table_destroy (self->priv->view_states);
+  g_hash_table_destroy (self->priv->view_proxies);
+
   static_factory = NULL;
 
   G_OBJECT_CLASS (bamf_factory_parent_class)->finalize (object);
@@ -112,12 +130,31 @@ bamf_factory_class_init (BamfFactoryClass *klass)
 }
 
 
+static void
+bamf_factory_view_state_free (BamfFactoryViewState *state)
+{
+  g_free (state->type);
+  g_variant_unref (state->properties);
+  g_strfreev (state->children);
+  g_slice_free (BamfFactoryViewState, state);
+}
+
+static void
+bamf_factory_proxies_free (GList *proxies)
+{
+  g_list_free_full (proxies, g_object_unref);
+}
+
 static void
 bamf_factory_init (BamfFactory *self)
 {
   self->priv = BAMF_FACTORY_GET_PRIVATE (self);
   self->priv->open_views = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                   g_free, g_object_unref);
+  self->priv->view_states = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                   (GDestroyNotify) bamf_factory_view_state_free);
+  self->priv->view_proxies = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                    (GDestroyNotify) bamf_factory_proxies_free);
 }
 
 static void
@@ -341,6 +378,16 @@ _bamf_factory_view_for_path_type (BamfFactory * factory, const char * path,
   if (BAMF_IS_VIEW (view))
     return view;
 
+  bamf_factory_load_state (factory);
+
+  if (type == BAMF_FACTORY_NONE)
+    {
+      const BamfFactoryViewState *state = _bamf_factory_peek_view_state (factory, path);
+
+      if (state)
+        type = compute_factory_type_by_str (state->type);
+    }
+
   if (type == BAMF_FACTORY_NONE)
     {
       vproxy = _bamf_dbus_item_view_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
@@ -500,9 +547,521 @@ _bamf_factory_view_for_path_type (BamfFactory * factory, const char * path,
       bamf_factory_register_view (factory, view, path);
     }
 
+  /* Once created, the view is kept updated by the daemon signals */
+  g_hash_table_remove (factory->priv->view_states, path);
+
   return view;
 }
 
+static gboolean
+on_view_states_idle (gpointer data)
+{
+  BamfFactory *self = data;
+
+  self->priv->view_states_idle = 0;
+
+  /* The views being prepared still need the state, we'll be called again */
+  if (self->priv->n_preparing > 0)
+    return FALSE;
+
+  g_hash_table_remove_all (self->priv->view_states);
+  g_hash_table_remove_all (self->priv->view_proxies);
+
+  return FALSE;
+}
+
+static void
+bamf_factory_drop_state_on_idle (BamfFactory *factory)
+{
+  if (!factory->priv->view_states_idle)
+    factory->priv->view_states_idle = g_idle_add (on_view_states_idle, factory);
+}
+
+static void
+bamf_factory_add_view_states (BamfFactory *factory, GVariant *state)
+{
+  GVariant *properties;
+  GVariantIter iter;
+  const gchar *path, *type;
+  gchar **children;
+
+  g_variant_iter_init (&iter, state);
+
+  while (g_variant_iter_next (&iter, "(&s&s@a{sv}^as)", &path, &type, &properties, &children))
+    {
+      BamfFactoryViewState *view_state;
+
+      if (path[0] == '\0')
+        {
+          g_variant_unref (properties);
+          g_strfreev (children);
+          continue;
+        }
+
+      view_state = g_slice_new (BamfFactoryViewState);
+      view_state->type = g_strdup (type);
+      view_state->properties = properties;
+      view_state->children = children;
+
+      g_hash_table_insert (factory->priv->view_states, g_strdup (path), view_state);
+    }
+}
+
+static gboolean
+bamf_factory_should_request_state (BamfFactory *factory)
+{
+  BamfFactoryPrivate *priv = factory->priv;
+  gchar *name_owner;
+
+  if (priv->state_requested || !priv->matcher_proxy)
+    return FALSE;
+
+  /* We'll be reset when the daemon starts */
+  name_owner = g_dbus_proxy_get_name_owner (G_DBUS_PROXY (priv->matcher_proxy));
+
+  if (!name_owner)
+    return FALSE;
+
+  g_free (name_owner);
+
+  return TRUE;
+}
+
+/* The state is the result of the GetState matcher method, it's fetched the
+ * first time a view is requested, so that the views we create get their data
+ * from it instead of fetching it from the daemon one call at time.
+ * The state is only valid for the views that the daemon currently has open,
+ * so it is dropped as soon as we get back to the main loop, while the views
+ * we've created from it are then kept updated by the daemon signals. */
+static void
+bamf_factory_load_state (BamfFactory *factory)
+{
+  BamfFactoryPrivate *priv = factory->priv;
+  GVariant *state = NULL;
+  GError *error = NULL;
+
+  if (!bamf_factory_should_request_state (factory))
+    return;
+
+  priv->state_requested = TRUE;
+
+  /* Older daemons don't support this, so we just fallback to the per-view calls */
+  if (!_bamf_dbus_matcher_call_get_state_sync (priv->matcher_proxy, &state, NULL, NULL, &error))
+    {
+      g_debug ("Failed to fetch the matcher state: %s", error ? error->message : "");
+      g_error_free (error);
+
+      return;
+    }
+
+  bamf_factory_add_view_states (factory, state);
+  g_variant_unref (state);
+
+  if (g_hash_table_size (priv->view_states) > 0)
+    bamf_factory_drop_state_on_idle (factory);
+}
+
+typedef struct
+{
+  BamfFactory *factory;
+  GCancellable *cancellable;
+  GList *tasks;
+} StateRequest;
+
+static void
+on_get_state_ready (GObject *proxy, GAsyncResult *res, gpointer data)
+{
+  StateRequest *request = data;
+  BamfFactory *factory = request->factory;
+  GVariant *state = NULL;
+  GError *error = NULL;
+  GList *l;
+
+  if (!_bamf_dbus_matcher_call_get_state_finish ((BamfDBusMatcher *) proxy, &state, res, &error))
+    {
+      g_debug ("Failed to fetch the matcher state: %s", error ? error->message : "");
+      g_clear_error (&error);
+    }
+  else if (factory->priv->state_request == request)
+    {
+      /* Unless reset meanwhile, as the state would be the one of an old daemon */
+      bamf_factory_add_view_states (factory, state);
+    }
+
+  if (factory->priv->state_request == request)
+    factory->priv->state_request = NULL;
+
+  for (l = request->tasks; l; l = l->next)
+    {
+      g_task_return_boolean (l->data, TRUE);
+      g_object_unref (l->data);
+    }
+
+  if (state)
+    g_variant_unref (state);
+
+  g_list_free (request->tasks);
+  g_object_unref (request->cancellable);
+  g_object_unref (request->factory);
+  g_slice_free (StateRequest, request);
+}
+
+/* Asynchronous version of bamf_factory_load_state, callers wait for the same
+ * request if one is already running. The state is dropped on idle by the
+ * views preparation once done. */
+static void
+bamf_factory_load_state_async (BamfFactory *factory, GAsyncReadyCallback callback, gpointer user_data)
+{
+  BamfFactoryPrivate *priv = factory->priv;
+  StateRequest *request;
+  GTask *task;
+
+  task = g_task_new (factory, NULL, callback, user_data);
+
+  if (priv->state_request)
+    {
+      request = priv->state_request;
+      request->tasks = g_list_prepend (request->tasks, task);
+      return;
+    }
+
+  if (!bamf_factory_should_request_state (factory))
+    {
+      g_task_return_boolean (task, TRUE);
+      g_object_unref (task);
+      return;
+    }
+
+  priv->state_requested = TRUE;
+
+  request = g_slice_new0 (StateRequest);
+  request->factory = g_object_ref (factory);
+  request->cancellable = g_cancellable_new ();
+  request->tasks = g_list_prepend (NULL, task);
+  priv->state_request = request;
+
+  _bamf_dbus_matcher_call_get_state (priv->matcher_proxy, request->cancellable,
+                                     on_get_state_ready, request);
+}
+
+/* Drops the loaded state (if any), the next view request will fetch it again */
+void
+_bamf_factory_reset_state (BamfFactory *factory)
+{
+  BamfFactoryPrivate *priv;
+
+  g_return_if_fail (BAMF_IS_FACTORY (factory));
+  priv = factory->priv;
+
+  if (priv->view_states_idle)
+    {
+      g_source_remove (priv->view_states_idle);
+      priv->view_states_idle = 0;
+    }
+
+  if (priv->state_request)
+    {
+      g_cancellable_cancel (((StateRequest *) priv->state_request)->cancellable);
+      priv->state_request = NULL;
+    }
+
+  g_hash_table_remove_all (priv->view_states);
+  g_hash_table_remove_all (priv->view_proxies);
+  priv->state_requested = FALSE;
+}
+
+static void
+bamf_factory_add_view_proxy (BamfFactory *factory, GDBusProxy *proxy)
+{
+  const gchar *path = g_dbus_proxy_get_object_path (proxy);
+  GList *proxies;
+
+  proxies = g_hash_table_lookup (factory->priv->view_proxies, path);
+  g_hash_table_steal (factory->priv->view_proxies, path);
+  g_hash_table_insert (factory->priv->view_proxies, g_strdup (path),
+                       g_list_prepend (proxies, proxy));
+}
+
+/* Returns (transfer full) the proxy of the given type that has been prepared
+ * for the path by _bamf_factory_prepare_views_async, if any */
+GDBusProxy *
+_bamf_factory_steal_view_proxy (BamfFactory *factory, const char *path, GType proxy_type)
+{
+  GDBusProxy *proxy = NULL;
+  GList *proxies, *l;
+
+  g_return_val_if_fail (BAMF_IS_FACTORY (factory), NULL);
+
+  if (!path)
+    return NULL;
+
+  proxies = g_hash_table_lookup (factory->priv->view_proxies, path);
+
+  for (l = proxies; l; l = l->next)
+    {
+      if (G_OBJECT_TYPE (l->data) == proxy_type)
+        {
+          proxy = l->data;
+          proxies = g_list_delete_link (proxies, l);
+          break;
+        }
+    }
+
+  if (!proxy)
+    return NULL;
+
+  g_hash_table_steal (factory->priv->view_proxies, path);
+
+  if (proxies)
+    g_hash_table_insert (factory->priv->view_proxies, g_strdup (path), proxies);
+
+  return proxy;
+}
+
+typedef struct
+{
+  gchar **paths;
+  BamfFactoryViewType type;
+  guint pending;
+} PrepareViews;
+
+static void
+prepare_views_free (PrepareViews *prepare)
+{
+  g_strfreev (prepare->paths);
+  g_slice_free (PrepareViews, prepare);
+}
+
+static void
+prepare_views_complete (GTask *task)
+{
+  BamfFactory *factory = g_task_get_source_object (task);
+
+  --factory->priv->n_preparing;
+  bamf_factory_drop_state_on_idle (factory);
+
+  g_task_return_boolean (task, TRUE);
+  g_object_unref (task);
+}
+
+static void
+on_view_proxy_ready (GObject *source, GAsyncResult *res, gpointer data)
+{
+  GTask *task = data;
+  PrepareViews *prepare = g_task_get_task_data (task);
+  GObject *proxy;
+
+  proxy = g_async_initable_new_finish (G_ASYNC_INITABLE (source), res, NULL);
+
+  if (proxy)
+    bamf_factory_add_view_proxy (g_task_get_source_object (task), G_DBUS_PROXY (proxy));
+
+  if (--prepare->pending == 0)
+    prepare_views_complete (task);
+}
+
+static void
+bamf_factory_prepare_view_proxies (BamfFactory *factory, GTask *task,
+                                   const char *path, BamfFactoryViewType type,
+                                   GHashTable *prepared)
+{
+  PrepareViews *prepare = g_task_get_task_data (task);
+  GCancellable *cancellable = g_task_get_cancellable (task);
+  const BamfFactoryViewState *state;
+  GDBusProxyFlags flags;
+  int i;
+
+  if (!path || path[0] == '\0' || g_hash_table_contains (prepared, path))
+    return;
+
+  g_hash_table_add (prepared, (gpointer) path);
+  state = _bamf_factory_peek_view_state (factory, path);
+
+  if (state)
+    {
+      if (type == BAMF_FACTORY_NONE)
+        type = compute_factory_type_by_str (state->type);
+
+      /* The children are created with their parent, so they're prepared too */
+      for (i = 0; state->children[i]; ++i)
+        {
+          bamf_factory_prepare_view_proxies (factory, task, state->children[i],
+                                             BAMF_FACTORY_NONE, prepared);
+        }
+    }
+
+  if (type == BAMF_FACTORY_NONE || type == BAMF_FACTORY_VIEW)
+    return;
+
+  if (g_hash_table_contains (factory->priv->open_views, path) ||
+      g_hash_table_contains (factory->priv->view_proxies, path))
+    return;
+
+  /* These must match the flags that the views would use, see _bamf_view_set_path */
+  flags = state ? G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES : G_DBUS_PROXY_FLAGS_NONE;
+
+  ++prepare->pending;
+  _bamf_dbus_item_view_proxy_new_for_bus (G_BUS_TYPE_SESSION, flags, BAMF_DBUS_SERVICE_NAME,
+                                          path, cancellable, on_view_proxy_ready, task);
+  ++prepare->pending;
+
+  switch (type)
+    {
+      case BAMF_FACTORY_WINDOW:
+        _bamf_dbus_item_window_proxy_new_for_bus (G_BUS_TYPE_SESSION,
+                                                  G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
+                                                  BAMF_DBUS_SERVICE_NAME, path, cancellable,
+                                                  on_view_proxy_ready, task);
+        break;
+      case BAMF_FACTORY_APPLICATION:
+        _bamf_dbus_item_application_proxy_new_for_bus (G_BUS_TYPE_SESSION,
+                                                       G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
+                                                       BAMF_DBUS_SERVICE_NAME, path, cancellable,
+                                                       on_view_proxy_ready, task);
+        break;
+      case BAMF_FACTORY_TAB:
+        _bamf_dbus_item_tab_proxy_new_for_bus (G_BUS_TYPE_SESSION, flags,
+                                               BAMF_DBUS_SERVICE_NAME, path, cancellable,
+                                               on_view_proxy_ready, task);
+        break;
+      default:
+        g_assert_not_reached ();
+    }
+}
+
+static void
+on_prepare_state_loaded (GObject *source, GAsyncResult *res, gpointer data)
+{
+  BamfFactory *factory = BAMF_FACTORY (source);
+  GTask *task = data;
+  PrepareViews *prepare = g_task_get_task_data (task);
+  GHashTable *prepared;
+  int i;
+
+  g_task_propagate_boolean (G_TASK (res), NULL);
+
+  prepared = g_hash_table_new (g_str_hash, g_str_equal);
+
+  /* Keeps the task alive until all the proxies have been started */
+  ++prepare->pending;
+
+  for (i = 0; prepare->paths[i]; ++i)
+    bamf_factory_prepare_view_proxies (factory, task, prepare->paths[i], prepare->type, prepared);
+
+  g_hash_table_destroy (prepared);
+
+  if (--prepare->pending == 0)
+    prepare_views_complete (task);
+}
+
+/* Fetches the matcher state and creates the proxies of the views at paths
+ * (and of their children) without blocking, so that getting them from the
+ * factory afterwards doesn't need any synchronous call to the daemon.
+ * Views without a known type are left to the synchronous path. */
+void
+_bamf_factory_prepare_views_async (BamfFactory *factory,
+                                   gchar **paths,
+                                   BamfFactoryViewType type,
+                                   GCancellable *cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data)
+{
+  PrepareViews *prepare;
+  GTask *task;
+
+  g_return_if_fail (BAMF_IS_FACTORY (factory));
+
+  task = g_task_new (factory, cancellable, callback, user_data);
+  prepare = g_slice_new0 (PrepareViews);
+  prepare->paths = g_strdupv (paths);
+  prepare->type = type;
+  g_task_set_task_data (task, prepare, (GDestroyNotify) prepare_views_free);
+
+  if (!paths)
+    {
+      g_task_return_boolean (task, TRUE);
+      g_object_unref (task);
+      return;
+    }
+
+  ++factory->priv->n_preparing;
+  bamf_factory_load_state_async (factory, on_prepare_state_loaded, task);
+}
+
+gboolean
+_bamf_factory_prepare_views_finish (BamfFactory *factory,
+                                    GAsyncResult *result,
+                                    GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, factory), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+void
+_bamf_factory_set_matcher_proxy (BamfFactory *factory, BamfDBusMatcher *proxy)
+{
+  BamfFactoryPrivate *priv;
+
+  g_return_if_fail (BAMF_IS_FACTORY (factory));
+  priv = factory->priv;
+
+  if (priv->matcher_proxy == proxy)
+    return;
+
+  if (priv->matcher_proxy)
+    g_object_remove_weak_pointer (G_OBJECT (priv->matcher_proxy), (gpointer *) &priv->matcher_proxy);
+
+  priv->matcher_proxy = proxy;
+
+  if (proxy)
+    g_object_add_weak_pointer (G_OBJECT (proxy), (gpointer *) &priv->matcher_proxy);
+
+  _bamf_factory_reset_state (factory);
+}
+
+const BamfFactoryViewState *
+_bamf_factory_peek_view_state (BamfFactory *factory, const char *path)
+{
+  g_return_val_if_fail (BAMF_IS_FACTORY (factory), NULL);
+
+  if (!path)
+    return NULL;
+
+  return g_hash_table_lookup (factory->priv->view_states, path);
+}
+
+/* Sets the cached values of the proxy properties, so that proxies created
+ * with G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES are ready to use */
+void
+_bamf_factory_seed_proxy_properties (GDBusProxy *proxy, GVariant *properties)
+{
+  GDBusInterfaceInfo *info;
+  GVariant *value;
+  guint i;
+
+  g_return_if_fail (G_IS_DBUS_PROXY (proxy));
+
+  info = g_dbus_proxy_get_interface_info (proxy);
+
+  if (!info || !info->properties || !properties)
+    return;
+
+  for (i = 0; info->properties[i]; ++i)
+    {
+      GDBusPropertyInfo *property = info->properties[i];
+      const GVariantType *type = G_VARIANT_TYPE (property->signature);
+
+      value = g_variant_lookup_value (properties, property->name, type);
+
+      if (value)
+        {
+          g_dbus_proxy_set_cached_property (proxy, property->name, value);
+          g_variant_unref (value);
+        }
+    }
+}
+
 BamfFactory *
 _bamf_factory_get_default (void)
 {
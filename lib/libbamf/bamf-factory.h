@@ -29,6 +29,7 @@
 #define _BAMF_FACTORY_H_
 
 #include <glib-object.h>
+#include <libbamf-private/bamf-private.h>
 #include <libbamf/bamf-view.h>
 #include <libbamf/bamf-window.h>
 #include <libbamf/bamf-application.h>
@@ -65,6 +66,13 @@ typedef enum
   BAMF_FACTORY_NONE
 } BamfFactoryViewType;
 
+typedef struct _BamfFactoryViewState
+{
+  gchar     *type;
+  GVariant  *properties;
+  gchar    **children;
+} BamfFactoryViewState;
+
 struct _BamfFactory
 {
   GObject parent;
@@ -100,6 +108,32 @@ BamfApplication * _bamf_factory_app_for_file         (BamfFactory * factory,
 BamfApplication * _bamf_factory_app_for_xid          (BamfFactory * factory,
                                                       guint32 xid);
 
+void              _bamf_factory_set_matcher_proxy    (BamfFactory * factory,
+                                                      BamfDBusMatcher * proxy);
+
+void              _bamf_factory_reset_state          (BamfFactory * factory);
+
+const BamfFactoryViewState * _bamf_factory_peek_view_state (BamfFactory * factory,
+                                                            const char * path);
+
+void              _bamf_factory_prepare_views_async  (BamfFactory * factory,
+                                                      gchar ** paths,
+                                                      BamfFactoryViewType type,
+                                                      GCancellable * cancellable,
+                                                      GAsyncReadyCallback callback,
+                                                      gpointer user_data);
+
+gboolean          _bamf_factory_prepare_views_finish (BamfFactory * factory,
+                                                      GAsyncResult * result,
+                                                      GError ** error);
+
+GDBusProxy      * _bamf_factory_steal_view_proxy     (BamfFactory * factory,
+                                                      const char * path,
+                                                      GType proxy_type);
+
+void              _bamf_factory_seed_proxy_properties (GDBusProxy * proxy,
+                                                       GVariant * properties);
+
 BamfFactory     * _bamf_factory_get_default          (void);
 
 G_END_DECLS
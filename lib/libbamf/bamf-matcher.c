@@ -156,6 +156,120 @@ track_ptr (GType wanted_type,
   return FALSE;
 }
 
+static BamfApplication *
+track_active_application_path (BamfMatcher *matcher, const gchar *path)
+{
+  BamfView *view;
+
+  view = _bamf_factory_view_for_path_type (_bamf_factory_get_default (), path,
+                                           BAMF_FACTORY_APPLICATION);
+
+  if (!BAMF_IS_APPLICATION (view))
+    view = NULL;
+
+  track_ptr (BAMF_TYPE_APPLICATION, view, (gpointer *) &matcher->priv->active_application);
+
+  return matcher->priv->active_application;
+}
+
+static BamfWindow *
+track_active_window_path (BamfMatcher *matcher, const gchar *path)
+{
+  BamfView *view;
+
+  view = _bamf_factory_view_for_path_type (_bamf_factory_get_default (), path,
+                                           BAMF_FACTORY_WINDOW);
+
+  if (!BAMF_IS_WINDOW (view))
+    view = NULL;
+
+  track_ptr (BAMF_TYPE_WINDOW, view, (gpointer *) &matcher->priv->active_window);
+
+  return matcher->priv->active_window;
+}
+
+static GList *
+views_for_paths (gchar **paths, BamfFactoryViewType type, GType wanted_type)
+{
+  BamfFactory *factory;
+  BamfView *view;
+  GHashTable *added;
+  GList *result = NULL;
+  int i, len;
+
+  if (!paths)
+    return NULL;
+
+  factory = _bamf_factory_get_default ();
+  added = g_hash_table_new (g_direct_hash, g_direct_equal);
+  len = g_strv_length (paths);
+
+  for (i = len-1; i >= 0; --i)
+    {
+      view = _bamf_factory_view_for_path_type (factory, paths[i], type);
+
+      /* Different paths might be mapped to the same application */
+      if (!G_TYPE_CHECK_INSTANCE_TYPE (view, wanted_type) || g_hash_table_contains (added, view))
+        continue;
+
+      g_hash_table_add (added, view);
+      result = g_list_prepend (result, view);
+    }
+
+  g_hash_table_destroy (added);
+
+  return result;
+}
+
+typedef void (*PathsPreparedFunc) (GTask *task, gchar **paths);
+
+typedef struct
+{
+  GTask *task;
+  gchar **paths;
+  PathsPreparedFunc prepared_func;
+} PathsPreparation;
+
+static void
+on_paths_prepared (GObject *factory, GAsyncResult *res, gpointer data)
+{
+  PathsPreparation *preparation = data;
+
+  _bamf_factory_prepare_views_finish (BAMF_FACTORY (factory), res, NULL);
+  preparation->prepared_func (preparation->task, preparation->paths);
+
+  g_strfreev (preparation->paths);
+  g_slice_free (PathsPreparation, preparation);
+}
+
+/* The async callers must not block on the views creation, so the factory
+ * fetches the state and the views proxies before they get resolved.
+ * This takes ownership of the paths. */
+static void
+prepare_paths (GTask *task, gchar **paths, BamfFactoryViewType type,
+               PathsPreparedFunc prepared_func)
+{
+  PathsPreparation *preparation;
+
+  preparation = g_slice_new (PathsPreparation);
+  preparation->task = task;
+  preparation->paths = paths;
+  preparation->prepared_func = prepared_func;
+
+  _bamf_factory_prepare_views_async (_bamf_factory_get_default (), paths, type,
+                                     g_task_get_cancellable (task),
+                                     on_paths_prepared, preparation);
+}
+
+static gchar **
+single_path_new (gchar *path)
+{
+  gchar **paths = g_new0 (gchar *, 2);
+  paths[0] = path;
+
+  return paths;
+}
+
 static void
 bamf_matcher_on_name_owner_changed (BamfDBusMatcher *proxy,
                                     GParamSpec *param,
@@ -170,6 +284,9 @@ bamf_matcher_on_name_owner_changed (BamfDBusMatcher *proxy,
       track_ptr (BAMF_TYPE_WINDOW, NULL, (gpointer *) &matcher->priv->active_window);
     }
 
+  /* Any state we got from the previous daemon instance is not valid anymore */
+  _bamf_factory_reset_state (_bamf_factory_get_default ());
+
   g_free (name_owner);
 }
 
@@ -312,6 +429,9 @@ bamf_matcher_init (BamfMatcher *self)
 
   g_signal_connect (priv->proxy, "stacking-order-changed",
                     G_CALLBACK (bamf_matcher_on_stacking_order_changed), self);
+
+  /* The views state will be fetched only once they're requested */
+  _bamf_factory_set_matcher_proxy (_bamf_factory_get_default (), priv->proxy);
 }
 
 static void
@@ -321,6 +441,7 @@ bamf_matcher_dispose (GObject *object)
 
   if (G_IS_DBUS_PROXY (self->priv->proxy))
     {
+      _bamf_factory_set_matcher_proxy (_bamf_factory_get_default (), NULL);
       g_signal_handlers_disconnect_by_data (self->priv->proxy, self);
       g_object_unref (self->priv->proxy);
       self->priv->proxy = NULL;
@@ -367,7 +488,6 @@ BamfApplication *
 bamf_matcher_get_active_application (BamfMatcher *matcher)
 {
   BamfMatcherPrivate *priv;
-  BamfView *view;
   char *app = NULL;
   GError *error = NULL;
 
@@ -388,16 +508,96 @@ bamf_matcher_get_active_application (BamfMatcher *matcher)
       return NULL;
     }
 
-  BamfFactory *factory = _bamf_factory_get_default ();
-  view = _bamf_factory_view_for_path_type (factory, app, BAMF_FACTORY_APPLICATION);
+  track_active_application_path (matcher, app);
   g_free (app);
 
-  if (!BAMF_IS_APPLICATION (view))
-    view = NULL;
+  return priv->active_application;
+}
 
-  track_ptr (BAMF_TYPE_APPLICATION, view, (gpointer *) &priv->active_application);
+static void
+return_active_application (GTask *task, gchar **paths)
+{
+  BamfMatcher *matcher = g_task_get_source_object (task);
 
-  return priv->active_application;
+  g_task_return_pointer (task, track_active_application_path (matcher, paths[0]), NULL);
+  g_object_unref (task);
+}
+
+static void
+on_active_application_ready (GObject *proxy, GAsyncResult *res, gpointer data)
+{
+  GTask *task = data;
+  char *app = NULL;
+  GError *error = NULL;
+
+  if (!_bamf_dbus_matcher_call_active_application_finish ((BamfDBusMatcher *) proxy, &app, res, &error))
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  prepare_paths (task, single_path_new (app), BAMF_FACTORY_APPLICATION,
+                 return_active_application);
+}
+
+/**
+ * bamf_matcher_get_active_application_async:
+ * @matcher: a #BamfMatcher
+ * @cancellable: (allow-none): a #GCancellable or %NULL
+ * @callback: (scope async): a callback to call when the result is ready
+ * @user_data: (closure): data to be sent to the callback
+ *
+ * Asynchronous version of bamf_matcher_get_active_application(), the daemon
+ * is not queried if the active application is already known.
+ *
+ * Since: 0.5.6
+ */
+void
+bamf_matcher_get_active_application_async (BamfMatcher *matcher,
+                                           GCancellable *cancellable,
+                                           GAsyncReadyCallback callback,
+                                           gpointer user_data)
+{
+  BamfMatcherPrivate *priv;
+  GTask *task;
+
+  g_return_if_fail (BAMF_IS_MATCHER (matcher));
+  priv = matcher->priv;
+
+  task = g_task_new (matcher, cancellable, callback, user_data);
+  g_task_set_source_tag (task, bamf_matcher_get_active_application_async);
+
+  if (BAMF_IS_APPLICATION (priv->active_application) &&
+      !bamf_view_is_closed (BAMF_VIEW (priv->active_application)))
+    {
+      g_task_return_pointer (task, priv->active_application, NULL);
+      g_object_unref (task);
+      return;
+    }
+
+  _bamf_dbus_matcher_call_active_application (priv->proxy, cancellable,
+                                              on_active_application_ready, task);
+}
+
+/**
+ * bamf_matcher_get_active_application_finish:
+ * @matcher: a #BamfMatcher
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns: (transfer none): The active #BamfApplication.
+ *
+ * Since: 0.5.6
+ */
+BamfApplication *
+bamf_matcher_get_active_application_finish (BamfMatcher *matcher,
+                                            GAsyncResult *result,
+                                            GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, matcher), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 /**
@@ -412,7 +612,6 @@ BamfWindow *
 bamf_matcher_get_active_window (BamfMatcher *matcher)
 {
   BamfMatcherPrivate *priv;
-  BamfView *view;
   char *win = NULL;
   GError *error = NULL;
 
@@ -433,16 +632,95 @@ bamf_matcher_get_active_window (BamfMatcher *matcher)
       return NULL;
     }
 
-  BamfFactory *factory = _bamf_factory_get_default ();
-  view = _bamf_factory_view_for_path_type (factory, win, BAMF_FACTORY_WINDOW);
+  track_active_window_path (matcher, win);
   g_free (win);
 
-  if (!BAMF_IS_WINDOW (view))
-    view = NULL;
+  return priv->active_window;
+}
+
+static void
+return_active_window (GTask *task, gchar **paths)
+{
+  BamfMatcher *matcher = g_task_get_source_object (task);
 
-  track_ptr (BAMF_TYPE_WINDOW, view, (gpointer *) &priv->active_window);
+  g_task_return_pointer (task, track_active_window_path (matcher, paths[0]), NULL);
+  g_object_unref (task);
+}
 
-  return priv->active_window;
+static void
+on_active_window_ready (GObject *proxy, GAsyncResult *res, gpointer data)
+{
+  GTask *task = data;
+  char *win = NULL;
+  GError *error = NULL;
+
+  if (!_bamf_dbus_matcher_call_active_window_finish ((BamfDBusMatcher *) proxy, &win, res, &error))
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  prepare_paths (task, single_path_new (win), BAMF_FACTORY_WINDOW, return_active_window);
+}
+
+/**
+ * bamf_matcher_get_active_window_async:
+ * @matcher: a #BamfMatcher
+ * @cancellable: (allow-none): a #GCancellable or %NULL
+ * @callback: (scope async): a callback to call when the result is ready
+ * @user_data: (closure): data to be sent to the callback
+ *
+ * Asynchronous version of bamf_matcher_get_active_window(), the daemon
+ * is not queried if the active window is already known.
+ *
+ * Since: 0.5.6
+ */
+void
+bamf_matcher_get_active_window_async (BamfMatcher *matcher,
+                                      GCancellable *cancellable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data)
+{
+  BamfMatcherPrivate *priv;
+  GTask *task;
+
+  g_return_if_fail (BAMF_IS_MATCHER (matcher));
+  priv = matcher->priv;
+
+  task = g_task_new (matcher, cancellable, callback, user_data);
+  g_task_set_source_tag (task, bamf_matcher_get_active_window_async);
+
+  if (BAMF_IS_WINDOW (priv->active_window) &&
+      !bamf_view_is_closed (BAMF_VIEW (priv->active_window)))
+    {
+      g_task_return_pointer (task, priv->active_window, NULL);
+      g_object_unref (task);
+      return;
+    }
+
+  _bamf_dbus_matcher_call_active_window (priv->proxy, cancellable,
+                                         on_active_window_ready, task);
+}
+
+/**
+ * bamf_matcher_get_active_window_finish:
+ * @matcher: a #BamfMatcher
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns: (transfer none): The active #BamfWindow.
+ *
+ * Since: 0.5.6
+ */
+BamfWindow *
+bamf_matcher_get_active_window_finish (BamfMatcher *matcher,
+                                       GAsyncResult *result,
+                                       GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, matcher), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 /**
@@ -534,6 +812,97 @@ bamf_matcher_get_application_for_xid (BamfMatcher  *matcher, guint32 xid)
   return BAMF_APPLICATION (view);
 }
 
+static void
+return_application_for_xid (GTask *task, gchar **paths)
+{
+  BamfView *view;
+
+  view = _bamf_factory_view_for_path_type (_bamf_factory_get_default (), paths[0],
+                                           BAMF_FACTORY_APPLICATION);
+
+  g_task_return_pointer (task, BAMF_IS_APPLICATION (view) ? view : NULL, NULL);
+  g_object_unref (task);
+}
+
+static void
+on_application_for_xid_ready (GObject *proxy, GAsyncResult *res, gpointer data)
+{
+  GTask *task = data;
+  char *app = NULL;
+  GError *error = NULL;
+
+  if (!_bamf_dbus_matcher_call_application_for_xid_finish ((BamfDBusMatcher *) proxy, &app, res, &error))
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  prepare_paths (task, single_path_new (app), BAMF_FACTORY_APPLICATION,
+                 return_application_for_xid);
+}
+
+/**
+ * bamf_matcher_get_application_for_xid_async:
+ * @matcher: a #BamfMatcher
+ * @xid: The XID to search for
+ * @cancellable: (allow-none): a #GCancellable or %NULL
+ * @callback: (scope async): a callback to call when the result is ready
+ * @user_data: (closure): data to be sent to the callback
+ *
+ * Asynchronous version of bamf_matcher_get_application_for_xid(), the daemon
+ * is not queried if the application is already known.
+ *
+ * Since: 0.5.6
+ */
+void
+bamf_matcher_get_application_for_xid_async (BamfMatcher *matcher,
+                                            guint32 xid,
+                                            GCancellable *cancellable,
+                                            GAsyncReadyCallback callback,
+                                            gpointer user_data)
+{
+  BamfApplication *app;
+  GTask *task;
+
+  g_return_if_fail (BAMF_IS_MATCHER (matcher));
+
+  task = g_task_new (matcher, cancellable, callback, user_data);
+  g_task_set_source_tag (task, bamf_matcher_get_application_for_xid_async);
+
+  app = _bamf_factory_app_for_xid (_bamf_factory_get_default (), xid);
+
+  if (BAMF_IS_APPLICATION (app))
+    {
+      g_task_return_pointer (task, app, NULL);
+      g_object_unref (task);
+      return;
+    }
+
+  _bamf_dbus_matcher_call_application_for_xid (matcher->priv->proxy, xid, cancellable,
+                                               on_application_for_xid_ready, task);
+}
+
+/**
+ * bamf_matcher_get_application_for_xid_finish:
+ * @matcher: a #BamfMatcher
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns: (transfer none): The #BamfApplication representing the xid passed, or NULL if none exists.
+ *
+ * Since: 0.5.6
+ */
+BamfApplication *
+bamf_matcher_get_application_for_xid_finish (BamfMatcher *matcher,
+                                             GAsyncResult *result,
+                                             GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, matcher), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 gboolean
 bamf_matcher_application_is_running (BamfMatcher *matcher, const gchar *app)
 {
@@ -565,6 +934,59 @@ bamf_matcher_application_is_running (BamfMatcher *matcher, const gchar *app)
   return running;
 }
 
+static void
+return_prepared_views (GTask *task, gchar **paths)
+{
+  BamfFactoryViewType type;
+  GList *views;
+
+  type = GPOINTER_TO_INT (g_task_get_task_data (task));
+
+  if (type == BAMF_FACTORY_APPLICATION)
+    views = views_for_paths (paths, type, BAMF_TYPE_APPLICATION);
+  else
+    views = views_for_paths (paths, type, BAMF_TYPE_WINDOW);
+
+  g_task_return_pointer (task, views, (GDestroyNotify) g_list_free);
+  g_object_unref (task);
+}
+
+static void
+return_views_for_paths (GTask *task, gchar **paths, GError *error)
+{
+  if (error)
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  prepare_paths (task, paths, GPOINTER_TO_INT (g_task_get_task_data (task)),
+                 return_prepared_views);
+}
+
+static GTask *
+views_task_new (BamfMatcher *matcher, BamfFactoryViewType type, gpointer source_tag,
+                GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+  GTask *task;
+
+  task = g_task_new (matcher, cancellable, callback, user_data);
+  g_task_set_source_tag (task, source_tag);
+  g_task_set_task_data (task, GINT_TO_POINTER (type), NULL);
+
+  return task;
+}
+
+static GList *
+views_task_finish (BamfMatcher *matcher, GAsyncResult *result, gpointer source_tag, GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, matcher), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == source_tag, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 /**
  * bamf_matcher_get_applications:
  * @matcher: a #BamfMatcher
@@ -580,10 +1002,8 @@ GList *
 bamf_matcher_get_applications (BamfMatcher *matcher)
 {
   BamfMatcherPrivate *priv;
-  BamfView *view;
   char **array = NULL;
-  int i, len;
-  GList *result = NULL;
+  GList *result;
   GError *error = NULL;
 
   g_return_val_if_fail (BAMF_IS_MATCHER (matcher), NULL);
@@ -597,24 +1017,65 @@ bamf_matcher_get_applications (BamfMatcher *matcher)
       return NULL;
     }
 
-  if (!array)
-    return NULL;
+  result = views_for_paths (array, BAMF_FACTORY_APPLICATION, BAMF_TYPE_APPLICATION);
+  g_strfreev (array);
 
-  BamfFactory *factory = _bamf_factory_get_default ();
-  len = g_strv_length (array);
-  for (i = len-1; i >= 0; --i)
-    {
-      view = _bamf_factory_view_for_path_type (factory, array[i], BAMF_FACTORY_APPLICATION);
+  return result;
+}
 
-      if (BAMF_IS_APPLICATION (view))
-        {
-          if (!g_list_find (result, view))
-            result = g_list_prepend (result, view);
-        }
-    }
+static void
+on_application_paths_ready (GObject *proxy, GAsyncResult *res, gpointer data)
+{
+  gchar **paths = NULL;
+  GError *error = NULL;
 
-  g_strfreev (array);
-  return result;
+  _bamf_dbus_matcher_call_application_paths_finish ((BamfDBusMatcher *) proxy, &paths, res, &error);
+  return_views_for_paths (data, paths, error);
+}
+
+/**
+ * bamf_matcher_get_applications_async:
+ * @matcher: a #BamfMatcher
+ * @cancellable: (allow-none): a #GCancellable or %NULL
+ * @callback: (scope async): a callback to call when the result is ready
+ * @user_data: (closure): data to be sent to the callback
+ *
+ * Asynchronous version of bamf_matcher_get_applications().
+ *
+ * Since: 0.5.6
+ */
+void
+bamf_matcher_get_applications_async (BamfMatcher *matcher,
+                                     GCancellable *cancellable,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data)
+{
+  GTask *task;
+
+  g_return_if_fail (BAMF_IS_MATCHER (matcher));
+
+  task = views_task_new (matcher, BAMF_FACTORY_APPLICATION, bamf_matcher_get_applications_async,
+                         cancellable, callback, user_data);
+  _bamf_dbus_matcher_call_application_paths (matcher->priv->proxy, cancellable,
+                                             on_application_paths_ready, task);
+}
+
+/**
+ * bamf_matcher_get_applications_finish:
+ * @matcher: a #BamfMatcher
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns: (element-type Bamf.Application) (transfer container): A list of #BamfApplication's.
+ *
+ * Since: 0.5.6
+ */
+GList *
+bamf_matcher_get_applications_finish (BamfMatcher *matcher,
+                                      GAsyncResult *result,
+                                      GError **error)
+{
+  return views_task_finish (matcher, result, bamf_matcher_get_applications_async, error);
 }
 
 /**
@@ -629,10 +1090,8 @@ GList *
 bamf_matcher_get_windows (BamfMatcher *matcher)
 {
   BamfMatcherPrivate *priv;
-  BamfView *view;
   char **array = NULL;
-  int i, len;
-  GList *result = NULL;
+  GList *result;
   GError *error = NULL;
 
   g_return_val_if_fail (BAMF_IS_MATCHER (matcher), NULL);
@@ -646,21 +1105,65 @@ bamf_matcher_get_windows (BamfMatcher *matcher)
       return NULL;
     }
 
-  if (!array)
-    return NULL;
+  result = views_for_paths (array, BAMF_FACTORY_WINDOW, BAMF_TYPE_WINDOW);
+  g_strfreev (array);
 
-  BamfFactory *factory = _bamf_factory_get_default ();
-  len = g_strv_length (array);
-  for (i = len-1; i >= 0; --i)
-    {
-      view = _bamf_factory_view_for_path_type (factory, array[i], BAMF_FACTORY_WINDOW);
+  return result;
+}
 
-      if (BAMF_IS_WINDOW (view))
-        result = g_list_prepend (result, view);
-    }
+static void
+on_window_paths_ready (GObject *proxy, GAsyncResult *res, gpointer data)
+{
+  gchar **paths = NULL;
+  GError *error = NULL;
 
-  g_strfreev (array);
-  return result;
+  _bamf_dbus_matcher_call_window_paths_finish ((BamfDBusMatcher *) proxy, &paths, res, &error);
+  return_views_for_paths (data, paths, error);
+}
+
+/**
+ * bamf_matcher_get_windows_async:
+ * @matcher: a #BamfMatcher
+ * @cancellable: (allow-none): a #GCancellable or %NULL
+ * @callback: (scope async): a callback to call when the result is ready
+ * @user_data: (closure): data to be sent to the callback
+ *
+ * Asynchronous version of bamf_matcher_get_windows().
+ *
+ * Since: 0.5.6
+ */
+void
+bamf_matcher_get_windows_async (BamfMatcher *matcher,
+                                GCancellable *cancellable,
+                                GAsyncReadyCallback callback,
+                                gpointer user_data)
+{
+  GTask *task;
+
+  g_return_if_fail (BAMF_IS_MATCHER (matcher));
+
+  task = views_task_new (matcher, BAMF_FACTORY_WINDOW, bamf_matcher_get_windows_async,
+                         cancellable, callback, user_data);
+  _bamf_dbus_matcher_call_window_paths (matcher->priv->proxy, cancellable,
+                                        on_window_paths_ready, task);
+}
+
+/**
+ * bamf_matcher_get_windows_finish:
+ * @matcher: a #BamfMatcher
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns: (element-type Bamf.Window) (transfer container): A list of #BamfWindow's.
+ *
+ * Since: 0.5.6
+ */
+GList *
+bamf_matcher_get_windows_finish (BamfMatcher *matcher,
+                                 GAsyncResult *result,
+                                 GError **error)
+{
+  return views_task_finish (matcher, result, bamf_matcher_get_windows_async, error);
 }
 
 /**
@@ -678,10 +1181,8 @@ GList *
 bamf_matcher_get_window_stack_for_monitor (BamfMatcher *matcher, gint monitor)
 {
   BamfMatcherPrivate *priv;
-  BamfView *view;
   char **array = NULL;
-  int i, len;
-  GList *result = NULL;
+  GList *result;
   GError *error = NULL;
 
   g_return_val_if_fail (BAMF_IS_MATCHER (matcher), NULL);
@@ -697,21 +1198,67 @@ bamf_matcher_get_window_stack_for_monitor (BamfMatcher *matcher, gint monitor)
       return NULL;
     }
 
-  if (!array)
-    return NULL;
+  result = views_for_paths (array, BAMF_FACTORY_WINDOW, BAMF_TYPE_WINDOW);
+  g_strfreev (array);
 
-  BamfFactory *factory = _bamf_factory_get_default ();
-  len = g_strv_length (array);
-  for (i = len-1; i >= 0; --i)
-    {
-      view = _bamf_factory_view_for_path_type (factory, array[i], BAMF_FACTORY_WINDOW);
+  return result;
+}
 
-      if (BAMF_IS_WINDOW (view))
-        result = g_list_prepend (result, view);
-    }
+static void
+on_window_stack_for_monitor_ready (GObject *proxy, GAsyncResult *res, gpointer data)
+{
+  gchar **paths = NULL;
+  GError *error = NULL;
 
-  g_strfreev (array);
-  return result;
+  _bamf_dbus_matcher_call_window_stack_for_monitor_finish ((BamfDBusMatcher *) proxy, &paths, res, &error);
+  return_views_for_paths (data, paths, error);
+}
+
+/**
+ * bamf_matcher_get_window_stack_for_monitor_async:
+ * @matcher: a #BamfMatcher
+ * @monitor: the monitor you want the stack from, negative value to get all
+ * @cancellable: (allow-none): a #GCancellable or %NULL
+ * @callback: (scope async): a callback to call when the result is ready
+ * @user_data: (closure): data to be sent to the callback
+ *
+ * Asynchronous version of bamf_matcher_get_window_stack_for_monitor().
+ *
+ * Since: 0.5.6
+ */
+void
+bamf_matcher_get_window_stack_for_monitor_async (BamfMatcher *matcher,
+                                                 gint monitor,
+                                                 GCancellable *cancellable,
+                                                 GAsyncReadyCallback callback,
+                                                 gpointer user_data)
+{
+  GTask *task;
+
+  g_return_if_fail (BAMF_IS_MATCHER (matcher));
+
+  task = views_task_new (matcher, BAMF_FACTORY_WINDOW, bamf_matcher_get_window_stack_for_monitor_async,
+                         cancellable, callback, user_data);
+  _bamf_dbus_matcher_call_window_stack_for_monitor (matcher->priv->proxy, monitor, cancellable,
+                                                    on_window_stack_for_monitor_ready, task);
+}
+
+/**
+ * bamf_matcher_get_window_stack_for_monitor_finish:
+ * @matcher: a #BamfMatcher
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns: (element-type Bamf.Window) (transfer container): A list of #BamfWindow's.
+ *
+ * Since: 0.5.6
+ */
+GList *
+bamf_matcher_get_window_stack_for_monitor_finish (BamfMatcher *matcher,
+                                                  GAsyncResult *result,
+                                                  GError **error)
+{
+  return views_task_finish (matcher, result, bamf_matcher_get_window_stack_for_monitor_async, error);
 }
 
 
@@ -754,10 +1301,8 @@ GList *
 bamf_matcher_get_running_applications (BamfMatcher *matcher)
 {
   BamfMatcherPrivate *priv;
-  BamfView *view;
   char **array = NULL;
-  int i, len;
-  GList *result = NULL;
+  GList *result;
   GError *error = NULL;
 
   g_return_val_if_fail (BAMF_IS_MATCHER (matcher), NULL);
@@ -771,21 +1316,65 @@ bamf_matcher_get_running_applications (BamfMatcher *matcher)
       return NULL;
     }
 
-  if (!array)
-    return NULL;
+  result = views_for_paths (array, BAMF_FACTORY_APPLICATION, BAMF_TYPE_APPLICATION);
+  g_strfreev (array);
 
-  BamfFactory *factory = _bamf_factory_get_default ();
-  len = g_strv_length (array);
-  for (i = len-1; i >= 0; --i)
-    {
-      view = _bamf_factory_view_for_path_type (factory, array[i], BAMF_FACTORY_APPLICATION);
+  return result;
+}
 
-      if (BAMF_IS_APPLICATION (view))
-        result = g_list_prepend (result, view);
-    }
+static void
+on_running_applications_ready (GObject *proxy, GAsyncResult *res, gpointer data)
+{
+  gchar **paths = NULL;
+  GError *error = NULL;
 
-  g_strfreev (array);
-  return result;
+  _bamf_dbus_matcher_call_running_applications_finish ((BamfDBusMatcher *) proxy, &paths, res, &error);
+  return_views_for_paths (data, paths, error);
+}
+
+/**
+ * bamf_matcher_get_running_applications_async:
+ * @matcher: a #BamfMatcher
+ * @cancellable: (allow-none): a #GCancellable or %NULL
+ * @callback: (scope async): a callback to call when the result is ready
+ * @user_data: (closure): data to be sent to the callback
+ *
+ * Asynchronous version of bamf_matcher_get_running_applications().
+ *
+ * Since: 0.5.6
+ */
+void
+bamf_matcher_get_running_applications_async (BamfMatcher *matcher,
+                                             GCancellable *cancellable,
+                                             GAsyncReadyCallback callback,
+                                             gpointer user_data)
+{
+  GTask *task;
+
+  g_return_if_fail (BAMF_IS_MATCHER (matcher));
+
+  task = views_task_new (matcher, BAMF_FACTORY_APPLICATION, bamf_matcher_get_running_applications_async,
+                         cancellable, callback, user_data);
+  _bamf_dbus_matcher_call_running_applications (matcher->priv->proxy, cancellable,
+                                                on_running_applications_ready, task);
+}
+
+/**
+ * bamf_matcher_get_running_applications_finish:
+ * @matcher: a #BamfMatcher
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns: (element-type Bamf.Application) (transfer container): A list of #BamfApplication's.
+ *
+ * Since: 0.5.6
+ */
+GList *
+bamf_matcher_get_running_applications_finish (BamfMatcher *matcher,
+                                              GAsyncResult *result,
+                                              GError **error)
+{
+  return views_task_finish (matcher, result, bamf_matcher_get_running_applications_async, error);
 }
 
 /**
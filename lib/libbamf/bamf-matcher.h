@@ -121,6 +121,72 @@ BamfApplication * bamf_matcher_get_application_for_desktop_file (BamfMatcher *ma
                                                                  const gchar *desktop_file_path,
                                                                  gboolean create_if_not_found);
 
+/* Asynchronous versions, sharing the caches of the functions above */
+void              bamf_matcher_get_active_application_async  (BamfMatcher *matcher,
+                                                              GCancellable *cancellable,
+                                                              GAsyncReadyCallback callback,
+                                                              gpointer user_data);
+
+BamfApplication * bamf_matcher_get_active_application_finish (BamfMatcher *matcher,
+                                                              GAsyncResult *result,
+                                                              GError **error);
+
+void              bamf_matcher_get_active_window_async       (BamfMatcher *matcher,
+                                                              GCancellable *cancellable,
+                                                              GAsyncReadyCallback callback,
+                                                              gpointer user_data);
+
+BamfWindow      * bamf_matcher_get_active_window_finish      (BamfMatcher *matcher,
+                                                              GAsyncResult *result,
+                                                              GError **error);
+
+void              bamf_matcher_get_application_for_xid_async (BamfMatcher *matcher,
+                                                              guint32 xid,
+                                                              GCancellable *cancellable,
+                                                              GAsyncReadyCallback callback,
+                                                              gpointer user_data);
+
+BamfApplication * bamf_matcher_get_application_for_xid_finish (BamfMatcher *matcher,
+                                                               GAsyncResult *result,
+                                                               GError **error);
+
+void              bamf_matcher_get_applications_async        (BamfMatcher *matcher,
+                                                              GCancellable *cancellable,
+                                                              GAsyncReadyCallback callback,
+                                                              gpointer user_data);
+
+GList *           bamf_matcher_get_applications_finish       (BamfMatcher *matcher,
+                                                              GAsyncResult *result,
+                                                              GError **error);
+
+void              bamf_matcher_get_running_applications_async (BamfMatcher *matcher,
+                                                               GCancellable *cancellable,
+                                                               GAsyncReadyCallback callback,
+                                                               gpointer user_data);
+
+GList *           bamf_matcher_get_running_applications_finish (BamfMatcher *matcher,
+                                                                GAsyncResult *result,
+                                                                GError **error);
+
+void              bamf_matcher_get_windows_async             (BamfMatcher *matcher,
+                                                              GCancellable *cancellable,
+                                                              GAsyncReadyCallback callback,
+                                                              gpointer user_data);
+
+GList *           bamf_matcher_get_windows_finish            (BamfMatcher *matcher,
+                                                              GAsyncResult *result,
+                                                              GError **error);
+
+void              bamf_matcher_get_window_stack_for_monitor_async (BamfMatcher *matcher,
+                                                                   gint monitor,
+                                                                   GCancellable *cancellable,
+                                                                   GAsyncReadyCallback callback,
+                                                                   gpointer user_data);
+
+GList *           bamf_matcher_get_window_stack_for_monitor_finish (BamfMatcher *matcher,
+                                                                    GAsyncResult *result,
+                                                                    GError **error);
+
 G_END_DECLS
 
 #endif
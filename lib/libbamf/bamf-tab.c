@@ -28,6 +28,7 @@
 #include <libbamf-private/bamf-private.h>
 #include "bamf-tab.h"
 #include "bamf-view-private.h"
+#include "bamf-factory.h"
 
 #define BAMF_TAB_GET_PRIVATE(object) (G_TYPE_INSTANCE_GET_PRIVATE (object, BAMF_TYPE_TAB, BamfTabPrivate))
 
@@ -63,17 +64,26 @@ bamf_tab_set_path (BamfView *view, const gchar *path)
 {
   BamfTab *self;
   BamfTabPrivate *priv;
+  const BamfFactoryViewState *state;
   GError *error = NULL;
 
   self = BAMF_TAB (view);
   priv = self->priv;
+  state = _bamf_factory_peek_view_state (_bamf_factory_get_default (), path);
 
   bamf_tab_unset_proxy (self);
-  priv->proxy = _bamf_dbus_item_tab_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
-                                                            G_DBUS_PROXY_FLAGS_NONE,
-                                                            BAMF_DBUS_SERVICE_NAME,
-                                                            path, CANCELLABLE (view),
-                                                            &error);
+  priv->proxy = (BamfDBusItemTab *) _bamf_factory_steal_view_proxy (_bamf_factory_get_default (), path,
+                                                                     BAMF_DBUS_ITEM_TYPE_TAB_PROXY);
+
+  if (!priv->proxy)
+    {
+      priv->proxy = _bamf_dbus_item_tab_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
+                                                                state ? G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES :
+                                                                        G_DBUS_PROXY_FLAGS_NONE,
+                                                                BAMF_DBUS_SERVICE_NAME,
+                                                                path, CANCELLABLE (view),
+                                                                &error);
+    }
   if (!G_IS_DBUS_PROXY (priv->proxy))
     {
       g_error ("Unable to get %s tab: %s", BAMF_DBUS_SERVICE_NAME, error ? error->message : "");
@@ -82,6 +92,10 @@ bamf_tab_set_path (BamfView *view, const gchar *path)
     }
 
   g_dbus_proxy_set_default_timeout (G_DBUS_PROXY (priv->proxy), BAMF_DBUS_DEFAULT_TIMEOUT);
+
+  if (state)
+    _bamf_factory_seed_proxy_properties (G_DBUS_PROXY (priv->proxy), state->properties);
+
   g_signal_connect (priv->proxy, "notify", G_CALLBACK (on_proxy_property_change), self);
 }
 
@@ -95,6 +95,33 @@ struct _BamfViewPrivate
 
 static void bamf_view_unset_proxy (BamfView *self);
 
+static void
+cache_children_paths (BamfView *view, gchar **children)
+{
+  BamfViewPrivate *priv = view->priv;
+  GList *results = NULL;
+  BamfView *child;
+  int i, len;
+
+  len = g_strv_length (children);
+
+  for (i = len-1; i >= 0; --i)
+    {
+      child = _bamf_factory_view_for_path (_bamf_factory_get_default (), children[i]);
+
+      if (BAMF_IS_VIEW (child))
+        {
+          results = g_list_prepend (results, g_object_ref (child));
+        }
+    }
+
+  if (priv->cached_children)
+    g_list_free_full (priv->cached_children, g_object_unref);
+
+  priv->reload_children = FALSE;
+  priv->cached_children = results;
+}
+
 /**
  * bamf_view_get_children:
  * @view: a #BamfView
@@ -129,11 +156,8 @@ GList *
 bamf_view_peek_children (BamfView *view)
 {
   char ** children;
-  int i, len;
-  GList *results = NULL;
   GError *error = NULL;
   BamfViewPrivate *priv;
-  BamfView *child;
 
   g_return_val_if_fail (BAMF_IS_VIEW (view), NULL);
 
@@ -155,25 +179,109 @@ bamf_view_peek_children (BamfView *view)
   if (!children)
     return NULL;
 
-  len = g_strv_length (children);
+  cache_children_paths (view, children);
+  g_strfreev (children);
 
-  for (i = len-1; i >= 0; --i)
+  return priv->cached_children;
+}
+
+static void
+on_children_ready (GObject *proxy, GAsyncResult *res, gpointer data)
+{
+  GTask *task = data;
+  BamfView *view = g_task_get_source_object (task);
+  gchar **children = NULL;
+  GError *error = NULL;
+
+  if (!_bamf_dbus_item_view_call_children_finish ((BamfDBusItemView *) proxy, &children, res, &error))
     {
-      child = _bamf_factory_view_for_path (_bamf_factory_get_default (), children[i]);
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
 
-      if (BAMF_IS_VIEW (child))
-        {
-          results = g_list_prepend (results, g_object_ref (child));
-        }
+  if (children)
+    cache_children_paths (view, children);
+
+  g_strfreev (children);
+
+  g_task_return_pointer (task, g_list_copy (view->priv->cached_children),
+                         (GDestroyNotify) g_list_free);
+  g_object_unref (task);
+}
+
+/**
+ * bamf_view_get_children_async:
+ * @view: a #BamfView
+ * @cancellable: (allow-none): a #GCancellable or %NULL
+ * @callback: (scope async): a callback to call when the result is ready
+ * @user_data: (closure): data to be sent to the callback
+ *
+ * Asynchronous version of bamf_view_get_children(), the daemon is not queried
+ * if the children of the view are already known.
+ *
+ * Since: 0.5.6
+ */
+void
+bamf_view_get_children_async (BamfView *view,
+                              GCancellable *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer user_data)
+{
+  BamfViewPrivate *priv;
+  GTask *task;
+
+  g_return_if_fail (BAMF_IS_VIEW (view));
+  priv = view->priv;
+
+  task = g_task_new (view, cancellable, callback, user_data);
+  g_task_set_source_tag (task, bamf_view_get_children_async);
+
+  if (BAMF_VIEW_GET_CLASS (view)->get_children)
+    {
+      g_task_return_pointer (task, BAMF_VIEW_GET_CLASS (view)->get_children (view),
+                             (GDestroyNotify) g_list_free);
+      g_object_unref (task);
+      return;
     }
 
-  if (priv->cached_children)
-    g_list_free_full (priv->cached_children, g_object_unref);
+  if (!_bamf_view_remote_ready (view))
+    {
+      g_task_return_pointer (task, NULL, NULL);
+      g_object_unref (task);
+      return;
+    }
 
-  priv->reload_children = FALSE;
-  priv->cached_children = results;
+  if (priv->cached_children || !priv->reload_children)
+    {
+      g_task_return_pointer (task, g_list_copy (priv->cached_children),
+                             (GDestroyNotify) g_list_free);
+      g_object_unref (task);
+      return;
+    }
 
-  return priv->cached_children;
+  _bamf_dbus_item_view_call_children (priv->proxy, cancellable, on_children_ready, task);
+}
+
+/**
+ * bamf_view_get_children_finish:
+ * @view: a #BamfView
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns: (element-type Bamf.View) (transfer container): Returns a list of #BamfView which must be
+ *           freed after usage. Elements of the list are owned by bamf and should not be unreffed.
+ *
+ * Since: 0.5.6
+ */
+GList *
+bamf_view_get_children_finish (BamfView *view,
+                               GAsyncResult *result,
+                               GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, view), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 /**
@@ -839,10 +947,38 @@ _bamf_view_reset_flags (BamfView *view)
   g_object_notify (G_OBJECT (view->priv->proxy), "name");
 }
 
+static void
+bamf_view_load_state (BamfView *view, const BamfFactoryViewState *state)
+{
+  BamfViewPrivate *priv = view->priv;
+  BamfFactory *factory = _bamf_factory_get_default ();
+  GList *children = NULL;
+  BamfView *child;
+  int i;
+
+  _bamf_factory_seed_proxy_properties (G_DBUS_PROXY (priv->proxy), state->properties);
+
+  g_free (priv->type);
+  priv->type = g_strdup (state->type);
+
+  for (i = g_strv_length (state->children) - 1; i >= 0; --i)
+    {
+      child = _bamf_factory_view_for_path (factory, state->children[i]);
+
+      if (BAMF_IS_VIEW (child))
+        children = g_list_prepend (children, g_object_ref (child));
+    }
+
+  g_list_free_full (priv->cached_children, g_object_unref);
+  priv->cached_children = children;
+  priv->reload_children = FALSE;
+}
+
 void
 _bamf_view_set_path (BamfView *view, const char *path)
 {
   BamfViewPrivate *priv;
+  const BamfFactoryViewState *state;
   GError *error = NULL;
 
   g_return_if_fail (BAMF_IS_VIEW (view));
@@ -861,12 +997,20 @@ _bamf_view_set_path (BamfView *view, const char *path)
 
   priv = view->priv;
   priv->reload_children = TRUE;
+  state = _bamf_factory_peek_view_state (_bamf_factory_get_default (), path);
 
-  priv->proxy = _bamf_dbus_item_view_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
-                                                             G_DBUS_PROXY_FLAGS_NONE,
-                                                             BAMF_DBUS_SERVICE_NAME,
-                                                             path, CANCELLABLE (view),
-                                                             &error);
+  priv->proxy = (BamfDBusItemView *) _bamf_factory_steal_view_proxy (_bamf_factory_get_default (), path,
+                                                                      BAMF_DBUS_ITEM_TYPE_VIEW_PROXY);
+
+  if (!priv->proxy)
+    {
+      priv->proxy = _bamf_dbus_item_view_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
+                                                                 state ? G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES :
+                                                                         G_DBUS_PROXY_FLAGS_NONE,
+                                                                 BAMF_DBUS_SERVICE_NAME,
+                                                                 path, CANCELLABLE (view),
+                                                                 &error);
+    }
   if (!G_IS_DBUS_PROXY (priv->proxy))
     {
       g_critical ("Unable to get %s view: %s", BAMF_DBUS_SERVICE_NAME, error ? error ? error->message : "" : "");
@@ -875,6 +1019,10 @@ _bamf_view_set_path (BamfView *view, const char *path)
     }
 
   g_dbus_proxy_set_default_timeout (G_DBUS_PROXY (priv->proxy), BAMF_DBUS_DEFAULT_TIMEOUT);
+
+  if (state)
+    bamf_view_load_state (view, state);
+
   g_object_notify_by_pspec (G_OBJECT (view), properties[PROP_PATH]);
 
   g_signal_connect (priv->proxy, "notify::g-name-owner",
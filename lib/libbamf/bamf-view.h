@@ -29,6 +29,7 @@
 #define _BAMF_VIEW_H_
 
 #include <glib-object.h>
+#include <gio/gio.h>
 
 G_BEGIN_DECLS
 
@@ -125,6 +126,15 @@ GList    * bamf_view_get_children  (BamfView *view);
 
 GList    * bamf_view_peek_children (BamfView *view);
 
+void       bamf_view_get_children_async  (BamfView *view,
+                                          GCancellable *cancellable,
+                                          GAsyncReadyCallback callback,
+                                          gpointer user_data);
+
+GList    * bamf_view_get_children_finish (BamfView *view,
+                                          GAsyncResult *result,
+                                          GError **error);
+
 gboolean   bamf_view_has_child     (BamfView *view, BamfView *child);
 
 gboolean   bamf_view_is_closed     (BamfView *view);
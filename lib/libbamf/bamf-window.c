@@ -189,6 +189,95 @@ bamf_window_get_pid (BamfWindow *self)
   return priv->pid;
 }
 
+static void
+on_pid_ready (GObject *proxy, GAsyncResult *res, gpointer data)
+{
+  GTask *task = data;
+  BamfWindow *self = g_task_get_source_object (task);
+  guint32 pid = 0;
+  GError *error = NULL;
+
+  if (!_bamf_dbus_item_window_call_get_pid_finish ((BamfDBusItemWindow *) proxy, &pid, res, &error))
+    {
+      g_task_return_error (task, error);
+    }
+  else
+    {
+      self->priv->pid = pid;
+      g_task_return_int (task, pid);
+    }
+
+  g_object_unref (task);
+}
+
+/**
+ * bamf_window_get_pid_async:
+ * @self: a #BamfWindow
+ * @cancellable: (allow-none): a #GCancellable or %NULL
+ * @callback: (scope async): a callback to call when the result is ready
+ * @user_data: (closure): data to be sent to the callback
+ *
+ * Asynchronous version of bamf_window_get_pid(), the daemon is not queried
+ * if the pid of the window is already known.
+ *
+ * Since: 0.5.6
+ */
+void
+bamf_window_get_pid_async (BamfWindow *self,
+                           GCancellable *cancellable,
+                           GAsyncReadyCallback callback,
+                           gpointer user_data)
+{
+  BamfWindowPrivate *priv;
+  GTask *task;
+
+  g_return_if_fail (BAMF_IS_WINDOW (self));
+  priv = self->priv;
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, bamf_window_get_pid_async);
+
+  if (BAMF_WINDOW_GET_CLASS (self)->get_pid)
+    {
+      g_task_return_int (task, BAMF_WINDOW_GET_CLASS (self)->get_pid (self));
+      g_object_unref (task);
+      return;
+    }
+
+  if (priv->pid != 0 || !_bamf_view_remote_ready (BAMF_VIEW (self)))
+    {
+      g_task_return_int (task, priv->pid);
+      g_object_unref (task);
+      return;
+    }
+
+  _bamf_dbus_item_window_call_get_pid (priv->proxy, cancellable, on_pid_ready, task);
+}
+
+/**
+ * bamf_window_get_pid_finish:
+ * @self: a #BamfWindow
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns: The pid of the window, or 0 on error.
+ *
+ * Since: 0.5.6
+ */
+guint32
+bamf_window_get_pid_finish (BamfWindow *self,
+                            GAsyncResult *result,
+                            GError **error)
+{
+  gssize pid;
+
+  g_return_val_if_fail (g_task_is_valid (result, self), 0);
+
+  pid = g_task_propagate_int (G_TASK (result), error);
+
+  return pid > 0 ? pid : 0;
+}
+
 guint32
 bamf_window_get_xid (BamfWindow *self)
 {
@@ -255,6 +344,94 @@ bamf_window_get_utf8_prop (BamfWindow *self, const char* xprop)
   return result;
 }
 
+static void
+on_xprop_ready (GObject *proxy, GAsyncResult *res, gpointer data)
+{
+  GTask *task = data;
+  char *result = NULL;
+  GError *error = NULL;
+
+  if (!_bamf_dbus_item_window_call_xprop_finish ((BamfDBusItemWindow *) proxy, &result, res, &error))
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  if (result && result[0] == '\0')
+    {
+      g_free (result);
+      result = NULL;
+    }
+
+  g_task_return_pointer (task, result, g_free);
+  g_object_unref (task);
+}
+
+/**
+ * bamf_window_get_utf8_prop_async:
+ * @self: a #BamfWindow
+ * @prop: the X property name
+ * @cancellable: (allow-none): a #GCancellable or %NULL
+ * @callback: (scope async): a callback to call when the result is ready
+ * @user_data: (closure): data to be sent to the callback
+ *
+ * Asynchronous version of bamf_window_get_utf8_prop().
+ *
+ * Since: 0.5.6
+ */
+void
+bamf_window_get_utf8_prop_async (BamfWindow *self,
+                                 const char *prop,
+                                 GCancellable *cancellable,
+                                 GAsyncReadyCallback callback,
+                                 gpointer user_data)
+{
+  GTask *task;
+
+  g_return_if_fail (BAMF_IS_WINDOW (self));
+  g_return_if_fail (prop);
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, bamf_window_get_utf8_prop_async);
+
+  if (BAMF_WINDOW_GET_CLASS (self)->get_utf8_prop)
+    {
+      g_task_return_pointer (task, BAMF_WINDOW_GET_CLASS (self)->get_utf8_prop (self, prop), g_free);
+      g_object_unref (task);
+      return;
+    }
+
+  if (!_bamf_view_remote_ready (BAMF_VIEW (self)))
+    {
+      g_task_return_pointer (task, NULL, NULL);
+      g_object_unref (task);
+      return;
+    }
+
+  _bamf_dbus_item_window_call_xprop (self->priv->proxy, prop, cancellable, on_xprop_ready, task);
+}
+
+/**
+ * bamf_window_get_utf8_prop_finish:
+ * @self: a #BamfWindow
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns: (transfer full) (allow-none): The property value, or %NULL if unset.
+ *
+ * Since: 0.5.6
+ */
+gchar *
+bamf_window_get_utf8_prop_finish (BamfWindow *self,
+                                  GAsyncResult *result,
+                                  GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 gint
 bamf_window_get_monitor (BamfWindow *self)
 {
@@ -359,22 +536,43 @@ bamf_window_unset_proxy (BamfWindow *self)
   priv->proxy = NULL;
 }
 
+static void
+bamf_window_load_state (BamfWindow *self, GVariant *properties)
+{
+  BamfWindowPrivate *priv = self->priv;
+
+  g_variant_lookup (properties, "Xid", "u", &priv->xid);
+  g_variant_lookup (properties, "Pid", "u", &priv->pid);
+  g_variant_lookup (properties, "WindowType", "u", &priv->type);
+  g_variant_lookup (properties, "Monitor", "i", &priv->monitor);
+  g_variant_lookup (properties, "Maximized", "i", &priv->maximized);
+}
+
 static void
 bamf_window_set_path (BamfView *view, const char *path)
 {
   BamfWindow *self;
   BamfWindowPrivate *priv;
+  const BamfFactoryViewState *state;
   GError *error = NULL;
 
   self = BAMF_WINDOW (view);
   priv = self->priv;
 
   bamf_window_unset_proxy (self);
-  priv->proxy = _bamf_dbus_item_window_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
-                                                               G_DBUS_PROXY_FLAGS_NONE,
-                                                               BAMF_DBUS_SERVICE_NAME,
-                                                               path, CANCELLABLE (self),
-                                                               &error);
+
+  priv->proxy = (BamfDBusItemWindow *) _bamf_factory_steal_view_proxy (_bamf_factory_get_default (), path,
+                                                                        BAMF_DBUS_ITEM_TYPE_WINDOW_PROXY);
+
+  if (!priv->proxy)
+    {
+      /* The interface has no properties, no need to ask the daemon for them */
+      priv->proxy = _bamf_dbus_item_window_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
+                                                                   G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
+                                                                   BAMF_DBUS_SERVICE_NAME,
+                                                                   path, CANCELLABLE (self),
+                                                                   &error);
+    }
   if (!G_IS_DBUS_PROXY (priv->proxy))
     {
       g_error ("Unable to get %s window: %s", BAMF_DBUS_SERVICE_NAME, error ? error->message : "");
@@ -384,6 +582,11 @@ bamf_window_set_path (BamfView *view, const char *path)
 
   g_dbus_proxy_set_default_timeout (G_DBUS_PROXY (priv->proxy), BAMF_DBUS_DEFAULT_TIMEOUT);
 
+  state = _bamf_factory_peek_view_state (_bamf_factory_get_default (), path);
+
+  if (state)
+    bamf_window_load_state (self, state->properties);
+
   priv->xid = bamf_window_get_xid (self);
   priv->type = bamf_window_get_window_type (self);
   priv->monitor = bamf_window_get_monitor (self);
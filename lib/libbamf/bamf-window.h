@@ -127,6 +127,25 @@ BamfWindowMaximizationType bamf_window_maximized        (BamfWindow *self);
 
 time_t            bamf_window_last_active               (BamfWindow *self);
 
+void              bamf_window_get_pid_async             (BamfWindow *self,
+                                                         GCancellable *cancellable,
+                                                         GAsyncReadyCallback callback,
+                                                         gpointer user_data);
+
+guint32           bamf_window_get_pid_finish            (BamfWindow *self,
+                                                         GAsyncResult *result,
+                                                         GError **error);
+
+void              bamf_window_get_utf8_prop_async       (BamfWindow *self,
+                                                         const char *prop,
+                                                         GCancellable *cancellable,
+                                                         GAsyncReadyCallback callback,
+                                                         gpointer user_data);
+
+gchar           * bamf_window_get_utf8_prop_finish      (BamfWindow *self,
+                                                         GAsyncResult *result,
+                                                         GError **error);
+
 G_END_DECLS
 
 #endif
@@ -45,6 +45,7 @@ struct _BamfApplicationPrivate
   GList * desktop_file_list;
   char * wmclass;
   char ** mimes;
+  gboolean mimes_loaded;
   gboolean show_stubs;
 };
 
@@ -84,6 +85,7 @@ bamf_application_supported_mime_types_changed (BamfApplication *application,
     g_strfreev (application->priv->mimes);
 
   application->priv->mimes = mimes;
+  application->priv->mimes_loaded = TRUE;
 }
 
 static gboolean
@@ -128,13 +130,15 @@ bamf_application_get_supported_mime_types (BamfApplication *application)
 
   g_return_val_if_fail (BAMF_IS_APPLICATION (application), NULL);
 
-  if (application->priv->mimes)
+  /* An application without mime types is loaded only once as well */
+  if (application->priv->mimes_loaded)
     return g_strdupv (application->priv->mimes);
 
   if (BAMF_APPLICATION_GET_CLASS (application)->get_supported_mime_types)
     mimes = BAMF_APPLICATION_GET_CLASS (application)->get_supported_mime_types (application);
 
   application->priv->mimes = mimes;
+  application->priv->mimes_loaded = TRUE;
 
   return g_strdupv (mimes);
 }
@@ -393,6 +397,10 @@ bamf_application_set_desktop_file (BamfApplication *application,
   if (desktop_file && desktop_file[0] != '\0')
     application->priv->desktop_file = g_strdup (desktop_file);
 
+  /* The mime types are read again from the new desktop file when requested */
+  g_clear_pointer (&application->priv->mimes, g_strfreev);
+  application->priv->mimes_loaded = FALSE;
+
   if (application->priv->main_child)
     {
       g_signal_handlers_disconnect_by_func (application->priv->main_child,
@@ -1287,30 +1295,55 @@ on_dbus_handle_application_menu (BamfDBusItemApplication *interface,
   return TRUE;
 }
 
-static gboolean
-on_dbus_handle_application_type (BamfDBusItemApplication *interface,
-                                 GDBusMethodInvocation *invocation,
-                                 BamfApplication *self)
+static const char *
+bamf_application_get_application_type_string (BamfApplication *self)
 {
-  const char *type = "";
-
   switch (self->priv->app_type)
     {
       case BAMF_APPLICATION_SYSTEM:
-        type = "system";
-        break;
+        return "system";
       case BAMF_APPLICATION_WEB:
-        type = "webapp";
-        break;
+        return "webapp";
       default:
-        type = "unknown";
+        return "unknown";
     }
+}
+
+static gboolean
+on_dbus_handle_application_type (BamfDBusItemApplication *interface,
+                                 GDBusMethodInvocation *invocation,
+                                 BamfApplication *self)
+{
+  const char *type = bamf_application_get_application_type_string (self);
 
   g_dbus_method_invocation_return_value (invocation, g_variant_new ("(s)", type));
 
   return TRUE;
 }
 
+static void
+bamf_application_state_properties (BamfView *view, GVariantBuilder *properties)
+{
+  BamfApplication *self = BAMF_APPLICATION (view);
+  const char *desktop_file = self->priv->desktop_file;
+  gchar **mimes = self->priv->mimes;
+
+  g_variant_builder_add (properties, "{sv}", "DesktopFile",
+                         g_variant_new_string (desktop_file ? desktop_file : ""));
+  g_variant_builder_add (properties, "{sv}", "ApplicationType",
+                         g_variant_new_string (bamf_application_get_application_type_string (self)));
+  g_variant_builder_add (properties, "{sv}", "ShowStubs",
+                         g_variant_new_boolean (bamf_application_get_show_stubs (self)));
+
+  /* Reading the mime types may touch the disk and emit a change, so they're
+   * part of the state only once loaded; clients fetch them otherwise */
+  if (self->priv->mimes_loaded)
+    {
+      g_variant_builder_add (properties, "{sv}", "SupportedMimeTypes",
+                             g_variant_new_strv ((const gchar **) mimes, mimes ? -1 : 0));
+    }
+}
+
 static void
 bamf_application_dispose (GObject *object)
 {
@@ -1442,6 +1475,7 @@ bamf_application_class_init (BamfApplicationClass * klass)
   view_class->child_removed = bamf_application_child_removed;
   view_class->starting_changed = bamf_application_starting_changed;
   view_class->stable_bus_name = bamf_application_get_stable_bus_name;
+  view_class->state_properties = bamf_application_state_properties;
 
   klass->get_supported_mime_types = bamf_application_default_get_supported_mime_types;
   klass->get_close_when_empty = bamf_application_default_get_close_when_empty;
@@ -20,6 +20,7 @@
 #include "bamf-daemon.h"
 #include "bamf-matcher.h"
 #include "bamf-control.h"
+#include "bamf-stats.h"
 
 G_DEFINE_TYPE (BamfDaemon, bamf_daemon, G_TYPE_OBJECT);
 #define BAMF_DAEMON_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE(obj, \
@@ -31,6 +32,7 @@ struct _BamfDaemonPrivate
 {
   BamfMatcher *matcher;
   BamfControl *control;
+  BamfStats *stats;
   GMainLoop *loop;
 };
 
@@ -60,6 +62,7 @@ bamf_on_bus_acquired (GDBusConnection *connection, const gchar *name,
 
   self->priv->matcher = bamf_matcher_get_default ();
   self->priv->control = bamf_control_get_default ();
+  self->priv->stats = bamf_stats_get_default ();
 
   g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (self->priv->matcher),
                                     connection,
@@ -84,6 +87,19 @@ bamf_on_bus_acquired (GDBusConnection *connection, const gchar *name,
                                                                 error->message);
       g_clear_error (&error);
     }
+
+  /* Stats are provided as a further interface of the matcher object */
+  g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (self->priv->stats),
+                                    connection,
+                                    BAMF_DBUS_MATCHER_PATH,
+                                    &error);
+
+  if (error)
+    {
+      g_critical ("Can't register BAMF stats at path %s: %s", BAMF_DBUS_MATCHER_PATH,
+                                                              error->message);
+      g_clear_error (&error);
+    }
 }
 
 static void
@@ -136,6 +152,12 @@ bamf_daemon_stop (BamfDaemon *self)
       self->priv->control = NULL;
     }
 
+  if (self->priv->stats)
+    {
+      g_object_unref (self->priv->stats);
+      self->priv->stats = NULL;
+    }
+
   g_main_loop_quit (self->priv->loop);
 }
 
@@ -0,0 +1,391 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+#include "bamf-desktop-cache.h"
+
+#include <errno.h>
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+
+/* The cache is a serialized GVariant, so it can be mapped in memory and read
+ * in place. Its layout is:
+ *   (version, context, [(directory, mtime, [(path, exec, id, class, no_display)])])
+ * where the context is the XDG_CURRENT_DESKTOP value the entries have been
+ * filtered for (the ShowIn rules are already applied to the cached data). */
+#define CACHE_ENTRY_TYPE "(ssssb)"
+#define CACHE_DIRECTORY_TYPE "(sta" CACHE_ENTRY_TYPE ")"
+#define CACHE_TYPE "(usa" CACHE_DIRECTORY_TYPE ")"
+
+struct _BamfDesktopCache
+{
+  gchar      * path;
+  gchar      * context;
+  GVariant   * data;
+  GHashTable * cached_dirs;
+  GHashTable * dirs;
+  gboolean     dirty;
+};
+
+BamfDesktopEntry *
+bamf_desktop_entry_new (const gchar *path,
+                        const gchar *exec,
+                        const gchar *desktop_id,
+                        const gchar *desktop_class,
+                        gboolean no_display)
+{
+  BamfDesktopEntry *entry;
+
+  g_return_val_if_fail (path, NULL);
+  g_return_val_if_fail (exec, NULL);
+  g_return_val_if_fail (desktop_id, NULL);
+
+  entry = g_slice_new0 (BamfDesktopEntry);
+  entry->path = g_strdup (path);
+  entry->exec = g_strdup (exec);
+  entry->desktop_id = g_strdup (desktop_id);
+  entry->no_display = no_display;
+
+  if (desktop_class && desktop_class[0] != '\0')
+    entry->desktop_class = g_strdup (desktop_class);
+
+  return entry;
+}
+
+void
+bamf_desktop_entry_free (BamfDesktopEntry *entry)
+{
+  if (!entry)
+    return;
+
+  g_free (entry->path);
+  g_free (entry->exec);
+  g_free (entry->desktop_id);
+  g_free (entry->desktop_class);
+  g_slice_free (BamfDesktopEntry, entry);
+}
+
+gchar *
+bamf_desktop_cache_get_default_path (void)
+{
+  return g_build_filename (g_get_user_cache_dir (), "bamf", BAMF_DESKTOP_CACHE_NAME, NULL);
+}
+
+static void
+bamf_desktop_cache_load (BamfDesktopCache *cache)
+{
+  GVariant *dirs;
+  const gchar *context;
+  guint32 version;
+  gsize i, n_dirs;
+
+  /* Invalid or foreign data is safely read back as default values by GVariant,
+   * so a corrupted cache just results in a version mismatch */
+  g_variant_get_child (cache->data, 0, "u", &version);
+  g_variant_get_child (cache->data, 1, "&s", &context);
+
+  if (version != BAMF_DESKTOP_CACHE_VERSION || g_strcmp0 (context, cache->context) != 0)
+    return;
+
+  dirs = g_variant_get_child_value (cache->data, 2);
+  n_dirs = g_variant_n_children (dirs);
+
+  for (i = 0; i < n_dirs; ++i)
+    {
+      GVariant *dir_data = g_variant_get_child_value (dirs, i);
+      const gchar *directory;
+
+      g_variant_get_child (dir_data, 0, "&s", &directory);
+      g_hash_table_insert (cache->cached_dirs, g_strdup (directory), dir_data);
+    }
+
+  g_variant_unref (dirs);
+}
+
+BamfDesktopCache *
+bamf_desktop_cache_new (const gchar *cache_file, const gchar *context)
+{
+  BamfDesktopCache *cache;
+  GMappedFile *mapped;
+
+  g_return_val_if_fail (cache_file, NULL);
+
+  cache = g_new0 (BamfDesktopCache, 1);
+  cache->path = g_strdup (cache_file);
+  cache->context = g_strdup (context ? context : "");
+  cache->cached_dirs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                              (GDestroyNotify) g_variant_unref);
+  cache->dirs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                       (GDestroyNotify) g_variant_unref);
+
+  mapped = g_mapped_file_new (cache_file, FALSE, NULL);
+
+  if (mapped)
+    {
+      if (g_mapped_file_get_length (mapped) > 0)
+        {
+          GVariant *data;
+          data = g_variant_new_from_data (G_VARIANT_TYPE (CACHE_TYPE),
+                                          g_mapped_file_get_contents (mapped),
+                                          g_mapped_file_get_length (mapped),
+                                          FALSE,
+                                          (GDestroyNotify) g_mapped_file_unref,
+                                          mapped);
+          cache->data = g_variant_ref_sink (data);
+          bamf_desktop_cache_load (cache);
+        }
+      else
+        {
+          g_mapped_file_unref (mapped);
+        }
+    }
+
+  return cache;
+}
+
+void
+bamf_desktop_cache_free (BamfDesktopCache *cache)
+{
+  if (!cache)
+    return;
+
+  g_hash_table_destroy (cache->cached_dirs);
+  g_hash_table_destroy (cache->dirs);
+
+  if (cache->data)
+    g_variant_unref (cache->data);
+
+  g_free (cache->context);
+  g_free (cache->path);
+  g_free (cache);
+}
+
+static guint64
+file_info_get_mtime (GFileInfo *info)
+{
+  guint64 mtime;
+
+  mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC;
+  mtime += g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+
+  return mtime;
+}
+
+guint64
+bamf_desktop_cache_get_mtime (const gchar *path)
+{
+  GFile *file;
+  GFileInfo *info;
+  guint64 mtime = 0;
+
+  g_return_val_if_fail (path, 0);
+
+  file = g_file_new_for_path (path);
+  info = g_file_query_info (file, G_FILE_ATTRIBUTE_TIME_MODIFIED","
+                                  G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                            G_FILE_QUERY_INFO_NONE, NULL, NULL);
+
+  if (info)
+    {
+      mtime = file_info_get_mtime (info);
+      g_object_unref (info);
+    }
+
+  g_object_unref (file);
+
+  return mtime;
+}
+
+/* The mtime of a directory only changes when its files are added, removed or
+ * renamed, so the newest mtime of its files is used as well, not to miss the
+ * files that have been edited in place. */
+guint64
+bamf_desktop_cache_get_directory_mtime (const gchar *directory)
+{
+  GFile *file;
+  GFileEnumerator *enumerator;
+  GFileInfo *info;
+  guint64 mtime;
+
+  g_return_val_if_fail (directory, 0);
+
+  mtime = bamf_desktop_cache_get_mtime (directory);
+
+  if (mtime == 0)
+    return 0;
+
+  file = g_file_new_for_path (directory);
+  enumerator = g_file_enumerate_children (file, G_FILE_ATTRIBUTE_STANDARD_TYPE","
+                                                G_FILE_ATTRIBUTE_TIME_MODIFIED","
+                                                G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                                          G_FILE_QUERY_INFO_NONE, NULL, NULL);
+  g_object_unref (file);
+
+  if (!enumerator)
+    return 0;
+
+  while ((info = g_file_enumerator_next_file (enumerator, NULL, NULL)))
+    {
+      /* Sub-directories are cached on their own */
+      if (g_file_info_get_file_type (info) != G_FILE_TYPE_DIRECTORY)
+        mtime = MAX (mtime, file_info_get_mtime (info));
+
+      g_object_unref (info);
+    }
+
+  g_object_unref (enumerator);
+
+  return mtime;
+}
+
+/* Returns the cached entries of directory, if they're still valid for the
+ * current directory mtime (as returned by bamf_desktop_cache_get_directory_mtime),
+ * or NULL if the directory must be parsed again */
+GPtrArray *
+bamf_desktop_cache_get_directory (BamfDesktopCache *cache,
+                                  const gchar *directory,
+                                  guint64 mtime)
+{
+  GVariant *dir_data, *entries_data;
+  GVariantIter iter;
+  GPtrArray *entries;
+  const gchar *path, *exec, *desktop_id, *desktop_class;
+  gboolean no_display;
+  guint64 cached_mtime;
+
+  g_return_val_if_fail (cache, NULL);
+  g_return_val_if_fail (directory, NULL);
+
+  if (mtime == 0)
+    return NULL;
+
+  dir_data = g_hash_table_lookup (cache->cached_dirs, directory);
+
+  if (!dir_data)
+    return NULL;
+
+  g_variant_get_child (dir_data, 1, "t", &cached_mtime);
+
+  if (cached_mtime != mtime)
+    return NULL;
+
+  entries_data = g_variant_get_child_value (dir_data, 2);
+  entries = g_ptr_array_new_full (g_variant_n_children (entries_data),
+                                  (GDestroyNotify) bamf_desktop_entry_free);
+
+  g_variant_iter_init (&iter, entries_data);
+
+  while (g_variant_iter_next (&iter, "(&s&s&s&sb)", &path, &exec, &desktop_id,
+                              &desktop_class, &no_display))
+    {
+      g_ptr_array_add (entries, bamf_desktop_entry_new (path, exec, desktop_id,
+                                                        desktop_class, no_display));
+    }
+
+  g_variant_unref (entries_data);
+
+  /* Valid data will be saved again as it is */
+  g_hash_table_insert (cache->dirs, g_strdup (directory), g_variant_ref (dir_data));
+
+  return entries;
+}
+
+void
+bamf_desktop_cache_set_directory (BamfDesktopCache *cache,
+                                  const gchar *directory,
+                                  guint64 mtime,
+                                  GPtrArray *entries)
+{
+  GVariantBuilder builder;
+  GVariant *dir_data;
+  guint i;
+
+  g_return_if_fail (cache);
+  g_return_if_fail (directory);
+
+  if (mtime == 0 || !entries)
+    return;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a" CACHE_ENTRY_TYPE));
+
+  for (i = 0; i < entries->len; ++i)
+    {
+      BamfDesktopEntry *entry = g_ptr_array_index (entries, i);
+
+      g_variant_builder_add (&builder, CACHE_ENTRY_TYPE, entry->path, entry->exec,
+                             entry->desktop_id,
+                             entry->desktop_class ? entry->desktop_class : "",
+                             entry->no_display);
+    }
+
+  dir_data = g_variant_new ("(st@a" CACHE_ENTRY_TYPE ")", directory, mtime,
+                            g_variant_builder_end (&builder));
+
+  g_hash_table_insert (cache->dirs, g_strdup (directory), g_variant_ref_sink (dir_data));
+  cache->dirty = TRUE;
+}
+
+gboolean
+bamf_desktop_cache_save (BamfDesktopCache *cache, GError **error)
+{
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  GVariant *data;
+  gpointer value;
+  gchar *dirname;
+  gboolean saved;
+
+  g_return_val_if_fail (cache, FALSE);
+
+  /* Nothing has changed, or some directory has just been removed */
+  if (!cache->dirty && g_hash_table_size (cache->dirs) == g_hash_table_size (cache->cached_dirs))
+    return TRUE;
+
+  dirname = g_path_get_dirname (cache->path);
+
+  if (g_mkdir_with_parents (dirname, 0700) != 0)
+    {
+      int errsv = errno;
+      g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+                   "Impossible to create the cache directory %s: %s",
+                   dirname, g_strerror (errsv));
+      g_free (dirname);
+
+      return FALSE;
+    }
+
+  g_free (dirname);
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a" CACHE_DIRECTORY_TYPE));
+  g_hash_table_iter_init (&iter, cache->dirs);
+
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    g_variant_builder_add_value (&builder, value);
+
+  data = g_variant_new ("(us@a" CACHE_DIRECTORY_TYPE ")", BAMF_DESKTOP_CACHE_VERSION,
+                        cache->context, g_variant_builder_end (&builder));
+  g_variant_ref_sink (data);
+
+  saved = g_file_set_contents (cache->path, g_variant_get_data (data),
+                               g_variant_get_size (data), error);
+
+  if (saved)
+    cache->dirty = FALSE;
+
+  g_variant_unref (data);
+
+  return saved;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __BAMF_DESKTOP_CACHE_H__
+#define __BAMF_DESKTOP_CACHE_H__
+
+#include <glib.h>
+
+#define BAMF_DESKTOP_CACHE_VERSION 2
+#define BAMF_DESKTOP_CACHE_NAME "desktop-index.cache"
+
+typedef struct _BamfDesktopEntry BamfDesktopEntry;
+typedef struct _BamfDesktopCache BamfDesktopCache;
+
+/* The data that the matcher tables need from a .desktop file */
+struct _BamfDesktopEntry
+{
+  gchar *path;
+  gchar *exec;
+  gchar *desktop_id;
+  gchar *desktop_class;
+  gboolean no_display;
+};
+
+BamfDesktopEntry * bamf_desktop_entry_new            (const gchar *path,
+                                                      const gchar *exec,
+                                                      const gchar *desktop_id,
+                                                      const gchar *desktop_class,
+                                                      gboolean no_display);
+void               bamf_desktop_entry_free           (BamfDesktopEntry *entry);
+
+gchar            * bamf_desktop_cache_get_default_path (void);
+
+BamfDesktopCache * bamf_desktop_cache_new            (const gchar *cache_file,
+                                                      const gchar *context);
+void               bamf_desktop_cache_free           (BamfDesktopCache *cache);
+
+guint64            bamf_desktop_cache_get_mtime      (const gchar *path);
+guint64            bamf_desktop_cache_get_directory_mtime (const gchar *directory);
+
+GPtrArray        * bamf_desktop_cache_get_directory  (BamfDesktopCache *cache,
+                                                      const gchar *directory,
+                                                      guint64 mtime);
+void               bamf_desktop_cache_set_directory  (BamfDesktopCache *cache,
+                                                      const gchar *directory,
+                                                      guint64 mtime,
+                                                      GPtrArray *entries);
+
+gboolean           bamf_desktop_cache_save           (BamfDesktopCache *cache,
+                                                      GError **error);
+
+#endif
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+#include "bamf-desktop-index.h"
+
+#include <gio/gdesktopappinfo.h>
+#include <string.h>
+
+static gchar *
+get_nullable_field (const gchar *value)
+{
+  if (!value || value[0] == '\0')
+    return NULL;
+
+  return g_strdup (value);
+}
+
+/* Index fields can't contain the separators, and spaces around values
+ * are not meaningful anyway */
+static gchar *
+get_field_value (const gchar *value)
+{
+  gchar *field;
+
+  if (!value)
+    return NULL;
+
+  field = g_strdup (value);
+  g_strdelimit (field, "\t\r\n", ' ');
+  g_strstrip (field);
+
+  if (field[0] == '\0')
+    {
+      g_free (field);
+      return NULL;
+    }
+
+  return field;
+}
+
+/* The entries are loaded as the daemon does for the directories without an
+ * index, so that GDesktopAppInfo drops the ones with a missing TryExec or
+ * Exec program. The show-in keys depend on the running desktop, so they're
+ * kept and checked at load time, see bamf_index_entry_get_show_in */
+BamfIndexEntry *
+bamf_index_entry_new_from_file (const gchar *file)
+{
+  BamfIndexEntry *entry;
+  GDesktopAppInfo *info;
+  gchar *exec, *value;
+
+  g_return_val_if_fail (file, NULL);
+
+  if (!g_str_has_suffix (file, ".desktop"))
+    return NULL;
+
+  info = g_desktop_app_info_new_from_filename (file);
+
+  if (!G_IS_APP_INFO (info))
+    return NULL;
+
+  if (g_desktop_app_info_get_is_hidden (info))
+    {
+      g_object_unref (info);
+      return NULL;
+    }
+
+  exec = get_field_value (g_app_info_get_commandline (G_APP_INFO (info)));
+
+  if (!exec)
+    {
+      g_object_unref (info);
+      return NULL;
+    }
+
+  entry = g_slice_new0 (BamfIndexEntry);
+  entry->desktop_id = g_path_get_basename (file);
+  entry->exec = exec;
+  entry->desktop_class = get_field_value (g_desktop_app_info_get_startup_wm_class (info));
+  entry->no_display = g_desktop_app_info_get_nodisplay (info);
+
+  value = g_desktop_app_info_get_string (info, G_KEY_FILE_DESKTOP_KEY_ONLY_SHOW_IN);
+  entry->show_in = get_field_value (value);
+  g_free (value);
+
+  value = g_desktop_app_info_get_string (info, G_KEY_FILE_DESKTOP_KEY_NOT_SHOW_IN);
+  entry->not_show_in = get_field_value (value);
+  g_free (value);
+
+  g_object_unref (info);
+
+  return entry;
+}
+
+BamfIndexEntry *
+bamf_index_entry_new_from_line (const gchar *line)
+{
+  BamfIndexEntry *entry;
+  gchar **parts;
+
+  g_return_val_if_fail (line, NULL);
+
+  /* Order is: 0 Desktop-Id, 1 Exec, 2 class, 3 ShowIn, 4 NoDisplay, 5 NotShowIn */
+  parts = g_strsplit (line, "\t", 6);
+
+  if (g_strv_length (parts) < 2 || !g_str_has_suffix (parts[0], ".desktop") ||
+      strlen (parts[0]) <= strlen (".desktop") || parts[1][0] == '\0')
+    {
+      g_strfreev (parts);
+      return NULL;
+    }
+
+  entry = g_slice_new0 (BamfIndexEntry);
+  entry->desktop_id = g_strdup (parts[0]);
+  entry->exec = g_strdup (parts[1]);
+
+  if (parts[2])
+    {
+      entry->desktop_class = get_nullable_field (parts[2]);
+
+      if (parts[3])
+        {
+          entry->show_in = get_nullable_field (parts[3]);
+
+          if (parts[4])
+            {
+              if (g_ascii_strcasecmp (parts[4], "true") == 0)
+                entry->no_display = TRUE;
+
+              if (parts[5])
+                entry->not_show_in = get_nullable_field (parts[5]);
+            }
+        }
+    }
+
+  g_strfreev (parts);
+
+  return entry;
+}
+
+void
+bamf_index_entry_free (BamfIndexEntry *entry)
+{
+  if (!entry)
+    return;
+
+  g_free (entry->desktop_id);
+  g_free (entry->exec);
+  g_free (entry->desktop_class);
+  g_free (entry->show_in);
+  g_free (entry->not_show_in);
+  g_slice_free (BamfIndexEntry, entry);
+}
+
+gchar *
+bamf_index_entry_to_line (BamfIndexEntry *entry)
+{
+  g_return_val_if_fail (entry, NULL);
+
+  return g_strdup_printf ("%s\t%s\t%s\t%s\t%s%s%s", entry->desktop_id, entry->exec,
+                          entry->desktop_class ? entry->desktop_class : "",
+                          entry->show_in ? entry->show_in : "",
+                          entry->no_display ? "true" : "false",
+                          entry->not_show_in ? "\t" : "",
+                          entry->not_show_in ? entry->not_show_in : "");
+}
+
+gboolean
+bamf_index_entry_equal (BamfIndexEntry *a, BamfIndexEntry *b)
+{
+  if (a == b)
+    return TRUE;
+
+  if (!a || !b)
+    return FALSE;
+
+  return (g_strcmp0 (a->desktop_id, b->desktop_id) == 0 &&
+          g_strcmp0 (a->exec, b->exec) == 0 &&
+          g_strcmp0 (a->desktop_class, b->desktop_class) == 0 &&
+          g_strcmp0 (a->show_in, b->show_in) == 0 &&
+          g_strcmp0 (a->not_show_in, b->not_show_in) == 0 &&
+          a->no_display == b->no_display);
+}
+
+static gboolean
+desktop_list_contains (const gchar *list, const gchar *desktop)
+{
+  gchar **desktops;
+  gboolean found;
+
+  if (!list)
+    return FALSE;
+
+  desktops = g_strsplit (list, ";", -1);
+  found = g_strv_contains ((const gchar * const *) desktops, desktop);
+  g_strfreev (desktops);
+
+  return found;
+}
+
+/* Same as g_desktop_app_info_get_show_in, the first of the desktops that
+ * is listed by the entry decides whether it is shown */
+gboolean
+bamf_index_entry_get_show_in (BamfIndexEntry *entry, const gchar * const *desktops)
+{
+  guint i;
+
+  g_return_val_if_fail (entry, FALSE);
+
+  for (i = 0; desktops && desktops[i]; ++i)
+    {
+      if (desktop_list_contains (entry->show_in, desktops[i]))
+        return TRUE;
+
+      if (desktop_list_contains (entry->not_show_in, desktops[i]))
+        return FALSE;
+    }
+
+  return entry->show_in == NULL;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __BAMF_DESKTOP_INDEX_H__
+#define __BAMF_DESKTOP_INDEX_H__
+
+#include <glib.h>
+
+#define BAMF_INDEX_NAME "bamf-2.index"
+
+typedef struct _BamfIndexEntry BamfIndexEntry;
+
+/* A line of a bamf-2.index file, its tab-separated fields are in order:
+ * Desktop-Id (the file name), Exec, StartupWMClass, OnlyShowIn, NoDisplay
+ * and NotShowIn, which is only written when set so that the other lines
+ * are still readable by older parsers */
+struct _BamfIndexEntry
+{
+  gchar *desktop_id;
+  gchar *exec;
+  gchar *desktop_class;
+  gchar *show_in;
+  gboolean no_display;
+  gchar *not_show_in;
+};
+
+BamfIndexEntry * bamf_index_entry_new_from_file (const gchar *file);
+BamfIndexEntry * bamf_index_entry_new_from_line (const gchar *line);
+void             bamf_index_entry_free          (BamfIndexEntry *entry);
+
+gchar          * bamf_index_entry_to_line       (BamfIndexEntry *entry);
+gboolean         bamf_index_entry_equal         (BamfIndexEntry *a,
+                                                 BamfIndexEntry *b);
+gboolean         bamf_index_entry_get_show_in   (BamfIndexEntry *entry,
+                                                 const gchar * const *desktops);
+
+#endif
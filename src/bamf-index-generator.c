@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Generates the bamf-2.index file of an applications directory, which allows
+ * the daemon to load the directory contents without parsing each .desktop file.
+ *
+ * Usage: bamf-index-generator [--output=FILE | --rebuild | --check] DIRECTORY
+ */
+
+#include "config.h"
+#include "bamf-desktop-index.h"
+
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static gchar *output_file = NULL;
+static gboolean rebuild = FALSE;
+static gboolean check = FALSE;
+
+static GOptionEntry option_entries[] =
+{
+  {"output", 'o', 0, G_OPTION_ARG_FILENAME, &output_file, "Write the index to FILE instead of the standard output", "FILE"},
+  {"rebuild", 'r', 0, G_OPTION_ARG_NONE, &rebuild, "Regenerate DIRECTORY/" BAMF_INDEX_NAME " if missing or out of date", NULL},
+  {"check", 'c', 0, G_OPTION_ARG_NONE, &check, "Only check that DIRECTORY/" BAMF_INDEX_NAME " is up to date", NULL},
+  {NULL}
+};
+
+static gint
+compare_entries (gconstpointer a, gconstpointer b)
+{
+  const BamfIndexEntry *entry_a = *((const BamfIndexEntry **) a);
+  const BamfIndexEntry *entry_b = *((const BamfIndexEntry **) b);
+
+  return g_strcmp0 (entry_a->desktop_id, entry_b->desktop_id);
+}
+
+/* Only the top level files are indexed, the daemon handles each sub-directory
+ * as a different applications directory with its own index */
+static GPtrArray *
+load_directory_entries (const gchar *directory, GError **error)
+{
+  GPtrArray *entries;
+  GDir *dir;
+  const gchar *name;
+
+  dir = g_dir_open (directory, 0, error);
+
+  if (!dir)
+    return NULL;
+
+  entries = g_ptr_array_new_with_free_func ((GDestroyNotify) bamf_index_entry_free);
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      BamfIndexEntry *entry;
+      gchar *path;
+
+      if (!g_str_has_suffix (name, ".desktop"))
+        continue;
+
+      path = g_build_filename (directory, name, NULL);
+
+      if (!g_file_test (path, G_FILE_TEST_IS_DIR))
+        {
+          entry = bamf_index_entry_new_from_file (path);
+
+          if (entry)
+            g_ptr_array_add (entries, entry);
+        }
+
+      g_free (path);
+    }
+
+  g_dir_close (dir);
+  g_ptr_array_sort (entries, compare_entries);
+
+  return entries;
+}
+
+static GString *
+build_index (GPtrArray *entries)
+{
+  GString *index;
+  guint i;
+
+  index = g_string_new (NULL);
+
+  for (i = 0; i < entries->len; ++i)
+    {
+      gchar *line = bamf_index_entry_to_line (g_ptr_array_index (entries, i));
+      g_string_append (index, line);
+      g_string_append_c (index, '\n');
+      g_free (line);
+    }
+
+  return index;
+}
+
+/* Checks that the index file provides the very same entries that the daemon
+ * would get by parsing the directory, reporting the differences on stderr */
+static gboolean
+validate_index (const gchar *index_file, GPtrArray *entries, gboolean verbose)
+{
+  GHashTable *indexed;
+  gchar *contents;
+  gchar **lines;
+  gboolean valid = TRUE;
+  guint i;
+
+  if (!g_file_get_contents (index_file, &contents, NULL, NULL))
+    {
+      if (verbose)
+        g_printerr ("%s: impossible to read the index\n", index_file);
+
+      return FALSE;
+    }
+
+  indexed = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                   (GDestroyNotify) bamf_index_entry_free);
+  lines = g_strsplit (contents, "\n", -1);
+
+  for (i = 0; lines[i]; ++i)
+    {
+      BamfIndexEntry *entry;
+
+      if (lines[i][0] == '\0')
+        continue;
+
+      entry = bamf_index_entry_new_from_line (lines[i]);
+
+      if (!entry || g_hash_table_contains (indexed, entry->desktop_id))
+        {
+          if (verbose)
+            g_printerr ("%s:%u: invalid or duplicated entry\n", index_file, i + 1);
+
+          bamf_index_entry_free (entry);
+          valid = FALSE;
+          continue;
+        }
+
+      g_hash_table_insert (indexed, entry->desktop_id, entry);
+    }
+
+  for (i = 0; i < entries->len; ++i)
+    {
+      BamfIndexEntry *entry = g_ptr_array_index (entries, i);
+      BamfIndexEntry *indexed_entry = g_hash_table_lookup (indexed, entry->desktop_id);
+
+      if (!bamf_index_entry_equal (entry, indexed_entry))
+        {
+          if (verbose)
+            g_printerr ("%s: %s entry for %s\n", index_file,
+                        indexed_entry ? "outdated" : "missing", entry->desktop_id);
+
+          valid = FALSE;
+        }
+
+      g_hash_table_remove (indexed, entry->desktop_id);
+    }
+
+  if (g_hash_table_size (indexed) > 0)
+    {
+      if (verbose)
+        {
+          GHashTableIter iter;
+          gpointer key;
+
+          g_hash_table_iter_init (&iter, indexed);
+
+          while (g_hash_table_iter_next (&iter, &key, NULL))
+            g_printerr ("%s: stale entry for %s\n", index_file, (gchar *) key);
+        }
+
+      valid = FALSE;
+    }
+
+  g_hash_table_destroy (indexed);
+  g_strfreev (lines);
+  g_free (contents);
+
+  return valid;
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *options;
+  GPtrArray *entries;
+  GString *index;
+  GError *error = NULL;
+  gchar *directory;
+  gchar *index_file;
+  int result = EXIT_SUCCESS;
+
+  options = g_option_context_new ("DIRECTORY");
+  g_option_context_set_summary (options, "Generates the " BAMF_INDEX_NAME
+                                " file of an applications directory");
+  g_option_context_add_main_entries (options, option_entries, NULL);
+
+  if (!g_option_context_parse (options, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_option_context_free (options);
+      g_clear_error (&error);
+      return EXIT_FAILURE;
+    }
+
+  g_option_context_free (options);
+
+  if (argc != 2 || (rebuild && check) || ((rebuild || check) && output_file))
+    {
+      g_printerr ("Usage: %s [--output=FILE | --rebuild | --check] DIRECTORY\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  directory = g_strdup (argv[1]);
+
+  /* Keep the directory name as the daemon would build it */
+  if (strlen (directory) > 1 && g_str_has_suffix (directory, G_DIR_SEPARATOR_S))
+    directory[strlen (directory) - 1] = '\0';
+
+  entries = load_directory_entries (directory, &error);
+
+  if (!entries)
+    {
+      g_printerr ("%s\n", error->message);
+      g_clear_error (&error);
+      g_free (directory);
+      return EXIT_FAILURE;
+    }
+
+  index_file = g_build_filename (directory, BAMF_INDEX_NAME, NULL);
+
+  if (check)
+    {
+      if (!validate_index (index_file, entries, TRUE))
+        result = EXIT_FAILURE;
+    }
+  else if (rebuild)
+    {
+      /* Up to date indexes are not touched, so that the directory mtime
+       * (and so the daemon caches) doesn't change */
+      if (!validate_index (index_file, entries, FALSE))
+        {
+          index = build_index (entries);
+
+          if (!g_file_set_contents (index_file, index->str, index->len, &error) ||
+              !validate_index (index_file, entries, TRUE))
+            {
+              if (error)
+                g_printerr ("%s\n", error->message);
+
+              g_clear_error (&error);
+              g_unlink (index_file);
+              result = EXIT_FAILURE;
+            }
+
+          g_string_free (index, TRUE);
+        }
+    }
+  else
+    {
+      index = build_index (entries);
+
+      if (output_file)
+        {
+          if (!g_file_set_contents (output_file, index->str, index->len, &error))
+            {
+              g_printerr ("%s\n", error->message);
+              g_clear_error (&error);
+              result = EXIT_FAILURE;
+            }
+        }
+      else
+        {
+          fwrite (index->str, 1, index->len, stdout);
+        }
+
+      g_string_free (index, TRUE);
+    }
+
+  g_ptr_array_unref (entries);
+  g_free (index_file);
+  g_free (directory);
+  g_free (output_file);
+
+  return result;
+}
@@ -26,4 +26,7 @@
 void _bamf_legacy_screen_open_test_window (BamfLegacyScreen *self, BamfLegacyWindowTest *window);
 void _bamf_legacy_screen_close_test_window (BamfLegacyScreen *self, BamfLegacyWindowTest *window);
 
+/* A screen tracking the real X windows through XCB, not the default one */
+BamfLegacyScreen * _bamf_legacy_screen_new_xcb (void);
+
 #endif
@@ -19,8 +19,12 @@
 
 #include "bamf-legacy-screen.h"
 #include "bamf-legacy-screen-private.h"
+#include "bamf-legacy-window-xcb.h"
+#include "bamf-xutils.h"
 #include <gdk/gdkx.h>
 #include <gio/gio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define SN_API_NOT_YET_FROZEN
 #include <libsn/sn.h>
@@ -31,6 +35,11 @@ G_DEFINE_TYPE (BamfLegacyScreen, bamf_legacy_screen, G_TYPE_OBJECT);
 BAMF_TYPE_LEGACY_SCREEN, BamfLegacyScreenPrivate))
 
 static BamfLegacyScreen *static_screen = NULL;
+static BamfLegacyScreenBackend screen_backend = BAMF_LEGACY_SCREEN_BACKEND_WNCK;
+static gboolean wnck_used = FALSE;
+
+/* The client list is read at once, this is much more than any real usage */
+#define CLIENT_LIST_MAX_LENGTH 65536
 
 enum
 {
@@ -53,18 +62,48 @@ struct _BamfLegacyScreenPrivate
 {
   WnckScreen * legacy_screen;
 
+  /* Only used by the XCB backend */
+  xcb_connection_t * xcb;
+  xcb_window_t xcb_root;
+  xcb_window_t xcb_active_window;
+  GSource * xcb_source;
+  GArray * xcb_stack;
+  GHashTable * xcb_stack_indexes;
+  GHashTable * xcb_windows;
+
   SnDisplay * sn_display;
   SnMonitorContext * sn_monitor_context;
 
   GList *windows;
   GFile *file;
   GDataInputStream *stream;
+  guint initial_windows_id;
 };
 
+/* Windows cache their position in the windows list, which is what
+ * bamf_legacy_window_get_stacking_position returns */
+static void
+update_windows_stacking_positions (BamfLegacyScreen *self)
+{
+  GList *l;
+  gint position = 0;
+
+  for (l = self->priv->windows; l; l = l->next, ++position)
+    bamf_legacy_window_set_stacking_position (l->data, position);
+}
+
 static void
 handle_window_closed (BamfLegacyWindow *window, BamfLegacyScreen *self)
 {
+  if (self->priv->xcb_windows)
+    {
+      g_hash_table_remove (self->priv->xcb_windows,
+                           GUINT_TO_POINTER (bamf_legacy_window_get_xid (window)));
+    }
+
   self->priv->windows = g_list_remove (self->priv->windows, window);
+  bamf_legacy_window_set_stacking_position (window, -1);
+  update_windows_stacking_positions (self);
 
   g_signal_emit (self, legacy_screen_signals[WINDOW_CLOSED], 0, window);
 
@@ -218,31 +257,55 @@ on_state_file_load_timeout (BamfLegacyScreen *self)
   return TRUE;
 }
 
-static gint
-compare_windows_by_stack_order (gconstpointer a, gconstpointer b, gpointer data)
+/* Maps the xid of the stacked windows to their index, starting from 1 */
+static GHashTable *
+get_stacking_indexes (BamfLegacyScreen *self)
 {
-  BamfLegacyScreen *self;
+  GHashTable *indexes;
   GList *l;
-  guint xid_a, xid_b;
+  gint index = 0;
+
+  /* The xcb stack indexes are built once per stack, see update_client_list */
+  if (self->priv->xcb_stack_indexes)
+    return g_hash_table_ref (self->priv->xcb_stack_indexes);
 
-  g_return_val_if_fail (BAMF_IS_LEGACY_SCREEN (data), 1);
-  self = BAMF_LEGACY_SCREEN (data);
+  indexes = g_hash_table_new (g_direct_hash, g_direct_equal);
 
-  xid_a = bamf_legacy_window_get_xid (BAMF_LEGACY_WINDOW (a));
-  xid_b = bamf_legacy_window_get_xid (BAMF_LEGACY_WINDOW (b));
+  if (!self->priv->legacy_screen)
+    return indexes;
 
   for (l = wnck_screen_get_windows_stacked (self->priv->legacy_screen); l; l = l->next)
-  {
-    gulong legacy_xid = wnck_window_get_xid (WNCK_WINDOW (l->data));
+    {
+      gulong legacy_xid = wnck_window_get_xid (WNCK_WINDOW (l->data));
+      g_hash_table_insert (indexes, GUINT_TO_POINTER (legacy_xid), GINT_TO_POINTER (++index));
+    }
 
-    if (legacy_xid == xid_a)
-      return -1;
+  return indexes;
+}
 
-    if (legacy_xid == xid_b)
-      return 1;
-  }
+static gint
+get_stacking_index (GHashTable *indexes, BamfLegacyWindow *window)
+{
+  gpointer xid = GUINT_TO_POINTER (bamf_legacy_window_get_xid (window));
+  gint index = GPOINTER_TO_INT (g_hash_table_lookup (indexes, xid));
 
-  return 0;
+  /* Windows not in the stack go on top of it */
+  return index > 0 ? index : G_MAXINT;
+}
+
+static gint
+compare_windows_by_stack_order (gconstpointer a, gconstpointer b, gpointer data)
+{
+  GHashTable *indexes = data;
+  gint index_a, index_b;
+
+  index_a = get_stacking_index (indexes, BAMF_LEGACY_WINDOW (a));
+  index_b = get_stacking_index (indexes, BAMF_LEGACY_WINDOW (b));
+
+  if (index_a == index_b)
+    return 0;
+
+  return (index_a < index_b) ? -1 : 1;
 }
 
 static void
@@ -279,33 +342,448 @@ handle_sn_monitor_event (SnMonitorEvent *event,
 }
 
 static void
-handle_window_opened (WnckScreen *screen, WnckWindow *window, BamfLegacyScreen *legacy)
+add_window (BamfLegacyScreen *legacy, BamfLegacyWindow *legacy_window)
 {
-  BamfLegacyWindow *legacy_window;
-  g_return_if_fail (WNCK_IS_WINDOW (window));
-
-  legacy_window = bamf_legacy_window_new (window);
+  GHashTable *indexes;
 
   g_signal_connect (G_OBJECT (legacy_window), "closed",
                     (GCallback) handle_window_closed, legacy);
 
+  indexes = get_stacking_indexes (legacy);
   legacy->priv->windows = g_list_insert_sorted_with_data (legacy->priv->windows, legacy_window,
                                                           compare_windows_by_stack_order,
-                                                          legacy);
+                                                          indexes);
+  update_windows_stacking_positions (legacy);
+  g_hash_table_unref (indexes);
 
   g_signal_emit (legacy, legacy_screen_signals[WINDOW_OPENED], 0, legacy_window);
 }
 
+static void
+handle_window_opened (WnckScreen *screen, WnckWindow *window, BamfLegacyScreen *legacy)
+{
+  g_return_if_fail (WNCK_IS_WINDOW (window));
+
+  add_window (legacy, bamf_legacy_window_new (window));
+}
+
 static void
 handle_stacking_changed (WnckScreen *screen, BamfLegacyScreen *legacy)
 {
+  GHashTable *indexes;
+
+  indexes = get_stacking_indexes (legacy);
   legacy->priv->windows = g_list_sort_with_data (legacy->priv->windows,
                                                  compare_windows_by_stack_order,
-                                                 legacy);
+                                                 indexes);
+  update_windows_stacking_positions (legacy);
+  g_hash_table_unref (indexes);
 
   g_signal_emit (legacy, legacy_screen_signals[STACKING_CHANGED], 0);
 }
 
+static gboolean
+xcb_stack_contains (BamfLegacyScreen *self, xcb_window_t xid)
+{
+  if (!self->priv->xcb_stack_indexes)
+    return FALSE;
+
+  return g_hash_table_contains (self->priv->xcb_stack_indexes, GUINT_TO_POINTER (xid));
+}
+
+static void
+xcb_stack_indexes_update (BamfLegacyScreen *self)
+{
+  GArray *stack = self->priv->xcb_stack;
+  guint i;
+
+  if (self->priv->xcb_stack_indexes)
+    g_hash_table_unref (self->priv->xcb_stack_indexes);
+
+  self->priv->xcb_stack_indexes = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  for (i = 0; i < stack->len; ++i)
+    {
+      xcb_window_t xid = g_array_index (stack, xcb_window_t, i);
+      g_hash_table_insert (self->priv->xcb_stack_indexes, GUINT_TO_POINTER (xid),
+                           GINT_TO_POINTER (i + 1));
+    }
+}
+
+static BamfLegacyWindowXcb *
+xcb_window_new (BamfLegacyScreen *self, xcb_window_t xid)
+{
+  BamfLegacyWindowXcb *window;
+
+  window = bamf_legacy_window_xcb_new (self->priv->xcb, xid);
+  bamf_legacy_window_xcb_set_active (window, xid == self->priv->xcb_active_window);
+  g_hash_table_insert (self->priv->xcb_windows, GUINT_TO_POINTER (xid), window);
+
+  return window;
+}
+
+/* Windows destroyed while being loaded are dropped before being added */
+static gboolean
+xcb_window_load (BamfLegacyScreen *self, BamfLegacyWindowXcb *window)
+{
+  if (bamf_legacy_window_xcb_load (window))
+    return TRUE;
+
+  g_hash_table_remove (self->priv->xcb_windows,
+                       GUINT_TO_POINTER (bamf_legacy_window_get_xid (BAMF_LEGACY_WINDOW (window))));
+  g_object_unref (window);
+
+  return FALSE;
+}
+
+static xcb_get_property_reply_t *
+get_root_property (BamfLegacyScreen *self, const char *atom_name, guint32 max_length)
+{
+  BamfLegacyScreenPrivate *priv = self->priv;
+  xcb_get_property_cookie_t cookie;
+  xcb_get_property_reply_t *reply;
+  xcb_generic_error_t *error = NULL;
+
+  cookie = xcb_get_property (priv->xcb, FALSE, priv->xcb_root,
+                             bamf_xutils_get_atom (atom_name),
+                             XCB_ATOM_WINDOW, 0, max_length);
+  reply = xcb_get_property_reply (priv->xcb, cookie, &error);
+
+  if (error)
+    {
+      g_warning ("%s: Impossible to read the %s root property, X error %u",
+                 G_STRFUNC, atom_name, error->error_code);
+      g_clear_pointer (&reply, free);
+      free (error);
+    }
+
+  return reply;
+}
+
+static gboolean
+xcb_stacks_equal (GArray *a, GArray *b)
+{
+  if (!a || !b || a->len != b->len)
+    return FALSE;
+
+  return memcmp (a->data, b->data, a->len * sizeof (xcb_window_t)) == 0;
+}
+
+/* The client list is the only source of truth for the managed windows: new
+ * clients are opened and missing ones are closed, the requests of all the new
+ * windows are sent before any of them is used, not to wait for each one */
+static void
+update_client_list (BamfLegacyScreen *self)
+{
+  BamfLegacyScreenPrivate *priv = self->priv;
+  xcb_get_property_reply_t *reply;
+  GHashTableIter iter;
+  GList *opened = NULL, *closed = NULL, *l;
+  GHashTable *indexes;
+  GArray *stack;
+  gpointer window;
+  gboolean stacking_changed;
+  guint i;
+
+  reply = get_root_property (self, "_NET_CLIENT_LIST_STACKING", CLIENT_LIST_MAX_LENGTH);
+
+  /* Keep the current windows, as we don't know the new list */
+  if (!reply && priv->xcb_stack)
+    return;
+
+  stack = g_array_new (FALSE, FALSE, sizeof (xcb_window_t));
+
+  if (reply && reply->format == 32)
+    {
+      g_array_append_vals (stack, xcb_get_property_value (reply),
+                           xcb_get_property_value_length (reply) / sizeof (xcb_window_t));
+    }
+
+  free (reply);
+
+  stacking_changed = !xcb_stacks_equal (priv->xcb_stack, stack);
+
+  if (priv->xcb_stack)
+    g_array_unref (priv->xcb_stack);
+
+  priv->xcb_stack = stack;
+
+  if (!stacking_changed)
+    return;
+
+  xcb_stack_indexes_update (self);
+
+  g_hash_table_iter_init (&iter, priv->xcb_windows);
+
+  while (g_hash_table_iter_next (&iter, NULL, &window))
+    {
+      if (!xcb_stack_contains (self, bamf_legacy_window_get_xid (window)))
+        closed = g_list_prepend (closed, window);
+    }
+
+  for (i = 0; i < stack->len; ++i)
+    {
+      xcb_window_t xid = g_array_index (stack, xcb_window_t, i);
+
+      if (!g_hash_table_contains (priv->xcb_windows, GUINT_TO_POINTER (xid)))
+        opened = g_list_prepend (opened, xcb_window_new (self, xid));
+    }
+
+  for (l = closed; l; l = l->next)
+    bamf_legacy_window_xcb_close (l->data);
+
+  /* Windows are added from the bottom of the stack */
+  opened = g_list_reverse (opened);
+
+  for (l = opened; l; l = l->next)
+    {
+      if (xcb_window_load (self, l->data))
+        add_window (self, l->data);
+    }
+
+  indexes = get_stacking_indexes (self);
+  priv->windows = g_list_sort_with_data (priv->windows, compare_windows_by_stack_order, indexes);
+  update_windows_stacking_positions (self);
+  g_hash_table_unref (indexes);
+
+  g_list_free (opened);
+  g_list_free (closed);
+
+  g_signal_emit (self, legacy_screen_signals[STACKING_CHANGED], 0);
+}
+
+static void
+update_active_window (BamfLegacyScreen *self)
+{
+  BamfLegacyScreenPrivate *priv = self->priv;
+  xcb_get_property_reply_t *reply;
+  xcb_window_t active = XCB_WINDOW_NONE;
+  BamfLegacyWindowXcb *window;
+
+  reply = get_root_property (self, "_NET_ACTIVE_WINDOW", 1);
+
+  if (!reply)
+    return;
+
+  if (reply->format == 32 && xcb_get_property_value_length (reply) >= sizeof (xcb_window_t))
+    active = *((xcb_window_t *) xcb_get_property_value (reply));
+
+  free (reply);
+
+  if (active == priv->xcb_active_window)
+    return;
+
+  window = g_hash_table_lookup (priv->xcb_windows, GUINT_TO_POINTER (priv->xcb_active_window));
+
+  if (window)
+    bamf_legacy_window_xcb_set_active (window, FALSE);
+
+  window = g_hash_table_lookup (priv->xcb_windows, GUINT_TO_POINTER (active));
+
+  if (window)
+    bamf_legacy_window_xcb_set_active (window, TRUE);
+
+  priv->xcb_active_window = active;
+
+  g_signal_emit (self, legacy_screen_signals[ACTIVE_WINDOW_CHANGED], 0);
+}
+
+/* The windows that are already there are all added at once, so that their
+ * properties are fetched with a single round trip, not with one per window
+ * as it happens for the ones opened later. This happens once the main loop
+ * runs, so that the screen users are already listening for new windows */
+static gboolean
+on_initial_windows_idle (BamfLegacyScreen *self)
+{
+  GList *windows, *l;
+
+  self->priv->initial_windows_id = 0;
+
+  if (self->priv->xcb)
+    {
+      update_active_window (self);
+      update_client_list (self);
+      return G_SOURCE_REMOVE;
+    }
+
+  wnck_screen_force_update (self->priv->legacy_screen);
+  windows = bamf_legacy_window_new_batch (wnck_screen_get_windows_stacked (self->priv->legacy_screen));
+
+  for (l = windows; l; l = l->next)
+    add_window (self, l->data);
+
+  g_list_free (windows);
+
+  g_signal_connect (G_OBJECT (self->priv->legacy_screen), "window-opened",
+                    (GCallback) handle_window_opened, self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+handle_xcb_event (BamfLegacyScreen *self, xcb_generic_event_t *event)
+{
+  BamfLegacyWindowXcb *window = NULL;
+
+  switch (event->response_type & ~0x80)
+    {
+      case XCB_PROPERTY_NOTIFY:
+        {
+          xcb_property_notify_event_t *property_event = (xcb_property_notify_event_t *) event;
+
+          if (property_event->window == self->priv->xcb_root)
+            {
+              if (property_event->atom == bamf_xutils_get_atom ("_NET_CLIENT_LIST_STACKING"))
+                update_client_list (self);
+              else if (property_event->atom == bamf_xutils_get_atom ("_NET_ACTIVE_WINDOW"))
+                update_active_window (self);
+
+              return;
+            }
+
+          window = g_hash_table_lookup (self->priv->xcb_windows,
+                                        GUINT_TO_POINTER (property_event->window));
+          break;
+        }
+      case XCB_CONFIGURE_NOTIFY:
+        {
+          xcb_configure_notify_event_t *configure_event = (xcb_configure_notify_event_t *) event;
+          window = g_hash_table_lookup (self->priv->xcb_windows,
+                                        GUINT_TO_POINTER (configure_event->window));
+          break;
+        }
+      default:
+        /* Errors of unchecked requests (i.e. on destroyed windows) end here too */
+        break;
+    }
+
+  if (window)
+    bamf_legacy_window_xcb_handle_event (window, event);
+}
+
+typedef struct
+{
+  GSource source;
+  GPollFD poll_fd;
+  xcb_connection_t *xcb;
+  xcb_generic_event_t *event;
+} XcbEventSource;
+
+static gboolean
+xcb_event_source_prepare (GSource *source, gint *timeout)
+{
+  XcbEventSource *xcb_source = (XcbEventSource *) source;
+
+  *timeout = -1;
+  xcb_flush (xcb_source->xcb);
+
+  /* Events might have been queued while waiting for replies */
+  if (!xcb_source->event)
+    xcb_source->event = xcb_poll_for_queued_event (xcb_source->xcb);
+
+  return xcb_source->event != NULL;
+}
+
+static gboolean
+xcb_event_source_check (GSource *source)
+{
+  XcbEventSource *xcb_source = (XcbEventSource *) source;
+
+  if (xcb_source->poll_fd.revents & (G_IO_ERR | G_IO_HUP))
+    return TRUE;
+
+  if (!xcb_source->event && (xcb_source->poll_fd.revents & G_IO_IN))
+    xcb_source->event = xcb_poll_for_event (xcb_source->xcb);
+
+  return xcb_source->event != NULL || xcb_connection_has_error (xcb_source->xcb);
+}
+
+static gboolean
+xcb_event_source_dispatch (GSource *source, GSourceFunc callback, gpointer data)
+{
+  XcbEventSource *xcb_source = (XcbEventSource *) source;
+  BamfLegacyScreen *self = data;
+  xcb_generic_event_t *event;
+
+  while ((event = xcb_source->event ? xcb_source->event : xcb_poll_for_event (xcb_source->xcb)))
+    {
+      xcb_source->event = NULL;
+      handle_xcb_event (self, event);
+      free (event);
+    }
+
+  if (xcb_connection_has_error (xcb_source->xcb))
+    {
+      g_critical ("The XCB connection has been lost, windows can't be tracked anymore");
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+xcb_event_source_finalize (GSource *source)
+{
+  XcbEventSource *xcb_source = (XcbEventSource *) source;
+
+  free (xcb_source->event);
+  xcb_source->event = NULL;
+}
+
+static GSourceFuncs xcb_event_source_funcs =
+{
+  xcb_event_source_prepare,
+  xcb_event_source_check,
+  xcb_event_source_dispatch,
+  xcb_event_source_finalize,
+};
+
+/* Tracks the windows through a dedicated XCB connection, following the EWMH
+ * root properties, without any libwnck (and per-window GTK) overhead */
+static gboolean
+setup_xcb_backend (BamfLegacyScreen *self)
+{
+  BamfLegacyScreenPrivate *priv = self->priv;
+  XcbEventSource *xcb_source;
+  xcb_screen_iterator_t screens;
+  const uint32_t event_mask = XCB_EVENT_MASK_PROPERTY_CHANGE;
+  int screen_number, i;
+
+  priv->xcb = xcb_connect (NULL, &screen_number);
+
+  if (xcb_connection_has_error (priv->xcb))
+    {
+      g_warning ("%s: Impossible to connect to the X server, falling back to libwnck", G_STRFUNC);
+      xcb_disconnect (priv->xcb);
+      priv->xcb = NULL;
+      return FALSE;
+    }
+
+  screens = xcb_setup_roots_iterator (xcb_get_setup (priv->xcb));
+
+  for (i = 0; i < screen_number; ++i)
+    xcb_screen_next (&screens);
+
+  priv->xcb_root = screens.data->root;
+  priv->xcb_windows = g_hash_table_new (g_direct_hash, g_direct_equal);
+  xcb_change_window_attributes (priv->xcb, priv->xcb_root, XCB_CW_EVENT_MASK, &event_mask);
+
+  xcb_source = (XcbEventSource *) g_source_new (&xcb_event_source_funcs, sizeof (XcbEventSource));
+  xcb_source->xcb = priv->xcb;
+  xcb_source->poll_fd.fd = xcb_get_file_descriptor (priv->xcb);
+  xcb_source->poll_fd.events = G_IO_IN | G_IO_ERR | G_IO_HUP;
+  g_source_add_poll ((GSource *) xcb_source, &xcb_source->poll_fd);
+  g_source_set_callback ((GSource *) xcb_source, NULL, self, NULL);
+  g_source_attach ((GSource *) xcb_source, NULL);
+  priv->xcb_source = (GSource *) xcb_source;
+
+  /* The current windows are added once the main loop runs */
+  priv->initial_windows_id =
+    g_idle_add_full (G_PRIORITY_DEFAULT, (GSourceFunc) on_initial_windows_idle, self, NULL);
+
+  return TRUE;
+}
+
 /* This function allows to push into the screen a window by its xid.
  * If the window is already known, it's just ignored, otherwise it gets added
  * to the windows list. The BamfLegacyScreen should automatically update its
@@ -328,6 +806,19 @@ bamf_legacy_screen_inject_window (BamfLegacyScreen *self, guint xid)
         }
     }
 
+  if (self->priv->xcb)
+    {
+      if (xcb_stack_contains (self, xid))
+        {
+          BamfLegacyWindowXcb *xcb_window = xcb_window_new (self, xid);
+
+          if (xcb_window_load (self, xcb_window))
+            add_window (self, BAMF_LEGACY_WINDOW (xcb_window));
+        }
+
+      return;
+    }
+
   WnckWindow *legacy_window = wnck_window_get (xid);
 
   if (WNCK_IS_WINDOW (legacy_window))
@@ -346,9 +837,24 @@ bamf_legacy_screen_set_state_file (BamfLegacyScreen *self,
   g_return_if_fail (BAMF_IS_LEGACY_SCREEN (self));
 
   // Disconnect our handlers so we can work purely on the file
-  g_signal_handlers_disconnect_by_func (self->priv->legacy_screen, handle_window_opened, self);
-  g_signal_handlers_disconnect_by_func (self->priv->legacy_screen, handle_window_closed, self);
-  g_signal_handlers_disconnect_by_func (self->priv->legacy_screen, handle_stacking_changed, self);
+  if (self->priv->initial_windows_id)
+    {
+      g_source_remove (self->priv->initial_windows_id);
+      self->priv->initial_windows_id = 0;
+    }
+
+  if (self->priv->legacy_screen)
+    {
+      g_signal_handlers_disconnect_by_func (self->priv->legacy_screen, handle_window_opened, self);
+      g_signal_handlers_disconnect_by_func (self->priv->legacy_screen, handle_window_closed, self);
+      g_signal_handlers_disconnect_by_func (self->priv->legacy_screen, handle_stacking_changed, self);
+    }
+
+  if (self->priv->xcb_source)
+    {
+      g_source_destroy (self->priv->xcb_source);
+      g_clear_pointer (&self->priv->xcb_source, g_source_unref);
+    }
 
   gfile = g_file_new_for_path (file);
 
@@ -450,8 +956,35 @@ bamf_legacy_screen_finalize (GObject *object)
   if (self->priv->stream)
     g_object_unref (self->priv->stream);
 
-  wnck_shutdown ();
-  static_screen = NULL;
+  if (self->priv->initial_windows_id)
+    g_source_remove (self->priv->initial_windows_id);
+
+  if (self->priv->xcb_source)
+    {
+      g_source_destroy (self->priv->xcb_source);
+      g_source_unref (self->priv->xcb_source);
+    }
+
+  if (self->priv->xcb_windows)
+    g_hash_table_destroy (self->priv->xcb_windows);
+
+  if (self->priv->xcb_stack)
+    g_array_unref (self->priv->xcb_stack);
+
+  if (self->priv->xcb_stack_indexes)
+    g_hash_table_unref (self->priv->xcb_stack_indexes);
+
+  if (self->priv->xcb)
+    xcb_disconnect (self->priv->xcb);
+
+  if (wnck_used)
+    {
+      wnck_shutdown ();
+      wnck_used = FALSE;
+    }
+
+  if (static_screen == self)
+    static_screen = NULL;
 
   G_OBJECT_CLASS (bamf_legacy_screen_parent_class)->finalize (object);
 }
@@ -592,12 +1125,29 @@ bamf_legacy_screen_get_default ()
   if (g_strcmp0 (g_getenv ("BAMF_TEST_MODE"), "TRUE") == 0)
     return static_screen;
 
-  wnck_set_default_icon_size (BAMF_DEFAULT_ICON_SIZE);
-  wnck_set_default_mini_icon_size (BAMF_DEFAULT_MINI_ICON_SIZE);
+  dpy = gdk_x11_get_default_xdisplay ();
+  bamf_xutils_intern_known_atoms ();
 
-  self->priv->legacy_screen = wnck_screen_get_default ();
+  if (screen_backend == BAMF_LEGACY_SCREEN_BACKEND_XCB && !setup_xcb_backend (self))
+    screen_backend = BAMF_LEGACY_SCREEN_BACKEND_WNCK;
 
-  dpy = gdk_x11_get_default_xdisplay ();
+  if (screen_backend == BAMF_LEGACY_SCREEN_BACKEND_WNCK)
+    {
+      wnck_set_default_icon_size (BAMF_DEFAULT_ICON_SIZE);
+      wnck_set_default_mini_icon_size (BAMF_DEFAULT_MINI_ICON_SIZE);
+
+      self->priv->legacy_screen = bamf_legacy_screen_get_wnck_screen ();
+
+      /* New windows are followed once the current ones have been added */
+      self->priv->initial_windows_id =
+        g_idle_add_full (G_PRIORITY_DEFAULT, (GSourceFunc) on_initial_windows_idle, self, NULL);
+
+      g_signal_connect (G_OBJECT (self->priv->legacy_screen), "window-stacking-changed",
+                        (GCallback) handle_stacking_changed, self);
+
+      g_signal_connect (G_OBJECT (self->priv->legacy_screen), "active-window-changed",
+                        (GCallback) handle_active_window_changed, self);
+    }
 
   self->priv->sn_display = sn_display_new (dpy, NULL, NULL);
 
@@ -606,15 +1156,6 @@ bamf_legacy_screen_get_default ()
                                                            handle_sn_monitor_event,
                                                            self, NULL);
 
-  g_signal_connect (G_OBJECT (self->priv->legacy_screen), "window-opened",
-                    (GCallback) handle_window_opened, self);
-
-  g_signal_connect (G_OBJECT (self->priv->legacy_screen), "window-stacking-changed",
-                    (GCallback) handle_stacking_changed, self);
-
-  g_signal_connect (G_OBJECT (self->priv->legacy_screen), "active-window-changed",
-                    (GCallback) handle_active_window_changed, self);
-
   xdg_current_desktop = g_getenv ("XDG_CURRENT_DESKTOP");
 
   if (xdg_current_desktop)
@@ -622,8 +1163,8 @@ bamf_legacy_screen_get_default ()
 
   if (current_desktops && g_strv_contains ((const gchar * const *) current_desktops, "Unity"))
     {
-      _COMPIZ_TOOLKIT_ACTION = XInternAtom (dpy, "_COMPIZ_TOOLKIT_ACTION", False);
-      _COMPIZ_TOOLKIT_ACTION_WINDOW_MENU = XInternAtom (dpy, "_COMPIZ_TOOLKIT_ACTION_WINDOW_MENU", False);
+      _COMPIZ_TOOLKIT_ACTION = bamf_xutils_get_atom ("_COMPIZ_TOOLKIT_ACTION");
+      _COMPIZ_TOOLKIT_ACTION_WINDOW_MENU = bamf_xutils_get_atom ("_COMPIZ_TOOLKIT_ACTION_WINDOW_MENU");
       gdk_window_add_filter (NULL, filter_compiz_messages, self);
     }
 
@@ -632,6 +1173,25 @@ bamf_legacy_screen_get_default ()
   return static_screen;
 }
 
+void
+bamf_legacy_screen_set_backend (BamfLegacyScreenBackend backend)
+{
+  g_return_if_fail (!static_screen);
+
+  screen_backend = backend;
+}
+
+WnckScreen *
+bamf_legacy_screen_get_wnck_screen (void)
+{
+  /* Don't initialize libwnck at all when it's not used */
+  if (screen_backend != BAMF_LEGACY_SCREEN_BACKEND_WNCK)
+    return NULL;
+
+  wnck_used = TRUE;
+
+  return wnck_screen_get_default ();
+}
 
 // Private functions for testing purposes
 
@@ -656,6 +1216,7 @@ void _bamf_legacy_screen_open_test_window (BamfLegacyScreen *self, BamfLegacyWin
     }
 
   self->priv->windows = g_list_append (self->priv->windows, window);
+  update_windows_stacking_positions (self);
   g_signal_emit (self, legacy_screen_signals[STACKING_CHANGED], 0);
 
   g_signal_connect (G_OBJECT (window), "closed",
@@ -672,3 +1233,16 @@ void _bamf_legacy_screen_close_test_window (BamfLegacyScreen *self, BamfLegacyWi
   // This will cause handle_window_closed to be called
   bamf_legacy_window_test_close (BAMF_LEGACY_WINDOW_TEST (test_window));
 }
+
+BamfLegacyScreen * _bamf_legacy_screen_new_xcb (void)
+{
+  BamfLegacyScreen *self;
+
+  self = (BamfLegacyScreen *) g_object_new (BAMF_TYPE_LEGACY_SCREEN, NULL);
+  bamf_xutils_intern_known_atoms ();
+
+  if (!setup_xcb_backend (self))
+    g_clear_object (&self);
+
+  return self;
+}
@@ -40,6 +40,12 @@
 #define BAMF_LEGACY_SCREEN_SIGNAL_STACKING_CHANGED         "stacking-changed"
 #define BAMF_LEGACY_SCREEN_SIGNAL_ACTIVE_WINDOW_CHANGED    "active-window-changed"
 
+typedef enum
+{
+  BAMF_LEGACY_SCREEN_BACKEND_WNCK,
+  BAMF_LEGACY_SCREEN_BACKEND_XCB,
+} BamfLegacyScreenBackend;
+
 typedef struct _BamfLegacyScreen BamfLegacyScreen;
 typedef struct _BamfLegacyScreenClass BamfLegacyScreenClass;
 typedef struct _BamfLegacyScreenPrivate BamfLegacyScreenPrivate;
@@ -78,6 +84,12 @@ BamfLegacyWindow * bamf_legacy_screen_get_active_window  (BamfLegacyScreen *scre
 
 BamfLegacyScreen * bamf_legacy_screen_get_default        (void);
 
+/* Must be called before the default screen is created */
+void               bamf_legacy_screen_set_backend        (BamfLegacyScreenBackend backend);
+
+/* The libwnck screen, or NULL if windows aren't tracked through libwnck */
+WnckScreen       * bamf_legacy_screen_get_wnck_screen    (void);
+
 void               bamf_legacy_screen_inject_window      (BamfLegacyScreen *screen, guint xid);
 
 #endif
@@ -0,0 +1,809 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+#include "bamf-legacy-window-xcb.h"
+#include "bamf-legacy-screen.h"
+#include "bamf-process-info.h"
+#include "bamf-xutils.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+G_DEFINE_TYPE (BamfLegacyWindowXcb, bamf_legacy_window_xcb, BAMF_TYPE_LEGACY_WINDOW);
+#define BAMF_LEGACY_WINDOW_XCB_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE(obj, \
+BAMF_TYPE_LEGACY_WINDOW_XCB, BamfLegacyWindowXcbPrivate))
+
+/* Tracked properties are expected to be small, values are truncated at 4KiB */
+#define PROPERTY_MAX_LENGTH 1024
+
+/* ICCCM urgency flag of the WM_HINTS property */
+#define WM_HINTS_URGENCY_FLAG (1 << 8)
+
+typedef enum
+{
+  PROPERTY_NET_WM_NAME,
+  PROPERTY_WM_NAME,
+  PROPERTY_WM_CLASS,
+  PROPERTY_WM_WINDOW_ROLE,
+  PROPERTY_NET_WM_PID,
+  PROPERTY_WM_TRANSIENT_FOR,
+  PROPERTY_WM_HINTS,
+  PROPERTY_NET_WM_STATE,
+  PROPERTY_NET_WM_WINDOW_TYPE,
+
+  N_PROPERTIES,
+} TrackedProperty;
+
+static const char *tracked_properties[N_PROPERTIES] =
+{
+  "_NET_WM_NAME",
+  "WM_NAME",
+  "WM_CLASS",
+  "WM_WINDOW_ROLE",
+  "_NET_WM_PID",
+  "WM_TRANSIENT_FOR",
+  "WM_HINTS",
+  "_NET_WM_STATE",
+  "_NET_WM_WINDOW_TYPE",
+};
+
+static const struct
+{
+  const char *atom_name;
+  BamfWindowType type;
+} window_types[] =
+{
+  {"_NET_WM_WINDOW_TYPE_NORMAL", BAMF_WINDOW_NORMAL},
+  {"_NET_WM_WINDOW_TYPE_DESKTOP", BAMF_WINDOW_DESKTOP},
+  {"_NET_WM_WINDOW_TYPE_DOCK", BAMF_WINDOW_DOCK},
+  {"_NET_WM_WINDOW_TYPE_DIALOG", BAMF_WINDOW_DIALOG},
+  {"_NET_WM_WINDOW_TYPE_TOOLBAR", BAMF_WINDOW_TOOLBAR},
+  {"_NET_WM_WINDOW_TYPE_MENU", BAMF_WINDOW_MENU},
+  {"_NET_WM_WINDOW_TYPE_UTILITY", BAMF_WINDOW_UTILITY},
+  {"_NET_WM_WINDOW_TYPE_SPLASH", BAMF_WINDOW_SPLASHSCREEN},
+};
+
+struct _BamfLegacyWindowXcbPrivate
+{
+  xcb_connection_t * xcb;
+  xcb_window_t       xid;
+  xcb_get_property_cookie_t cookies[N_PROPERTIES];
+  gboolean           loaded;
+  gboolean           destroyed;
+  gchar            * net_wm_name;
+  gchar            * wm_name;
+  gchar            * role;
+  gchar            * class_name;
+  gchar            * class_instance_name;
+  guint              pid;
+  guint              held_pid;
+  xcb_window_t       transient_for;
+  BamfWindowType     window_type;
+  gboolean           has_window_type;
+  gboolean           urgent;
+  gboolean           demands_attention;
+  gboolean           skip_taskbar;
+  gboolean           maximized_horizontally;
+  gboolean           maximized_vertically;
+  gboolean           is_active;
+  gboolean           is_closed;
+  gboolean           geometry_valid;
+  gint               x, y, width, height;
+  GHashTable       * hints;
+};
+
+static gchar *
+reply_to_string (xcb_get_property_reply_t *reply, xcb_atom_t type)
+{
+  const char *value, *end;
+  int length;
+
+  if (!reply || reply->format != 8 || reply->type != type)
+    return NULL;
+
+  value = xcb_get_property_value (reply);
+  length = xcb_get_property_value_length (reply);
+  end = memchr (value, '\0', length);
+
+  if (end)
+    length = end - value;
+
+  if (length <= 0)
+    return NULL;
+
+  if (type == XCB_ATOM_STRING)
+    return g_convert (value, length, "utf-8", "iso-8859-1", NULL, NULL, NULL);
+
+  if (!g_utf8_validate (value, length, NULL))
+    return NULL;
+
+  return g_strndup (value, length);
+}
+
+static guint32 *
+reply_to_cardinals (xcb_get_property_reply_t *reply, guint *n_values)
+{
+  *n_values = 0;
+
+  if (!reply || reply->format != 32)
+    return NULL;
+
+  *n_values = xcb_get_property_value_length (reply) / sizeof (guint32);
+
+  return *n_values > 0 ? xcb_get_property_value (reply) : NULL;
+}
+
+static gboolean
+atoms_contain (const guint32 *atoms, guint n_atoms, const char *atom_name)
+{
+  xcb_atom_t atom = bamf_xutils_get_atom (atom_name);
+  guint i;
+
+  for (i = 0; i < n_atoms; ++i)
+    {
+      if (atoms[i] == atom)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+replace_string (gchar **string, gchar *value)
+{
+  if (g_strcmp0 (*string, value) == 0)
+    {
+      g_free (value);
+      return FALSE;
+    }
+
+  g_free (*string);
+  *string = value;
+
+  return TRUE;
+}
+
+static void
+set_pid (BamfLegacyWindowXcb *self, guint pid)
+{
+  if (self->priv->pid == pid)
+    return;
+
+  /* Keep the process info around for the whole window life, only releasing
+   * the hold we actually got, not to drop the one of another window */
+  if (self->priv->held_pid)
+    bamf_process_info_release (self->priv->held_pid);
+
+  self->priv->pid = pid;
+  self->priv->held_pid = bamf_process_info_hold (pid) ? pid : 0;
+}
+
+static gboolean
+get_window_type_from_atoms (const guint32 *atoms, guint n_atoms, BamfWindowType *type)
+{
+  guint i, j;
+
+  /* The first known type is the one to use, as per EWMH */
+  for (i = 0; i < n_atoms; ++i)
+    {
+      for (j = 0; j < G_N_ELEMENTS (window_types); ++j)
+        {
+          if (atoms[i] == bamf_xutils_get_atom (window_types[j].atom_name))
+            {
+              *type = window_types[j].type;
+              return TRUE;
+            }
+        }
+    }
+
+  return FALSE;
+}
+
+/* Returns the name of the signal to emit, if the property change needs it */
+static const char *
+update_property (BamfLegacyWindowXcb *self, TrackedProperty property,
+                 xcb_get_property_reply_t *reply)
+{
+  BamfLegacyWindowXcbPrivate *priv = self->priv;
+  gchar *old_name;
+  gchar *class_name, *class_instance_name;
+  gboolean changed;
+  guint32 *values;
+  guint n_values;
+
+  values = reply_to_cardinals (reply, &n_values);
+
+  switch (property)
+    {
+      case PROPERTY_NET_WM_NAME:
+      case PROPERTY_WM_NAME:
+        /* _NET_WM_NAME takes precedence over WM_NAME */
+        old_name = g_strdup (priv->net_wm_name ? priv->net_wm_name : priv->wm_name);
+
+        if (property == PROPERTY_NET_WM_NAME)
+          replace_string (&priv->net_wm_name, reply_to_string (reply, bamf_xutils_get_atom ("UTF8_STRING")));
+        else
+          replace_string (&priv->wm_name, reply_to_string (reply, XCB_ATOM_STRING));
+
+        changed = g_strcmp0 (old_name, priv->net_wm_name ? priv->net_wm_name : priv->wm_name) != 0;
+        g_free (old_name);
+
+        return changed ? BAMF_LEGACY_WINDOW_SIGNAL_NAME_CHANGED : NULL;
+
+      case PROPERTY_WM_CLASS:
+        class_name = NULL;
+        class_instance_name = NULL;
+
+        if (reply && reply->format == 8)
+          bamf_xutils_parse_class_hints (xcb_get_property_value (reply),
+                                         xcb_get_property_value_length (reply),
+                                         &class_instance_name, &class_name);
+
+        changed = replace_string (&priv->class_name, class_name);
+        changed = replace_string (&priv->class_instance_name, class_instance_name) || changed;
+        return changed ? BAMF_LEGACY_WINDOW_SIGNAL_CLASS_CHANGED : NULL;
+
+      case PROPERTY_WM_WINDOW_ROLE:
+        changed = replace_string (&priv->role, reply_to_string (reply, XCB_ATOM_STRING));
+        return changed ? BAMF_LEGACY_WINDOW_SIGNAL_ROLE_CHANGED : NULL;
+
+      case PROPERTY_NET_WM_PID:
+        set_pid (self, n_values > 0 ? values[0] : 0);
+        return NULL;
+
+      case PROPERTY_WM_TRANSIENT_FOR:
+        priv->transient_for = n_values > 0 ? values[0] : XCB_WINDOW_NONE;
+        return NULL;
+
+      case PROPERTY_WM_HINTS:
+        changed = priv->urgent;
+        priv->urgent = n_values > 0 && (values[0] & WM_HINTS_URGENCY_FLAG);
+        return (changed != priv->urgent) ? BAMF_LEGACY_WINDOW_SIGNAL_STATE_CHANGED : NULL;
+
+      case PROPERTY_NET_WM_STATE:
+        {
+          gboolean demands_attention = atoms_contain (values, n_values, "_NET_WM_STATE_DEMANDS_ATTENTION");
+          gboolean skip_taskbar = atoms_contain (values, n_values, "_NET_WM_STATE_SKIP_TASKBAR");
+          gboolean maximized_horizontally = atoms_contain (values, n_values, "_NET_WM_STATE_MAXIMIZED_HORZ");
+          gboolean maximized_vertically = atoms_contain (values, n_values, "_NET_WM_STATE_MAXIMIZED_VERT");
+
+          changed = (demands_attention != priv->demands_attention ||
+                     skip_taskbar != priv->skip_taskbar ||
+                     maximized_horizontally != priv->maximized_horizontally ||
+                     maximized_vertically != priv->maximized_vertically);
+
+          priv->demands_attention = demands_attention;
+          priv->skip_taskbar = skip_taskbar;
+          priv->maximized_horizontally = maximized_horizontally;
+          priv->maximized_vertically = maximized_vertically;
+
+          return changed ? BAMF_LEGACY_WINDOW_SIGNAL_STATE_CHANGED : NULL;
+        }
+
+      case PROPERTY_NET_WM_WINDOW_TYPE:
+        priv->has_window_type = get_window_type_from_atoms (values, n_values, &priv->window_type);
+        return NULL;
+
+      default:
+        return NULL;
+    }
+}
+
+static xcb_get_property_cookie_t
+request_property (BamfLegacyWindowXcb *self, TrackedProperty property)
+{
+  return xcb_get_property (self->priv->xcb, FALSE, self->priv->xid,
+                           bamf_xutils_get_atom (tracked_properties[property]),
+                           XCB_GET_PROPERTY_TYPE_ANY, 0, PROPERTY_MAX_LENGTH);
+}
+
+/* A failed request means that the window has been destroyed meanwhile, as
+ * the atoms are valid, so its value can't be trusted */
+static xcb_get_property_reply_t *
+get_property_reply (BamfLegacyWindowXcb *self, xcb_get_property_cookie_t cookie)
+{
+  xcb_get_property_reply_t *reply;
+  xcb_generic_error_t *error = NULL;
+
+  reply = xcb_get_property_reply (self->priv->xcb, cookie, &error);
+
+  if (error)
+    {
+      self->priv->destroyed = TRUE;
+      g_clear_pointer (&reply, free);
+      free (error);
+    }
+
+  return reply;
+}
+
+static void
+ensure_loaded (BamfLegacyWindowXcb *self)
+{
+  xcb_get_property_reply_t *reply;
+  guint i;
+
+  if (self->priv->loaded)
+    return;
+
+  self->priv->loaded = TRUE;
+
+  /* All the replies must be read anyway, even if the window is gone */
+  for (i = 0; i < N_PROPERTIES; ++i)
+    {
+      reply = get_property_reply (self, self->priv->cookies[i]);
+
+      if (!self->priv->destroyed)
+        update_property (self, i, reply);
+
+      free (reply);
+    }
+}
+
+static void
+ensure_geometry (BamfLegacyWindowXcb *self)
+{
+  BamfLegacyWindowXcbPrivate *priv = self->priv;
+  xcb_get_geometry_reply_t *geometry;
+  xcb_translate_coordinates_reply_t *coordinates;
+  xcb_get_geometry_cookie_t geometry_cookie;
+  xcb_translate_coordinates_cookie_t coordinates_cookie;
+  xcb_window_t root;
+
+  if (priv->geometry_valid)
+    return;
+
+  /* Clients are reparented by the window manager, so the position has to be
+   * translated to the root coordinates */
+  root = xcb_setup_roots_iterator (xcb_get_setup (priv->xcb)).data->root;
+  geometry_cookie = xcb_get_geometry (priv->xcb, priv->xid);
+  coordinates_cookie = xcb_translate_coordinates (priv->xcb, priv->xid, root, 0, 0);
+
+  geometry = xcb_get_geometry_reply (priv->xcb, geometry_cookie, NULL);
+  coordinates = xcb_translate_coordinates_reply (priv->xcb, coordinates_cookie, NULL);
+
+  if (geometry && coordinates)
+    {
+      priv->x = coordinates->dst_x;
+      priv->y = coordinates->dst_y;
+      priv->width = geometry->width;
+      priv->height = geometry->height;
+      priv->geometry_valid = TRUE;
+    }
+
+  free (geometry);
+  free (coordinates);
+}
+
+static void
+handle_property_notify (BamfLegacyWindowXcb *self, xcb_property_notify_event_t *event)
+{
+  xcb_get_property_reply_t *reply;
+  const char *signal = NULL;
+  const char *atom_name;
+  guint i;
+
+  ensure_loaded (self);
+
+  for (i = 0; i < N_PROPERTIES; ++i)
+    {
+      if (event->atom != bamf_xutils_get_atom (tracked_properties[i]))
+        continue;
+
+      reply = get_property_reply (self, request_property (self, i));
+
+      if (self->priv->destroyed)
+        {
+          bamf_legacy_window_xcb_close (self);
+          return;
+        }
+
+      signal = update_property (self, i, reply);
+      free (reply);
+
+      if (signal)
+        g_signal_emit_by_name (self, signal);
+
+      return;
+    }
+
+  /* If the atom has never been interned, we've nothing cached for it */
+  atom_name = bamf_xutils_get_atom_name (event->atom);
+
+  if (!atom_name)
+    return;
+
+  if (event->state == XCB_PROPERTY_DELETE)
+    g_hash_table_insert (self->priv->hints, g_strdup (atom_name), NULL);
+  else
+    g_hash_table_remove (self->priv->hints, atom_name);
+}
+
+void
+bamf_legacy_window_xcb_handle_event (BamfLegacyWindowXcb *self, xcb_generic_event_t *event)
+{
+  g_return_if_fail (BAMF_IS_LEGACY_WINDOW_XCB (self));
+  g_return_if_fail (event);
+
+  if (self->priv->is_closed)
+    return;
+
+  /* The window might be closed and released by the screen while handling */
+  g_object_ref (self);
+
+  switch (event->response_type & ~0x80)
+    {
+      case XCB_PROPERTY_NOTIFY:
+        handle_property_notify (self, (xcb_property_notify_event_t *) event);
+        break;
+      case XCB_CONFIGURE_NOTIFY:
+        self->priv->geometry_valid = FALSE;
+        g_signal_emit_by_name (self, BAMF_LEGACY_WINDOW_SIGNAL_GEOMETRY_CHANGED);
+        break;
+    }
+
+  g_object_unref (self);
+}
+
+gboolean
+bamf_legacy_window_xcb_load (BamfLegacyWindowXcb *self)
+{
+  g_return_val_if_fail (BAMF_IS_LEGACY_WINDOW_XCB (self), FALSE);
+
+  ensure_loaded (self);
+
+  return !self->priv->destroyed;
+}
+
+void
+bamf_legacy_window_xcb_set_active (BamfLegacyWindowXcb *self, gboolean active)
+{
+  g_return_if_fail (BAMF_IS_LEGACY_WINDOW_XCB (self));
+
+  self->priv->is_active = active;
+}
+
+void
+bamf_legacy_window_xcb_close (BamfLegacyWindowXcb *self)
+{
+  g_return_if_fail (BAMF_IS_LEGACY_WINDOW_XCB (self));
+
+  if (self->priv->is_closed)
+    return;
+
+  self->priv->is_closed = TRUE;
+  g_signal_emit_by_name (self, BAMF_LEGACY_WINDOW_SIGNAL_CLOSED);
+}
+
+static guint32
+bamf_legacy_window_xcb_get_xid (BamfLegacyWindow *window)
+{
+  return BAMF_LEGACY_WINDOW_XCB (window)->priv->xid;
+}
+
+static guint
+bamf_legacy_window_xcb_get_pid (BamfLegacyWindow *window)
+{
+  BamfLegacyWindowXcb *self = BAMF_LEGACY_WINDOW_XCB (window);
+
+  ensure_loaded (self);
+
+  return self->priv->pid;
+}
+
+static const char *
+bamf_legacy_window_xcb_get_name (BamfLegacyWindow *window)
+{
+  BamfLegacyWindowXcb *self = BAMF_LEGACY_WINDOW_XCB (window);
+
+  ensure_loaded (self);
+
+  return self->priv->net_wm_name ? self->priv->net_wm_name : self->priv->wm_name;
+}
+
+static const char *
+bamf_legacy_window_xcb_get_role (BamfLegacyWindow *window)
+{
+  BamfLegacyWindowXcb *self = BAMF_LEGACY_WINDOW_XCB (window);
+
+  ensure_loaded (self);
+
+  return self->priv->role;
+}
+
+static const char *
+bamf_legacy_window_xcb_get_class_name (BamfLegacyWindow *window)
+{
+  BamfLegacyWindowXcb *self = BAMF_LEGACY_WINDOW_XCB (window);
+
+  ensure_loaded (self);
+
+  return self->priv->class_name;
+}
+
+static const char *
+bamf_legacy_window_xcb_get_class_instance_name (BamfLegacyWindow *window)
+{
+  BamfLegacyWindowXcb *self = BAMF_LEGACY_WINDOW_XCB (window);
+
+  ensure_loaded (self);
+
+  return self->priv->class_instance_name;
+}
+
+static BamfLegacyWindow *
+bamf_legacy_window_xcb_get_transient (BamfLegacyWindow *window)
+{
+  BamfLegacyWindowXcb *self = BAMF_LEGACY_WINDOW_XCB (window);
+  GList *l;
+
+  ensure_loaded (self);
+
+  if (!self->priv->transient_for)
+    return NULL;
+
+  for (l = bamf_legacy_screen_get_windows (bamf_legacy_screen_get_default ()); l; l = l->next)
+    {
+      if (bamf_legacy_window_get_xid (l->data) == self->priv->transient_for)
+        return l->data;
+    }
+
+  return NULL;
+}
+
+static BamfWindowType
+bamf_legacy_window_xcb_get_window_type (BamfLegacyWindow *window)
+{
+  BamfLegacyWindowXcb *self = BAMF_LEGACY_WINDOW_XCB (window);
+
+  ensure_loaded (self);
+
+  /* Transient windows without a type are dialogs, as per EWMH */
+  if (self->priv->has_window_type)
+    return self->priv->window_type;
+
+  return self->priv->transient_for ? BAMF_WINDOW_DIALOG : BAMF_WINDOW_NORMAL;
+}
+
+static gboolean
+bamf_legacy_window_xcb_needs_attention (BamfLegacyWindow *window)
+{
+  BamfLegacyWindowXcb *self = BAMF_LEGACY_WINDOW_XCB (window);
+
+  ensure_loaded (self);
+
+  return self->priv->urgent || self->priv->demands_attention;
+}
+
+/* Follows the libwnck logic, so that the windows are shown the same way */
+static gboolean
+bamf_legacy_window_xcb_is_skip_tasklist (BamfLegacyWindow *window)
+{
+  BamfLegacyWindowXcb *self = BAMF_LEGACY_WINDOW_XCB (window);
+
+  ensure_loaded (self);
+
+  switch (bamf_legacy_window_xcb_get_window_type (window))
+    {
+      case BAMF_WINDOW_DESKTOP:
+      case BAMF_WINDOW_DOCK:
+      case BAMF_WINDOW_SPLASHSCREEN:
+        return TRUE;
+      case BAMF_WINDOW_TOOLBAR:
+      case BAMF_WINDOW_MENU:
+      case BAMF_WINDOW_UTILITY:
+      case BAMF_WINDOW_DIALOG:
+        if (bamf_legacy_window_xcb_get_transient (window))
+          return TRUE;
+        break;
+      default:
+        break;
+    }
+
+  return self->priv->skip_taskbar;
+}
+
+static gboolean
+bamf_legacy_window_xcb_is_active (BamfLegacyWindow *window)
+{
+  return BAMF_LEGACY_WINDOW_XCB (window)->priv->is_active;
+}
+
+static gboolean
+bamf_legacy_window_xcb_is_closed (BamfLegacyWindow *window)
+{
+  return BAMF_LEGACY_WINDOW_XCB (window)->priv->is_closed;
+}
+
+static BamfWindowMaximizationType
+bamf_legacy_window_xcb_maximized (BamfLegacyWindow *window)
+{
+  BamfLegacyWindowXcb *self = BAMF_LEGACY_WINDOW_XCB (window);
+
+  ensure_loaded (self);
+
+  if (self->priv->maximized_vertically && self->priv->maximized_horizontally)
+    return BAMF_WINDOW_MAXIMIZED;
+
+  if (self->priv->maximized_horizontally)
+    return BAMF_WINDOW_HORIZONTAL_MAXIMIZED;
+
+  if (self->priv->maximized_vertically)
+    return BAMF_WINDOW_VERTICAL_MAXIMIZED;
+
+  return BAMF_WINDOW_FLOATING;
+}
+
+static void
+bamf_legacy_window_xcb_get_geometry (BamfLegacyWindow *window, gint *x, gint *y,
+                                     gint *width, gint *height)
+{
+  BamfLegacyWindowXcb *self = BAMF_LEGACY_WINDOW_XCB (window);
+
+  if (self->priv->is_closed)
+    return;
+
+  ensure_geometry (self);
+
+  if (x) *x = self->priv->x;
+  if (y) *y = self->priv->y;
+  if (width) *width = self->priv->width;
+  if (height) *height = self->priv->height;
+}
+
+static char *
+bamf_legacy_window_xcb_get_hint (BamfLegacyWindow *window, const char *name)
+{
+  BamfLegacyWindowXcb *self = BAMF_LEGACY_WINDOW_XCB (window);
+  char *hint;
+
+  if (g_hash_table_lookup_extended (self->priv->hints, name, NULL, (gpointer *) &hint))
+    return g_strdup (hint);
+
+  hint = bamf_xutils_get_string_window_hint (self->priv->xid, name);
+
+  /* Changes can't be tracked for atoms that are unknown to the server */
+  if (bamf_xutils_peek_atom (name) != None)
+    g_hash_table_insert (self->priv->hints, g_strdup (name), g_strdup (hint));
+
+  return hint;
+}
+
+static void
+bamf_legacy_window_xcb_set_hint (BamfLegacyWindow *window, const char *name, const char *value)
+{
+  BamfLegacyWindowXcb *self = BAMF_LEGACY_WINDOW_XCB (window);
+
+  bamf_xutils_set_string_window_hint (self->priv->xid, name, value);
+  g_hash_table_insert (self->priv->hints, g_strdup (name), g_strdup (value));
+}
+
+static GtkWidget *
+bamf_legacy_window_xcb_get_action_menu (BamfLegacyWindow *window)
+{
+  return NULL;
+}
+
+static void
+bamf_legacy_window_xcb_show_action_menu (BamfLegacyWindow *window, guint32 time,
+                                         guint button, gint x, gint y)
+{}
+
+static void
+handle_destroy_notify (gpointer data, GObject *self_was_here)
+{
+  BamfLegacyScreen *screen = bamf_legacy_screen_get_default ();
+  bamf_legacy_screen_inject_window (screen, GPOINTER_TO_UINT (data));
+}
+
+static void
+bamf_legacy_window_xcb_reopen (BamfLegacyWindow *window)
+{
+  BamfLegacyWindowXcb *self = BAMF_LEGACY_WINDOW_XCB (window);
+
+  /* Once this window has been destroyed, the screen will add it again */
+  g_object_weak_ref (G_OBJECT (self), handle_destroy_notify,
+                     GUINT_TO_POINTER (self->priv->xid));
+
+  bamf_legacy_window_xcb_close (self);
+}
+
+static void
+bamf_legacy_window_xcb_finalize (GObject *object)
+{
+  BamfLegacyWindowXcb *self = BAMF_LEGACY_WINDOW_XCB (object);
+  guint i;
+
+  if (!self->priv->loaded)
+    {
+      for (i = 0; i < N_PROPERTIES; ++i)
+        xcb_discard_reply (self->priv->xcb, self->priv->cookies[i].sequence);
+    }
+
+  if (self->priv->held_pid)
+    bamf_process_info_release (self->priv->held_pid);
+
+  g_free (self->priv->net_wm_name);
+  g_free (self->priv->wm_name);
+  g_free (self->priv->role);
+  g_free (self->priv->class_name);
+  g_free (self->priv->class_instance_name);
+  g_hash_table_destroy (self->priv->hints);
+
+  G_OBJECT_CLASS (bamf_legacy_window_xcb_parent_class)->finalize (object);
+}
+
+static void
+bamf_legacy_window_xcb_init (BamfLegacyWindowXcb *self)
+{
+  self->priv = BAMF_LEGACY_WINDOW_XCB_GET_PRIVATE (self);
+  self->priv->hints = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+}
+
+static void
+bamf_legacy_window_xcb_class_init (BamfLegacyWindowXcbClass *klass)
+{
+  BamfLegacyWindowClass *win_class = BAMF_LEGACY_WINDOW_CLASS (klass);
+  GObjectClass *obj_class = G_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (BamfLegacyWindowXcbPrivate));
+
+  obj_class->finalize         = bamf_legacy_window_xcb_finalize;
+  win_class->get_transient    = bamf_legacy_window_xcb_get_transient;
+  win_class->get_name         = bamf_legacy_window_xcb_get_name;
+  win_class->get_role         = bamf_legacy_window_xcb_get_role;
+  win_class->get_class_name   = bamf_legacy_window_xcb_get_class_name;
+  win_class->get_class_instance_name = bamf_legacy_window_xcb_get_class_instance_name;
+  win_class->get_xid          = bamf_legacy_window_xcb_get_xid;
+  win_class->get_pid          = bamf_legacy_window_xcb_get_pid;
+  win_class->needs_attention  = bamf_legacy_window_xcb_needs_attention;
+  win_class->is_skip_tasklist = bamf_legacy_window_xcb_is_skip_tasklist;
+  win_class->is_active        = bamf_legacy_window_xcb_is_active;
+  win_class->is_closed        = bamf_legacy_window_xcb_is_closed;
+  win_class->maximized        = bamf_legacy_window_xcb_maximized;
+  win_class->get_window_type  = bamf_legacy_window_xcb_get_window_type;
+  win_class->get_geometry     = bamf_legacy_window_xcb_get_geometry;
+  win_class->get_hint         = bamf_legacy_window_xcb_get_hint;
+  win_class->set_hint         = bamf_legacy_window_xcb_set_hint;
+  win_class->get_action_menu  = bamf_legacy_window_xcb_get_action_menu;
+  win_class->show_action_menu = bamf_legacy_window_xcb_show_action_menu;
+  win_class->reopen           = bamf_legacy_window_xcb_reopen;
+}
+
+BamfLegacyWindowXcb *
+bamf_legacy_window_xcb_new (xcb_connection_t *xcb, xcb_window_t xid)
+{
+  BamfLegacyWindowXcb *self;
+  const uint32_t event_mask = XCB_EVENT_MASK_PROPERTY_CHANGE | XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+  guint i;
+
+  g_return_val_if_fail (xcb, NULL);
+  g_return_val_if_fail (xid != XCB_WINDOW_NONE, NULL);
+
+  self = g_object_new (BAMF_TYPE_LEGACY_WINDOW_XCB, NULL);
+  self->priv->xcb = xcb;
+  self->priv->xid = xid;
+
+  /* Changes must be selected before reading, not to miss any of them */
+  xcb_change_window_attributes (xcb, xid, XCB_CW_EVENT_MASK, &event_mask);
+
+  for (i = 0; i < N_PROPERTIES; ++i)
+    self->priv->cookies[i] = request_property (self, i);
+
+  return self;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __BAMF_LEGACY_WINDOW_XCB_H__
+#define __BAMF_LEGACY_WINDOW_XCB_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include <xcb/xcb.h>
+#include "bamf-legacy-window.h"
+
+#define BAMF_TYPE_LEGACY_WINDOW_XCB (bamf_legacy_window_xcb_get_type ())
+
+#define BAMF_LEGACY_WINDOW_XCB(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj),\
+        BAMF_TYPE_LEGACY_WINDOW_XCB, BamfLegacyWindowXcb))
+
+#define BAMF_LEGACY_WINDOW_XCB_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST ((klass),\
+        BAMF_TYPE_LEGACY_WINDOW_XCB, BamfLegacyWindowXcbClass))
+
+#define BAMF_IS_LEGACY_WINDOW_XCB(obj) (G_TYPE_CHECK_INSTANCE_TYPE ((obj),\
+        BAMF_TYPE_LEGACY_WINDOW_XCB))
+
+#define BAMF_IS_LEGACY_WINDOW_XCB_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),\
+        BAMF_TYPE_LEGACY_WINDOW_XCB))
+
+#define BAMF_LEGACY_WINDOW_XCB_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj),\
+        BAMF_TYPE_LEGACY_WINDOW_XCB, BamfLegacyWindowXcbClass))
+
+typedef struct _BamfLegacyWindowXcb        BamfLegacyWindowXcb;
+typedef struct _BamfLegacyWindowXcbClass   BamfLegacyWindowXcbClass;
+typedef struct _BamfLegacyWindowXcbPrivate BamfLegacyWindowXcbPrivate;
+
+struct _BamfLegacyWindowXcb
+{
+  BamfLegacyWindow parent;
+
+  /* private */
+  BamfLegacyWindowXcbPrivate *priv;
+};
+
+struct _BamfLegacyWindowXcbClass
+{
+  BamfLegacyWindowClass parent_class;
+};
+
+GType                 bamf_legacy_window_xcb_get_type        (void) G_GNUC_CONST;
+
+/* Windows only send their property requests when created, replies are read
+ * once loaded, so that many windows can be loaded with a single round trip */
+BamfLegacyWindowXcb * bamf_legacy_window_xcb_new             (xcb_connection_t *xcb,
+                                                              xcb_window_t xid);
+
+/* Reads the replies of the property requests, returns FALSE if the window has
+ * been destroyed meanwhile, so that it must not be used */
+gboolean              bamf_legacy_window_xcb_load            (BamfLegacyWindowXcb *self);
+
+/* Events and state changes are fed by the BamfLegacyScreen */
+void                  bamf_legacy_window_xcb_handle_event    (BamfLegacyWindowXcb *self,
+                                                              xcb_generic_event_t *event);
+
+void                  bamf_legacy_window_xcb_set_active      (BamfLegacyWindowXcb *self,
+                                                              gboolean active);
+
+void                  bamf_legacy_window_xcb_close           (BamfLegacyWindowXcb *self);
+
+#endif
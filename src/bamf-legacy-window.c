@@ -23,10 +23,9 @@
 #include "bamf-legacy-window.h"
 #include "bamf-legacy-screen.h"
 #include "bamf-xutils.h"
+#include "bamf-process-info.h"
 #include <libgtop-2.0/glibtop.h>
 #include <libgtop-2.0/glibtop/procwd.h>
-#include <glibtop/procargs.h>
-#include <glibtop/procuid.h>
 #include <stdio.h>
 
 G_DEFINE_TYPE (BamfLegacyWindow, bamf_legacy_window, G_TYPE_OBJECT);
@@ -34,6 +33,8 @@ G_DEFINE_TYPE (BamfLegacyWindow, bamf_legacy_window, G_TYPE_OBJECT);
 BAMF_TYPE_LEGACY_WINDOW, BamfLegacyWindowPrivate))
 
 #define WNCK_WINDOW_BAMF_DATA "bamf-legacy-window"
+#define WM_CLASS "WM_CLASS"
+#define WM_WINDOW_ROLE "WM_WINDOW_ROLE"
 
 enum
 {
@@ -49,29 +50,48 @@ enum
 
 static guint legacy_window_signals[LAST_SIGNAL] = { 0 };
 
+/* Hints that are needed to match every window, read as soon as it opens */
+static const char *prefetched_hints[] =
+{
+  "_BAMF_DESKTOP_FILE",
+  "_GTK_APPLICATION_ID",
+};
+
 struct _BamfLegacyWindowPrivate
 {
   WnckWindow * legacy_window;
   GtkWidget  * action_menu;
   GFile      * mini_icon;
-  gchar      * exec_string;
+  GHashTable * hints;
+  gchar      * class_name;
+  gchar      * class_instance_name;
+  gchar      * role;
   gchar      * working_dir;
+  guint        process_pid;
+  gint         stacking_position;
   gboolean     is_closed;
+  gboolean     tracking_properties;
 };
 
+/* Maps the xids of the windows whose properties are tracked to them */
+static GHashTable *tracked_windows = NULL;
+
 gboolean
 bamf_legacy_window_is_active (BamfLegacyWindow *self)
 {
-  WnckWindow *active;
+  WnckScreen *wnck_screen;
 
   g_return_val_if_fail (BAMF_IS_LEGACY_WINDOW (self), FALSE);
 
   if (BAMF_LEGACY_WINDOW_GET_CLASS (self)->is_active)
     return BAMF_LEGACY_WINDOW_GET_CLASS (self)->is_active (self);
 
-  active = wnck_screen_get_active_window (wnck_screen_get_default ());
+  wnck_screen = bamf_legacy_screen_get_wnck_screen ();
+
+  if (!wnck_screen || !self->priv->legacy_window)
+    return FALSE;
 
-  return active == self->priv->legacy_window;
+  return wnck_screen_get_active_window (wnck_screen) == self->priv->legacy_window;
 }
 
 BamfWindowType
@@ -128,7 +148,7 @@ bamf_legacy_window_get_class_instance_name (BamfLegacyWindow *self)
   if (!window)
     return NULL;
 
-  return wnck_window_get_class_instance_name (window);
+  return self->priv->class_instance_name;
 }
 
 const char *
@@ -146,7 +166,7 @@ bamf_legacy_window_get_class_name (BamfLegacyWindow *self)
   if (!window)
     return NULL;
 
-  return wnck_window_get_class_group_name (window);
+  return self->priv->class_name;
 }
 
 const char *
@@ -174,17 +194,13 @@ bamf_legacy_window_get_role (BamfLegacyWindow *self)
   if (!self->priv->legacy_window)
     return NULL;
 
-  return wnck_window_get_role (self->priv->legacy_window);
+  return self->priv->role;
 }
 
 char *
 bamf_legacy_window_get_process_name (BamfLegacyWindow *self)
 {
-  gchar *stat_path;
-  gchar *contents;
-  gchar **lines;
-  gchar **sections;
-  gchar *result = NULL;
+  BamfProcessInfo *info;
   guint pid;
 
   g_return_val_if_fail (BAMF_IS_LEGACY_WINDOW (self), NULL);
@@ -197,56 +213,30 @@ bamf_legacy_window_get_process_name (BamfLegacyWindow *self)
   if (pid < 2)
     return NULL;
 
-  stat_path = g_strdup_printf ("/proc/%i/status", pid);
-
-  if (g_file_get_contents (stat_path, &contents, NULL, NULL))
-    {
-      lines = g_strsplit (contents, "\n", 2);
-
-      if (lines && g_strv_length (lines) > 0)
-        {
-          sections = g_strsplit (lines[0], "\t", 0);
-          if (sections)
-            {
-              if (g_strv_length (sections) > 1)
-                result = g_strdup (sections[1]);
-
-              g_strfreev (sections);
-            }
-          g_strfreev (lines);
-        }
-      g_free (contents);
-    }
-  g_free (stat_path);
+  info = bamf_process_info_get (pid);
 
-  return result;
+  return info ? g_strdup (bamf_process_info_get_name (info)) : NULL;
 }
 
 const char *
 bamf_legacy_window_get_exec_string (BamfLegacyWindow *self)
 {
+  BamfProcessInfo *info;
   guint pid;
-  gchar **argv;
-  glibtop_proc_args buffer;
 
   g_return_val_if_fail (BAMF_IS_LEGACY_WINDOW (self), NULL);
 
   if (BAMF_LEGACY_WINDOW_GET_CLASS (self)->get_exec_string)
     return BAMF_LEGACY_WINDOW_GET_CLASS (self)->get_exec_string (self);
 
-  if (self->priv->exec_string)
-    return self->priv->exec_string;
-
   pid = bamf_legacy_window_get_pid (self);
 
   if (pid == 0)
     return NULL;
 
-  argv = glibtop_get_proc_argv (&buffer, pid, 0);
-  self->priv->exec_string = g_strstrip (g_strjoinv (" ", argv));
-  g_strfreev (argv);
+  info = bamf_process_info_get (pid);
 
-  return self->priv->exec_string;
+  return info ? bamf_process_info_get_exec_string (info) : NULL;
 }
 
 const char *
@@ -408,14 +398,17 @@ bamf_legacy_window_get_transient (BamfLegacyWindow *self)
 gint
 bamf_legacy_window_get_stacking_position (BamfLegacyWindow *self)
 {
-  BamfLegacyScreen *screen;
-
   g_return_val_if_fail (BAMF_IS_LEGACY_WINDOW (self), -1);
 
-  screen = bamf_legacy_screen_get_default ();
-  g_return_val_if_fail (BAMF_IS_LEGACY_SCREEN (screen), -1);
+  return self->priv->stacking_position;
+}
 
-  return g_list_index (bamf_legacy_screen_get_windows (screen), self);
+void
+bamf_legacy_window_set_stacking_position (BamfLegacyWindow *self, gint position)
+{
+  g_return_if_fail (BAMF_IS_LEGACY_WINDOW (self));
+
+  self->priv->stacking_position = position;
 }
 
 static void
@@ -460,8 +453,8 @@ bamf_legacy_window_get_geometry (BamfLegacyWindow *self, gint *x, gint *y,
 
   g_return_if_fail (BAMF_IS_LEGACY_WINDOW (self));
 
-  if (BAMF_LEGACY_WINDOW_GET_CLASS (self)->get_app_id)
-    BAMF_LEGACY_WINDOW_GET_CLASS (self)->get_app_id (self);
+  if (BAMF_LEGACY_WINDOW_GET_CLASS (self)->get_geometry)
+    return BAMF_LEGACY_WINDOW_GET_CLASS (self)->get_geometry (self, x, y, width, height);
 
   if (!self->priv->legacy_window)
     return;
@@ -510,6 +503,8 @@ bamf_legacy_window_maximized (BamfLegacyWindow *self)
 char *
 bamf_legacy_window_get_hint (BamfLegacyWindow *self, const char *name)
 {
+  char *hint;
+
   g_return_val_if_fail (BAMF_IS_LEGACY_WINDOW (self), NULL);
   g_return_val_if_fail (name, NULL);
 
@@ -518,9 +513,17 @@ bamf_legacy_window_get_hint (BamfLegacyWindow *self, const char *name)
 
   g_return_val_if_fail (WNCK_IS_WINDOW (self->priv->legacy_window), NULL);
 
+  if (g_hash_table_lookup_extended (self->priv->hints, name, NULL, (gpointer *) &hint))
+    return g_strdup (hint);
+
   guint xid = bamf_legacy_window_get_xid (self);
+  hint = bamf_xutils_get_string_window_hint (xid, name);
+
+  /* Changes can't be tracked for atoms that are unknown to the server */
+  if (self->priv->tracking_properties && bamf_xutils_peek_atom (name) != None)
+    g_hash_table_insert (self->priv->hints, g_strdup (name), g_strdup (hint));
 
-  return bamf_xutils_get_string_window_hint (xid, name);
+  return hint;
 }
 
 void
@@ -537,6 +540,9 @@ bamf_legacy_window_set_hint (BamfLegacyWindow *self, const char *name, const cha
   guint xid = bamf_legacy_window_get_xid (self);
 
   bamf_xutils_set_string_window_hint (xid, name, value);
+
+  if (self->priv->tracking_properties)
+    g_hash_table_insert (self->priv->hints, g_strdup (name), g_strdup (value));
 }
 
 static void
@@ -609,6 +615,192 @@ void bamf_legacy_window_show_action_menu (BamfLegacyWindow *self, guint32 time,
   gtk_menu_popup (GTK_MENU (menu), NULL, NULL, position, self, button, time);
 }
 
+static gboolean
+update_class_hints (BamfLegacyWindow *self, const char *value, gsize length)
+{
+  gchar *class_name = NULL;
+  gchar *class_instance_name = NULL;
+  gboolean changed;
+
+  bamf_xutils_parse_class_hints (value, length, &class_instance_name, &class_name);
+
+  changed = (g_strcmp0 (class_name, self->priv->class_name) != 0 ||
+             g_strcmp0 (class_instance_name, self->priv->class_instance_name) != 0);
+
+  g_free (self->priv->class_name);
+  g_free (self->priv->class_instance_name);
+  self->priv->class_name = class_name;
+  self->priv->class_instance_name = class_instance_name;
+
+  return changed;
+}
+
+static gboolean
+update_role (BamfLegacyWindow *self, char *role)
+{
+  if (g_strcmp0 (role, self->priv->role) == 0)
+    {
+      g_free (role);
+      return FALSE;
+    }
+
+  g_free (self->priv->role);
+  self->priv->role = role;
+
+  return TRUE;
+}
+
+static GdkFilterReturn
+filter_property_notify (GdkXEvent *gdkxevent, GdkEvent *event, gpointer data)
+{
+  BamfLegacyWindow *self;
+  XEvent *xevent = gdkxevent;
+  BamfXutilsHintQuery query;
+  const char *atom_name;
+
+  if (xevent->type != PropertyNotify)
+    return GDK_FILTER_CONTINUE;
+
+  self = g_hash_table_lookup (tracked_windows, GUINT_TO_POINTER (xevent->xproperty.window));
+
+  if (!self)
+    return GDK_FILTER_CONTINUE;
+
+  /* If the atom has never been interned, we've nothing cached for it */
+  atom_name = bamf_xutils_get_atom_name (xevent->xproperty.atom);
+
+  if (!atom_name)
+    return GDK_FILTER_CONTINUE;
+
+  if (g_strcmp0 (atom_name, WM_CLASS) == 0 || g_strcmp0 (atom_name, WM_WINDOW_ROLE) == 0)
+    {
+      query.xid = xevent->xproperty.window;
+      query.atom_name = atom_name;
+      bamf_xutils_get_string_window_hints (&query, 1);
+
+      if (g_strcmp0 (atom_name, WM_CLASS) == 0)
+        {
+          if (update_class_hints (self, query.value, query.length))
+            g_signal_emit (self, legacy_window_signals[CLASS_CHANGED], 0);
+
+          g_free (query.value);
+        }
+      else if (update_role (self, bamf_xutils_hint_query_steal_string (&query)))
+        {
+          g_signal_emit (self, legacy_window_signals[ROLE_CHANGED], 0);
+        }
+    }
+  else if (xevent->xproperty.state == PropertyDelete)
+    {
+      g_hash_table_insert (self->priv->hints, g_strdup (atom_name), NULL);
+    }
+  else
+    {
+      /* The new value is read only when someone needs it */
+      g_hash_table_remove (self->priv->hints, atom_name);
+    }
+
+  return GDK_FILTER_CONTINUE;
+}
+
+/* Wnck already selects the property changes of the windows it manages on the
+ * same connection, but we ask for them anyway not to depend on it. The event
+ * mask is the one wnck uses, so that setting it without reading the current
+ * one first (that would cost a round trip per window) won't override it. */
+static void
+track_properties (BamfLegacyWindow *self)
+{
+  GdkDisplay *display = gdk_display_get_default ();
+  guint32 xid = bamf_legacy_window_get_xid (self);
+
+  if (!GDK_IS_X11_DISPLAY (display) || xid == 0)
+    return;
+
+  if (!tracked_windows)
+    {
+      tracked_windows = g_hash_table_new (g_direct_hash, g_direct_equal);
+      gdk_window_add_filter (NULL, filter_property_notify, NULL);
+    }
+
+  gdk_error_trap_push ();
+  XSelectInput (GDK_DISPLAY_XDISPLAY (display), xid, PropertyChangeMask | StructureNotifyMask);
+  gdk_error_trap_pop_ignored ();
+
+  g_hash_table_insert (tracked_windows, GUINT_TO_POINTER (xid), self);
+  self->priv->tracking_properties = TRUE;
+}
+
+static void
+untrack_properties (BamfLegacyWindow *self)
+{
+  gpointer xid;
+
+  if (!self->priv->tracking_properties)
+    return;
+
+  xid = GUINT_TO_POINTER (bamf_legacy_window_get_xid (self));
+
+  if (g_hash_table_lookup (tracked_windows, xid) == self)
+    g_hash_table_remove (tracked_windows, xid);
+
+  self->priv->tracking_properties = FALSE;
+}
+
+#define N_LOADED_PROPERTIES (G_N_ELEMENTS (prefetched_hints) + 2)
+
+/* All the hints we always need are read at once for all the windows,
+ * properties must be tracked already, so that no change can be missed */
+static void
+load_properties (BamfLegacyWindow **windows, guint n_windows)
+{
+  BamfXutilsHintQuery *queries, *window_queries;
+  BamfLegacyWindow *self;
+  guint32 xid;
+  guint i, j;
+
+  queries = g_new (BamfXutilsHintQuery, n_windows * N_LOADED_PROPERTIES);
+
+  for (i = 0; i < n_windows; ++i)
+    {
+      xid = bamf_legacy_window_get_xid (windows[i]);
+      window_queries = queries + i * N_LOADED_PROPERTIES;
+
+      window_queries[0].xid = xid;
+      window_queries[0].atom_name = WM_CLASS;
+      window_queries[1].xid = xid;
+      window_queries[1].atom_name = WM_WINDOW_ROLE;
+
+      for (j = 0; j < G_N_ELEMENTS (prefetched_hints); ++j)
+        {
+          window_queries[j + 2].xid = xid;
+          window_queries[j + 2].atom_name = prefetched_hints[j];
+        }
+    }
+
+  bamf_xutils_get_string_window_hints (queries, n_windows * N_LOADED_PROPERTIES);
+
+  for (i = 0; i < n_windows; ++i)
+    {
+      self = windows[i];
+      window_queries = queries + i * N_LOADED_PROPERTIES;
+
+      update_class_hints (self, window_queries[0].value, window_queries[0].length);
+      update_role (self, bamf_xutils_hint_query_steal_string (&window_queries[1]));
+      g_free (window_queries[0].value);
+
+      for (j = 0; j < G_N_ELEMENTS (prefetched_hints); ++j)
+        {
+          if (self->priv->tracking_properties)
+            g_hash_table_insert (self->priv->hints, g_strdup (prefetched_hints[j]),
+                                 bamf_xutils_hint_query_steal_string (&window_queries[j + 2]));
+          else
+            g_free (window_queries[j + 2].value);
+        }
+    }
+
+  g_free (queries);
+}
+
 static void
 handle_window_closed (WnckScreen *screen,
                       WnckWindow *window,
@@ -661,6 +853,7 @@ static void
 bamf_legacy_window_dispose (GObject *object)
 {
   BamfLegacyWindow *self;
+  WnckScreen *wnck_screen;
   guint i;
 
   self = BAMF_LEGACY_WINDOW (object);
@@ -671,13 +864,27 @@ bamf_legacy_window_dispose (GObject *object)
       g_clear_object (&self->priv->mini_icon);
     }
 
-  g_clear_pointer (&self->priv->exec_string, g_free);
   g_clear_pointer (&self->priv->working_dir, g_free);
+  g_clear_pointer (&self->priv->class_name, g_free);
+  g_clear_pointer (&self->priv->class_instance_name, g_free);
+  g_clear_pointer (&self->priv->role, g_free);
+  g_hash_table_remove_all (self->priv->hints);
 
-  g_signal_handlers_disconnect_by_data (wnck_screen_get_default (), self);
+  untrack_properties (self);
+
+  if (self->priv->process_pid)
+    {
+      bamf_process_info_release (self->priv->process_pid);
+      self->priv->process_pid = 0;
+    }
 
   if (self->priv->legacy_window)
     {
+      wnck_screen = bamf_legacy_screen_get_wnck_screen ();
+
+      if (wnck_screen)
+        g_signal_handlers_disconnect_by_data (wnck_screen, self);
+
       g_object_set_data (G_OBJECT (self->priv->legacy_window), WNCK_WINDOW_BAMF_DATA, NULL);
       g_signal_handlers_disconnect_by_data (self->priv->legacy_window, self);
 
@@ -701,13 +908,22 @@ bamf_legacy_window_dispose (GObject *object)
   G_OBJECT_CLASS (bamf_legacy_window_parent_class)->dispose (object);
 }
 
+static void
+bamf_legacy_window_finalize (GObject *object)
+{
+  BamfLegacyWindow *self = BAMF_LEGACY_WINDOW (object);
+
+  g_hash_table_destroy (self->priv->hints);
+
+  G_OBJECT_CLASS (bamf_legacy_window_parent_class)->finalize (object);
+}
+
 static void
 bamf_legacy_window_init (BamfLegacyWindow * self)
 {
   self->priv = BAMF_LEGACY_WINDOW_GET_PRIVATE (self);
-
-  g_signal_connect (wnck_screen_get_default (), "window-closed",
-                    (GCallback) handle_window_closed, self);
+  self->priv->stacking_position = -1;
+  self->priv->hints = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 }
 
 static void
@@ -716,6 +932,7 @@ bamf_legacy_window_class_init (BamfLegacyWindowClass * klass)
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   object_class->dispose = bamf_legacy_window_dispose;
+  object_class->finalize = bamf_legacy_window_finalize;
 
   g_type_class_add_private (klass, sizeof (BamfLegacyWindowPrivate));
 
@@ -762,10 +979,13 @@ bamf_legacy_window_class_init (BamfLegacyWindowClass * klass)
                   NULL, NULL, NULL, G_TYPE_NONE, 0);
 }
 
-BamfLegacyWindow *
-bamf_legacy_window_new (WnckWindow *legacy_window)
+static BamfLegacyWindow *
+legacy_window_new_unloaded (WnckWindow *legacy_window)
 {
   BamfLegacyWindow *self;
+  WnckScreen *wnck_screen;
+  guint pid;
+
   self = (BamfLegacyWindow *) g_object_new (BAMF_TYPE_LEGACY_WINDOW, NULL);
 
   self->priv->legacy_window = legacy_window;
@@ -775,17 +995,23 @@ bamf_legacy_window_new (WnckWindow *legacy_window)
 
   g_object_set_data (G_OBJECT (legacy_window), WNCK_WINDOW_BAMF_DATA, self);
 
-  g_signal_connect (G_OBJECT (legacy_window), "name-changed",
-                    G_CALLBACK (handle_window_signal),
-                    GUINT_TO_POINTER (NAME_CHANGED));
+  wnck_screen = bamf_legacy_screen_get_wnck_screen ();
 
-  g_signal_connect (G_OBJECT (legacy_window), "role-changed",
-                    G_CALLBACK (handle_window_signal),
-                    GUINT_TO_POINTER (ROLE_CHANGED));
+  if (wnck_screen)
+    g_signal_connect (wnck_screen, "window-closed", (GCallback) handle_window_closed, self);
 
-  g_signal_connect (G_OBJECT (legacy_window), "class-changed",
+  /* Keep the process info around for the whole window life */
+  pid = bamf_legacy_window_get_pid (self);
+
+  if (bamf_process_info_hold (pid))
+    self->priv->process_pid = pid;
+
+  /* Role and class changes are notified by the X property events */
+  track_properties (self);
+
+  g_signal_connect (G_OBJECT (legacy_window), "name-changed",
                     G_CALLBACK (handle_window_signal),
-                    GUINT_TO_POINTER (CLASS_CHANGED));
+                    GUINT_TO_POINTER (NAME_CHANGED));
 
   g_signal_connect (G_OBJECT (legacy_window), "geometry-changed",
                     G_CALLBACK (handle_window_signal),
@@ -796,3 +1022,42 @@ bamf_legacy_window_new (WnckWindow *legacy_window)
 
   return self;
 }
+
+BamfLegacyWindow *
+bamf_legacy_window_new (WnckWindow *legacy_window)
+{
+  BamfLegacyWindow *self;
+
+  self = legacy_window_new_unloaded (legacy_window);
+
+  if (WNCK_IS_WINDOW (legacy_window))
+    load_properties (&self, 1);
+
+  return self;
+}
+
+GList *
+bamf_legacy_window_new_batch (GList *legacy_windows)
+{
+  GPtrArray *windows;
+  GList *l, *result = NULL;
+  guint i;
+
+  windows = g_ptr_array_new ();
+
+  for (l = legacy_windows; l; l = l->next)
+    {
+      if (WNCK_IS_WINDOW (l->data))
+        g_ptr_array_add (windows, legacy_window_new_unloaded (l->data));
+    }
+
+  if (windows->len > 0)
+    load_properties ((BamfLegacyWindow **) windows->pdata, windows->len);
+
+  for (i = windows->len; i > 0; --i)
+    result = g_list_prepend (result, g_ptr_array_index (windows, i - 1));
+
+  g_ptr_array_free (windows, TRUE);
+
+  return result;
+}
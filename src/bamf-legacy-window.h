@@ -172,6 +172,10 @@ void               bamf_legacy_window_set_hint             (BamfLegacyWindow *se
 
 gint               bamf_legacy_window_get_stacking_position (BamfLegacyWindow *self);
 
+/* The stacking position is only meant to be updated by the BamfLegacyScreen */
+void               bamf_legacy_window_set_stacking_position (BamfLegacyWindow *self,
+                                                             gint position);
+
 GtkWidget        * bamf_legacy_window_get_action_menu      (BamfLegacyWindow *self);
 
 void               bamf_legacy_window_show_action_menu     (BamfLegacyWindow *self,
@@ -182,5 +186,8 @@ void               bamf_legacy_window_reopen               (BamfLegacyWindow *se
 
 BamfLegacyWindow * bamf_legacy_window_new                  (WnckWindow *legacy_window);
 
+/* Creates the windows reading all their properties with one round trip */
+GList            * bamf_legacy_window_new_batch            (GList *legacy_windows);
+
 #endif
 
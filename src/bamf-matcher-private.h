@@ -28,26 +28,51 @@
 
 struct _BamfMatcherPrivate
 {
-  GArray          * bad_prefixes;
-  GArray          * good_prefixes;
+  GRegex          * bad_prefixes;
+  GRegex          * good_prefixes;
+  GRegex          * bad_suffixes;
   GHashTable      * desktop_id_table;
   GHashTable      * desktop_file_table;
   GHashTable      * desktop_class_table;
+  GHashTable      * class_desktop_files_table;
+  GHashTable      * desktop_file_refs_table;
   GHashTable      * registered_pids;
   GHashTable      * opened_closed_paths_table;
-  GList           * known_pids;
+  GHashTable      * views_by_path;
+  GHashTable      * windows_by_xid;
+  GHashTable      * applications_by_desktop_file;
+  GHashTable      * pending_rematch_files;
+  GHashTable      * windows_by_pid;
+  GHashTable      * pid_parent_trees;
+  GHashTable      * pid_children;
+  GHashTable      * possible_apps_cache;
+  GHashTable      * monitor_window_stacks;
+  GHashTable      * view_changes_table;
+  GHashTable      * views_changed_subscribers;
+  GPtrArray       * window_stack;
+  GQueue          * view_events;
+  GQueue          * queued_monitor_events;
   GList           * views;
   GList           * monitors;
   GList           * favorites;
   GList           * no_display_desktop;
+  GList           * queued_windows;
+  GList           * desktop_windows;
   BamfView        * active_app;
   BamfView        * active_win;
   guint             dispatch_changes_id;
+  guint             pending_rematch_id;
+  guint             dispatch_view_changes_id;
+  guint64           generation;
+  guint64           dropped_generation;
 };
 
 BamfApplication * bamf_matcher_get_application_by_desktop_file (BamfMatcher *self, const char *desktop_file);
 BamfApplication * bamf_matcher_get_application_by_xid (BamfMatcher *self, guint xid);
 char * get_exec_overridden_desktop_file (const char *exec);
+void bamf_matcher_register_view_stealing_ref (BamfMatcher *self, BamfView *view);
+void bamf_matcher_load_monitored_desktop_file (BamfMatcher *self, const char *desktop_file);
+void bamf_matcher_free_desktop_file_tables (BamfMatcher *self);
 
 gboolean is_autostart_desktop_file (const gchar *desktop_file);
 
@@ -26,12 +26,17 @@
 #include "bamf-tab.h"
 #include "bamf-window.h"
 #include "bamf-legacy-screen.h"
+#include "bamf-desktop-cache.h"
+#include "bamf-desktop-index.h"
+#include "bamf-process-info.h"
+#include "bamf-stats.h"
 
 #include <strings.h>
 
-#define BAMF_INDEX_NAME "bamf-2.index"
 #define EXEC_DESKTOP_FILE_OVERRIDE "--desktop_file_hint"
 #define ENV_DESKTOP_FILE_OVERRIDE "BAMF_DESKTOP_FILE_HINT"
+#define REMATCH_BATCH_INTERVAL 300
+#define POSSIBLE_APPS_CACHE_SIZE 512
 
 G_DEFINE_TYPE (BamfMatcher, bamf_matcher, BAMF_DBUS_TYPE_MATCHER_SKELETON);
 #define BAMF_MATCHER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE(obj, \
@@ -51,6 +56,7 @@ typedef enum
 } ViewChangeType;
 
 static BamfMatcher *static_matcher;
+static gboolean lazy_loading = FALSE;
 static guint matcher_signals[LAST_SIGNAL] = { 0 };
 
 // Prefixes to be ignored in exec strings
@@ -81,6 +87,53 @@ const gchar * CLASS_BAD_VALUES[] =
   "com-sun-javaws-Main", "VCLSalFrame"
 };
 
+/* Merges a list of anchored patterns into a single alternation, so that
+ * checking a string against all of them requires only one regex match. */
+static GRegex *
+build_exec_prefixes_regex (const gchar **prefixes, gsize n_prefixes)
+{
+  GString *pattern;
+  GRegex *regex;
+  GError *error = NULL;
+  gsize i;
+
+  pattern = g_string_new ("^(?:");
+
+  for (i = 0; i < n_prefixes; ++i)
+    {
+      const gchar *prefix = prefixes[i];
+      gsize len = strlen (prefix);
+
+      if (prefix[0] == '^')
+        {
+          ++prefix;
+          --len;
+        }
+
+      if (len > 0 && prefix[len-1] == '$')
+        --len;
+
+      if (i > 0)
+        g_string_append_c (pattern, '|');
+
+      g_string_append_len (pattern, prefix, len);
+    }
+
+  g_string_append (pattern, ")$");
+
+  regex = g_regex_new (pattern->str, G_REGEX_OPTIMIZE, 0, &error);
+
+  if (error)
+    {
+      g_critical ("Impossible to compile the exec prefixes regex: %s", error->message);
+      g_error_free (error);
+    }
+
+  g_string_free (pattern, TRUE);
+
+  return regex;
+}
+
 static void
 on_view_active_changed (BamfView *view, gboolean active, BamfMatcher *matcher)
 {
@@ -143,52 +196,39 @@ static void bamf_matcher_unregister_view (BamfMatcher *self, BamfView *view);
 BamfApplication *
 bamf_matcher_get_application_by_desktop_file (BamfMatcher *self, const char *desktop_file)
 {
-  GList *l;
-  BamfView *view;
+  GList *apps;
 
   g_return_val_if_fail (BAMF_IS_MATCHER (self), NULL);
 
   if (!desktop_file || desktop_file[0] == '\0')
     return NULL;
 
-  for (l = self->priv->views; l; l = l->next)
-    {
-      view = l->data;
-
-      if (!BAMF_IS_APPLICATION (view))
-        continue;
-
-      BamfApplication *app = BAMF_APPLICATION (view);
-      const gchar *app_desktop;
-      app_desktop = bamf_application_get_desktop_file (app);
+  /* The most recently registered application is always the first one */
+  apps = g_hash_table_lookup (self->priv->applications_by_desktop_file, desktop_file);
 
-      if (g_strcmp0 (desktop_file, app_desktop) == 0)
-        {
-          return app;
-        }
-    }
-
-  return NULL;
+  return apps ? BAMF_APPLICATION (apps->data) : NULL;
 }
 
 BamfApplication *
 bamf_matcher_get_application_by_xid (BamfMatcher *self, guint xid)
 {
   GList *l;
-  BamfView *view;
+  BamfView *window;
 
   g_return_val_if_fail (BAMF_IS_MATCHER (self), NULL);
 
-  for (l = self->priv->views; l; l = l->next)
-    {
-      view = l->data;
+  window = g_hash_table_lookup (self->priv->windows_by_xid, GUINT_TO_POINTER (xid));
 
-      if (!BAMF_IS_APPLICATION (view))
-        continue;
+  if (!window)
+    return NULL;
 
-      if (bamf_application_manages_xid (BAMF_APPLICATION (view), xid))
+  /* A window is owned by the application that has it as child, so we don't
+   * need to ask every application if it manages this xid */
+  for (l = bamf_view_get_parents (window); l; l = l->next)
+    {
+      if (BAMF_IS_APPLICATION (l->data) && bamf_view_get_path (l->data))
         {
-          return BAMF_APPLICATION (view);
+          return BAMF_APPLICATION (l->data);
         }
     }
 
@@ -199,25 +239,12 @@ bamf_matcher_get_application_by_xid (BamfMatcher *self, guint xid)
 BamfView *
 bamf_matcher_get_view_by_path (BamfMatcher *self, const char *view_path)
 {
-  GList *l;
-  BamfView *view;
-
   g_return_val_if_fail (BAMF_IS_MATCHER (self), NULL);
 
-  for (l = self->priv->views; l; l = l->next)
-    {
-      view = l->data;
-
-      if (!BAMF_IS_VIEW (view))
-        continue;
-
-      if (g_strcmp0 (bamf_view_get_path (view), view_path) == 0)
-        {
-          return view;
-        }
-    }
+  if (!view_path)
+    return NULL;
 
-  return NULL;
+  return g_hash_table_lookup (self->priv->views_by_path, view_path);
 }
 
 static gboolean
@@ -306,6 +333,380 @@ bamf_matcher_prepare_path_change (BamfMatcher *self, const gchar *desktop_file,
     }
 }
 
+typedef struct
+{
+  GVariant *old_value;
+  GVariant *value;
+} ViewPropertyChange;
+
+static void
+view_property_change_free (ViewPropertyChange *change)
+{
+  g_variant_unref (change->old_value);
+  g_variant_unref (change->value);
+  g_slice_free (ViewPropertyChange, change);
+}
+
+static gboolean
+emit_views_changed (gpointer user_data)
+{
+  BamfMatcher *self;
+  BamfMatcherPrivate *priv;
+  GHashTableIter iter, props_iter;
+  GVariantBuilder changes_builder;
+  GVariant *changes;
+  gpointer path, props, property, value;
+  gboolean changed = FALSE;
+
+  g_return_val_if_fail (BAMF_IS_MATCHER (user_data), FALSE);
+
+  self = BAMF_MATCHER (user_data);
+  priv = self->priv;
+  priv->dispatch_view_changes_id = 0;
+
+  g_variant_builder_init (&changes_builder, G_VARIANT_TYPE ("a(sa{sv})"));
+  g_hash_table_iter_init (&iter, priv->view_changes_table);
+
+  while (g_hash_table_iter_next (&iter, &path, &props))
+    {
+      GVariantBuilder props_builder;
+      gboolean view_changed = FALSE;
+
+      g_variant_builder_init (&props_builder, G_VARIANT_TYPE ("a{sv}"));
+      g_hash_table_iter_init (&props_iter, props);
+
+      while (g_hash_table_iter_next (&props_iter, &property, &value))
+        {
+          ViewPropertyChange *change = value;
+
+          /* Values that went back to the original state in the meanwhile
+           * are not a change for our clients */
+          if (g_variant_equal (change->old_value, change->value))
+            continue;
+
+          g_variant_builder_add (&props_builder, "{sv}", property, change->value);
+          view_changed = TRUE;
+        }
+
+      if (view_changed)
+        {
+          g_variant_builder_add (&changes_builder, "(sa{sv})", path, &props_builder);
+          changed = TRUE;
+        }
+
+      g_variant_builder_clear (&props_builder);
+    }
+
+  changes = g_variant_ref_sink (g_variant_builder_end (&changes_builder));
+  g_hash_table_remove_all (priv->view_changes_table);
+
+  if (changed)
+    bamf_dbus_matcher_emit_views_changed (BAMF_DBUS_MATCHER (self), changes);
+
+  g_variant_unref (changes);
+
+  return FALSE;
+}
+
+/* Property changes of all the views are merged per view and property, and
+ * delivered in a single ViewsChanged signal once the main loop is idle, so
+ * that the subscribed clients are woken up only once per iteration. */
+static void
+bamf_matcher_queue_view_change (BamfMatcher *self, BamfView *view, const gchar *property,
+                                GVariant *old_value, GVariant *value)
+{
+  BamfMatcherPrivate *priv = self->priv;
+  ViewPropertyChange *change;
+  GHashTable *props;
+  const gchar *path;
+
+  g_variant_ref_sink (old_value);
+  g_variant_ref_sink (value);
+  path = bamf_view_get_path (view);
+
+  if (!path)
+    {
+      g_variant_unref (old_value);
+      g_variant_unref (value);
+      return;
+    }
+
+  props = g_hash_table_lookup (priv->view_changes_table, path);
+
+  if (!props)
+    {
+      props = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                     (GDestroyNotify) view_property_change_free);
+      g_hash_table_insert (priv->view_changes_table, g_strdup (path), props);
+    }
+
+  change = g_hash_table_lookup (props, property);
+
+  if (change)
+    {
+      g_variant_unref (old_value);
+      g_variant_unref (change->value);
+      change->value = value;
+    }
+  else
+    {
+      change = g_slice_new (ViewPropertyChange);
+      change->old_value = old_value;
+      change->value = value;
+      g_hash_table_insert (props, (gpointer) property, change);
+    }
+
+  if (priv->dispatch_view_changes_id == 0)
+    {
+      /* Views emit their active changes on idle too, so we use a lower priority */
+      priv->dispatch_view_changes_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+                                                        emit_views_changed,
+                                                        self, NULL);
+    }
+}
+
+static inline gboolean
+bamf_matcher_has_views_changed_subscribers (BamfMatcher *self)
+{
+  return g_hash_table_size (self->priv->views_changed_subscribers) > 0;
+}
+
+#define VIEW_EVENTS_MAX_SIZE 4096
+
+typedef enum
+{
+  VIEW_EVENT_OPENED,
+  VIEW_EVENT_CLOSED,
+  VIEW_EVENT_PROPERTY_CHANGED,
+  VIEW_EVENT_CHILD_ADDED,
+  VIEW_EVENT_CHILD_REMOVED,
+} ViewEventType;
+
+typedef struct
+{
+  guint64        generation;
+  ViewEventType  type;
+  gchar        * path;
+  gchar        * detail;
+} ViewEvent;
+
+static void
+view_event_free (ViewEvent *event)
+{
+  g_free (event->path);
+  g_free (event->detail);
+  g_slice_free (ViewEvent, event);
+}
+
+/* Each mutation of the views graph is stamped with a new generation number,
+ * the latest ones are kept so that clients can catch up using GetChangesSince.
+ * The detail is the view type for opened and closed views, the property name
+ * or the child path for the other events. */
+static void
+bamf_matcher_log_view_event (BamfMatcher *self, BamfView *view,
+                             ViewEventType type, const gchar *detail)
+{
+  BamfMatcherPrivate *priv = self->priv;
+  ViewEvent *event;
+  const gchar *path;
+
+  path = bamf_view_get_path (view);
+
+  if (!path)
+    return;
+
+  event = g_slice_new (ViewEvent);
+  event->generation = ++priv->generation;
+  event->type = type;
+  event->path = g_strdup (path);
+  event->detail = g_strdup (detail);
+  g_queue_push_tail (priv->view_events, event);
+
+  while (g_queue_get_length (priv->view_events) > VIEW_EVENTS_MAX_SIZE)
+    {
+      event = g_queue_pop_head (priv->view_events);
+      priv->dropped_generation = event->generation;
+      view_event_free (event);
+    }
+}
+
+static void
+on_view_tracked_active_changed (BamfView *view, gboolean active, BamfMatcher *self)
+{
+  bamf_matcher_log_view_event (self, view, VIEW_EVENT_PROPERTY_CHANGED, "Active");
+
+  if (!bamf_matcher_has_views_changed_subscribers (self))
+    return;
+
+  bamf_matcher_queue_view_change (self, view, "Active",
+                                  g_variant_new_boolean (!active),
+                                  g_variant_new_boolean (active));
+}
+
+static void
+on_view_tracked_urgent_changed (BamfView *view, gboolean urgent, BamfMatcher *self)
+{
+  bamf_matcher_log_view_event (self, view, VIEW_EVENT_PROPERTY_CHANGED, "Urgent");
+
+  if (!bamf_matcher_has_views_changed_subscribers (self))
+    return;
+
+  bamf_matcher_queue_view_change (self, view, "Urgent",
+                                  g_variant_new_boolean (!urgent),
+                                  g_variant_new_boolean (urgent));
+}
+
+static void
+on_view_tracked_running_changed (BamfView *view, gboolean running, BamfMatcher *self)
+{
+  bamf_matcher_log_view_event (self, view, VIEW_EVENT_PROPERTY_CHANGED, "Running");
+
+  if (!bamf_matcher_has_views_changed_subscribers (self))
+    return;
+
+  bamf_matcher_queue_view_change (self, view, "Running",
+                                  g_variant_new_boolean (!running),
+                                  g_variant_new_boolean (running));
+}
+
+static void
+on_view_tracked_user_visible_changed (BamfView *view, gboolean user_visible, BamfMatcher *self)
+{
+  bamf_matcher_log_view_event (self, view, VIEW_EVENT_PROPERTY_CHANGED, "UserVisible");
+
+  if (!bamf_matcher_has_views_changed_subscribers (self))
+    return;
+
+  bamf_matcher_queue_view_change (self, view, "UserVisible",
+                                  g_variant_new_boolean (!user_visible),
+                                  g_variant_new_boolean (user_visible));
+}
+
+static void
+on_view_tracked_name_changed (BamfView *view, const gchar *old_name, const gchar *new_name, BamfMatcher *self)
+{
+  bamf_matcher_log_view_event (self, view, VIEW_EVENT_PROPERTY_CHANGED, "Name");
+
+  if (!bamf_matcher_has_views_changed_subscribers (self))
+    return;
+
+  bamf_matcher_queue_view_change (self, view, "Name",
+                                  g_variant_new_string (old_name ? old_name : ""),
+                                  g_variant_new_string (new_name ? new_name : ""));
+}
+
+static void
+on_view_tracked_icon_changed (BamfView *view, GParamSpec *pspec, BamfMatcher *self)
+{
+  bamf_matcher_log_view_event (self, view, VIEW_EVENT_PROPERTY_CHANGED, "Icon");
+}
+
+static void
+on_view_tracked_starting_changed (BamfView *view, GParamSpec *pspec, BamfMatcher *self)
+{
+  bamf_matcher_log_view_event (self, view, VIEW_EVENT_PROPERTY_CHANGED, "Starting");
+}
+
+static void
+on_view_tracked_child_added (BamfView *view, const gchar *child_path, BamfMatcher *self)
+{
+  bamf_matcher_log_view_event (self, view, VIEW_EVENT_CHILD_ADDED, child_path);
+}
+
+static void
+on_view_tracked_child_removed (BamfView *view, const gchar *child_path, BamfMatcher *self)
+{
+  bamf_matcher_log_view_event (self, view, VIEW_EVENT_CHILD_REMOVED, child_path);
+}
+
+static void
+on_application_tracked_mimes_changed (BamfApplication *app, const gchar **mimes, BamfMatcher *self)
+{
+  bamf_matcher_log_view_event (self, BAMF_VIEW (app), VIEW_EVENT_PROPERTY_CHANGED,
+                               "SupportedMimeTypes");
+}
+
+static void
+on_window_tracked_maximized_changed (BamfWindow *window, gint old, gint new, BamfMatcher *self)
+{
+  bamf_matcher_log_view_event (self, BAMF_VIEW (window), VIEW_EVENT_PROPERTY_CHANGED,
+                               "Maximized");
+}
+
+/* Tab properties are serialized using their GObject names */
+static void
+on_tab_tracked_property_changed (BamfTab *tab, GParamSpec *pspec, BamfMatcher *self)
+{
+  bamf_matcher_log_view_event (self, BAMF_VIEW (tab), VIEW_EVENT_PROPERTY_CHANGED,
+                               g_param_spec_get_name (pspec));
+}
+
+static void
+bamf_matcher_clear_view_changes (BamfMatcher *self)
+{
+  BamfMatcherPrivate *priv = self->priv;
+
+  g_hash_table_remove_all (priv->view_changes_table);
+
+  if (priv->dispatch_view_changes_id != 0)
+    {
+      g_source_remove (priv->dispatch_view_changes_id);
+      priv->dispatch_view_changes_id = 0;
+    }
+}
+
+static void
+unwatch_views_changed_subscriber (gpointer watch_id)
+{
+  if (GPOINTER_TO_UINT (watch_id) != 0)
+    g_bus_unwatch_name (GPOINTER_TO_UINT (watch_id));
+}
+
+static void
+on_views_changed_subscriber_vanished (GDBusConnection *connection, const gchar *name, gpointer data)
+{
+  bamf_matcher_unsubscribe_views_changed (BAMF_MATCHER (data), name);
+}
+
+void
+bamf_matcher_subscribe_views_changed (BamfMatcher *self, const gchar *subscriber)
+{
+  GDBusConnection *connection;
+  guint watch_id = 0;
+
+  g_return_if_fail (BAMF_IS_MATCHER (self));
+  g_return_if_fail (subscriber);
+
+  if (g_hash_table_contains (self->priv->views_changed_subscribers, subscriber))
+    return;
+
+  connection = g_dbus_interface_skeleton_get_connection (G_DBUS_INTERFACE_SKELETON (self));
+
+  /* Clients that leave the bus without unsubscribing are removed as well */
+  if (connection && g_dbus_is_unique_name (subscriber))
+    {
+      watch_id = g_bus_watch_name_on_connection (connection, subscriber,
+                                                 G_BUS_NAME_WATCHER_FLAGS_NONE,
+                                                 NULL, on_views_changed_subscriber_vanished,
+                                                 self, NULL);
+    }
+
+  g_hash_table_insert (self->priv->views_changed_subscribers, g_strdup (subscriber),
+                       GUINT_TO_POINTER (watch_id));
+}
+
+void
+bamf_matcher_unsubscribe_views_changed (BamfMatcher *self, const gchar *subscriber)
+{
+  g_return_if_fail (BAMF_IS_MATCHER (self));
+  g_return_if_fail (subscriber);
+
+  g_hash_table_remove (self->priv->views_changed_subscribers, subscriber);
+
+  if (!bamf_matcher_has_views_changed_subscribers (self))
+    bamf_matcher_clear_view_changes (self);
+}
+
 static gboolean
 bamf_matcher_is_view_registered (BamfMatcher *self, BamfView *view)
 {
@@ -317,7 +718,78 @@ bamf_matcher_is_view_registered (BamfMatcher *self, BamfView *view)
   return (bamf_view_get_path (view) != NULL);
 }
 
+#define INDEXED_DESKTOP_FILE_KEY "bamf-matcher-indexed-desktop-file"
+
+static void
+bamf_matcher_index_application (BamfMatcher *self, BamfApplication *app)
+{
+  const char *desktop_file;
+  GList *apps;
+
+  desktop_file = bamf_application_get_desktop_file (app);
+
+  if (!desktop_file)
+    return;
+
+  apps = g_hash_table_lookup (self->priv->applications_by_desktop_file, desktop_file);
+  apps = g_list_prepend (apps, app);
+  g_hash_table_insert (self->priv->applications_by_desktop_file, g_strdup (desktop_file), apps);
+
+  /* We save the indexed value, since the application could change it later */
+  g_object_set_data_full (G_OBJECT (app), INDEXED_DESKTOP_FILE_KEY,
+                          g_strdup (desktop_file), g_free);
+}
+
+static void
+bamf_matcher_unindex_application (BamfMatcher *self, BamfApplication *app)
+{
+  const char *desktop_file;
+  GList *apps;
+
+  desktop_file = g_object_get_data (G_OBJECT (app), INDEXED_DESKTOP_FILE_KEY);
+
+  if (!desktop_file)
+    return;
+
+  apps = g_hash_table_lookup (self->priv->applications_by_desktop_file, desktop_file);
+  apps = g_list_remove (apps, app);
+
+  if (apps)
+    g_hash_table_insert (self->priv->applications_by_desktop_file, g_strdup (desktop_file), apps);
+  else
+    g_hash_table_remove (self->priv->applications_by_desktop_file, desktop_file);
+
+  g_object_set_data (G_OBJECT (app), INDEXED_DESKTOP_FILE_KEY, NULL);
+}
+
 static void
+on_application_desktop_file_updated (BamfApplication *app, const char *desktop_file, BamfMatcher *self)
+{
+  g_return_if_fail (BAMF_IS_MATCHER (self));
+  g_return_if_fail (BAMF_IS_APPLICATION (app));
+
+  bamf_matcher_unindex_application (self, app);
+  bamf_matcher_index_application (self, app);
+  bamf_matcher_log_view_event (self, BAMF_VIEW (app), VIEW_EVENT_PROPERTY_CHANGED,
+                               "DesktopFile");
+}
+
+static void
+invalidate_window_stacks (BamfMatcher *self)
+{
+  g_clear_pointer (&self->priv->window_stack, g_ptr_array_unref);
+  g_hash_table_remove_all (self->priv->monitor_window_stacks);
+}
+
+static void
+on_window_monitor_changed (BamfWindow *window, gint old, gint new, BamfMatcher *self)
+{
+  invalidate_window_stacks (self);
+  bamf_matcher_log_view_event (self, BAMF_VIEW (window), VIEW_EVENT_PROPERTY_CHANGED,
+                               "Monitor");
+}
+
+void
 bamf_matcher_register_view_stealing_ref (BamfMatcher *self, BamfView *view)
 {
   const char *path, *type;
@@ -332,16 +804,65 @@ bamf_matcher_register_view_stealing_ref (BamfMatcher *self, BamfView *view)
                             (GCallback) bamf_matcher_unregister_view, self);
   g_signal_connect (G_OBJECT (view), "active-changed",
                     (GCallback) on_view_active_changed, self);
+  g_signal_connect (G_OBJECT (view), "active-changed",
+                    (GCallback) on_view_tracked_active_changed, self);
+  g_signal_connect (G_OBJECT (view), "urgent-changed",
+                    (GCallback) on_view_tracked_urgent_changed, self);
+  g_signal_connect (G_OBJECT (view), "running-changed",
+                    (GCallback) on_view_tracked_running_changed, self);
+  g_signal_connect (G_OBJECT (view), "user-visible-changed",
+                    (GCallback) on_view_tracked_user_visible_changed, self);
+  g_signal_connect (G_OBJECT (view), "name-changed",
+                    (GCallback) on_view_tracked_name_changed, self);
+  g_signal_connect (G_OBJECT (view), "notify::icon",
+                    (GCallback) on_view_tracked_icon_changed, self);
+  g_signal_connect (G_OBJECT (view), "notify::starting",
+                    (GCallback) on_view_tracked_starting_changed, self);
+  g_signal_connect (G_OBJECT (view), "child-added",
+                    (GCallback) on_view_tracked_child_added, self);
+  g_signal_connect (G_OBJECT (view), "child-removed",
+                    (GCallback) on_view_tracked_child_removed, self);
 
   if (BAMF_IS_APPLICATION (view))
     {
       bamf_matcher_prepare_path_change (self,
         bamf_application_get_desktop_file (BAMF_APPLICATION (view)), VIEW_ADDED);
+
+      bamf_matcher_index_application (self, BAMF_APPLICATION (view));
+      g_signal_connect (G_OBJECT (view), "desktop-file-updated",
+                        (GCallback) on_application_desktop_file_updated, self);
+      g_signal_connect (G_OBJECT (view), "supported-mimes-changed",
+                        (GCallback) on_application_tracked_mimes_changed, self);
     }
+  else if (BAMF_IS_WINDOW (view))
+    {
+      guint32 xid = bamf_window_get_xid (BAMF_WINDOW (view));
+      g_hash_table_insert (self->priv->windows_by_xid, GUINT_TO_POINTER (xid), view);
+      g_signal_connect (G_OBJECT (view), "monitor-changed",
+                        (GCallback) on_window_monitor_changed, self);
+      g_signal_connect (G_OBJECT (view), "maximized-changed",
+                        (GCallback) on_window_tracked_maximized_changed, self);
+      invalidate_window_stacks (self);
+    }
+  else if (BAMF_IS_TAB (view))
+    {
+      g_signal_connect (G_OBJECT (view), "notify::location",
+                        (GCallback) on_tab_tracked_property_changed, self);
+      g_signal_connect (G_OBJECT (view), "notify::xid",
+                        (GCallback) on_tab_tracked_property_changed, self);
+      g_signal_connect (G_OBJECT (view), "notify::desktop-id",
+                        (GCallback) on_tab_tracked_property_changed, self);
+      g_signal_connect (G_OBJECT (view), "notify::is-foreground-tab",
+                        (GCallback) on_tab_tracked_property_changed, self);
+    }
+
+  if (path)
+    g_hash_table_insert (self->priv->views_by_path, g_strdup (path), view);
 
   // This steals the reference of the view
   self->priv->views = g_list_prepend (self->priv->views, view);
 
+  bamf_matcher_log_view_event (self, view, VIEW_EVENT_OPENED, type);
   g_signal_emit_by_name (self, "view-opened", path, type);
 
   // trigger manually since this is already active
@@ -358,10 +879,15 @@ bamf_matcher_unregister_view (BamfMatcher *self, BamfView *view)
   path = bamf_view_get_path (view);
   type = bamf_view_get_view_type (view);
 
+  bamf_matcher_log_view_event (self, view, VIEW_EVENT_CLOSED, type);
   g_signal_emit_by_name (self, "view-closed", path, type);
 
   g_signal_handlers_disconnect_by_data (G_OBJECT (view), self);
 
+  /* Clients already get the ViewClosed signal */
+  if (path)
+    g_hash_table_remove (self->priv->view_changes_table, path);
+
   if (BAMF_IS_APPLICATION (view))
     {
       bamf_matcher_prepare_path_change (self,
@@ -378,6 +904,25 @@ bamf_matcher_unregister_view (BamfMatcher *self, BamfView *view)
   GList *listed_view = g_list_find (self->priv->views, view);
   if (listed_view)
     {
+      /* Views sharing the same key might have replaced this one, so we only
+       * remove the indexes that are still pointing to it */
+      if (path && g_hash_table_lookup (self->priv->views_by_path, path) == view)
+        g_hash_table_remove (self->priv->views_by_path, path);
+
+      if (BAMF_IS_APPLICATION (view))
+        {
+          bamf_matcher_unindex_application (self, BAMF_APPLICATION (view));
+        }
+      else if (BAMF_IS_WINDOW (view))
+        {
+          gpointer xid = GUINT_TO_POINTER (bamf_window_get_xid (BAMF_WINDOW (view)));
+
+          if (g_hash_table_lookup (self->priv->windows_by_xid, xid) == view)
+            g_hash_table_remove (self->priv->windows_by_xid, xid);
+
+          invalidate_window_stacks (self);
+        }
+
       self->priv->views = g_list_delete_link (self->priv->views, listed_view);
       g_object_unref (view);
     }
@@ -386,25 +931,12 @@ bamf_matcher_unregister_view (BamfMatcher *self, BamfView *view)
 gboolean
 bamf_matcher_is_valid_process_prefix (BamfMatcher *self, const char *process_name)
 {
-  GRegex *regex;
-  gint i;
-
   g_return_val_if_fail (BAMF_IS_MATCHER (self), TRUE);
 
   if (!process_name || *process_name == '\0')
     return FALSE;
 
-  for (i = 0; i < self->priv->bad_prefixes->len; ++i)
-    {
-      regex = g_array_index (self->priv->bad_prefixes, GRegex *, i);
-
-      if (g_regex_match (regex, process_name, 0, NULL))
-        {
-          return FALSE;
-        }
-    }
-
-  return TRUE;
+  return !g_regex_match (self->priv->bad_prefixes, process_name, 0, NULL);
 }
 
 /* Attempts to return the binary name for a particular execution string */
@@ -413,11 +945,10 @@ bamf_matcher_get_trimmed_exec (BamfMatcher * self, const char * exec_string)
 {
   gchar *result = NULL, *part, *tmp;
   gchar **parts;
-  gint i, j, parts_size;
+  gint i, parts_size;
   gboolean bad_prefix;
   gboolean good_prefix = FALSE;
   gboolean double_parsed = FALSE;
-  GRegex *regex;
 
   if (!exec_string || exec_string[0] == '\0')
     return NULL;
@@ -455,15 +986,10 @@ bamf_matcher_get_trimmed_exec (BamfMatcher * self, const char * exec_string)
             }
           else
             {
-              for (j = 0; j < self->priv->good_prefixes->len; j++)
+              if (g_regex_match (self->priv->good_prefixes, part, 0, NULL))
                 {
-                  regex = g_array_index (self->priv->good_prefixes, GRegex *, j);
-                  if (g_regex_match (regex, part, 0, NULL))
-                    {
-                      good_prefix = TRUE;
-                      result = g_ascii_strdown (part, -1);
-                      break;
-                    }
+                  good_prefix = TRUE;
+                  result = g_ascii_strdown (part, -1);
                 }
 
               if (good_prefix)
@@ -513,11 +1039,9 @@ bamf_matcher_get_trimmed_exec (BamfMatcher * self, const char * exec_string)
     {
       tmp = result;
 
-      regex = g_regex_new (EXEC_BAD_SUFIXES, 0, 0, NULL);
-      result = g_regex_replace_literal (regex, result, -1, 0, "", 0, NULL);
+      result = g_regex_replace_literal (self->priv->bad_suffixes, result, -1, 0, "", 0, NULL);
 
       g_free (tmp);
-      g_regex_unref (regex);
     }
 
   g_strfreev (parts);
@@ -559,83 +1083,173 @@ get_exec_overridden_desktop_file (const char *exec_string)
 static char *
 get_env_overridden_desktop_file (guint pid)
 {
-  gchar *environ_file;
-  gchar *environ;
-  gchar *result;
-  gsize file_len;
-  gint i;
+  BamfProcessInfo *info;
+  const gchar *file_path;
 
   if (pid < 2)
     return NULL;
 
-  environ = NULL;
-  result = NULL;
-  environ_file = g_strdup_printf ("/proc/%u/environ", pid);
+  info = bamf_process_info_get (pid);
 
-  if (g_file_get_contents (environ_file, &environ, &file_len, NULL))
-    {
-      for (i = 0; i < file_len && environ && environ[i] != '\0'; i += strlen (environ + i) + 1)
-        {
-          const gchar *var = environ + i;
+  if (!info)
+    return NULL;
 
-          if (g_str_has_prefix (var, ENV_DESKTOP_FILE_OVERRIDE"="))
-            {
-              const gchar *file_path;
-              file_path = var + sizeof (ENV_DESKTOP_FILE_OVERRIDE);
+  file_path = bamf_process_info_get_environ_value (info, ENV_DESKTOP_FILE_OVERRIDE);
 
-              if (g_str_has_suffix (file_path, ".desktop") &&
-                  g_file_test (file_path, G_FILE_TEST_EXISTS|G_FILE_TEST_IS_REGULAR))
-                {
-                  result = g_strdup (file_path);
-                  break;
-                }
-            }
-        }
+  if (file_path && g_str_has_suffix (file_path, ".desktop") &&
+      g_file_test (file_path, G_FILE_TEST_EXISTS|G_FILE_TEST_IS_REGULAR))
+    {
+      return g_strdup (file_path);
     }
 
-  g_free (environ);
-  g_free (environ_file);
+  return NULL;
+}
 
-  return result;
+static GList *
+build_pid_parent_tree (BamfMatcher *self, guint pid)
+{
+  BamfProcessInfo *info;
+  GList *tree;
+
+  tree = g_list_append (NULL, GUINT_TO_POINTER (pid));
+
+  info = bamf_process_info_get (pid);
+  info = info ? bamf_process_info_get_parent (info) : NULL;
+
+  while (info && bamf_process_info_get_pid (info) > 1)
+    {
+      pid = bamf_process_info_get_pid (info);
+
+      /* ensure we dont match onto a terminal by mistake */
+      if (g_hash_table_contains (self->priv->windows_by_pid, GUINT_TO_POINTER (pid)))
+        return tree;
+
+      tree = g_list_prepend (tree, GUINT_TO_POINTER (pid));
+      info = bamf_process_info_get_parent (info);
+    }
+
+  return g_list_reverse (tree);
 }
 
 static GList *
 pid_parent_tree (BamfMatcher *self, guint pid)
 {
-  BamfMatcherPrivate *priv;
-  GList *tree, *l;
-  guint known_pid;
+  GList *tree;
 
   g_return_val_if_fail (BAMF_IS_MATCHER (self), NULL);
 
-  priv = self->priv;
-  tree = g_list_append (NULL, GUINT_TO_POINTER (pid));
+  /* Trees only depend on the pids having windows, so they're valid until one
+   * of them is added or removed */
+  tree = g_hash_table_lookup (self->priv->pid_parent_trees, GUINT_TO_POINTER (pid));
 
-  glibtop_proc_uid buf;
-  glibtop_get_proc_uid (&buf, pid);
+  if (!tree)
+    {
+      tree = build_pid_parent_tree (self, pid);
+      g_hash_table_insert (self->priv->pid_parent_trees, GUINT_TO_POINTER (pid), tree);
+    }
+
+  return g_list_copy (tree);
+}
+
+static void
+free_lists_table (GHashTable *table)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, table);
+
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    g_list_free (value);
+
+  g_hash_table_destroy (table);
+}
 
-  pid = buf.ppid;
+static void
+invalidate_pid_parent_trees (BamfMatcher *self)
+{
+  g_hash_table_remove_all (self->priv->pid_parent_trees);
+  g_clear_pointer (&self->priv->pid_children, free_lists_table);
+}
 
-  while (pid > 1)
+/* Maps each pid to the window pids that have it in their parent tree, so that
+ * the windows of a process subtree can be found without walking all of them */
+static GHashTable *
+get_pid_children_table (BamfMatcher *self)
+{
+  BamfMatcherPrivate *priv = self->priv;
+  GHashTableIter iter;
+  gpointer key;
+  GList *tree, *l;
+
+  if (priv->pid_children)
+    return priv->pid_children;
+
+  priv->pid_children = g_hash_table_new (g_direct_hash, g_direct_equal);
+  g_hash_table_iter_init (&iter, priv->windows_by_pid);
+
+  while (g_hash_table_iter_next (&iter, &key, NULL))
     {
-      for (l = priv->known_pids; l; l = l->next)
-        {
-          /* ensure we dont match onto a terminal by mistake */
-          known_pid = GPOINTER_TO_UINT (l->data);
+      tree = pid_parent_tree (self, GPOINTER_TO_UINT (key));
 
-          if (known_pid == pid)
-            return tree;
+      for (l = tree; l; l = l->next)
+        {
+          GList *children = g_hash_table_lookup (priv->pid_children, l->data);
+          children = g_list_prepend (children, key);
+          g_hash_table_insert (priv->pid_children, l->data, children);
         }
 
-      tree = g_list_prepend (tree, GUINT_TO_POINTER (pid));
+      g_list_free (tree);
+    }
 
-      glibtop_proc_uid buf;
-      glibtop_get_proc_uid (&buf, pid);
+  return priv->pid_children;
+}
 
-      pid = buf.ppid;
-    }
+static void
+add_pid_window (BamfMatcher *self, BamfLegacyWindow *window)
+{
+  gpointer key;
+  GList *windows;
+  guint pid;
 
-  return g_list_reverse (tree);
+  pid = bamf_legacy_window_get_pid (window);
+
+  if (pid < 2)
+    return;
+
+  key = GUINT_TO_POINTER (pid);
+  windows = g_hash_table_lookup (self->priv->windows_by_pid, key);
+
+  if (!windows)
+    invalidate_pid_parent_trees (self);
+
+  windows = g_list_prepend (windows, window);
+  g_hash_table_insert (self->priv->windows_by_pid, key, windows);
+}
+
+static void
+remove_pid_window (BamfMatcher *self, BamfLegacyWindow *window)
+{
+  gpointer key;
+  GList *windows;
+
+  key = GUINT_TO_POINTER (bamf_legacy_window_get_pid (window));
+  windows = g_hash_table_lookup (self->priv->windows_by_pid, key);
+
+  if (!g_list_find (windows, window))
+    return;
+
+  windows = g_list_remove (windows, window);
+
+  if (windows)
+    {
+      g_hash_table_insert (self->priv->windows_by_pid, key, windows);
+    }
+  else
+    {
+      g_hash_table_remove (self->priv->windows_by_pid, key);
+      invalidate_pid_parent_trees (self);
+    }
 }
 
 static gboolean
@@ -702,6 +1316,113 @@ get_last_no_display_desktop_in_list (BamfMatcher *self, GList *desktop_list)
   return last;
 }
 
+/* Back-reference of a .desktop file path inserted in the exec and id tables */
+typedef struct
+{
+  char *exec;
+  char *desktop_id;
+  char *path; /* the string instance shared by the tables lists */
+} DesktopFileRef;
+
+static void
+desktop_file_ref_free (DesktopFileRef *ref)
+{
+  g_free (ref->exec);
+  g_free (ref->desktop_id);
+  g_slice_free (DesktopFileRef, ref);
+}
+
+static void
+free_desktop_file_refs_table (GHashTable *desktop_file_refs_table)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, desktop_file_refs_table);
+
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      GSList *l;
+
+      /* The refs own the path strings shared by the exec and id tables lists */
+      for (l = value; l; l = l->next)
+        g_free (((DesktopFileRef *) l->data)->path);
+
+      g_slist_free_full (value, (GDestroyNotify) desktop_file_ref_free);
+    }
+
+  g_hash_table_destroy (desktop_file_refs_table);
+}
+
+static void
+remove_data_from_table_list (GHashTable *table, const char *key, const char *data)
+{
+  GList *list;
+
+  list = g_hash_table_lookup (table, key);
+
+  if (!list)
+    return;
+
+  list = g_list_remove (list, data);
+
+  if (list)
+    g_hash_table_insert (table, g_strdup (key), list);
+  else
+    g_hash_table_remove (table, key);
+}
+
+/* Removes a .desktop file from the exec and id tables, only touching the
+ * lists it has been inserted into */
+static void
+remove_desktop_file_from_tables (BamfMatcher *self, const char *desktop_file)
+{
+  BamfMatcherPrivate *priv = self->priv;
+  GSList *refs, *l;
+  gpointer key;
+
+  if (!g_hash_table_lookup_extended (priv->desktop_file_refs_table, desktop_file,
+                                     &key, (gpointer *) &refs))
+    return;
+
+  g_hash_table_steal (priv->desktop_file_refs_table, desktop_file);
+  g_hash_table_remove_all (priv->possible_apps_cache);
+
+  for (l = refs; l; l = l->next)
+    {
+      DesktopFileRef *ref = l->data;
+
+      remove_data_from_table_list (priv->desktop_file_table, ref->exec, ref->path);
+      remove_data_from_table_list (priv->desktop_id_table, ref->desktop_id, ref->path);
+      priv->no_display_desktop = g_list_remove (priv->no_display_desktop, ref->path);
+      g_free (ref->path);
+    }
+
+  g_slist_free_full (refs, (GDestroyNotify) desktop_file_ref_free);
+  g_free (key);
+}
+
+static void
+remove_desktop_files_with_prefix (BamfMatcher *self, const char *prefix)
+{
+  GHashTableIter iter;
+  gpointer key;
+  GList *to_remove = NULL, *l;
+
+  g_hash_table_iter_init (&iter, self->priv->desktop_file_refs_table);
+
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      if (g_str_has_prefix (key, prefix))
+        to_remove = g_list_prepend (to_remove, g_strdup (key));
+    }
+
+  for (l = to_remove; l; l = l->next)
+    remove_desktop_file_from_tables (self, l->data);
+
+  g_list_free_full (to_remove, g_free);
+}
+
 static void
 insert_data_into_tables (BamfMatcher *self,
                          const char *data,
@@ -712,20 +1433,27 @@ insert_data_into_tables (BamfMatcher *self,
                          GHashTable *desktop_id_table)
 {
   GList *file_list, *id_list, *last, *l;
+  DesktopFileRef *ref;
+  GSList *refs;
   char *datadup;
 
   g_return_if_fail (exec);
   g_return_if_fail (desktop_id);
 
-  file_list = g_hash_table_lookup (desktop_file_table, exec);
-  id_list   = g_hash_table_lookup (desktop_id_table, desktop_id);
+  g_hash_table_remove_all (self->priv->possible_apps_cache);
+  refs = g_hash_table_lookup (self->priv->desktop_file_refs_table, data);
 
-  if (g_list_find_custom (file_list, data, (GCompareFunc) g_strcmp0) &&
-      g_list_find_custom (id_list, data, (GCompareFunc) g_strcmp0))
+  for (; refs; refs = refs->next)
     {
-      return;
+      ref = refs->data;
+
+      if (g_strcmp0 (ref->exec, exec) == 0 && g_strcmp0 (ref->desktop_id, desktop_id) == 0)
+        return;
     }
 
+  file_list = g_hash_table_lookup (desktop_file_table, exec);
+  id_list   = g_hash_table_lookup (desktop_id_table, desktop_id);
+
   datadup = g_strdup (data);
 
   if (no_display)
@@ -790,60 +1518,129 @@ insert_data_into_tables (BamfMatcher *self,
 
   g_hash_table_insert (desktop_file_table, g_strdup (exec),       file_list);
   g_hash_table_insert (desktop_id_table,   g_strdup (desktop_id), id_list);
+
+  ref = g_slice_new (DesktopFileRef);
+  ref->exec = g_strdup (exec);
+  ref->desktop_id = g_strdup (desktop_id);
+  ref->path = datadup;
+
+  refs = g_hash_table_lookup (self->priv->desktop_file_refs_table, data);
+  g_hash_table_insert (self->priv->desktop_file_refs_table, g_strdup (data),
+                       g_slist_prepend (refs, ref));
+}
+
+static void
+remove_desktop_file_class_from_tables (const char *desktop_file,
+                                       GHashTable *desktop_class_table,
+                                       GHashTable *class_desktop_files_table)
+{
+  const char *desktop_class;
+  GList *files, *l;
+
+  desktop_class = g_hash_table_lookup (desktop_class_table, desktop_file);
+
+  if (!desktop_class)
+    return;
+
+  files = g_hash_table_lookup (class_desktop_files_table, desktop_class);
+  l = g_list_find_custom (files, desktop_file, (GCompareFunc) g_strcmp0);
+
+  if (l)
+    {
+      g_free (l->data);
+      files = g_list_delete_link (files, l);
+
+      if (files)
+        g_hash_table_insert (class_desktop_files_table, g_strdup (desktop_class), files);
+      else
+        g_hash_table_remove (class_desktop_files_table, desktop_class);
+    }
+
+  g_hash_table_remove (desktop_class_table, desktop_file);
+}
+
+static void
+insert_desktop_file_class_into_tables (const char *desktop_file,
+                                       char *desktop_class,
+                                       GHashTable *desktop_class_table,
+                                       GHashTable *class_desktop_files_table)
+{
+  GList *files;
+
+  /* The class of a desktop file could be changed, so the old reverse mapping
+   * must be dropped first. This takes the ownership of the class string. */
+  remove_desktop_file_class_from_tables (desktop_file, desktop_class_table,
+                                         class_desktop_files_table);
+
+  files = g_hash_table_lookup (class_desktop_files_table, desktop_class);
+  files = g_list_prepend (files, g_strdup (desktop_file));
+
+  g_hash_table_insert (class_desktop_files_table, g_strdup (desktop_class), files);
+  g_hash_table_insert (desktop_class_table, g_strdup (desktop_file), desktop_class);
+}
+
+static void
+free_class_desktop_files_table (GHashTable *class_desktop_files_table)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, class_desktop_files_table);
+
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    g_list_free_full (value, g_free);
+
+  g_hash_table_destroy (class_desktop_files_table);
 }
 
-static void
-insert_desktop_file_class_into_table (BamfMatcher *self,
-                                      const char *desktop_file,
-                                      GHashTable *desktop_class_table)
+void
+bamf_matcher_free_desktop_file_tables (BamfMatcher *self)
 {
-  GKeyFile *desktop_keyfile;
-  char *class;
-
-  g_return_if_fail (desktop_file);
+  BamfMatcherPrivate *priv;
 
-  desktop_keyfile = g_key_file_new ();
+  g_return_if_fail (BAMF_IS_MATCHER (self));
 
-  if (g_key_file_load_from_file (desktop_keyfile, desktop_file, G_KEY_FILE_NONE,
-                                 NULL))
-    {
-      class = g_key_file_get_string (desktop_keyfile,
-                                     G_KEY_FILE_DESKTOP_GROUP,
-                                     G_KEY_FILE_DESKTOP_KEY_STARTUP_WM_CLASS,
-                                     NULL);
-      if (class)
-        g_hash_table_insert (desktop_class_table, g_strdup (desktop_file), class);
+  priv = self->priv;
+  free_lists_table (priv->desktop_id_table);
+  free_lists_table (priv->desktop_file_table);
+  g_hash_table_destroy (priv->desktop_class_table);
+  free_class_desktop_files_table (priv->class_desktop_files_table);
+  free_desktop_file_refs_table (priv->desktop_file_refs_table);
+  g_list_free (priv->no_display_desktop);
 
-      g_key_file_free (desktop_keyfile);
-    }
+  priv->desktop_id_table = NULL;
+  priv->desktop_file_table = NULL;
+  priv->desktop_class_table = NULL;
+  priv->class_desktop_files_table = NULL;
+  priv->desktop_file_refs_table = NULL;
+  priv->no_display_desktop = NULL;
 }
 
-static void
-load_desktop_file_to_table (BamfMatcher * self,
-                            const char *file,
-                            GHashTable *desktop_file_table,
-                            GHashTable *desktop_id_table,
-                            GHashTable *desktop_class_table)
+static BamfDesktopEntry *
+load_desktop_file_entry (BamfMatcher * self,
+                         const char *file)
 {
   GDesktopAppInfo *desktop_file;
-  gboolean no_display;
+  BamfDesktopEntry *entry;
   char *exec;
   char *path;
   GString *desktop_id; /* is ok... really */
 
-  g_return_if_fail (BAMF_IS_MATCHER (self));
+  g_return_val_if_fail (BAMF_IS_MATCHER (self), NULL);
 
   desktop_file = g_desktop_app_info_new_from_filename (file);
 
   if (!G_IS_APP_INFO (desktop_file))
     {
-      return;
+      return NULL;
     }
 
-  if (!g_desktop_app_info_get_show_in (desktop_file, NULL))
+  /* Hidden entries are meant to be considered as deleted */
+  if (g_desktop_app_info_get_is_hidden (desktop_file) ||
+      !g_desktop_app_info_get_show_in (desktop_file, NULL))
     {
       g_object_unref (desktop_file);
-      return;
+      return NULL;
     }
 
   exec = g_strdup (g_app_info_get_commandline (G_APP_INFO (desktop_file)));
@@ -857,7 +1654,7 @@ load_desktop_file_to_table (BamfMatcher * self,
           g_free (exec);
         }
 
-      return;
+      return NULL;
     }
 
   /**
@@ -875,26 +1672,88 @@ load_desktop_file_to_table (BamfMatcher * self,
   g_free (path);
 
   desktop_id = g_string_truncate (desktop_id, desktop_id->len - 8); /* remove last 8 characters for .desktop */
-  no_display = g_desktop_app_info_get_nodisplay (desktop_file);
 
-  insert_data_into_tables (self, file, exec, desktop_id->str, no_display, desktop_file_table, desktop_id_table);
-  insert_desktop_file_class_into_table (self, file, desktop_class_table);
+  entry = bamf_desktop_entry_new (file, exec, desktop_id->str,
+                                  g_desktop_app_info_get_startup_wm_class (desktop_file),
+                                  g_desktop_app_info_get_nodisplay (desktop_file));
 
   g_free (exec);
   g_string_free (desktop_id, TRUE);
   g_object_unref (desktop_file);
+
+  return entry;
 }
 
 static void
-load_directory_to_table (BamfMatcher * self,
-                         const char *directory,
-                         GHashTable *desktop_file_table,
-                         GHashTable *desktop_id_table,
-                         GHashTable *desktop_class_table)
+insert_desktop_entry_into_tables (BamfMatcher *self,
+                                  BamfDesktopEntry *entry,
+                                  GHashTable *desktop_file_table,
+                                  GHashTable *desktop_id_table,
+                                  GHashTable *desktop_class_table,
+                                  GHashTable *class_desktop_files_table)
+{
+  insert_data_into_tables (self, entry->path, entry->exec, entry->desktop_id,
+                           entry->no_display, desktop_file_table, desktop_id_table);
+
+  if (entry->desktop_class)
+    {
+      insert_desktop_file_class_into_tables (entry->path, g_strdup (entry->desktop_class),
+                                             desktop_class_table,
+                                             class_desktop_files_table);
+    }
+}
+
+static void
+insert_desktop_entries_into_tables (BamfMatcher *self,
+                                    GPtrArray *entries,
+                                    GHashTable *desktop_file_table,
+                                    GHashTable *desktop_id_table,
+                                    GHashTable *desktop_class_table,
+                                    GHashTable *class_desktop_files_table)
+{
+  guint i;
+
+  for (i = 0; i < entries->len; ++i)
+    {
+      insert_desktop_entry_into_tables (self, g_ptr_array_index (entries, i),
+                                        desktop_file_table, desktop_id_table,
+                                        desktop_class_table,
+                                        class_desktop_files_table);
+    }
+}
+
+static void
+load_desktop_file_to_table (BamfMatcher * self,
+                            const char *file,
+                            GHashTable *desktop_file_table,
+                            GHashTable *desktop_id_table,
+                            GHashTable *desktop_class_table,
+                            GHashTable *class_desktop_files_table)
+{
+  BamfDesktopEntry *entry;
+
+  g_return_if_fail (BAMF_IS_MATCHER (self));
+
+  entry = load_desktop_file_entry (self, file);
+
+  if (!entry)
+    return;
+
+  insert_desktop_entry_into_tables (self, entry, desktop_file_table,
+                                    desktop_id_table, desktop_class_table,
+                                    class_desktop_files_table);
+  bamf_desktop_entry_free (entry);
+}
+
+static GPtrArray *
+load_directory_entries (BamfMatcher * self,
+                        const char *directory)
 {
   GFile *dir;
   GFileEnumerator *enumerator;
   GFileInfo *info;
+  GPtrArray *entries;
+  BamfDesktopEntry *entry;
   const char *name;
   char *path;
 
@@ -907,39 +1766,46 @@ load_directory_to_table (BamfMatcher * self,
                                           NULL);
 
   if (!enumerator)
-    return;
+    {
+      g_object_unref (dir);
+      return NULL;
+    }
+
+  entries = g_ptr_array_new_with_free_func ((GDestroyNotify) bamf_desktop_entry_free);
 
   info = g_file_enumerator_next_file (enumerator, NULL, NULL);
   for (; info; info = g_file_enumerator_next_file (enumerator, NULL, NULL))
     {
       name = g_file_info_get_name (info);
-      path = g_build_filename (directory, name, NULL);
 
       if (g_str_has_suffix (name, ".desktop"))
-        load_desktop_file_to_table (self,
-                                    path,
-                                    desktop_file_table,
-                                    desktop_id_table,
-                                    desktop_class_table);
+        {
+          path = g_build_filename (directory, name, NULL);
+          entry = load_desktop_file_entry (self, path);
+
+          if (entry)
+            g_ptr_array_add (entries, entry);
+
+          g_free (path);
+        }
 
-      g_free (path);
       g_object_unref (info);
     }
 
   g_object_unref (enumerator);
   g_object_unref (dir);
+
+  return entries;
 }
 
-static void
-load_index_file_to_table (BamfMatcher * self,
-                          const char *index_file,
-                          GHashTable *desktop_file_table,
-                          GHashTable *desktop_id_table,
-                          GHashTable *desktop_class_table)
+static GPtrArray *
+load_index_file_entries (BamfMatcher * self,
+                         const char *index_file)
 {
   GFile *file;
   GFileInputStream *stream;
   GDataInputStream *input;
+  GPtrArray *entries;
   char *line;
   char *directory;
   gchar **current_desktops = NULL;
@@ -948,14 +1814,14 @@ load_index_file_to_table (BamfMatcher * self,
 
   file = g_file_new_for_path (index_file);
 
-  g_return_if_fail (file);
+  g_return_val_if_fail (file, NULL);
 
   stream = g_file_read (file, NULL, NULL);
 
   if (!stream)
     {
       g_object_unref (file);
-      return;
+      return NULL;
     }
 
   length = 0;
@@ -965,77 +1831,45 @@ load_index_file_to_table (BamfMatcher * self,
   if (xdg_current_desktop)
     current_desktops = g_strsplit (xdg_current_desktop, ":", 0);
 
+  entries = g_ptr_array_new_with_free_func ((GDestroyNotify) bamf_desktop_entry_free);
   directory = g_path_get_dirname (index_file);
   input = g_data_input_stream_new (G_INPUT_STREAM (stream));
 
   while ((line = g_data_input_stream_read_line (input, &length, NULL, NULL)))
     {
+      BamfIndexEntry *index_entry;
       char *exec;
       char *filename;
-      const char *class;
-      const char *show_in;
       GString *desktop_id;
-      gboolean no_display;
 
-      /* Order is: 0 Desktop-Id, 1 Exec, 2 class, 3 ShowIn, 4 NoDisplay */
-      gchar **parts = g_strsplit (line, "\t", 5);
+      index_entry = bamf_index_entry_new_from_line (line);
+      g_free (line);
+      length = 0;
 
-      show_in = parts[3];
+      if (!index_entry)
+        continue;
 
-      if (current_desktops && show_in && show_in[0] != '\0')
+      /* The same filtering of load_desktop_file_entry */
+      if (!bamf_index_entry_get_show_in (index_entry, (const gchar * const *) current_desktops))
         {
-          gchar **sub_parts = g_strsplit (show_in, ";", -1);
-          gboolean found_current = FALSE;
-          int i = 0;
-
-          for (i = 0; sub_parts[i]; ++i)
-            {
-              if (g_strv_contains ((const gchar * const *) current_desktops, sub_parts[i]) == 0)
-                {
-                  found_current = TRUE;
-                  break;
-                }
-            }
-
-          g_strfreev (sub_parts);
-
-          if (!found_current)
-            {
-              length = 0;
-              g_strfreev (parts);
-              continue;
-            }
+          bamf_index_entry_free (index_entry);
+          continue;
         }
 
-      char *tmp = bamf_matcher_get_trimmed_exec (self, parts[1]);
-      g_free (parts[1]);
-      parts[1] = tmp;
-      exec = parts[1];
+      exec = bamf_matcher_get_trimmed_exec (self, index_entry->exec);
+      filename = g_build_filename (directory, index_entry->desktop_id, NULL);
 
-      filename = g_build_filename (directory, parts[0], NULL);
-
-      desktop_id = g_string_new (parts[0]);
+      desktop_id = g_string_new (index_entry->desktop_id);
       g_string_truncate (desktop_id, desktop_id->len - 8);
 
-      no_display = FALSE;
-      if (parts[4] && g_ascii_strcasecmp (parts[4], "true") == 0)
-        {
-          no_display = TRUE;
-        }
-
-      insert_data_into_tables (self, filename, exec, desktop_id->str, no_display, desktop_file_table, desktop_id_table);
-
-      class = parts[2];
-      if (class && class[0] != '\0')
-        {
-          g_hash_table_insert (desktop_class_table, g_strdup (filename), g_strdup (class));
-        }
+      g_ptr_array_add (entries, bamf_desktop_entry_new (filename, exec, desktop_id->str,
+                                                        index_entry->desktop_class,
+                                                        index_entry->no_display));
 
       g_string_free (desktop_id, TRUE);
-      g_free (line);
       g_free (filename);
-      g_strfreev (parts);
-      length = 0;
+      g_free (exec);
+      bamf_index_entry_free (index_entry);
     }
 
   g_object_unref (input);
@@ -1043,6 +1877,8 @@ load_index_file_to_table (BamfMatcher * self,
   g_object_unref (file);
   g_strfreev (current_desktops);
   g_free (directory);
+
+  return entries;
 }
 
 static GList * get_directory_tree_list (GList *) G_GNUC_WARN_UNUSED_RESULT;
@@ -1180,85 +2016,68 @@ compare_sub_values (gconstpointer desktop_path, gconstpointer desktop_file)
 }
 
 static void
-hash_table_remove_sub_values (GHashTable *htable, GCompareFunc compare_func,
-                              GFreeFunc free_func, gpointer target, gboolean search_all)
+remove_desktop_files_class_with_prefix (const char *prefix,
+                                        GHashTable *desktop_class_table,
+                                        GHashTable *class_desktop_files_table)
 {
-  g_return_if_fail (htable);
-  g_return_if_fail (compare_func);
-
   GHashTableIter iter;
   gpointer key;
-  gpointer value;
+  GList *to_remove = NULL, *l;
 
-  g_hash_table_iter_init (&iter, htable);
+  g_hash_table_iter_init (&iter, desktop_class_table);
 
-  while (g_hash_table_iter_next (&iter, &key, &value))
+  while (g_hash_table_iter_next (&iter, &key, NULL))
     {
-      GList *list, *l;
-      gboolean found;
+      if (compare_sub_values (prefix, key) == 0)
+        to_remove = g_list_prepend (to_remove, g_strdup (key));
+    }
 
-      list = value;
-      found = FALSE;
+  for (l = to_remove; l; l = l->next)
+    {
+      remove_desktop_file_class_from_tables (l->data, desktop_class_table,
+                                             class_desktop_files_table);
+    }
 
-      l = list;
-      while (l)
-        {
-          GList *next = l->next;
+  g_list_free_full (to_remove, g_free);
+}
 
-          if (compare_func (target, l->data) == 0)
-            {
-              found = TRUE;
-
-              if (!l->prev && !l->next)
-              {
-                if (free_func)
-                  g_list_free_full (list, free_func);
-                else
-                  g_list_free (list);
-
-                g_hash_table_iter_remove (&iter);
-
-                next = NULL;
-                break;
-              }
-            else
-              {
-                if (free_func)
-                  free_func (l->data);
-
-                /* If the target is the first element of the list (and thanks to
-                 * the previous check we're also sure that it's not the only one),
-                 * simply switch it with its follower, not to change the first
-                 * pointer and the hash table value for key
-                 */
-                if (l == list)
-                  {
-                    l->data = next->data;
-                    l = next;
-                    next = list;
-                  }
+static void fill_desktop_file_table (BamfMatcher *, GList *, BamfDesktopCache *, GHashTable *, GHashTable *, GHashTable *, GHashTable *);
+static void handle_window_opened (BamfLegacyScreen *, BamfLegacyWindow *, BamfMatcher *);
+static void bamf_matcher_queue_desktop_file_rematch (BamfMatcher *, const char *);
 
-                list = g_list_delete_link (list, l);
-              }
+static void
+queue_desktop_files_rematch_with_prefix (BamfMatcher *self, const char *directory)
+{
+  GHashTableIter iter;
+  gpointer key;
+  char *prefix;
 
-              if (!search_all)
-                break;
-            }
-            l = next;
-        }
+  prefix = g_strconcat (directory, G_DIR_SEPARATOR_S, NULL);
+  g_hash_table_iter_init (&iter, self->priv->desktop_file_refs_table);
 
-      if (found && !search_all)
-         break;
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      if (g_str_has_prefix (key, prefix))
+        bamf_matcher_queue_desktop_file_rematch (self, key);
     }
+
+  g_free (prefix);
 }
 
-static gboolean
-hash_table_compare_sub_values (gpointer desktop_path, gpointer desktop_class, gpointer target_path)
+typedef struct
 {
-  return !compare_sub_values (target_path, desktop_path);
-}
+  GFileMonitor *monitor;
+  GFile *file;
+  GFileMonitorEvent type;
+} MonitorEvent;
 
-static void fill_desktop_file_table (BamfMatcher *, GList *, GHashTable *, GHashTable *, GHashTable *);
+static void
+monitor_event_free (MonitorEvent *event)
+{
+  g_object_unref (event->monitor);
+  g_object_unref (event->file);
+  g_slice_free (MonitorEvent, event);
+}
 
 static void
 on_monitor_changed (GFileMonitor *monitor, GFile *file, GFile *other_file, GFileMonitorEvent type, BamfMatcher *self)
@@ -1266,6 +2085,7 @@ on_monitor_changed (GFileMonitor *monitor, GFile *file, GFile *other_file, GFile
   char *path;
   const char *monitored_dir;
   GFileType filetype;
+  gint64 start_time;
 
   g_return_if_fail (G_IS_FILE_MONITOR (monitor));
   g_return_if_fail (G_IS_FILE (file));
@@ -1276,6 +2096,18 @@ on_monitor_changed (GFileMonitor *monitor, GFile *file, GFile *other_file, GFile
       type != G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT)
     return;
 
+  if (self->priv->queued_monitor_events)
+    {
+      /* The desktop files are being loaded in background, the changes are
+       * applied once their (maybe older) contents are in the tables */
+      MonitorEvent *event = g_slice_new (MonitorEvent);
+      event->monitor = g_object_ref (monitor);
+      event->file = g_object_ref (file);
+      event->type = type;
+      g_queue_push_tail (self->priv->queued_monitor_events, event);
+      return;
+    }
+
   path = g_file_get_path (file);
   filetype = g_file_query_file_type (file, G_FILE_QUERY_INFO_NONE, NULL);
   monitored_dir = g_object_get_data (G_OBJECT (monitor), "root");
@@ -1288,35 +2120,27 @@ on_monitor_changed (GFileMonitor *monitor, GFile *file, GFile *other_file, GFile
       return;
     }
 
+  start_time = bamf_stats_timer_start ();
+
   if (type == G_FILE_MONITOR_EVENT_DELETED ||
       type == G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT)
     {
       if (g_str_has_suffix (path, ".desktop"))
         {
-          /* Remove all the .desktop file references from the hash tables.
-           * Free the string itself only on the 2nd pass (tables share the same
-           * string instance)
-           */
-          hash_table_remove_sub_values (self->priv->desktop_id_table,
-                                       (GCompareFunc) g_strcmp0, NULL, path, FALSE);
-          hash_table_remove_sub_values (self->priv->desktop_file_table,
-                                       (GCompareFunc) g_strcmp0, g_free, path, FALSE);
-          g_hash_table_remove (self->priv->desktop_class_table, path);
+          /* Remove all the .desktop file references from the hash tables */
+          remove_desktop_file_from_tables (self, path);
+          remove_desktop_file_class_from_tables (path, self->priv->desktop_class_table,
+                                                 self->priv->class_desktop_files_table);
         }
       else if (g_strcmp0 (monitored_dir, path) == 0)
         {
           /* Remove all the references to the .desktop files placed in subfolders
-           * of the current path. Free the strings itself only on the 2nd pass
-           * (as before, the tables share the same string instance)
-           */
+           * of the current path */
           char *prefix = g_strconcat (path, G_DIR_SEPARATOR_S, NULL);
 
-          hash_table_remove_sub_values (self->priv->desktop_id_table,
-                                        compare_sub_values, NULL, prefix, TRUE);
-          hash_table_remove_sub_values (self->priv->desktop_file_table,
-                                        compare_sub_values, g_free, prefix, TRUE);
-          g_hash_table_foreach_remove (self->priv->desktop_class_table,
-                                       hash_table_compare_sub_values, prefix);
+          remove_desktop_files_with_prefix (self, prefix);
+          remove_desktop_files_class_with_prefix (prefix, self->priv->desktop_class_table,
+                                                  self->priv->class_desktop_files_table);
 
           g_signal_handlers_disconnect_by_func (monitor, on_monitor_changed, self);
           self->priv->monitors = g_list_remove (self->priv->monitors, monitor);
@@ -1338,21 +2162,24 @@ on_monitor_changed (GFileMonitor *monitor, GFile *file, GFile *other_file, GFile
               GList *dirs = NULL;
               dirs = g_list_prepend (dirs, g_strdup (path));
               dirs = get_directory_tree_list (dirs);
-              fill_desktop_file_table (self, dirs,
+              fill_desktop_file_table (self, dirs, NULL,
                                        self->priv->desktop_file_table,
                                        self->priv->desktop_id_table,
-                                       self->priv->desktop_class_table);
+                                       self->priv->desktop_class_table,
+                                       self->priv->class_desktop_files_table);
 
+              queue_desktop_files_rematch_with_prefix (self, path);
               g_list_free_full (dirs, g_free);
             }
         }
       else if (filetype != G_FILE_TYPE_UNKNOWN)
         {
-          bamf_matcher_load_desktop_file (self, path);
+          bamf_matcher_load_monitored_desktop_file (self, path);
         }
     }
 
   g_free (path);
+  bamf_stats_timer_stop (BAMF_STATS_TIMER_MONITOR_CHANGED, start_time);
 }
 
 static void
@@ -1383,18 +2210,47 @@ bamf_matcher_add_new_monitored_directory (BamfMatcher * self, const gchar *direc
   g_object_unref (file);
 }
 
+typedef struct
+{
+  char *directory;
+  char *index_file;
+  guint64 mtime;
+  GPtrArray *entries;
+  gboolean cached;
+} DesktopDirectoryJob;
+
 static void
-fill_desktop_file_table (BamfMatcher * self,
-                         GList *directories,
-                         GHashTable *desktop_file_table,
-                         GHashTable *desktop_id_table,
-                         GHashTable *desktop_class_table)
+desktop_directory_job_free (DesktopDirectoryJob *job)
 {
-  g_return_if_fail (BAMF_IS_MATCHER (self));
+  if (job->entries)
+    g_ptr_array_unref (job->entries);
 
+  g_free (job->directory);
+  g_free (job->index_file);
+  g_slice_free (DesktopDirectoryJob, job);
+}
+
+/* This may run in a worker thread, so it must only access the read-only
+ * matcher data (the exec prefixes regexes) */
+static void
+load_desktop_directory_job (DesktopDirectoryJob *job, BamfMatcher *self)
+{
+  if (job->index_file)
+    job->entries = load_index_file_entries (self, job->index_file);
+  else
+    job->entries = load_directory_entries (self, job->directory);
+}
+
+static GPtrArray *
+prepare_desktop_directory_jobs (BamfMatcher * self,
+                                GList *directories)
+{
   GList *l;
+  GPtrArray *jobs;
+  DesktopDirectoryJob *job;
   char *directory;
-  char *bamf_file;
+
+  jobs = g_ptr_array_new_with_free_func ((GDestroyNotify) desktop_directory_job_free);
 
   for (l = directories; l; l = l->next)
     {
@@ -1405,32 +2261,289 @@ fill_desktop_file_table (BamfMatcher * self,
 
       bamf_matcher_add_new_monitored_directory (self, directory);
 
-      bamf_file = g_build_filename (directory, BAMF_INDEX_NAME, NULL);
+      job = g_slice_new0 (DesktopDirectoryJob);
+      job->directory = g_strdup (directory);
+      g_ptr_array_add (jobs, job);
+    }
+
+  return jobs;
+}
+
+/* This may run in a worker thread, as it only touches the jobs and the cache */
+static void
+lookup_desktop_directory_jobs (GPtrArray *jobs,
+                               BamfDesktopCache *cache)
+{
+  DesktopDirectoryJob *job;
+  char *bamf_file;
+  guint i;
+
+  for (i = 0; i < jobs->len; ++i)
+    {
+      job = g_ptr_array_index (jobs, i);
+
+      bamf_file = g_build_filename (job->directory, BAMF_INDEX_NAME, NULL);
+
+      if (g_file_test (bamf_file, G_FILE_TEST_EXISTS))
+        job->index_file = bamf_file;
+      else
+        g_free (bamf_file);
+
+      if (cache)
+        {
+          /* The mtime must be read before parsing, so that any change happening
+           * meanwhile will invalidate the cached data at next startup */
+          job->mtime = bamf_desktop_cache_get_directory_mtime (job->directory);
+
+          job->entries = bamf_desktop_cache_get_directory (cache, job->directory, job->mtime);
+          job->cached = (job->entries != NULL);
+        }
+    }
+}
+
+static void
+run_desktop_directory_jobs (BamfMatcher * self,
+                            GPtrArray *jobs)
+{
+  GThreadPool *pool = NULL;
+  DesktopDirectoryJob *job;
+  guint to_parse = 0;
+  guint i;
+
+  for (i = 0; i < jobs->len; ++i)
+    {
+      job = g_ptr_array_index (jobs, i);
+
+      if (!job->cached)
+        ++to_parse;
+    }
+
+  /* Directories are parsed in parallel, while their results are merged later
+   * in the directories priority order, as the tables insertion depends on it */
+  if (to_parse > 1)
+    {
+      pool = g_thread_pool_new ((GFunc) load_desktop_directory_job, self,
+                                MIN (g_get_num_processors (), to_parse),
+                                FALSE, NULL);
+    }
+
+  for (i = 0; i < jobs->len; ++i)
+    {
+      job = g_ptr_array_index (jobs, i);
+
+      if (job->cached)
+        continue;
+
+      if (pool)
+        g_thread_pool_push (pool, job, NULL);
+      else
+        load_desktop_directory_job (job, self);
+    }
+
+  if (pool)
+    g_thread_pool_free (pool, FALSE, TRUE);
+}
+
+static void
+merge_desktop_directory_jobs (BamfMatcher * self,
+                              GPtrArray *jobs,
+                              BamfDesktopCache *cache,
+                              GHashTable *desktop_file_table,
+                              GHashTable *desktop_id_table,
+                              GHashTable *desktop_class_table,
+                              GHashTable *class_desktop_files_table)
+{
+  DesktopDirectoryJob *job;
+  guint i;
+
+  for (i = 0; i < jobs->len; ++i)
+    {
+      job = g_ptr_array_index (jobs, i);
+
+      if (cache && !job->cached)
+        bamf_desktop_cache_set_directory (cache, job->directory, job->mtime, job->entries);
+
+      if (job->entries)
+        {
+          insert_desktop_entries_into_tables (self, job->entries, desktop_file_table,
+                                              desktop_id_table, desktop_class_table,
+                                              class_desktop_files_table);
+        }
+    }
+}
+
+static void
+fill_desktop_file_table (BamfMatcher * self,
+                         GList *directories,
+                         BamfDesktopCache *cache,
+                         GHashTable *desktop_file_table,
+                         GHashTable *desktop_id_table,
+                         GHashTable *desktop_class_table,
+                         GHashTable *class_desktop_files_table)
+{
+  g_return_if_fail (BAMF_IS_MATCHER (self));
+
+  GPtrArray *jobs;
+
+  jobs = prepare_desktop_directory_jobs (self, directories);
+  lookup_desktop_directory_jobs (jobs, cache);
+  run_desktop_directory_jobs (self, jobs);
+  merge_desktop_directory_jobs (self, jobs, cache, desktop_file_table,
+                                desktop_id_table, desktop_class_table,
+                                class_desktop_files_table);
+
+  g_ptr_array_unref (jobs);
+}
+
+typedef struct
+{
+  BamfDesktopCache *cache;
+  gchar *cache_file;
+  gchar *context;
+  GPtrArray *jobs;
+  gint64 start_time;
+} DesktopFilesLoad;
+
+static void
+desktop_files_load_free (DesktopFilesLoad *load)
+{
+  bamf_desktop_cache_free (load->cache);
+  g_ptr_array_unref (load->jobs);
+  g_free (load->cache_file);
+  g_free (load->context);
+  g_slice_free (DesktopFilesLoad, load);
+}
+
+static DesktopFilesLoad *
+desktop_files_load_new (BamfMatcher * self)
+{
+  DesktopFilesLoad *load;
+  GList *directories;
+
+  load = g_slice_new0 (DesktopFilesLoad);
+  load->start_time = bamf_stats_timer_start ();
+  load->cache_file = bamf_desktop_cache_get_default_path ();
+  load->context = g_strdup (g_getenv ("XDG_CURRENT_DESKTOP"));
+
+  /* Only the directories are listed and monitored here, reading the cache
+   * and the directories mtimes is up to desktop_files_load_run */
+  directories = get_desktop_file_directories (self);
+  load->jobs = prepare_desktop_directory_jobs (self, directories);
+  g_list_free_full (directories, g_free);
+
+  return load;
+}
+
+/* This may run in a worker thread, see load_desktop_directory_job */
+static void
+desktop_files_load_run (BamfMatcher * self,
+                        DesktopFilesLoad *load)
+{
+  load->cache = bamf_desktop_cache_new (load->cache_file, load->context);
+  lookup_desktop_directory_jobs (load->jobs, load->cache);
+  run_desktop_directory_jobs (self, load->jobs);
+}
+
+static void
+desktop_files_load_finish (BamfMatcher * self,
+                           DesktopFilesLoad *load,
+                           GHashTable *desktop_file_table,
+                           GHashTable *desktop_id_table,
+                           GHashTable *desktop_class_table,
+                           GHashTable *class_desktop_files_table)
+{
+  GError *error = NULL;
+
+  merge_desktop_directory_jobs (self, load->jobs, load->cache, desktop_file_table,
+                                desktop_id_table, desktop_class_table,
+                                class_desktop_files_table);
+
+  bamf_stats_timer_stop (BAMF_STATS_TIMER_LOAD_DESKTOP_FILES, load->start_time);
+
+  if (!bamf_desktop_cache_save (load->cache, &error))
+    {
+      g_warning ("Impossible to save the desktop files cache %s: %s",
+                 load->cache_file, error ? error->message : "");
+      g_clear_error (&error);
+    }
+}
+
+static void
+bamf_matcher_set_ready (BamfMatcher *self)
+{
+  BamfLegacyScreen *screen;
+  GList *queued, *l;
+
+  bamf_dbus_matcher_set_ready (BAMF_DBUS_MATCHER (self), TRUE);
+
+  screen = bamf_legacy_screen_get_default ();
+  queued = self->priv->queued_windows;
+  self->priv->queued_windows = NULL;
+
+  for (l = queued; l; l = l->next)
+    {
+      if (!bamf_legacy_window_is_closed (l->data))
+        handle_window_opened (screen, l->data, self);
+    }
+
+  g_list_free_full (queued, g_object_unref);
+
+  bamf_dbus_matcher_emit_ready (BAMF_DBUS_MATCHER (self));
+}
+
+static void
+load_desktop_files_thread (GTask *task, BamfMatcher *self,
+                           DesktopFilesLoad *load, GCancellable *cancellable)
+{
+  desktop_files_load_run (self, load);
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+replay_monitor_events (BamfMatcher *self)
+{
+  BamfMatcherPrivate *priv = self->priv;
+  GQueue *events = priv->queued_monitor_events;
+  MonitorEvent *event;
+
+  priv->queued_monitor_events = NULL;
+
+  while ((event = g_queue_pop_head (events)))
+    {
+      /* Monitors of removed directories are dropped by their own events */
+      if (g_list_find (priv->monitors, event->monitor))
+        on_monitor_changed (event->monitor, event->file, NULL, event->type, self);
+
+      monitor_event_free (event);
+    }
+
+  g_queue_free (events);
+}
+
+static void
+on_desktop_files_loaded (BamfMatcher *self, GAsyncResult *result, gpointer data)
+{
+  BamfMatcherPrivate *priv = self->priv;
+  DesktopFilesLoad *load = g_task_get_task_data (G_TASK (result));
 
-      if (g_file_test (bamf_file, G_FILE_TEST_EXISTS))
-        {
-          load_index_file_to_table (self, bamf_file, desktop_file_table,
-                                    desktop_id_table, desktop_class_table);
-        }
-      else
-        {
-          load_directory_to_table (self, directory, desktop_file_table,
-                                   desktop_id_table, desktop_class_table);
-        }
+  desktop_files_load_finish (self, load, priv->desktop_file_table,
+                             priv->desktop_id_table, priv->desktop_class_table,
+                             priv->class_desktop_files_table);
 
-      g_free (bamf_file);
-    }
+  replay_monitor_events (self);
+  bamf_matcher_set_ready (self);
 }
 
 static void
 create_desktop_file_table (BamfMatcher * self,
                            GHashTable **desktop_file_table,
                            GHashTable **desktop_id_table,
-                           GHashTable **desktop_class_table)
+                           GHashTable **desktop_class_table,
+                           GHashTable **class_desktop_files_table)
 {
   g_return_if_fail (BAMF_IS_MATCHER (self));
 
-  GList *directories;
+  DesktopFilesLoad *load;
 
   *desktop_file_table =
     g_hash_table_new_full ((GHashFunc) g_str_hash,
@@ -1450,12 +2563,31 @@ create_desktop_file_table (BamfMatcher * self,
                            (GDestroyNotify) g_free,
                            (GDestroyNotify) g_free);
 
-  directories = get_desktop_file_directories (self);
+  *class_desktop_files_table =
+    g_hash_table_new_full ((GHashFunc) g_str_hash,
+                           (GEqualFunc) g_str_equal,
+                           (GDestroyNotify) g_free,
+                           NULL);
 
-  fill_desktop_file_table (self, directories, *desktop_file_table,
-                           *desktop_id_table, *desktop_class_table);
+  load = desktop_files_load_new (self);
 
-  g_list_free_full (directories, g_free);
+  if (lazy_loading)
+    {
+      /* The desktop files are parsed in a worker thread, while the tables
+       * are filled in the main one once done. The task keeps the matcher alive */
+      GTask *task = g_task_new (self, NULL, (GAsyncReadyCallback) on_desktop_files_loaded, NULL);
+      self->priv->queued_monitor_events = g_queue_new ();
+      g_task_set_task_data (task, load, (GDestroyNotify) desktop_files_load_free);
+      g_task_run_in_thread (task, (GTaskThreadFunc) load_desktop_files_thread);
+      g_object_unref (task);
+
+      return;
+    }
+
+  desktop_files_load_run (self, load);
+  desktop_files_load_finish (self, load, *desktop_file_table, *desktop_id_table,
+                             *desktop_class_table, *class_desktop_files_table);
+  desktop_files_load_free (load);
 }
 
 static GList *
@@ -1589,24 +2721,17 @@ bamf_matcher_window_skips_hint_set (BamfMatcher *self, BamfLegacyWindow *window)
 static GList *
 bamf_matcher_get_class_matching_desktop_files (BamfMatcher *self, const gchar *class_name)
 {
-  GList* desktop_files = NULL;
-  gpointer key;
-  gpointer value;
-  GHashTableIter iter;
+  GList* desktop_files = NULL, *l;
 
   g_return_val_if_fail (BAMF_IS_MATCHER (self), NULL);
-  g_hash_table_iter_init (&iter, self->priv->desktop_class_table);
 
-  while (g_hash_table_iter_next (&iter, &key, &value))
-    {
-      gchar* desktop_file = g_strdup (key);
-      gchar* desktop_class = value;
+  if (!class_name)
+    return NULL;
 
-      if (g_strcmp0 (desktop_class, class_name) == 0)
-        {
-          desktop_files = g_list_prepend (desktop_files, desktop_file);
-        }
-    }
+  l = g_hash_table_lookup (self->priv->class_desktop_files_table, class_name);
+
+  for (; l; l = l->next)
+    desktop_files = g_list_prepend (desktop_files, g_strdup (l->data));
 
   return desktop_files;
 }
@@ -1614,24 +2739,12 @@ bamf_matcher_get_class_matching_desktop_files (BamfMatcher *self, const gchar *c
 static gboolean
 bamf_matcher_has_instance_class_desktop_file (BamfMatcher *self, const gchar *class_name)
 {
-  gpointer key;
-  gpointer value;
-  GHashTableIter iter;
-
   g_return_val_if_fail (BAMF_IS_MATCHER (self), FALSE);
-  g_hash_table_iter_init (&iter, self->priv->desktop_class_table);
-
-  while (g_hash_table_iter_next (&iter, &key, &value))
-    {
-      gchar* desktop_class = value;
 
-      if (g_strcmp0 (desktop_class, class_name) == 0)
-        {
-          return TRUE;
-        }
-    }
+  if (!class_name)
+    return FALSE;
 
-  return FALSE;
+  return g_hash_table_contains (self->priv->class_desktop_files_table, class_name);
 }
 
 gboolean
@@ -1653,28 +2766,16 @@ bamf_matcher_is_valid_class_name (BamfMatcher *self, const char *class_name)
   return TRUE;
 }
 
-static GList *
-bamf_matcher_possible_applications_for_window (BamfMatcher *self,
-                                               BamfWindow *bamf_window,
-                                               const char **target_class_out)
+static const char *
+bamf_matcher_get_window_target_class (BamfMatcher *self,
+                                      BamfLegacyWindow *window,
+                                      gboolean *filter_by_wmclass_out)
 {
-  BamfMatcherPrivate *priv;
-  BamfLegacyWindow *window;
-  GList *desktop_files = NULL, *l;
-  char *app_id;
-  char *desktop_file = NULL;
-  const char *desktop_class = NULL;
   const char *class_name = NULL;
   const char *instance_name = NULL;
   const char *target_class = NULL;
   gboolean filter_by_wmclass = FALSE;
 
-  g_return_val_if_fail (BAMF_IS_WINDOW (bamf_window), NULL);
-  g_return_val_if_fail (BAMF_IS_MATCHER (self), NULL);
-
-  priv = self->priv;
-  window = bamf_window_get_window (bamf_window);
-  desktop_file = bamf_legacy_window_get_hint (window, _BAMF_DESKTOP_FILE);
   class_name = bamf_legacy_window_get_class_name (window);
   instance_name = bamf_legacy_window_get_class_instance_name (window);
 
@@ -1701,6 +2802,38 @@ bamf_matcher_possible_applications_for_window (BamfMatcher *self,
         }
     }
 
+  if (filter_by_wmclass_out)
+    *filter_by_wmclass_out = filter_by_wmclass;
+
+  return target_class;
+}
+
+static GList *
+bamf_matcher_find_possible_applications_for_window (BamfMatcher *self,
+                                                    BamfWindow *bamf_window,
+                                                    BamfStatsMatch *match_out)
+{
+  BamfMatcherPrivate *priv;
+  BamfLegacyWindow *window;
+  GList *desktop_files = NULL, *l;
+  char *app_id;
+  char *desktop_file = NULL;
+  const char *desktop_class = NULL;
+  const char *class_name = NULL;
+  const char *target_class = NULL;
+  gboolean filter_by_wmclass = FALSE;
+  BamfStatsMatch match = BAMF_STATS_MATCH_LAST;
+
+  priv = self->priv;
+  window = bamf_window_get_window (bamf_window);
+  desktop_file = bamf_legacy_window_get_hint (window, _BAMF_DESKTOP_FILE);
+  class_name = bamf_legacy_window_get_class_name (window);
+
+  if (!bamf_matcher_is_valid_class_name (self, class_name))
+    class_name = NULL;
+
+  target_class = bamf_matcher_get_window_target_class (self, window, &filter_by_wmclass);
+
   if (desktop_file)
     {
       desktop_class = bamf_matcher_get_desktop_file_class (self, desktop_file);
@@ -1708,6 +2841,7 @@ bamf_matcher_possible_applications_for_window (BamfMatcher *self,
       if ((!filter_by_wmclass && !desktop_class) || g_strcmp0 (desktop_class, target_class) == 0)
         {
           desktop_files = g_list_prepend (desktop_files, desktop_file);
+          match = BAMF_STATS_MATCH_HINT;
         }
       else
         {
@@ -1723,6 +2857,7 @@ bamf_matcher_possible_applications_for_window (BamfMatcher *self,
       if (desktop_file)
         {
           desktop_files = g_list_prepend (desktop_files, desktop_file);
+          match = BAMF_STATS_MATCH_ENV;
         }
 
       const char *exec_string = bamf_legacy_window_get_exec_string (window);
@@ -1731,6 +2866,7 @@ bamf_matcher_possible_applications_for_window (BamfMatcher *self,
       if (desktop_file)
         {
           desktop_files = g_list_prepend (desktop_files, desktop_file);
+          match = BAMF_STATS_MATCH_EXEC;
         }
 
       if (!desktop_files)
@@ -1747,6 +2883,7 @@ bamf_matcher_possible_applications_for_window (BamfMatcher *self,
                   if ((!filter_by_wmclass && !desktop_class) || g_strcmp0 (desktop_class, target_class) == 0)
                     {
                       desktop_files = g_list_prepend (desktop_files, g_strdup (desktop_file));
+                      match = BAMF_STATS_MATCH_APP_ID;
                     }
                 }
 
@@ -1785,6 +2922,9 @@ bamf_matcher_possible_applications_for_window (BamfMatcher *self,
             }
 
           desktop_files = g_list_reverse (desktop_files);
+
+          if (desktop_files)
+            match = BAMF_STATS_MATCH_CLASS;
         }
 
       GList *pid_list = bamf_matcher_possible_applications_for_window_process (self, window);
@@ -1846,24 +2986,166 @@ bamf_matcher_possible_applications_for_window (BamfMatcher *self,
         }
 
       g_list_free (pid_list);
+
+      if (desktop_files && match == BAMF_STATS_MATCH_LAST)
+        match = BAMF_STATS_MATCH_PROCESS;
     }
 
   if (!desktop_files && filter_by_wmclass)
     {
       desktop_files = bamf_matcher_get_class_matching_desktop_files (self, target_class);
+
+      if (desktop_files)
+        match = BAMF_STATS_MATCH_CLASS;
+    }
+
+  if (match_out)
+    *match_out = match;
+
+  return desktop_files;
+}
+
+typedef struct
+{
+  GList *desktop_files;
+  BamfStatsMatch match;
+} PossibleApplications;
+
+static void
+possible_applications_free (PossibleApplications *possible_apps)
+{
+  g_list_free_full (possible_apps->desktop_files, g_free);
+  g_slice_free (PossibleApplications, possible_apps);
+}
+
+static void
+append_match_key_field (GString *key, const char *field)
+{
+  /* Fields are prefixed so that NULL and empty values are different */
+  if (field)
+    {
+      g_string_append_c (key, '+');
+      g_string_append (key, field);
+    }
+  else
+    {
+      g_string_append_c (key, '-');
+    }
+
+  g_string_append_c (key, '\n');
+}
+
+#define PROCESS_MATCH_KEY "bamf-matcher-process-match-key"
+
+/* The values that depend on the window process never change, so they're
+ * computed only once per window */
+static const char *
+get_window_process_match_key (BamfWindow *bamf_window)
+{
+  BamfLegacyWindow *window;
+  BamfProcessInfo *info;
+  GString *key;
+  char *value;
+
+  value = g_object_get_data (G_OBJECT (bamf_window), PROCESS_MATCH_KEY);
+
+  if (value)
+    return value;
+
+  window = bamf_window_get_window (bamf_window);
+  key = g_string_new (NULL);
+
+  append_match_key_field (key, bamf_legacy_window_get_exec_string (window));
+
+  value = bamf_legacy_window_get_process_name (window);
+  append_match_key_field (key, value);
+  g_free (value);
+
+  value = bamf_window_get_application_id (bamf_window);
+  append_match_key_field (key, value);
+  g_free (value);
+
+  info = bamf_process_info_get (bamf_legacy_window_get_pid (window));
+  append_match_key_field (key, info ? bamf_process_info_get_environ_value (info, ENV_DESKTOP_FILE_OVERRIDE) : NULL);
+
+  value = g_string_free (key, FALSE);
+  g_object_set_data_full (G_OBJECT (bamf_window), PROCESS_MATCH_KEY, value, g_free);
+
+  return value;
+}
+
+/* Windows sharing these values are always matched to the same desktop files,
+ * until the desktop files tables change */
+static char *
+get_window_match_key (BamfWindow *bamf_window)
+{
+  BamfLegacyWindow *window;
+  GString *key;
+  char *value;
+
+  window = bamf_window_get_window (bamf_window);
+  key = g_string_new (NULL);
+
+  /* These can be changed by the window at any time */
+  value = bamf_legacy_window_get_hint (window, _BAMF_DESKTOP_FILE);
+  append_match_key_field (key, value);
+  g_free (value);
+
+  append_match_key_field (key, bamf_legacy_window_get_class_name (window));
+  append_match_key_field (key, bamf_legacy_window_get_class_instance_name (window));
+  g_string_append (key, get_window_process_match_key (bamf_window));
+
+  return g_string_free (key, FALSE);
+}
+
+static GList *
+bamf_matcher_possible_applications_for_window (BamfMatcher *self,
+                                               BamfWindow *bamf_window,
+                                               const char **target_class_out,
+                                               BamfStatsMatch *match_out)
+{
+  BamfMatcherPrivate *priv;
+  PossibleApplications *possible_apps;
+  char *key;
+
+  g_return_val_if_fail (BAMF_IS_WINDOW (bamf_window), NULL);
+  g_return_val_if_fail (BAMF_IS_MATCHER (self), NULL);
+
+  priv = self->priv;
+  key = get_window_match_key (bamf_window);
+  possible_apps = g_hash_table_lookup (priv->possible_apps_cache, key);
+
+  if (possible_apps)
+    {
+      g_free (key);
+    }
+  else
+    {
+      if (g_hash_table_size (priv->possible_apps_cache) >= POSSIBLE_APPS_CACHE_SIZE)
+        g_hash_table_remove_all (priv->possible_apps_cache);
+
+      possible_apps = g_slice_new0 (PossibleApplications);
+      possible_apps->desktop_files =
+        bamf_matcher_find_possible_applications_for_window (self, bamf_window,
+                                                            &possible_apps->match);
+      g_hash_table_insert (priv->possible_apps_cache, key, possible_apps);
     }
 
   if (target_class_out)
     {
-      *target_class_out = target_class;
+      BamfLegacyWindow *window = bamf_window_get_window (bamf_window);
+      *target_class_out = bamf_matcher_get_window_target_class (self, window, NULL);
     }
 
-  return desktop_files;
+  if (match_out)
+    *match_out = possible_apps->match;
+
+  return g_list_copy_deep (possible_apps->desktop_files, (GCopyFunc) g_strdup, NULL);
 }
 
 static BamfApplication *
-bamf_matcher_get_application_for_window (BamfMatcher *self,
-                                         BamfWindow *bamf_window)
+bamf_matcher_match_application_for_window (BamfMatcher *self,
+                                           BamfWindow *bamf_window)
 {
   GList *possible_apps, *l;
   BamfLegacyWindow *window;
@@ -1872,9 +3154,7 @@ bamf_matcher_get_application_for_window (BamfMatcher *self,
   const gchar *app_class = NULL;
   const gchar *app_desktop = NULL;
   BamfApplication *app = NULL, *best = NULL;
-
-  g_return_val_if_fail (BAMF_IS_MATCHER (self), NULL);
-  g_return_val_if_fail (BAMF_IS_WINDOW (bamf_window), NULL);
+  BamfStatsMatch match = BAMF_STATS_MATCH_LAST;
 
   window = bamf_window_get_window (bamf_window);
 
@@ -1888,13 +3168,16 @@ bamf_matcher_get_application_for_window (BamfMatcher *self,
           app = bamf_matcher_get_application_by_xid (self, xid);
 
           if (BAMF_IS_APPLICATION (app))
-            return app;
+            {
+              bamf_stats_add_match (BAMF_STATS_MATCH_TRANSIENT);
+              return app;
+            }
         }
     }
 
   win_class_name = bamf_legacy_window_get_class_name (window);
 
-  possible_apps = bamf_matcher_possible_applications_for_window (self, bamf_window, &target_class);
+  possible_apps = bamf_matcher_possible_applications_for_window (self, bamf_window, &target_class, &match);
   app_class = target_class;
 
   /* Loop over every possible desktop file that could match the window, and try
@@ -2029,6 +3312,11 @@ bamf_matcher_get_application_for_window (BamfMatcher *self,
       g_free (trimmed_exec);
     }
 
+  if (possible_apps)
+    bamf_stats_add_match (match);
+  else
+    bamf_stats_add_match (best ? BAMF_STATS_MATCH_SECONDARY : BAMF_STATS_MATCH_NEW_APPLICATION);
+
   if (!best)
     {
       if (app_desktop)
@@ -2052,6 +3340,23 @@ bamf_matcher_get_application_for_window (BamfMatcher *self,
   return best;
 }
 
+static BamfApplication *
+bamf_matcher_get_application_for_window (BamfMatcher *self,
+                                         BamfWindow *bamf_window)
+{
+  BamfApplication *app;
+  gint64 start_time;
+
+  g_return_val_if_fail (BAMF_IS_MATCHER (self), NULL);
+  g_return_val_if_fail (BAMF_IS_WINDOW (bamf_window), NULL);
+
+  start_time = bamf_stats_timer_start ();
+  app = bamf_matcher_match_application_for_window (self, bamf_window);
+  bamf_stats_timer_stop (BAMF_STATS_TIMER_APPLICATION_FOR_WINDOW, start_time);
+
+  return app;
+}
+
 /* Ensures that the window hint is set if a registered pid matches, and that set window hints
    are already known to bamfdaemon */
 static void
@@ -2167,6 +3472,7 @@ static void
 on_raw_window_closed (BamfLegacyWindow *window, BamfMatcher* self)
 {
   g_signal_handlers_disconnect_by_data (window, self);
+  remove_pid_window (self, window);
 }
 
 static void
@@ -2174,16 +3480,17 @@ handle_raw_window (BamfMatcher *self, BamfLegacyWindow *window)
 {
   BamfWindow *bamf_win;
   BamfApplication *bamf_app;
+  gint64 start_time;
 
   g_return_if_fail (BAMF_IS_MATCHER (self));
   g_return_if_fail (BAMF_IS_LEGACY_WINDOW (window));
 
+  start_time = bamf_stats_timer_start ();
+
   g_signal_connect (window, "class-changed", G_CALLBACK (on_raw_window_class_changed), self);
   g_signal_connect (window, "closed", G_CALLBACK (on_raw_window_closed), self);
 
-  guint pid = bamf_legacy_window_get_pid (window);
-  if (pid > 1 && !g_list_find (self->priv->known_pids, GUINT_TO_POINTER (pid)))
-    self->priv->known_pids = g_list_prepend (self->priv->known_pids, GUINT_TO_POINTER (pid));
+  add_pid_window (self, window);
 
   ensure_window_hint_set (self, window);
 
@@ -2202,6 +3509,8 @@ handle_raw_window (BamfMatcher *self, BamfLegacyWindow *window)
     }
 
   bamf_view_add_child (BAMF_VIEW (bamf_app), BAMF_VIEW (bamf_win));
+
+  bamf_stats_timer_stop (BAMF_STATS_TIMER_HANDLE_WINDOW, start_time);
 }
 
 static char *
@@ -2262,11 +3571,27 @@ handle_window_opening_finished (BamfLegacyScreen *screen, const gchar *desktop_i
   bamf_matcher_set_starting_desktop_file (self, desktop_id, NULL, FALSE);
 }
 
+static void
+on_desktop_window_closed (BamfLegacyWindow *window, BamfMatcher *self)
+{
+  g_signal_handlers_disconnect_by_func (window, on_desktop_window_closed, self);
+  self->priv->desktop_windows = g_list_remove (self->priv->desktop_windows, window);
+}
+
 static void
 handle_window_opened (BamfLegacyScreen * screen, BamfLegacyWindow * window, BamfMatcher *self)
 {
   g_return_if_fail (BAMF_IS_MATCHER (self));
   g_return_if_fail (BAMF_IS_LEGACY_WINDOW (window));
+
+  if (!bamf_dbus_matcher_get_ready (BAMF_DBUS_MATCHER (self)))
+    {
+      /* Windows are matched once the desktop files have been loaded */
+      self->priv->queued_windows = g_list_append (self->priv->queued_windows,
+                                                  g_object_ref (window));
+      return;
+    }
+
   BamfWindowType win_type = bamf_legacy_window_get_window_type (window);
 
   if (win_type == BAMF_WINDOW_DESKTOP)
@@ -2274,6 +3599,10 @@ handle_window_opened (BamfLegacyScreen * screen, BamfLegacyWindow * window, Bamf
       BamfWindow *bamfwindow = bamf_window_new (window);
       bamf_matcher_register_view_stealing_ref (self, BAMF_VIEW (bamfwindow));
 
+      /* Not matched to any application, but their pid can still be registered */
+      self->priv->desktop_windows = g_list_prepend (self->priv->desktop_windows, window);
+      g_signal_connect (window, "closed", G_CALLBACK (on_desktop_window_closed), self);
+
       return;
     }
 
@@ -2305,29 +3634,24 @@ handle_window_opened (BamfLegacyScreen * screen, BamfLegacyWindow * window, Bamf
 static void
 handle_stacking_changed (BamfLegacyScreen * screen, BamfMatcher *self)
 {
+  invalidate_window_stacks (self);
   g_signal_emit_by_name (self, "stacking-order-changed");
 }
 
-void
-bamf_matcher_load_desktop_file (BamfMatcher * self,
-                                const char * desktop_file)
+static void
+handle_monitors_changed (GdkScreen *screen, BamfMatcher *self)
 {
-  GList *vl, *wl;
-
-  g_return_if_fail (BAMF_IS_MATCHER (self));
-
-  if (is_autostart_desktop_file (desktop_file))
-    return;
+  invalidate_window_stacks (self);
+}
 
-  load_desktop_file_to_table (self,
-                              desktop_file,
-                              self->priv->desktop_file_table,
-                              self->priv->desktop_id_table,
-                              self->priv->desktop_class_table);
+/* If an application with no .desktop file has windows that matches one of
+ * the new added .desktop files, then we try to re-match them. */
+static void
+rematch_desktopless_windows (BamfMatcher *self, GHashTable *desktop_files)
+{
+  GList *vl, *wl, *dl;
 
-  /* If an application with no .desktop file has windows that matches
-   * the new added .desktop file, then we try to re-match them.
-   * We use another list to save the windows that should be re-matched to avoid
+  /* We use another list to save the windows that should be re-matched to avoid
    * that the list that we're iterating is changed, since reopening a window
    * makes it to be removed from the views. */
   GList *to_rematch = NULL;
@@ -2349,12 +3673,16 @@ bamf_matcher_load_desktop_file (BamfMatcher * self,
                 continue;
 
               BamfWindow *win = BAMF_WINDOW (wl->data);
-              GList *desktops = bamf_matcher_possible_applications_for_window (self, win, NULL);
+              GList *desktops = bamf_matcher_possible_applications_for_window (self, win, NULL, NULL);
 
-              if (g_list_find_custom (desktops, desktop_file, (GCompareFunc) g_strcmp0))
+              for (dl = desktops; dl; dl = dl->next)
                 {
-                  BamfLegacyWindow *legacy_window = bamf_window_get_window (win);
-                  to_rematch = g_list_prepend (to_rematch, legacy_window);
+                  if (g_hash_table_contains (desktop_files, dl->data))
+                    {
+                      BamfLegacyWindow *legacy_window = bamf_window_get_window (win);
+                      to_rematch = g_list_prepend (to_rematch, legacy_window);
+                      break;
+                    }
                 }
 
               g_list_free_full (desktops, g_free);
@@ -2368,7 +3696,89 @@ bamf_matcher_load_desktop_file (BamfMatcher * self,
       bamf_legacy_window_reopen (legacy_window);
     }
 
-  g_list_free (to_rematch);
+  g_list_free (to_rematch);
+}
+
+void
+bamf_matcher_load_desktop_file (BamfMatcher * self,
+                                const char * desktop_file)
+{
+  GHashTable *desktop_files;
+
+  g_return_if_fail (BAMF_IS_MATCHER (self));
+
+  if (is_autostart_desktop_file (desktop_file))
+    return;
+
+  load_desktop_file_to_table (self,
+                              desktop_file,
+                              self->priv->desktop_file_table,
+                              self->priv->desktop_id_table,
+                              self->priv->desktop_class_table,
+                              self->priv->class_desktop_files_table);
+
+  desktop_files = g_hash_table_new (g_str_hash, g_str_equal);
+  g_hash_table_add (desktop_files, (gpointer) desktop_file);
+  rematch_desktopless_windows (self, desktop_files);
+  g_hash_table_destroy (desktop_files);
+}
+
+static gboolean
+on_pending_rematch_timeout (BamfMatcher *self)
+{
+  GHashTable *desktop_files = self->priv->pending_rematch_files;
+
+  self->priv->pending_rematch_files = NULL;
+  self->priv->pending_rematch_id = 0;
+
+  rematch_desktopless_windows (self, desktop_files);
+  g_hash_table_destroy (desktop_files);
+
+  return FALSE;
+}
+
+/* Monitored files are loaded as soon as they change, while the windows
+ * re-matching is done once for all the files added in a short interval,
+ * as packages installation generally adds many of them at once. */
+static void
+bamf_matcher_queue_desktop_file_rematch (BamfMatcher *self, const char *desktop_file)
+{
+  BamfMatcherPrivate *priv = self->priv;
+
+  if (!priv->pending_rematch_files)
+    {
+      priv->pending_rematch_files = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                           g_free, NULL);
+    }
+
+  g_hash_table_add (priv->pending_rematch_files, g_strdup (desktop_file));
+
+  if (priv->pending_rematch_id == 0)
+    {
+      priv->pending_rematch_id = g_timeout_add (REMATCH_BATCH_INTERVAL,
+                                                (GSourceFunc) on_pending_rematch_timeout,
+                                                self);
+    }
+}
+
+/* Like bamf_matcher_load_desktop_file, but the windows are re-matched later,
+ * together with the ones of the other files added meanwhile */
+void
+bamf_matcher_load_monitored_desktop_file (BamfMatcher *self, const char *desktop_file)
+{
+  g_return_if_fail (BAMF_IS_MATCHER (self));
+
+  if (is_autostart_desktop_file (desktop_file))
+    return;
+
+  load_desktop_file_to_table (self,
+                              desktop_file,
+                              self->priv->desktop_file_table,
+                              self->priv->desktop_id_table,
+                              self->priv->desktop_class_table,
+                              self->priv->class_desktop_files_table);
+
+  bamf_matcher_queue_desktop_file_rematch (self, desktop_file);
 }
 
 gboolean
@@ -2428,6 +3838,22 @@ is_valid_desktop_file (const gchar *desktop_file)
   return TRUE;
 }
 
+static gboolean
+window_descends_from_pid (BamfMatcher *self, BamfLegacyWindow *window, guint64 pid)
+{
+  GList *tree;
+  gboolean found;
+
+  if (bamf_legacy_window_get_pid (window) < 2)
+    return FALSE;
+
+  tree = pid_parent_tree (self, bamf_legacy_window_get_pid (window));
+  found = (g_list_find (tree, GUINT_TO_POINTER (pid)) != NULL);
+  g_list_free (tree);
+
+  return found;
+}
+
 gboolean
 is_visible_desktop_file (BamfMatcher *self,
                          const gchar *desktop_file)
@@ -2450,9 +3876,7 @@ bamf_matcher_register_desktop_file_for_pid (BamfMatcher * self,
                                             guint64 pid)
 {
   gpointer key;
-  BamfLegacyScreen *screen;
-  GList *windows, *pids, *l, *ll;
-  gboolean matching_window_found;
+  GList *children, *l;
 
   g_return_if_fail (BAMF_IS_MATCHER (self));
   g_return_if_fail (desktop_file);
@@ -2463,36 +3887,38 @@ bamf_matcher_register_desktop_file_for_pid (BamfMatcher * self,
   key = GUINT_TO_POINTER (pid);
   g_hash_table_insert (self->priv->registered_pids, key, g_strdup (desktop_file));
 
-  screen = bamf_legacy_screen_get_default ();
-  g_return_if_fail (BAMF_IS_LEGACY_SCREEN (screen));
-
-  windows = bamf_legacy_screen_get_windows (screen);
-  matching_window_found = FALSE;
+  /* Only the windows whose process descends from pid are affected */
+  children = g_hash_table_lookup (get_pid_children_table (self), key);
 
-  for (l = windows; l; l = l->next)
+  for (l = children; l; l = l->next)
     {
-      BamfLegacyWindow *window = l->data;
+      GList *windows = g_hash_table_lookup (self->priv->windows_by_pid, l->data);
 
-      if (!BAMF_IS_LEGACY_WINDOW (window))
-        continue;
-
-      pids = pid_parent_tree (self, bamf_legacy_window_get_pid (window));
-
-      for (ll = pids; ll; ll = ll->next)
+      if (windows && BAMF_IS_LEGACY_WINDOW (windows->data))
         {
-          if (pid == GPOINTER_TO_UINT (ll->data))
-            {
-              matching_window_found = TRUE;
-              break;
-            }
+          ensure_window_hint_set (self, windows->data);
+          return;
         }
+    }
 
-      g_list_free (pids);
+  /* Desktop windows are never matched, so they aren't indexed by pid */
+  for (l = self->priv->desktop_windows; l; l = l->next)
+    {
+      if (window_descends_from_pid (self, l->data, pid))
+        {
+          ensure_window_hint_set (self, l->data);
+          return;
+        }
+    }
 
-      if (matching_window_found)
+  /* The windows waiting for the desktop files to be loaded aren't indexed */
+  for (l = self->priv->queued_windows; l; l = l->next)
+    {
+      if (!bamf_legacy_window_is_closed (l->data) &&
+          window_descends_from_pid (self, l->data, pid))
         {
-          ensure_window_hint_set (self, window);
-          break;
+          ensure_window_hint_set (self, l->data);
+          return;
         }
     }
 }
@@ -2618,56 +4044,110 @@ bamf_matcher_application_for_xid (BamfMatcher *matcher,
   return "";
 }
 
+typedef struct
+{
+  BamfWindow *window;
+  gint position;
+} StackedWindow;
+
 static gint
 compare_windows_by_stack_order (gconstpointer a, gconstpointer b)
 {
-  g_return_val_if_fail (BAMF_IS_WINDOW (a), -1);
-  g_return_val_if_fail (BAMF_IS_WINDOW (b), 1);
+  const StackedWindow *stacked_a = a;
+  const StackedWindow *stacked_b = b;
 
-  gint idx_a = bamf_window_get_stack_position (BAMF_WINDOW (a));
-  gint idx_b = bamf_window_get_stack_position (BAMF_WINDOW (b));
+  if (stacked_a->position != stacked_b->position)
+    return (stacked_a->position < stacked_b->position) ? -1 : 1;
 
-  return (idx_a < idx_b) ? -1 : 1;
+  return 0;
 }
 
-GVariant *
-bamf_matcher_get_window_stack_for_monitor (BamfMatcher *matcher, gint monitor)
+/* Windows are sorted once per stacking, windows or monitors change, using
+ * their position in the (already sorted) legacy screen windows list, and
+ * the windows not in it at the bottom, as bamf_window_get_stack_position
+ * would do. Stacks are then split by monitor. */
+static void
+ensure_window_stacks (BamfMatcher *self)
 {
+  BamfMatcherPrivate *priv = self->priv;
+  BamfLegacyScreen *screen;
+  GHashTable *positions;
+  GArray *stacked;
   GList *l;
-  GList *windows;
-  BamfView *view;
-  GVariantBuilder b;
+  gint position;
+  guint i;
 
-  g_return_val_if_fail (BAMF_IS_MATCHER (matcher), NULL);
+  if (priv->window_stack)
+    return;
+
+  screen = bamf_legacy_screen_get_default ();
+  positions = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  for (l = bamf_legacy_screen_get_windows (screen), position = 0; l; l = l->next, ++position)
+    g_hash_table_insert (positions, l->data, GINT_TO_POINTER (position + 1));
 
-  windows = NULL;
-  for (l = matcher->priv->views; l; l = l->next)
+  stacked = g_array_new (FALSE, FALSE, sizeof (StackedWindow));
+
+  for (l = priv->views; l; l = l->next)
     {
-      if (BAMF_IS_WINDOW (l->data))
-        {
-          windows = g_list_insert_sorted (windows, l->data,
-                                          compare_windows_by_stack_order);
-        }
+      StackedWindow stacked_window;
+
+      if (!BAMF_IS_WINDOW (l->data))
+        continue;
+
+      stacked_window.window = l->data;
+      stacked_window.position = GPOINTER_TO_INT (g_hash_table_lookup (positions,
+                                  bamf_window_get_window (stacked_window.window))) - 1;
+      g_array_append_val (stacked, stacked_window);
     }
 
-  g_variant_builder_init (&b, G_VARIANT_TYPE ("(as)"));
-  g_variant_builder_open (&b, G_VARIANT_TYPE ("as"));
+  g_array_sort (stacked, compare_windows_by_stack_order);
+  priv->window_stack = g_ptr_array_sized_new (stacked->len);
 
-  for (l = windows; l; l = l->next)
+  for (i = 0; i < stacked->len; ++i)
     {
-      view = l->data;
+      BamfWindow *window = g_array_index (stacked, StackedWindow, i).window;
+      gpointer monitor = GINT_TO_POINTER (bamf_window_get_monitor (window));
+      GPtrArray *monitor_stack;
 
-      if (!BAMF_IS_WINDOW (view))
-        continue;
+      g_ptr_array_add (priv->window_stack, window);
+      monitor_stack = g_hash_table_lookup (priv->monitor_window_stacks, monitor);
 
-      if ((monitor >= 0 && bamf_window_get_monitor (BAMF_WINDOW (view)) == monitor) ||
-          monitor < 0)
-      {
-        g_variant_builder_add (&b, "s", bamf_view_get_path (view));
-      }
+      if (!monitor_stack)
+        {
+          monitor_stack = g_ptr_array_new ();
+          g_hash_table_insert (priv->monitor_window_stacks, monitor, monitor_stack);
+        }
+
+      g_ptr_array_add (monitor_stack, window);
     }
 
-  g_list_free (windows);
+  g_array_free (stacked, TRUE);
+  g_hash_table_destroy (positions);
+}
+
+GVariant *
+bamf_matcher_get_window_stack_for_monitor (BamfMatcher *matcher, gint monitor)
+{
+  GPtrArray *windows;
+  GVariantBuilder b;
+  guint i;
+
+  g_return_val_if_fail (BAMF_IS_MATCHER (matcher), NULL);
+
+  ensure_window_stacks (matcher);
+
+  if (monitor < 0)
+    windows = matcher->priv->window_stack;
+  else
+    windows = g_hash_table_lookup (matcher->priv->monitor_window_stacks, GINT_TO_POINTER (monitor));
+
+  g_variant_builder_init (&b, G_VARIANT_TYPE ("(as)"));
+  g_variant_builder_open (&b, G_VARIANT_TYPE ("as"));
+
+  for (i = 0; windows && i < windows->len; ++i)
+    g_variant_builder_add (&b, "s", bamf_view_get_path (g_ptr_array_index (windows, i)));
+
   g_variant_builder_close (&b);
 
   return g_variant_builder_end (&b);
@@ -2721,6 +4201,221 @@ bamf_matcher_window_dbus_paths (BamfMatcher *matcher)
   return g_variant_builder_end (&b);
 }
 
+GVariant *
+bamf_matcher_get_state (BamfMatcher *matcher)
+{
+  GList *l;
+  BamfView *view;
+  BamfMatcherPrivate *priv;
+  GVariantBuilder b;
+
+  g_return_val_if_fail (BAMF_IS_MATCHER (matcher), NULL);
+
+  g_variant_builder_init (&b, G_VARIANT_TYPE ("(a(ssa{sv}as)t)"));
+  g_variant_builder_open (&b, G_VARIANT_TYPE ("a(ssa{sv}as)"));
+
+  priv = matcher->priv;
+
+  for (l = g_list_last (priv->views); l; l = l->prev)
+    {
+      view = l->data;
+
+      if (!bamf_view_get_path (view))
+        continue;
+
+      g_variant_builder_add_value (&b, bamf_view_get_state (view));
+    }
+
+  g_variant_builder_close (&b);
+  g_variant_builder_add (&b, "t", priv->generation);
+
+  return g_variant_builder_end (&b);
+}
+
+typedef struct
+{
+  ViewEventType  change;
+  const gchar  * type;
+  gboolean       existed;
+  GHashTable   * properties;
+  GHashTable   * children;
+} ViewDelta;
+
+static void
+view_delta_free (ViewDelta *delta)
+{
+  g_hash_table_destroy (delta->properties);
+  g_hash_table_destroy (delta->children);
+  g_slice_free (ViewDelta, delta);
+}
+
+static GVariant *
+view_delta_to_variant (BamfMatcher *self, const gchar *path, ViewDelta *delta)
+{
+  GVariantBuilder props_builder, added_builder, removed_builder;
+  GVariant *state, *props, *children, *value, *result;
+  GHashTableIter iter;
+  gpointer key, event_type;
+  const gchar *type;
+  BamfView *view;
+
+  if (delta->change == VIEW_EVENT_CLOSED)
+    {
+      /* Views that have been opened and closed meanwhile are not relevant,
+       * but paths are stable so a known view may be closed after reopening */
+      if (!delta->existed)
+        return NULL;
+
+      return g_variant_new ("(sssa{sv}asas)", path, delta->type ? delta->type : "",
+                            "closed", NULL, NULL, NULL);
+    }
+
+  view = g_hash_table_lookup (self->priv->views_by_path, path);
+
+  if (!view)
+    return NULL;
+
+  state = g_variant_ref_sink (bamf_view_get_state (view));
+  g_variant_get (state, "(&s&s@a{sv}@as)", NULL, &type, &props, &children);
+
+  if (delta->change == VIEW_EVENT_OPENED)
+    {
+      result = g_variant_new ("(sss@a{sv}@asas)", path, type, "opened",
+                              props, children, NULL);
+    }
+  else
+    {
+      g_variant_builder_init (&props_builder, G_VARIANT_TYPE ("a{sv}"));
+      g_variant_builder_init (&added_builder, G_VARIANT_TYPE ("as"));
+      g_variant_builder_init (&removed_builder, G_VARIANT_TYPE ("as"));
+
+      /* Only the current values matter, no matter how many times they changed */
+      g_hash_table_iter_init (&iter, delta->properties);
+
+      while (g_hash_table_iter_next (&iter, &key, NULL))
+        {
+          value = g_variant_lookup_value (props, key, NULL);
+
+          if (value)
+            {
+              g_variant_builder_add (&props_builder, "{sv}", key, value);
+              g_variant_unref (value);
+            }
+        }
+
+      g_hash_table_iter_init (&iter, delta->children);
+
+      while (g_hash_table_iter_next (&iter, &key, &event_type))
+        {
+          if (GPOINTER_TO_INT (event_type) == VIEW_EVENT_CHILD_ADDED)
+            g_variant_builder_add (&added_builder, "s", key);
+          else
+            g_variant_builder_add (&removed_builder, "s", key);
+        }
+
+      result = g_variant_new ("(sssa{sv}asas)", path, type, "changed",
+                              &props_builder, &added_builder, &removed_builder);
+    }
+
+  g_variant_unref (props);
+  g_variant_unref (children);
+  g_variant_unref (state);
+
+  return result;
+}
+
+GVariant *
+bamf_matcher_get_changes_since (BamfMatcher *matcher, guint64 generation)
+{
+  BamfMatcherPrivate *priv;
+  GHashTable *deltas;
+  GPtrArray *paths;
+  GVariantBuilder b;
+  gboolean complete;
+  GList *l;
+  guint i;
+
+  g_return_val_if_fail (BAMF_IS_MATCHER (matcher), NULL);
+
+  priv = matcher->priv;
+
+  /* Clients that are too far behind (or ahead, after a daemon restart) must
+   * fetch the whole state again using GetState */
+  complete = (generation >= priv->dropped_generation && generation <= priv->generation);
+
+  g_variant_builder_init (&b, G_VARIANT_TYPE ("a(sssa{sv}asas)"));
+
+  if (!complete)
+    return g_variant_new ("(tba(sssa{sv}asas))", priv->generation, complete, &b);
+
+  /* Events are compacted per view, keeping the order of their first change */
+  deltas = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                  (GDestroyNotify) view_delta_free);
+  paths = g_ptr_array_new ();
+
+  for (l = g_queue_peek_tail_link (priv->view_events); l; l = l->prev)
+    {
+      ViewEvent *event = l->data;
+
+      if (event->generation <= generation)
+        break;
+    }
+
+  for (l = l ? l->next : g_queue_peek_head_link (priv->view_events); l; l = l->next)
+    {
+      ViewEvent *event = l->data;
+      ViewDelta *delta = g_hash_table_lookup (deltas, event->path);
+
+      if (!delta)
+        {
+          delta = g_slice_new0 (ViewDelta);
+          delta->change = VIEW_EVENT_PROPERTY_CHANGED;
+          delta->existed = (event->type != VIEW_EVENT_OPENED);
+          delta->properties = g_hash_table_new (g_str_hash, g_str_equal);
+          delta->children = g_hash_table_new (g_str_hash, g_str_equal);
+          g_hash_table_insert (deltas, event->path, delta);
+          g_ptr_array_add (paths, event->path);
+        }
+
+      switch (event->type)
+        {
+          case VIEW_EVENT_OPENED:
+            delta->change = VIEW_EVENT_OPENED;
+            break;
+          case VIEW_EVENT_CLOSED:
+            delta->change = VIEW_EVENT_CLOSED;
+            delta->type = event->detail;
+            break;
+          case VIEW_EVENT_PROPERTY_CHANGED:
+            g_hash_table_add (delta->properties, event->detail);
+            break;
+          case VIEW_EVENT_CHILD_ADDED:
+          case VIEW_EVENT_CHILD_REMOVED:
+            g_hash_table_insert (delta->children, event->detail,
+                                 GINT_TO_POINTER (event->type));
+            break;
+        }
+    }
+
+  for (i = 0; i < paths->len; ++i)
+    {
+      const gchar *path = g_ptr_array_index (paths, i);
+      GVariant *change;
+
+      change = view_delta_to_variant (matcher, path, g_hash_table_lookup (deltas, path));
+
+      if (change)
+        g_variant_builder_add_value (&b, change);
+    }
+
+  g_ptr_array_free (paths, TRUE);
+  g_hash_table_destroy (deltas);
+
+  /* The deltas report the current state, so the generation is taken once
+   * they are built */
+  return g_variant_new ("(tba(sssa{sv}asas))", priv->generation, TRUE, &b);
+}
+
 GVariant *
 bamf_matcher_application_dbus_paths (BamfMatcher *matcher)
 {
@@ -3104,37 +4799,99 @@ on_dbus_handle_window_stack_for_monitor (BamfDBusMatcher *interface,
   return TRUE;
 }
 
+static gboolean
+on_dbus_handle_get_state (BamfDBusMatcher *interface,
+                          GDBusMethodInvocation *invocation,
+                          BamfMatcher *self)
+{
+  GVariant *state = bamf_matcher_get_state (self);
+
+  g_dbus_method_invocation_return_value (invocation, state);
+
+  return TRUE;
+}
+
+static gboolean
+on_dbus_handle_get_changes_since (BamfDBusMatcher *interface,
+                                  GDBusMethodInvocation *invocation,
+                                  guint64 generation,
+                                  BamfMatcher *self)
+{
+  GVariant *changes = bamf_matcher_get_changes_since (self, generation);
+
+  g_dbus_method_invocation_return_value (invocation, changes);
+
+  return TRUE;
+}
+
+static gboolean
+on_dbus_handle_subscribe_views_changed (BamfDBusMatcher *interface,
+                                        GDBusMethodInvocation *invocation,
+                                        BamfMatcher *self)
+{
+  const gchar *sender = g_dbus_method_invocation_get_sender (invocation);
+
+  bamf_matcher_subscribe_views_changed (self, sender ? sender : "");
+  g_dbus_method_invocation_return_value (invocation, NULL);
+
+  return TRUE;
+}
+
+static gboolean
+on_dbus_handle_unsubscribe_views_changed (BamfDBusMatcher *interface,
+                                          GDBusMethodInvocation *invocation,
+                                          BamfMatcher *self)
+{
+  const gchar *sender = g_dbus_method_invocation_get_sender (invocation);
+
+  bamf_matcher_unsubscribe_views_changed (self, sender ? sender : "");
+  g_dbus_method_invocation_return_value (invocation, NULL);
+
+  return TRUE;
+}
+
 static void
 bamf_matcher_init (BamfMatcher * self)
 {
   BamfMatcherPrivate *priv;
   BamfLegacyScreen *screen;
-  int i;
 
   priv = self->priv = BAMF_MATCHER_GET_PRIVATE (self);
 
-  priv->bad_prefixes = g_array_sized_new (FALSE, TRUE, sizeof (GRegex *),
-                                          G_N_ELEMENTS (EXEC_BAD_PREFIXES));
-  priv->good_prefixes = g_array_sized_new (FALSE, TRUE, sizeof (GRegex *),
-                                           G_N_ELEMENTS (EXEC_GOOD_PREFIXES));
+  priv->bad_prefixes = build_exec_prefixes_regex (EXEC_BAD_PREFIXES,
+                                                  G_N_ELEMENTS (EXEC_BAD_PREFIXES));
+  priv->good_prefixes = build_exec_prefixes_regex (EXEC_GOOD_PREFIXES,
+                                                   G_N_ELEMENTS (EXEC_GOOD_PREFIXES));
+  priv->bad_suffixes = g_regex_new (EXEC_BAD_SUFIXES, G_REGEX_OPTIMIZE, 0, NULL);
   priv->registered_pids = g_hash_table_new_full (g_direct_hash, g_direct_equal,
                                                  NULL, g_free);
-
-  for (i = 0; i < G_N_ELEMENTS (EXEC_BAD_PREFIXES); ++i)
-    {
-      GRegex *regex = g_regex_new (EXEC_BAD_PREFIXES[i], G_REGEX_OPTIMIZE, 0, NULL);
-      g_array_append_val (priv->bad_prefixes, regex);
-    }
-
-  for (i = 0; i < G_N_ELEMENTS (EXEC_GOOD_PREFIXES); ++i)
-    {
-      GRegex *regex = g_regex_new (EXEC_GOOD_PREFIXES[i], G_REGEX_OPTIMIZE, 0, NULL);
-      g_array_append_val (priv->good_prefixes, regex);
-    }
+  priv->views_by_path = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                               g_free, NULL);
+  priv->windows_by_xid = g_hash_table_new (g_direct_hash, g_direct_equal);
+  priv->monitor_window_stacks = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                                                       (GDestroyNotify) g_ptr_array_unref);
+  priv->view_changes_table = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                    (GDestroyNotify) g_hash_table_destroy);
+  priv->views_changed_subscribers = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                           unwatch_views_changed_subscriber);
+  priv->view_events = g_queue_new ();
+  priv->windows_by_pid = g_hash_table_new (g_direct_hash, g_direct_equal);
+  priv->possible_apps_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                     (GDestroyNotify) possible_applications_free);
+  priv->pid_parent_trees = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                  NULL, (GDestroyNotify) g_list_free);
+  priv->applications_by_desktop_file = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                              g_free, NULL);
+  priv->desktop_file_refs_table = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                         g_free, NULL);
 
   create_desktop_file_table (self, &(priv->desktop_file_table),
                              &(priv->desktop_id_table),
-                             &(priv->desktop_class_table));
+                             &(priv->desktop_class_table),
+                             &(priv->class_desktop_files_table));
+
+  if (!lazy_loading)
+    bamf_dbus_matcher_set_ready (BAMF_DBUS_MATCHER (self), TRUE);
 
   screen = bamf_legacy_screen_get_default ();
   g_signal_connect (G_OBJECT (screen), BAMF_LEGACY_SCREEN_SIGNAL_WINDOW_OPENING,
@@ -3152,6 +4909,12 @@ bamf_matcher_init (BamfMatcher * self)
   g_signal_connect (G_OBJECT (screen), BAMF_LEGACY_SCREEN_SIGNAL_STACKING_CHANGED,
                     G_CALLBACK (handle_stacking_changed), self);
 
+  if (gdk_screen_get_default ())
+    {
+      g_signal_connect (G_OBJECT (gdk_screen_get_default ()), "monitors-changed",
+                        G_CALLBACK (handle_monitors_changed), self);
+    }
+
   XSetErrorHandler (x_error_handler);
 
   /* Registering signal callbacks to reply to dbus method calls */
@@ -3193,6 +4956,18 @@ bamf_matcher_init (BamfMatcher * self)
 
   g_signal_connect (self, "handle-window-stack-for-monitor",
                     G_CALLBACK (on_dbus_handle_window_stack_for_monitor), self);
+
+  g_signal_connect (self, "handle-get-state",
+                    G_CALLBACK (on_dbus_handle_get_state), self);
+
+  g_signal_connect (self, "handle-get-changes-since",
+                    G_CALLBACK (on_dbus_handle_get_changes_since), self);
+
+  g_signal_connect (self, "handle-subscribe-views-changed",
+                    G_CALLBACK (on_dbus_handle_subscribe_views_changed), self);
+
+  g_signal_connect (self, "handle-unsubscribe-views-changed",
+                    G_CALLBACK (on_dbus_handle_unsubscribe_views_changed), self);
 }
 
 static void
@@ -3216,27 +4991,24 @@ bamf_matcher_finalize (GObject *object)
   BamfMatcherPrivate *priv = self->priv;
   BamfLegacyScreen *screen = bamf_legacy_screen_get_default ();
   GList *l;
-  int i;
 
-  for (i = 0; i < priv->bad_prefixes->len; i++)
-    {
-      GRegex *regex = g_array_index (priv->bad_prefixes, GRegex *, i);
-      g_regex_unref (regex);
-    }
+  g_regex_unref (priv->bad_prefixes);
+  g_regex_unref (priv->good_prefixes);
+  g_regex_unref (priv->bad_suffixes);
+  bamf_matcher_free_desktop_file_tables (self);
+  g_hash_table_destroy (priv->registered_pids);
+  g_hash_table_destroy (priv->views_by_path);
+  g_hash_table_destroy (priv->windows_by_xid);
+  g_hash_table_destroy (priv->applications_by_desktop_file);
+  g_list_free_full (priv->queued_windows, g_object_unref);
 
-  for (i = 0; i < priv->good_prefixes->len; i++)
-    {
-      GRegex *regex = g_array_index (priv->good_prefixes, GRegex *, i);
-      g_regex_unref (regex);
-    }
+  for (l = priv->desktop_windows; l; l = l->next)
+    g_signal_handlers_disconnect_by_func (l->data, on_desktop_window_closed, self);
 
-  g_array_free (priv->bad_prefixes, TRUE);
-  g_array_free (priv->good_prefixes, TRUE);
-  g_hash_table_destroy (priv->desktop_id_table);
-  g_hash_table_destroy (priv->desktop_file_table);
-  g_hash_table_destroy (priv->desktop_class_table);
-  g_hash_table_destroy (priv->registered_pids);
-  g_list_free (priv->no_display_desktop);
+  g_list_free (priv->desktop_windows);
+
+  if (priv->queued_monitor_events)
+    g_queue_free_full (priv->queued_monitor_events, (GDestroyNotify) monitor_event_free);
 
   if (priv->opened_closed_paths_table)
     {
@@ -3249,11 +5021,41 @@ bamf_matcher_finalize (GObject *object)
       priv->dispatch_changes_id = 0;
     }
 
-  g_list_free (priv->known_pids);
+  if (priv->pending_rematch_id != 0)
+    {
+      g_source_remove (priv->pending_rematch_id);
+      priv->pending_rematch_id = 0;
+    }
+
+  bamf_matcher_clear_view_changes (self);
+  g_hash_table_destroy (priv->view_changes_table);
+  g_hash_table_destroy (priv->views_changed_subscribers);
+  g_queue_free_full (priv->view_events, (GDestroyNotify) view_event_free);
+
+  if (priv->pending_rematch_files)
+    {
+      g_hash_table_destroy (priv->pending_rematch_files);
+      priv->pending_rematch_files = NULL;
+    }
+
+  free_lists_table (priv->windows_by_pid);
+  g_hash_table_destroy (priv->possible_apps_cache);
+  g_hash_table_destroy (priv->pid_parent_trees);
+  g_clear_pointer (&priv->pid_children, free_lists_table);
+
+  for (l = priv->views; l; l = l->next)
+    g_signal_handlers_disconnect_by_data (G_OBJECT (l->data), self);
+
   g_list_free_full (priv->views, g_object_unref);
 
   g_signal_handlers_disconnect_by_data (screen, self);
 
+  if (gdk_screen_get_default ())
+    g_signal_handlers_disconnect_by_data (gdk_screen_get_default (), self);
+
+  g_clear_pointer (&priv->window_stack, g_ptr_array_unref);
+  g_hash_table_destroy (priv->monitor_window_stacks);
+
   for (l = priv->monitors; l; l = l->next)
     g_signal_handlers_disconnect_by_data (G_OBJECT (l->data), self);
 
@@ -3285,6 +5087,12 @@ bamf_matcher_class_init (BamfMatcherClass * klass)
                   G_TYPE_NONE, 0);
 }
 
+void
+bamf_matcher_set_lazy_loading (gboolean lazy)
+{
+  lazy_loading = lazy;
+}
+
 BamfMatcher *
 bamf_matcher_get_default (void)
 {
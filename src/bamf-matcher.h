@@ -113,6 +113,17 @@ GVariant    * bamf_matcher_xids_for_application          (BamfMatcher *matcher,
 GVariant    * bamf_matcher_get_window_stack_for_monitor  (BamfMatcher *matcher,
                                                           gint monitor);
 
+GVariant    * bamf_matcher_get_state                     (BamfMatcher *matcher);
+
+GVariant    * bamf_matcher_get_changes_since             (BamfMatcher *matcher,
+                                                          guint64 generation);
+
+void          bamf_matcher_subscribe_views_changed       (BamfMatcher *matcher,
+                                                          const char *subscriber);
+
+void          bamf_matcher_unsubscribe_views_changed     (BamfMatcher *matcher,
+                                                          const char *subscriber);
+
 gboolean      bamf_matcher_is_valid_process_prefix       (BamfMatcher *matcher,
                                                           const char *process_name);
 
@@ -125,6 +136,8 @@ char        * bamf_matcher_get_trimmed_exec              (BamfMatcher *matcher,
 BamfView    * bamf_matcher_get_view_by_path              (BamfMatcher *matcher,
                                                           const char *view_path);
 
+void          bamf_matcher_set_lazy_loading              (gboolean lazy);
+
 BamfMatcher * bamf_matcher_get_default                   (void);
 
 #endif
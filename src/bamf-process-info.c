@@ -0,0 +1,460 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+#include "bamf-process-info.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <libgtop-2.0/glibtop.h>
+#include <glibtop/procargs.h>
+
+#define SNAP_SECURITY_LABEL_PREFIX "snap."
+
+/* Index of the ppid and starttime fields of /proc/<pid>/stat, counting
+ * from the one following the process name */
+#define STAT_PPID_FIELD 1
+#define STAT_START_TIME_FIELD 19
+
+struct _BamfProcessInfo
+{
+  guint        pid;
+  guint        ppid;
+  guint64      start_time;
+  guint        holds;
+  gchar      * name;
+  gchar      * exec_string;
+  gchar      * application_id;
+  GHashTable * environ_values;
+  gboolean     exec_string_loaded;
+  gboolean     application_id_loaded;
+};
+
+static GHashTable *process_info_table = NULL;
+
+/* The pids of the infos that have no holds, they're kept only until a
+ * window-holding process is released. Getting them always reads their stat
+ * again, so what's kept is only their lazily loaded data (exec, environ...) */
+static GHashTable *unheld_pids = NULL;
+
+static void
+bamf_process_info_free (BamfProcessInfo *info)
+{
+  if (info->environ_values)
+    g_hash_table_destroy (info->environ_values);
+
+  g_free (info->name);
+  g_free (info->exec_string);
+  g_free (info->application_id);
+  g_slice_free (BamfProcessInfo, info);
+}
+
+static gboolean
+read_proc_stat (guint pid, gchar **name, guint *ppid, guint64 *start_time)
+{
+  gchar *stat_path;
+  gchar *contents;
+  gchar *name_start, *name_end;
+  gchar **fields;
+  gboolean valid = FALSE;
+
+  stat_path = g_strdup_printf ("/proc/%u/stat", pid);
+
+  if (!g_file_get_contents (stat_path, &contents, NULL, NULL))
+    {
+      g_free (stat_path);
+      return FALSE;
+    }
+
+  /* The process name is between parentheses, and may contain spaces too */
+  name_start = strchr (contents, '(');
+  name_end = strrchr (contents, ')');
+
+  if (name_start && name_end && name_end > name_start && name_end[1] == ' ')
+    {
+      fields = g_strsplit (name_end + 2, " ", STAT_START_TIME_FIELD + 2);
+
+      if (g_strv_length (fields) > STAT_START_TIME_FIELD)
+        {
+          *name = g_strndup (name_start + 1, name_end - name_start - 1);
+          *ppid = strtoul (fields[STAT_PPID_FIELD], NULL, 10);
+          *start_time = g_ascii_strtoull (fields[STAT_START_TIME_FIELD], NULL, 10);
+          valid = TRUE;
+        }
+
+      g_strfreev (fields);
+    }
+
+  g_free (contents);
+  g_free (stat_path);
+
+  return valid;
+}
+
+BamfProcessInfo *
+bamf_process_info_get (guint pid)
+{
+  BamfProcessInfo *info;
+  gchar *name;
+  guint ppid;
+  guint64 start_time;
+
+  if (pid < 1)
+    return NULL;
+
+  if (!process_info_table)
+    {
+      process_info_table = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                                                  (GDestroyNotify) bamf_process_info_free);
+      unheld_pids = g_hash_table_new (g_direct_hash, g_direct_equal);
+    }
+
+  info = g_hash_table_lookup (process_info_table, GUINT_TO_POINTER (pid));
+
+  /* A process that has windows can't be replaced by another one */
+  if (info && info->holds > 0)
+    return info;
+
+  if (!read_proc_stat (pid, &name, &ppid, &start_time))
+    {
+      if (info)
+        {
+          g_hash_table_remove (process_info_table, GUINT_TO_POINTER (pid));
+          g_hash_table_remove (unheld_pids, GUINT_TO_POINTER (pid));
+        }
+
+      return NULL;
+    }
+
+  if (info && info->start_time == start_time)
+    {
+      g_free (name);
+      return info;
+    }
+
+  info = g_slice_new0 (BamfProcessInfo);
+  info->pid = pid;
+  info->ppid = ppid;
+  info->start_time = start_time;
+  info->name = name;
+
+  g_hash_table_insert (process_info_table, GUINT_TO_POINTER (pid), info);
+  g_hash_table_add (unheld_pids, GUINT_TO_POINTER (pid));
+
+  return info;
+}
+
+static gboolean
+refresh_ppid (BamfProcessInfo *info)
+{
+  gchar *name;
+  guint ppid;
+  guint64 start_time;
+
+  if (!read_proc_stat (info->pid, &name, &ppid, &start_time))
+    return FALSE;
+
+  g_free (name);
+
+  if (start_time != info->start_time)
+    return FALSE;
+
+  info->ppid = ppid;
+
+  return TRUE;
+}
+
+BamfProcessInfo *
+bamf_process_info_get_parent (BamfProcessInfo *info)
+{
+  BamfProcessInfo *parent;
+  guint ppid;
+
+  g_return_val_if_fail (info, NULL);
+
+  ppid = info->ppid;
+  parent = bamf_process_info_get (ppid);
+
+  /* A parent always starts before its children, so if it's gone or its pid
+   * has been reused the process has been reparented meanwhile */
+  if (!parent || parent->start_time > info->start_time)
+    {
+      if (!refresh_ppid (info) || info->ppid == ppid)
+        return NULL;
+
+      parent = bamf_process_info_get (info->ppid);
+    }
+
+  return parent;
+}
+
+gboolean
+bamf_process_info_hold (guint pid)
+{
+  BamfProcessInfo *info = bamf_process_info_get (pid);
+
+  if (!info)
+    return FALSE;
+
+  if (info->holds++ == 0)
+    g_hash_table_remove (unheld_pids, GUINT_TO_POINTER (pid));
+
+  return TRUE;
+}
+
+static gboolean
+remove_unheld_info (gpointer pid, gpointer value, gpointer data)
+{
+  g_hash_table_remove (process_info_table, pid);
+
+  return TRUE;
+}
+
+void
+bamf_process_info_release (guint pid)
+{
+  BamfProcessInfo *info;
+
+  if (!process_info_table)
+    return;
+
+  info = g_hash_table_lookup (process_info_table, GUINT_TO_POINTER (pid));
+
+  if (!info || info->holds == 0)
+    return;
+
+  --info->holds;
+
+  /* Once a process has no windows we don't care about it anymore, nor about
+   * the other processes (i.e. the parents) that have been checked meanwhile */
+  if (info->holds == 0)
+    {
+      g_hash_table_add (unheld_pids, GUINT_TO_POINTER (pid));
+      g_hash_table_foreach_remove (unheld_pids, remove_unheld_info, NULL);
+    }
+}
+
+guint
+bamf_process_info_get_pid (BamfProcessInfo *info)
+{
+  g_return_val_if_fail (info, 0);
+
+  return info->pid;
+}
+
+guint
+bamf_process_info_get_ppid (BamfProcessInfo *info)
+{
+  g_return_val_if_fail (info, 0);
+
+  return info->ppid;
+}
+
+guint64
+bamf_process_info_get_start_time (BamfProcessInfo *info)
+{
+  g_return_val_if_fail (info, 0);
+
+  return info->start_time;
+}
+
+const gchar *
+bamf_process_info_get_name (BamfProcessInfo *info)
+{
+  g_return_val_if_fail (info, NULL);
+
+  return info->name;
+}
+
+const gchar *
+bamf_process_info_get_exec_string (BamfProcessInfo *info)
+{
+  gchar **argv;
+  glibtop_proc_args buffer;
+
+  g_return_val_if_fail (info, NULL);
+
+  if (!info->exec_string_loaded)
+    {
+      argv = glibtop_get_proc_argv (&buffer, info->pid, 0);
+
+      if (argv)
+        info->exec_string = g_strstrip (g_strjoinv (" ", argv));
+
+      info->exec_string_loaded = TRUE;
+      g_strfreev (argv);
+    }
+
+  return info->exec_string;
+}
+
+static gchar *
+read_environ_value (guint pid, const gchar *variable)
+{
+  gchar *environ_file;
+  gchar *environ;
+  gchar *prefix;
+  gchar *result;
+  gsize file_len;
+  gsize i;
+
+  environ = NULL;
+  result = NULL;
+  environ_file = g_strdup_printf ("/proc/%u/environ", pid);
+  prefix = g_strconcat (variable, "=", NULL);
+
+  if (g_file_get_contents (environ_file, &environ, &file_len, NULL))
+    {
+      for (i = 0; i < file_len && environ && environ[i] != '\0'; i += strlen (environ + i) + 1)
+        {
+          const gchar *var = environ + i;
+
+          if (g_str_has_prefix (var, prefix))
+            {
+              result = g_strdup (var + strlen (prefix));
+              break;
+            }
+        }
+    }
+
+  g_free (environ);
+  g_free (environ_file);
+  g_free (prefix);
+
+  return result;
+}
+
+const gchar *
+bamf_process_info_get_environ_value (BamfProcessInfo *info, const gchar *variable)
+{
+  gpointer value;
+
+  g_return_val_if_fail (info, NULL);
+  g_return_val_if_fail (variable, NULL);
+
+  if (!info->environ_values)
+    info->environ_values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  if (!g_hash_table_lookup_extended (info->environ_values, variable, NULL, &value))
+    {
+      value = read_environ_value (info->pid, variable);
+      g_hash_table_insert (info->environ_values, g_strdup (variable), value);
+    }
+
+  return value;
+}
+
+static char *
+get_snap_desktop_id (guint pid)
+{
+  char *security_label_filename = NULL;
+  char *security_label_contents = NULL;
+  gsize i, security_label_contents_size = 0;
+  char *contents_start;
+  char *contents_end;
+  char *sandboxed_app_id;
+
+  g_return_val_if_fail (pid != 0, NULL);
+
+  security_label_filename = g_strdup_printf ("/proc/%u/attr/current", pid);
+
+  if (!g_file_get_contents (security_label_filename,
+                            &security_label_contents,
+                            &security_label_contents_size,
+                            NULL))
+    {
+      g_free (security_label_filename);
+      return NULL;
+    }
+
+  if (!g_str_has_prefix (security_label_contents, SNAP_SECURITY_LABEL_PREFIX))
+    {
+      g_free (security_label_filename);
+      g_free (security_label_contents);
+      return NULL;
+    }
+
+  /* We need to translate the security profile into the desktop-id.
+   * The profile is in the form of 'snap.name-space.binary-name (current)'
+   * while the desktop id will be name-space_binary-name.
+   */
+  security_label_contents_size -= sizeof (SNAP_SECURITY_LABEL_PREFIX) - 1;
+  contents_start = security_label_contents + sizeof (SNAP_SECURITY_LABEL_PREFIX) - 1;
+  contents_end = strchr (contents_start, ' ');
+
+  if (contents_end)
+    security_label_contents_size = contents_end - contents_start;
+
+  for (i = 0; i < security_label_contents_size; ++i)
+    {
+      if (contents_start[i] == '.')
+        contents_start[i] = '_';
+    }
+
+  sandboxed_app_id = g_malloc0 (security_label_contents_size + 1);
+  memcpy (sandboxed_app_id, contents_start, security_label_contents_size);
+
+  g_free (security_label_filename);
+  g_free (security_label_contents);
+
+  return sandboxed_app_id;
+}
+
+static char *
+get_flatpak_desktop_id (guint pid)
+{
+  GKeyFile *key_file = NULL;
+  char *info_filename = NULL;
+  char *app_id = NULL;
+
+  g_return_val_if_fail (pid != 0, NULL);
+
+  key_file = g_key_file_new ();
+  info_filename = g_strdup_printf ("/proc/%u/root/.flatpak-info", pid);
+
+  if (!g_key_file_load_from_file (key_file, info_filename, G_KEY_FILE_NONE, NULL))
+    {
+      g_key_file_free (key_file);
+      g_free (info_filename);
+      return NULL;
+    }
+
+  app_id = g_key_file_get_string (key_file, "Application", "name", NULL);
+
+  g_key_file_free (key_file);
+  g_free (info_filename);
+
+  return app_id;
+}
+
+const gchar *
+bamf_process_info_get_application_id (BamfProcessInfo *info)
+{
+  g_return_val_if_fail (info, NULL);
+
+  if (!info->application_id_loaded)
+    {
+      info->application_id = get_snap_desktop_id (info->pid);
+
+      if (!info->application_id)
+        info->application_id = get_flatpak_desktop_id (info->pid);
+
+      info->application_id_loaded = TRUE;
+    }
+
+  return info->application_id;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __BAMF_PROCESS_INFO_H__
+#define __BAMF_PROCESS_INFO_H__
+
+#include <glib.h>
+
+typedef struct _BamfProcessInfo BamfProcessInfo;
+
+/* Process data is read from /proc only once per pid and shared by all the
+ * windows of a process. Data is kept as long as the pid is held (i.e. while
+ * it has windows), otherwise it's validated against the process start time
+ * so that a reused pid is never confused with a previous process. */
+BamfProcessInfo * bamf_process_info_get                (guint pid);
+
+/* The ppid of a held process is re-read when its parent has gone, as the
+ * process has been reparented; use this rather than getting the ppid info */
+BamfProcessInfo * bamf_process_info_get_parent         (BamfProcessInfo *info);
+
+/* Holding fails if the process doesn't exist, in such case don't release it */
+gboolean          bamf_process_info_hold               (guint pid);
+void              bamf_process_info_release            (guint pid);
+
+guint             bamf_process_info_get_pid            (BamfProcessInfo *info);
+guint             bamf_process_info_get_ppid           (BamfProcessInfo *info);
+guint64           bamf_process_info_get_start_time     (BamfProcessInfo *info);
+const gchar     * bamf_process_info_get_name           (BamfProcessInfo *info);
+const gchar     * bamf_process_info_get_exec_string    (BamfProcessInfo *info);
+const gchar     * bamf_process_info_get_environ_value  (BamfProcessInfo *info,
+                                                        const gchar *variable);
+const gchar     * bamf_process_info_get_application_id (BamfProcessInfo *info);
+
+#endif
@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+#include "bamf-stats.h"
+
+#include <string.h>
+
+G_DEFINE_TYPE (BamfStats, bamf_stats, BAMF_DBUS_TYPE_STATS_SKELETON);
+
+/* Durations are stored in power of two buckets of microseconds, so the
+ * bucket N holds the values in the [2^(N-1), 2^N) range */
+#define HISTOGRAM_BUCKETS 40
+
+typedef struct
+{
+  guint64 buckets[HISTOGRAM_BUCKETS];
+  guint64 count;
+  guint64 total;
+  guint64 max;
+} TimerHistogram;
+
+static const gchar *TIMER_NAMES[] =
+{
+  "HandleWindow",
+  "ApplicationForWindow",
+  "LoadDesktopFiles",
+  "MonitorChanged",
+};
+
+static const gchar *MATCH_NAMES[] =
+{
+  "Hint",
+  "Environment",
+  "Exec",
+  "ApplicationId",
+  "Class",
+  "Process",
+  "Transient",
+  "Secondary",
+  "NewApplication",
+};
+
+G_STATIC_ASSERT (G_N_ELEMENTS (TIMER_NAMES) == BAMF_STATS_TIMER_LAST);
+G_STATIC_ASSERT (G_N_ELEMENTS (MATCH_NAMES) == BAMF_STATS_MATCH_LAST);
+
+static TimerHistogram timers[BAMF_STATS_TIMER_LAST];
+static guint64 matches[BAMF_STATS_MATCH_LAST];
+
+gint64
+bamf_stats_timer_start (void)
+{
+  return g_get_monotonic_time ();
+}
+
+void
+bamf_stats_timer_stop (BamfStatsTimer timer, gint64 start)
+{
+  TimerHistogram *histogram;
+  guint64 duration;
+  guint bucket = 0;
+
+  g_return_if_fail (timer < BAMF_STATS_TIMER_LAST);
+
+  histogram = &timers[timer];
+  duration = MAX (g_get_monotonic_time () - start, 0);
+
+  while (bucket < HISTOGRAM_BUCKETS - 1 && (duration >> bucket) > 0)
+    ++bucket;
+
+  histogram->buckets[bucket]++;
+  histogram->count++;
+  histogram->total += duration;
+  histogram->max = MAX (histogram->max, duration);
+}
+
+void
+bamf_stats_add_match (BamfStatsMatch match)
+{
+  g_return_if_fail (match < BAMF_STATS_MATCH_LAST);
+
+  matches[match]++;
+}
+
+guint64
+bamf_stats_get_timer_count (BamfStatsTimer timer)
+{
+  g_return_val_if_fail (timer < BAMF_STATS_TIMER_LAST, 0);
+
+  return timers[timer].count;
+}
+
+/* Returns the upper bound of the bucket containing the percentile, which
+ * is never greater than the maximum registered value */
+guint64
+bamf_stats_get_timer_percentile (BamfStatsTimer timer, guint percentile)
+{
+  TimerHistogram *histogram;
+  guint64 target, count = 0;
+  guint i;
+
+  g_return_val_if_fail (timer < BAMF_STATS_TIMER_LAST, 0);
+  g_return_val_if_fail (percentile <= 100, 0);
+
+  histogram = &timers[timer];
+
+  if (histogram->count == 0)
+    return 0;
+
+  target = MAX ((histogram->count * percentile + 99) / 100, 1);
+
+  for (i = 0; i < HISTOGRAM_BUCKETS; ++i)
+    {
+      count += histogram->buckets[i];
+
+      if (count >= target)
+        return MIN ((G_GUINT64_CONSTANT (1) << i) - 1, histogram->max);
+    }
+
+  return histogram->max;
+}
+
+guint64
+bamf_stats_get_match_count (BamfStatsMatch match)
+{
+  g_return_val_if_fail (match < BAMF_STATS_MATCH_LAST, 0);
+
+  return matches[match];
+}
+
+void
+bamf_stats_reset (void)
+{
+  memset (timers, 0, sizeof (timers));
+  memset (matches, 0, sizeof (matches));
+}
+
+static gboolean
+on_dbus_handle_timings (BamfDBusStats *interface,
+                        GDBusMethodInvocation *invocation,
+                        BamfStats *self)
+{
+  GVariantBuilder builder;
+  guint i;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sttttt)"));
+
+  for (i = 0; i < BAMF_STATS_TIMER_LAST; ++i)
+    {
+      TimerHistogram *histogram = &timers[i];
+
+      g_variant_builder_add (&builder, "(sttttt)", TIMER_NAMES[i], histogram->count,
+                             histogram->count ? histogram->total / histogram->count : 0,
+                             bamf_stats_get_timer_percentile (i, 50),
+                             bamf_stats_get_timer_percentile (i, 99),
+                             histogram->max);
+    }
+
+  bamf_dbus_stats_complete_timings (interface, invocation,
+                                    g_variant_builder_end (&builder));
+
+  return TRUE;
+}
+
+static gboolean
+on_dbus_handle_matches (BamfDBusStats *interface,
+                        GDBusMethodInvocation *invocation,
+                        BamfStats *self)
+{
+  GVariantBuilder builder;
+  guint i;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{st}"));
+
+  for (i = 0; i < BAMF_STATS_MATCH_LAST; ++i)
+    g_variant_builder_add (&builder, "{st}", MATCH_NAMES[i], matches[i]);
+
+  bamf_dbus_stats_complete_matches (interface, invocation,
+                                    g_variant_builder_end (&builder));
+
+  return TRUE;
+}
+
+static gboolean
+on_dbus_handle_reset (BamfDBusStats *interface,
+                      GDBusMethodInvocation *invocation,
+                      BamfStats *self)
+{
+  bamf_stats_reset ();
+  bamf_dbus_stats_complete_reset (interface, invocation);
+
+  return TRUE;
+}
+
+static void
+bamf_stats_init (BamfStats *self)
+{
+  g_signal_connect (self, "handle-timings",
+                    G_CALLBACK (on_dbus_handle_timings), self);
+
+  g_signal_connect (self, "handle-matches",
+                    G_CALLBACK (on_dbus_handle_matches), self);
+
+  g_signal_connect (self, "handle-reset",
+                    G_CALLBACK (on_dbus_handle_reset), self);
+}
+
+static void
+bamf_stats_class_init (BamfStatsClass *klass)
+{
+}
+
+BamfStats *
+bamf_stats_get_default (void)
+{
+  static BamfStats *stats;
+
+  if (!BAMF_IS_STATS (stats))
+    {
+      stats = (BamfStats *) g_object_new (BAMF_TYPE_STATS, NULL);
+    }
+
+  return stats;
+}
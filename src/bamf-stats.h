@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __BAMFSTATS_H__
+#define __BAMFSTATS_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include <libbamf-private/bamf-private.h>
+
+#define BAMF_TYPE_STATS                       (bamf_stats_get_type ())
+#define BAMF_STATS(obj)                       (G_TYPE_CHECK_INSTANCE_CAST ((obj), BAMF_TYPE_STATS, BamfStats))
+#define BAMF_IS_STATS(obj)                    (G_TYPE_CHECK_INSTANCE_TYPE ((obj), BAMF_TYPE_STATS))
+#define BAMF_STATS_CLASS(klass)               (G_TYPE_CHECK_CLASS_CAST ((klass), BAMF_TYPE_STATS, BamfStatsClass))
+#define BAMF_IS_STATS_CLASS(klass)            (G_TYPE_CHECK_CLASS_TYPE ((klass), BAMF_TYPE_STATS))
+#define BAMF_STATS_GET_CLASS(obj)             (G_TYPE_INSTANCE_GET_CLASS ((obj), BAMF_TYPE_STATS, BamfStatsClass))
+
+typedef struct _BamfStats BamfStats;
+typedef struct _BamfStatsClass BamfStatsClass;
+
+struct _BamfStatsClass
+{
+  BamfDBusStatsSkeletonClass parent;
+};
+
+struct _BamfStats
+{
+  BamfDBusStatsSkeleton parent;
+};
+
+typedef enum
+{
+  BAMF_STATS_TIMER_HANDLE_WINDOW = 0,
+  BAMF_STATS_TIMER_APPLICATION_FOR_WINDOW,
+  BAMF_STATS_TIMER_LOAD_DESKTOP_FILES,
+  BAMF_STATS_TIMER_MONITOR_CHANGED,
+  BAMF_STATS_TIMER_LAST
+} BamfStatsTimer;
+
+typedef enum
+{
+  BAMF_STATS_MATCH_HINT = 0,
+  BAMF_STATS_MATCH_ENV,
+  BAMF_STATS_MATCH_EXEC,
+  BAMF_STATS_MATCH_APP_ID,
+  BAMF_STATS_MATCH_CLASS,
+  BAMF_STATS_MATCH_PROCESS,
+  BAMF_STATS_MATCH_TRANSIENT,
+  BAMF_STATS_MATCH_SECONDARY,
+  BAMF_STATS_MATCH_NEW_APPLICATION,
+  BAMF_STATS_MATCH_LAST
+} BamfStatsMatch;
+
+GType       bamf_stats_get_type             (void) G_GNUC_CONST;
+
+BamfStats * bamf_stats_get_default          (void);
+
+/* Timers values are monotonic time stamps, as got from bamf_stats_timer_start */
+gint64      bamf_stats_timer_start          (void);
+void        bamf_stats_timer_stop           (BamfStatsTimer timer, gint64 start);
+
+void        bamf_stats_add_match            (BamfStatsMatch match);
+
+guint64     bamf_stats_get_timer_count      (BamfStatsTimer timer);
+guint64     bamf_stats_get_timer_percentile (BamfStatsTimer timer, guint percentile);
+guint64     bamf_stats_get_match_count      (BamfStatsMatch match);
+
+void        bamf_stats_reset                (void);
+
+#endif
@@ -60,6 +60,23 @@ bamf_tab_get_stable_bus_name (BamfView *view)
   return g_strdup_printf ("tab/%u", GPOINTER_TO_UINT (view));
 }
 
+static void
+bamf_tab_state_properties (BamfView *view, GVariantBuilder *properties)
+{
+  BamfTab *self = BAMF_TAB (view);
+  const gchar *location = bamf_tab_get_location (self);
+  const gchar *desktop_id = bamf_tab_get_desktop_id (self);
+
+  g_variant_builder_add (properties, "{sv}", "location",
+                         g_variant_new_string (location ? location : ""));
+  g_variant_builder_add (properties, "{sv}", "xid",
+                         g_variant_new_uint64 (bamf_tab_get_xid (self)));
+  g_variant_builder_add (properties, "{sv}", "desktop-id",
+                         g_variant_new_string (desktop_id ? desktop_id : ""));
+  g_variant_builder_add (properties, "{sv}", "is-foreground-tab",
+                         g_variant_new_boolean (bamf_tab_get_is_foreground_tab (self)));
+}
+
 static void
 bamf_tab_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
 {
@@ -202,6 +219,7 @@ bamf_tab_class_init (BamfTabClass * klass)
   object_class->finalize = bamf_tab_finalize;
   view_class->view_type = bamf_tab_get_view_type;
   view_class->stable_bus_name = bamf_tab_get_stable_bus_name;
+  view_class->state_properties = bamf_tab_state_properties;
 
   g_object_class_override_property (object_class, PROP_LOCATION, "location");
   g_object_class_override_property (object_class, PROP_DESKTOP_ID, "desktop-id");
@@ -185,6 +185,8 @@ bamf_view_starting_changed (BamfView *view, gboolean starting)
 
   if (starting)
     priv->starting_timeout = g_timeout_add_seconds (STARTING_MAX_WAIT, on_starting_timeout, view);
+
+  g_object_notify (G_OBJECT (view), "starting");
 }
 
 static void
@@ -578,6 +580,53 @@ bamf_view_get_view_type (BamfView *view)
   return "view";
 }
 
+/* Returns the view path, type, the values of its D-Bus properties (plus the
+ * ones that each view type adds) and its children paths, matching the
+ * items of the GetState matcher method */
+GVariant *
+bamf_view_get_state (BamfView *view)
+{
+  GVariantBuilder properties;
+  GVariantBuilder children;
+  const char *name, *icon;
+  GList *l;
+
+  g_return_val_if_fail (BAMF_IS_VIEW (view), NULL);
+
+  name = bamf_view_get_name (view);
+  icon = bamf_view_get_icon (view);
+
+  g_variant_builder_init (&properties, G_VARIANT_TYPE_VARDICT);
+  g_variant_builder_add (&properties, "{sv}", "Name", g_variant_new_string (name ? name : ""));
+  g_variant_builder_add (&properties, "{sv}", "Icon", g_variant_new_string (icon ? icon : ""));
+  g_variant_builder_add (&properties, "{sv}", "UserVisible",
+                         g_variant_new_boolean (bamf_view_is_user_visible (view)));
+  g_variant_builder_add (&properties, "{sv}", "Running",
+                         g_variant_new_boolean (bamf_view_is_running (view)));
+  g_variant_builder_add (&properties, "{sv}", "Starting",
+                         g_variant_new_boolean (bamf_view_is_starting (view)));
+  g_variant_builder_add (&properties, "{sv}", "Urgent",
+                         g_variant_new_boolean (bamf_view_is_urgent (view)));
+  g_variant_builder_add (&properties, "{sv}", "Active",
+                         g_variant_new_boolean (bamf_view_is_active (view)));
+
+  if (BAMF_VIEW_GET_CLASS (view)->state_properties)
+    BAMF_VIEW_GET_CLASS (view)->state_properties (view, &properties);
+
+  g_variant_builder_init (&children, G_VARIANT_TYPE_STRING_ARRAY);
+
+  for (l = view->priv->children; l; l = l->next)
+    {
+      const char *path = bamf_view_get_path (l->data);
+
+      if (path)
+        g_variant_builder_add (&children, "s", path);
+    }
+
+  return g_variant_new ("(ssa{sv}as)", view->priv->path ? view->priv->path : "",
+                        bamf_view_get_view_type (view), &properties, &children);
+}
+
 static char *
 bamf_view_get_stable_bus_name (BamfView *view)
 {
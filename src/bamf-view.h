@@ -48,6 +48,7 @@ struct _BamfViewClass
   /*< methods >*/
   const char * (*view_type)         (BamfView *view);
   char *       (*stable_bus_name)   (BamfView *view);
+  void         (*state_properties)  (BamfView *view, GVariantBuilder *properties);
 
   /*< random stuff >*/
   gboolean (* urgent_changed)       (BamfView *view, gboolean urgent);
@@ -117,6 +118,8 @@ void          bamf_view_set_parent         (BamfView *view, BamfView *parent);
 
 const char  * bamf_view_get_view_type      (BamfView *view);
 
+GVariant    * bamf_view_get_state          (BamfView *view);
+
 gboolean      bamf_view_is_on_bus          (BamfView *view);
 const char  * bamf_view_export_on_bus      (BamfView *view,
                                             GDBusConnection *connection);
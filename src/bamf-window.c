@@ -20,6 +20,7 @@
 #include "bamf-application.h"
 #include "bamf-window.h"
 #include "bamf-legacy-screen.h"
+#include "bamf-process-info.h"
 
 #include <glib.h>
 #include <string.h>
@@ -31,7 +32,6 @@
 #endif
 
 #define _GTK_APPLICATION_ID "_GTK_APPLICATION_ID"
-#define SNAP_SECURITY_LABEL_PREFIX "snap."
 
 #define BAMF_WINDOW_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE(obj, \
 BAMF_TYPE_WINDOW, BamfWindowPrivate))
@@ -241,110 +241,20 @@ bamf_window_get_string_hint (BamfWindow *self, const char* prop)
   return bamf_legacy_window_get_hint (self->priv->legacy_window, prop);
 }
 
-static char *
-get_snap_desktop_id (guint pid)
-{
-  char *security_label_filename = NULL;
-  char *security_label_contents = NULL;
-  gsize i, security_label_contents_size = 0;
-  char *contents_start;
-  char *contents_end;
-  char *sandboxed_app_id;
-
-  g_return_val_if_fail (pid != 0, NULL);
-
-  security_label_filename = g_strdup_printf ("/proc/%u/attr/current", pid);
-
-  if (!g_file_get_contents (security_label_filename,
-                            &security_label_contents,
-                            &security_label_contents_size,
-                            NULL))
-    {
-      g_free (security_label_filename);
-      return NULL;
-    }
-
-  if (!g_str_has_prefix (security_label_contents, SNAP_SECURITY_LABEL_PREFIX))
-    {
-      g_free (security_label_filename);
-      g_free (security_label_contents);
-      return NULL;
-    }
-
-  /* We need to translate the security profile into the desktop-id.
-   * The profile is in the form of 'snap.name-space.binary-name (current)'
-   * while the desktop id will be name-space_binary-name.
-   */
-  security_label_contents_size -= sizeof (SNAP_SECURITY_LABEL_PREFIX) - 1;
-  contents_start = security_label_contents + sizeof (SNAP_SECURITY_LABEL_PREFIX) - 1;
-  contents_end = strchr (contents_start, ' ');
-
-  if (contents_end)
-    security_label_contents_size = contents_end - contents_start;
-
-  for (i = 0; i < security_label_contents_size; ++i)
-    {
-      if (contents_start[i] == '.')
-        contents_start[i] = '_';
-    }
-
-  sandboxed_app_id = g_malloc0 (security_label_contents_size + 1);
-  memcpy (sandboxed_app_id, contents_start, security_label_contents_size);
-
-  g_free (security_label_filename);
-  g_free (security_label_contents);
-
-  return sandboxed_app_id;
-}
-
-static char *
-get_flatpak_desktop_id (guint pid)
-{
-  GKeyFile *key_file = NULL;
-  char *info_filename = NULL;
-  char *app_id = NULL;
-
-  g_return_val_if_fail (pid != 0, NULL);
-
-  key_file = g_key_file_new ();
-  info_filename = g_strdup_printf ("/proc/%u/root/.flatpak-info", pid);
-
-  if (!g_key_file_load_from_file (key_file, info_filename, G_KEY_FILE_NONE, NULL))
-    {
-      g_free (info_filename);
-      return NULL;
-    }
-
-  app_id = g_key_file_get_string (key_file, "Application", "name", NULL);
-
-  g_key_file_free (key_file);
-  g_free (info_filename);
-
-  return app_id;
-}
-
 char *
 bamf_window_get_application_id (BamfWindow *self)
 {
+  BamfProcessInfo *info;
   guint pid;
   char *app_id;
 
   g_return_val_if_fail (BAMF_IS_WINDOW (self), NULL);
 
   pid = bamf_window_get_pid (self);
+  info = bamf_process_info_get (pid);
 
-  if (pid > 0)
-    {
-      app_id = get_snap_desktop_id (pid);
-
-      if (app_id)
-        return app_id;
-
-      app_id = get_flatpak_desktop_id (pid);
-
-      if (app_id)
-        return app_id;
-    }
+  if (info && bamf_process_info_get_application_id (info))
+    return g_strdup (bamf_process_info_get_application_id (info));
 
   app_id = bamf_window_get_string_hint (self, _GTK_APPLICATION_ID);
 
@@ -449,6 +359,23 @@ bamf_window_active_changed (BamfView *view, gboolean active)
 }
 #endif
 
+static void
+bamf_window_state_properties (BamfView *view, GVariantBuilder *properties)
+{
+  BamfWindow *self = BAMF_WINDOW (view);
+
+  g_variant_builder_add (properties, "{sv}", "Xid",
+                         g_variant_new_uint32 (bamf_window_get_xid (self)));
+  g_variant_builder_add (properties, "{sv}", "Pid",
+                         g_variant_new_uint32 (bamf_window_get_pid (self)));
+  g_variant_builder_add (properties, "{sv}", "WindowType",
+                         g_variant_new_uint32 (bamf_window_get_window_type (self)));
+  g_variant_builder_add (properties, "{sv}", "Monitor",
+                         g_variant_new_int32 (bamf_window_get_monitor (self)));
+  g_variant_builder_add (properties, "{sv}", "Maximized",
+                         g_variant_new_int32 (bamf_window_maximized (self)));
+}
+
 static gboolean
 on_dbus_handle_get_pid (BamfDBusItemWindow *interface,
                         GDBusMethodInvocation *invocation,
@@ -717,6 +644,7 @@ bamf_window_class_init (BamfWindowClass * klass)
   object_class->constructed   = bamf_window_constructed;
   view_class->view_type       = bamf_window_get_view_type;
   view_class->stable_bus_name = bamf_window_get_stable_bus_name;
+  view_class->state_properties = bamf_window_state_properties;
 #ifdef EXPORT_ACTIONS_MENU
   view_class->active_changed  = bamf_window_active_changed;
 #endif
@@ -20,136 +20,466 @@
 
 #include "bamf-xutils.h"
 #include <X11/Xatom.h>
+#include <X11/Xlib-xcb.h>
 #include <string.h>
+#include <stdlib.h>
+
+static GHashTable *atoms_table = NULL;
+static GHashTable *atom_names_table = NULL;
+
+/* Used when there's no GDK display (i.e. in tools and tests), it's opened
+ * once and shared by all the calls, as each connection costs a handshake */
+static Display *fallback_xdisplay = NULL;
+static gboolean fallback_xdisplay_failed = FALSE;
 
 static Display *
-get_xdisplay (gboolean *opened)
+get_xdisplay (void)
 {
   Display *xdisplay;
   xdisplay = gdk_x11_get_default_xdisplay ();
 
-  if (opened)
-    *opened = FALSE;
+  if (xdisplay)
+    return xdisplay;
 
-  if (!xdisplay)
+  if (fallback_xdisplay && xcb_connection_has_error (XGetXCBConnection (fallback_xdisplay)))
+    {
+      g_warning ("%s: The X connection has been lost, reopening it", G_STRFUNC);
+      XCloseDisplay (fallback_xdisplay);
+      fallback_xdisplay = NULL;
+      fallback_xdisplay_failed = FALSE;
+
+      /* The server might have been reset, so the atoms are not valid anymore */
+      g_clear_pointer (&atom_names_table, g_hash_table_destroy);
+      g_clear_pointer (&atoms_table, g_hash_table_destroy);
+    }
+
+  if (!fallback_xdisplay && !fallback_xdisplay_failed)
     {
-      xdisplay = XOpenDisplay (NULL);
+      fallback_xdisplay = XOpenDisplay (NULL);
 
-      if (xdisplay)
+      /* Don't try again on each call, it might take long to fail */
+      if (!fallback_xdisplay)
         {
-          if (opened)
-            *opened = TRUE;
+          g_warning ("%s: Impossible to open the X display %s", G_STRFUNC, XDisplayName (NULL));
+          fallback_xdisplay_failed = TRUE;
         }
     }
 
-  return xdisplay;
+  return fallback_xdisplay;
 }
 
-static gboolean
-gdk_error_trap_pop_and_print (Display *dpy)
+static void
+print_xcb_error (Display *dpy, xcb_generic_error_t *error)
 {
-  gdk_flush ();
-  gint error_code = gdk_error_trap_pop ();
+  gchar tmp[1024];
 
-  if (error_code)
-    {
-      gchar tmp[1024];
-      XGetErrorText (dpy, error_code, tmp, sizeof (tmp) - 1);
-      tmp[sizeof (tmp) - 1] = '\0';
+  XGetErrorText (dpy, error->error_code, tmp, sizeof (tmp) - 1);
+  tmp[sizeof (tmp) - 1] = '\0';
+
+  g_warning ("Got an X error: %s\n", tmp);
+}
+
+/* Atoms that the daemon always needs, interned all at once at startup */
+static const char *known_atom_names[] =
+{
+  "UTF8_STRING",
+  "WM_CLASS",
+  "WM_WINDOW_ROLE",
+  "_BAMF_DESKTOP_FILE",
+  "_GTK_APPLICATION_ID",
+  "_COMPIZ_TOOLKIT_ACTION",
+  "_COMPIZ_TOOLKIT_ACTION_WINDOW_MENU",
+  "_NET_CLIENT_LIST_STACKING",
+  "_NET_ACTIVE_WINDOW",
+  "_NET_WM_NAME",
+  "_NET_WM_PID",
+  "_NET_WM_STATE",
+  "_NET_WM_STATE_DEMANDS_ATTENTION",
+  "_NET_WM_STATE_SKIP_TASKBAR",
+  "_NET_WM_STATE_MAXIMIZED_HORZ",
+  "_NET_WM_STATE_MAXIMIZED_VERT",
+  "_NET_WM_WINDOW_TYPE",
+  "_NET_WM_WINDOW_TYPE_NORMAL",
+  "_NET_WM_WINDOW_TYPE_DESKTOP",
+  "_NET_WM_WINDOW_TYPE_DOCK",
+  "_NET_WM_WINDOW_TYPE_DIALOG",
+  "_NET_WM_WINDOW_TYPE_TOOLBAR",
+  "_NET_WM_WINDOW_TYPE_MENU",
+  "_NET_WM_WINDOW_TYPE_UTILITY",
+  "_NET_WM_WINDOW_TYPE_SPLASH",
+  "WM_NAME",
+  "WM_HINTS",
+  "WM_TRANSIENT_FOR",
+};
+
+static void
+cache_atom (const char *atom_name, Atom atom)
+{
+  if (g_hash_table_contains (atoms_table, atom_name))
+    return;
+
+  g_hash_table_insert (atoms_table, g_strdup (atom_name), GUINT_TO_POINTER (atom));
+  g_hash_table_replace (atom_names_table, GUINT_TO_POINTER (atom), g_strdup (atom_name));
+}
+
+static void
+intern_known_atoms (Display *xdisplay)
+{
+  Atom atoms[G_N_ELEMENTS (known_atom_names)];
+  guint i;
 
-      g_warning ("Got an X error: %s\n", tmp);
+  if (atoms_table)
+    return;
+
+  atoms_table = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  atom_names_table = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
 
-      return TRUE;
+  if (!XInternAtoms (xdisplay, (char **) known_atom_names,
+                     G_N_ELEMENTS (known_atom_names), False, atoms))
+    {
+      g_warning ("%s: Impossible to intern the known atoms", G_STRFUNC);
+      return;
     }
 
-  return FALSE;
+  for (i = 0; i < G_N_ELEMENTS (known_atom_names); ++i)
+    {
+      if (atoms[i] != None)
+        cache_atom (known_atom_names[i], atoms[i]);
+    }
 }
 
+/* Resolves the atoms from the cache, the missing ones are requested at once.
+ * When only_if_exists is set, atoms are never created on the server (a
+ * property can't be set on an atom that doesn't exist) and None is returned
+ * for them; such results are not cached, as the atom could be created later */
 static void
-bamf_xutils_get_string_window_hint_and_type (Window xid, const char *atom_name,
-                                             gchar** return_hint, Atom* return_type)
+lookup_atoms (Display *xdisplay, guint n_atoms, const char **atom_names,
+              gboolean only_if_exists, Atom *atoms)
 {
-  Display *XDisplay;
-  gint format;
-  gulong numItems;
-  gulong bytesAfter;
-  Atom type;
-  unsigned char *buffer;
-  gboolean close_display;
+  xcb_connection_t *xcb = NULL;
+  xcb_intern_atom_cookie_t *cookies = NULL;
+  xcb_intern_atom_reply_t *reply;
+  GHashTable *requested = NULL;
+  gpointer value;
+  guint i;
 
-  if (return_hint)
-    *return_hint = NULL;
+  intern_known_atoms (xdisplay);
 
-  if (return_type)
-    *return_type = AnyPropertyType;
+  for (i = 0; i < n_atoms; ++i)
+    {
+      atoms[i] = None;
 
-  g_return_if_fail (xid != 0);
-  g_return_if_fail (return_hint || return_type);
+      if (!atom_names[i])
+        continue;
 
-  close_display = FALSE;
-  XDisplay = get_xdisplay (&close_display);
+      if (g_hash_table_lookup_extended (atoms_table, atom_names[i], NULL, &value))
+        {
+          atoms[i] = GPOINTER_TO_UINT (value);
+          continue;
+        }
 
-  if (!XDisplay)
+      if (!cookies)
+        {
+          xcb = XGetXCBConnection (xdisplay);
+          cookies = g_new0 (xcb_intern_atom_cookie_t, n_atoms);
+          requested = g_hash_table_new (g_str_hash, g_str_equal);
+        }
+
+      /* Names repeated in the same batch are requested only once, the others
+       * are resolved from the first reply */
+      if (g_hash_table_contains (requested, atom_names[i]))
+        continue;
+
+      g_hash_table_add (requested, (gpointer) atom_names[i]);
+      cookies[i] = xcb_intern_atom (xcb, only_if_exists, strlen (atom_names[i]),
+                                    atom_names[i]);
+    }
+
+  if (!cookies)
+    return;
+
+  for (i = 0; i < n_atoms; ++i)
+    {
+      if (cookies[i].sequence == 0)
+        continue;
+
+      reply = xcb_intern_atom_reply (xcb, cookies[i], NULL);
+
+      if (reply && reply->atom != XCB_ATOM_NONE)
+        {
+          atoms[i] = reply->atom;
+          cache_atom (atom_names[i], atoms[i]);
+        }
+
+      free (reply);
+    }
+
+  for (i = 0; i < n_atoms; ++i)
+    {
+      if (atoms[i] == None && atom_names[i] && cookies[i].sequence == 0)
+        atoms[i] = GPOINTER_TO_UINT (g_hash_table_lookup (atoms_table, atom_names[i]));
+    }
+
+  g_hash_table_destroy (requested);
+  g_free (cookies);
+}
+
+static Atom
+lookup_atom (Display *xdisplay, const char *atom_name, gboolean only_if_exists)
+{
+  Atom atom;
+
+  lookup_atoms (xdisplay, 1, &atom_name, only_if_exists, &atom);
+
+  return atom;
+}
+
+void
+bamf_xutils_intern_known_atoms (void)
+{
+  Display *xdisplay;
+
+  if (atoms_table)
+    return;
+
+  xdisplay = get_xdisplay ();
+
+  if (!xdisplay)
   {
     g_warning ("%s: Unable to get a valid XDisplay", G_STRFUNC);
     return;
   }
 
-  gdk_error_trap_push ();
+  intern_known_atoms (xdisplay);
+}
 
-  int result = XGetWindowProperty (XDisplay,  xid,
-                                   gdk_x11_get_xatom_by_name (atom_name),
-                                   0,  G_MAXINT, False, AnyPropertyType,
-                                   &type, &format, &numItems,
-                                   &bytesAfter, &buffer);
+Atom
+bamf_xutils_peek_atom (const char *atom_name)
+{
+  g_return_val_if_fail (atom_name, None);
 
-  gboolean x_error = gdk_error_trap_pop_and_print (XDisplay);
+  if (!atoms_table)
+    return None;
 
-  if (close_display)
-    XCloseDisplay (XDisplay);
+  return GPOINTER_TO_UINT (g_hash_table_lookup (atoms_table, atom_name));
+}
+
+const char *
+bamf_xutils_get_atom_name (Atom atom)
+{
+  if (!atom_names_table || atom == None)
+    return NULL;
+
+  return g_hash_table_lookup (atom_names_table, GUINT_TO_POINTER (atom));
+}
 
-  if (x_error)
+Atom
+bamf_xutils_get_atom (const char *atom_name)
+{
+  Display *xdisplay;
+  gpointer value;
+  Atom atom;
+
+  g_return_val_if_fail (atom_name, None);
+
+  if (atoms_table && g_hash_table_lookup_extended (atoms_table, atom_name, NULL, &value))
+    return GPOINTER_TO_UINT (value);
+
+  xdisplay = get_xdisplay ();
+
+  if (!xdisplay)
+  {
+    g_warning ("%s: Unable to get a valid XDisplay", G_STRFUNC);
+    return None;
+  }
+
+  atom = lookup_atom (xdisplay, atom_name, FALSE);
+
+  return atom;
+}
+
+/* All the requests are sent at once and the replies are collected afterwards,
+ * so that fetching many properties costs a single round trip to the server.
+ * Replies of failed or skipped requests are set to NULL. */
+static void
+get_window_properties (Display *xdisplay, guint n_requests, const Window *xids,
+                       const Atom *atoms, gboolean only_type,
+                       xcb_get_property_reply_t **replies)
+{
+  xcb_connection_t *xcb;
+  xcb_get_property_cookie_t *cookies;
+  xcb_generic_error_t *error;
+  guint i;
+
+  xcb = XGetXCBConnection (xdisplay);
+  cookies = g_new0 (xcb_get_property_cookie_t, n_requests);
+
+  for (i = 0; i < n_requests; ++i)
     {
-      XFree (buffer);
-      return;
+      if (xids[i] == 0 || atoms[i] == None)
+        continue;
+
+      cookies[i] = xcb_get_property (xcb, FALSE, xids[i], atoms[i],
+                                     XCB_GET_PROPERTY_TYPE_ANY, 0,
+                                     only_type ? 0 : G_MAXINT32);
     }
 
-  if (result == Success && numItems > 0)
+  for (i = 0; i < n_requests; ++i)
     {
-      if (return_type)
-        *return_type = type;
+      replies[i] = NULL;
+
+      if (cookies[i].sequence == 0)
+        continue;
 
-      if (return_hint && buffer && buffer[0] != '\0')
+      error = NULL;
+      replies[i] = xcb_get_property_reply (xcb, cookies[i], &error);
+
+      if (error)
         {
-          if (type == XA_STRING || type == gdk_x11_get_xatom_by_name ("UTF8_STRING"))
-            *return_hint = g_strdup ((char*) buffer);
+          print_xcb_error (xdisplay, error);
+          free (error);
+          free (replies[i]);
+          replies[i] = NULL;
         }
+    }
+
+  g_free (cookies);
+}
+
+static char *
+get_string_from_reply (xcb_get_property_reply_t *reply, Atom utf8_string, gsize *length)
+{
+  const char *value;
+  char *string;
+  int value_length;
+
+  *length = 0;
+
+  if (!reply || reply->format != 8)
+    return NULL;
+
+  if (reply->type != XA_STRING && reply->type != utf8_string)
+    return NULL;
+
+  value = xcb_get_property_value (reply);
+  value_length = xcb_get_property_value_length (reply);
 
-      XFree (buffer);
+  if (value_length <= 0)
+    return NULL;
+
+  /* Values might be lists of NUL separated strings (i.e. WM_CLASS) whose
+   * first item can be empty, so keep them whole */
+  string = g_malloc (value_length + 1);
+  memcpy (string, value, value_length);
+  string[value_length] = '\0';
+  *length = value_length;
+
+  return string;
+}
+
+void
+bamf_xutils_get_string_window_hints (BamfXutilsHintQuery *queries, guint n_queries)
+{
+  Display *XDisplay;
+  xcb_get_property_reply_t **replies;
+  const char **atom_names;
+  Window *xids;
+  Atom *atoms;
+  Atom utf8_string;
+  guint i;
+
+  g_return_if_fail (queries || n_queries == 0);
+
+  for (i = 0; i < n_queries; ++i)
+    {
+      queries[i].value = NULL;
+      queries[i].length = 0;
     }
+
+  if (n_queries == 0)
+    return;
+
+  XDisplay = get_xdisplay ();
+
+  if (!XDisplay)
+  {
+    g_warning ("%s: Unable to get a valid XDisplay", G_STRFUNC);
+    return;
+  }
+
+  xids = g_new (Window, n_queries);
+  atom_names = g_new (const char *, n_queries);
+  atoms = g_new (Atom, n_queries);
+  replies = g_new (xcb_get_property_reply_t *, n_queries);
+  utf8_string = lookup_atom (XDisplay, "UTF8_STRING", FALSE);
+
+  for (i = 0; i < n_queries; ++i)
+    {
+      xids[i] = queries[i].xid;
+      atom_names[i] = queries[i].atom_name;
+    }
+
+  /* Names requested by clients might be unknown to the server, there's no
+   * point in creating them as no window can have such properties */
+  lookup_atoms (XDisplay, n_queries, atom_names, TRUE, atoms);
+
+  get_window_properties (XDisplay, n_queries, xids, atoms, FALSE, replies);
+
+  for (i = 0; i < n_queries; ++i)
+    {
+      queries[i].value = get_string_from_reply (replies[i], utf8_string, &queries[i].length);
+      free (replies[i]);
+    }
+
+  g_free (replies);
+  g_free (atoms);
+  g_free (atom_names);
+  g_free (xids);
 }
 
 char *
 bamf_xutils_get_string_window_hint (Window xid, const char *atom_name)
 {
-  gchar *hint = NULL;
-  bamf_xutils_get_string_window_hint_and_type (xid, atom_name, &hint, NULL);
+  BamfXutilsHintQuery query = { xid, atom_name, NULL, 0 };
+
+  g_return_val_if_fail (xid != 0, NULL);
+  g_return_val_if_fail (atom_name, NULL);
 
-  return hint;
+  bamf_xutils_get_string_window_hints (&query, 1);
+
+  return bamf_xutils_hint_query_steal_string (&query);
+}
+
+char *
+bamf_xutils_hint_query_steal_string (BamfXutilsHintQuery *query)
+{
+  char *value;
+
+  g_return_val_if_fail (query, NULL);
+
+  value = query->value;
+  query->value = NULL;
+  query->length = 0;
+
+  if (value && value[0] == '\0')
+    g_clear_pointer (&value, g_free);
+
+  return value;
 }
 
 void
 bamf_xutils_set_string_window_hint (Window xid, const char *atom_name, const char *value)
 {
   Display *XDisplay;
-  Atom type;
-  gboolean close_display = FALSE;
+  xcb_connection_t *xcb;
+  xcb_get_property_reply_t *reply;
+  Atom type, atom, utf8_string;
 
   g_return_if_fail (xid != 0);
   g_return_if_fail (atom_name);
   g_return_if_fail (value);
 
-  XDisplay = get_xdisplay (&close_display);
+  XDisplay = get_xdisplay ();
 
   if (!XDisplay)
   {
@@ -157,43 +487,46 @@ bamf_xutils_set_string_window_hint (Window xid, const char *atom_name, const cha
     return;
   }
 
-  bamf_xutils_get_string_window_hint_and_type (xid, atom_name, NULL, &type);
+  atom = lookup_atom (XDisplay, atom_name, FALSE);
+  utf8_string = lookup_atom (XDisplay, "UTF8_STRING", FALSE);
+
+  if (atom == None)
+    return;
+
+  /* We only need the current type, not the value */
+  get_window_properties (XDisplay, 1, &xid, &atom, TRUE, &reply);
+  type = (reply && reply->type != None) ? reply->type : AnyPropertyType;
+  free (reply);
 
   if (type == AnyPropertyType)
     {
       type = XA_STRING;
     }
-  else if (type != XA_STRING && type != gdk_x11_get_xatom_by_name ("UTF8_STRING"))
+  else if (type != XA_STRING && type != utf8_string)
     {
       g_error ("Impossible to set the atom %s on Window %lu", atom_name, xid);
-
-      if (close_display)
-        XCloseDisplay (XDisplay);
-
       return;
     }
 
-  gdk_error_trap_push ();
-
-  XChangeProperty (XDisplay, xid, gdk_x11_get_xatom_by_name (atom_name),
-                   type, 8, PropModeReplace, (unsigned char *) value, strlen (value));
-
-  gdk_error_trap_pop_and_print (XDisplay);
-
-  if (close_display)
-    XCloseDisplay (XDisplay);
+  /* Errors of the unchecked requests are handled by the Xlib error handler,
+   * so there's no need to wait for the server here */
+  xcb = XGetXCBConnection (XDisplay);
+  xcb_change_property (xcb, XCB_PROP_MODE_REPLACE, xid, atom, type, 8,
+                       strlen (value), value);
+  xcb_flush (xcb);
 }
 
 void
 bamf_xutils_unset_window_hint (Window xid, const char *atom_name)
 {
   Display *XDisplay;
-  gboolean close_display = FALSE;
+  xcb_connection_t *xcb;
+  Atom atom;
 
   g_return_if_fail (xid != 0);
   g_return_if_fail (atom_name);
 
-  XDisplay = get_xdisplay (&close_display);
+  XDisplay = get_xdisplay ();
 
   if (!XDisplay)
   {
@@ -201,50 +534,53 @@ bamf_xutils_unset_window_hint (Window xid, const char *atom_name)
     return;
   }
 
-  gdk_error_trap_push ();
-  XDeleteProperty (XDisplay, xid, gdk_x11_get_xatom_by_name (atom_name));
-  gdk_error_trap_pop_and_print (XDisplay);
+  atom = lookup_atom (XDisplay, atom_name, TRUE);
 
-  if (close_display)
-    XCloseDisplay (XDisplay);
+  if (atom != None)
+    {
+      xcb = XGetXCBConnection (XDisplay);
+      xcb_delete_property (xcb, xid, atom);
+      xcb_flush (xcb);
+    }
 }
 
 void
-bamf_xutils_get_window_class_hints (Window xid, char **class_instance_name, char **class_name)
+bamf_xutils_parse_class_hints (const char *value, gsize length,
+                               char **class_instance_name, char **class_name)
 {
-  Display *xdisplay;
-  gboolean close_display = FALSE;
-
-  xdisplay = get_xdisplay (&close_display);
+  const char *separator;
+  gsize instance_length;
 
-  if (!xdisplay)
-  {
-    g_warning ("%s: Unable to get a valid XDisplay", G_STRFUNC);
+  if (!value || length == 0)
     return;
-  }
-
-  XClassHint class_hint;
-  class_hint.res_name = NULL;
-  class_hint.res_class = NULL;
 
-  gdk_error_trap_push ();
+  /* WM_CLASS contains the instance and the class names, as NUL separated
+   * latin-1 strings */
+  separator = memchr (value, '\0', length);
+  instance_length = separator ? (gsize) (separator - value) : length;
 
-  XGetClassHint (xdisplay, xid, &class_hint);
+  if (class_instance_name && instance_length > 0)
+    *class_instance_name = g_convert (value, instance_length, "utf-8", "iso-8859-1",
+                                      NULL, NULL, NULL);
 
-  if (!gdk_error_trap_pop_and_print (xdisplay))
+  if (class_name && separator && instance_length + 1 < length && separator[1] != '\0')
     {
-      if (class_name && class_hint.res_class && class_hint.res_class[0] != 0)
-        *class_name = g_convert (class_hint.res_class, -1, "utf-8", "iso-8859-1",
-                                 NULL, NULL, NULL);
+      value = separator + 1;
+      length -= instance_length + 1;
+      separator = memchr (value, '\0', length);
 
-      if (class_instance_name && class_hint.res_name && class_hint.res_name[0] != 0)
-        *class_instance_name = g_convert (class_hint.res_name, -1, "utf-8", "iso-8859-1",
-                                          NULL, NULL, NULL);
+      *class_name = g_convert (value, separator ? (gsize) (separator - value) : length,
+                               "utf-8", "iso-8859-1", NULL, NULL, NULL);
     }
+}
+
+void
+bamf_xutils_get_window_class_hints (Window xid, char **class_instance_name, char **class_name)
+{
+  BamfXutilsHintQuery query = { xid, "WM_CLASS", NULL, 0 };
 
-  XFree (class_hint.res_class);
-  XFree (class_hint.res_name);
+  bamf_xutils_get_string_window_hints (&query, 1);
+  bamf_xutils_parse_class_hints (query.value, query.length, class_instance_name, class_name);
 
-  if (close_display)
-    XCloseDisplay (xdisplay);
+  g_free (query.value);
 }
@@ -25,10 +25,36 @@
 #include <X11/Xlib.h>
 #include <gdk/gdkx.h>
 
+typedef struct _BamfXutilsHintQuery
+{
+  Window       xid;
+  const char * atom_name;
+  char       * value;
+  gsize        length;
+} BamfXutilsHintQuery;
+
+/* Atoms are cached once interned, the known ones are all interned at once */
+void  bamf_xutils_intern_known_atoms (void);
+Atom  bamf_xutils_get_atom (const char *atom_name);
+
+/* Cache lookups only, they never reach the server */
+Atom  bamf_xutils_peek_atom (const char *atom_name);
+const char * bamf_xutils_get_atom_name (Atom atom);
+
 void  bamf_xutils_set_string_window_hint (Window xid, const char *atom_name, const char *value);
 char* bamf_xutils_get_string_window_hint (Window xid, const char *atom_name);
+
+/* Fetches the values of all the queries with a single server round trip,
+ * each value is set to a newly allocated string or to NULL if unset; the
+ * length covers the whole value, which may contain NUL separated strings */
+void  bamf_xutils_get_string_window_hints (BamfXutilsHintQuery *queries, guint n_queries);
+
+/* Takes the query value as a single string, NULL if it's empty */
+char* bamf_xutils_hint_query_steal_string (BamfXutilsHintQuery *query);
 void  bamf_xutils_unset_window_hint (Window xid, const char *atom_name);
 
 void  bamf_xutils_get_window_class_hints (Window xid, char **class_instance_name, char **class_name);
+void  bamf_xutils_parse_class_hints (const char *value, gsize length,
+                                     char **class_instance_name, char **class_name);
 
 #endif
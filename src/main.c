@@ -21,6 +21,7 @@
 #include "config.h"
 #include "bamf-daemon.h"
 #include "bamf-legacy-screen.h"
+#include "bamf-matcher.h"
 
 #include "main.h"
 
@@ -31,6 +32,8 @@ main (int argc, char **argv)
   GOptionContext *options;
   GError *error = NULL;
   char *state_file = NULL;
+  char *backend = NULL;
+  gboolean lazy_load = FALSE;
 
   gtk_init (&argc, &argv);
   glibtop_init ();
@@ -42,6 +45,8 @@ main (int argc, char **argv)
   GOptionEntry entries[] =
   {
     {"load-file", 'l', 0, G_OPTION_ARG_STRING, &state_file, "Load bamf state from file instead of the system", NULL },
+    {"lazy-load", 0, 0, G_OPTION_ARG_NONE, &lazy_load, "Load the desktop files in background, once the bus has been acquired", NULL },
+    {"backend", 0, 0, G_OPTION_ARG_STRING, &backend, "Windows tracking backend: wnck (default) or xcb", "BACKEND" },
     {NULL}
   };
 
@@ -56,11 +61,25 @@ main (int argc, char **argv)
       exit (1);
     }
 
+  if (g_strcmp0 (backend, "xcb") == 0)
+    {
+      bamf_legacy_screen_set_backend (BAMF_LEGACY_SCREEN_BACKEND_XCB);
+    }
+  else if (backend && g_strcmp0 (backend, "wnck") != 0)
+    {
+      g_print ("%s, error: Invalid backend '%s'\n", g_option_context_get_help (options, TRUE, NULL), backend);
+      exit (1);
+    }
+
+  g_free (backend);
+
   if (state_file)
     {
       bamf_legacy_screen_set_state_file (bamf_legacy_screen_get_default (), state_file);
     }
 
+  bamf_matcher_set_lazy_loading (lazy_load);
+
   daemon = bamf_daemon_get_default ();
   bamf_daemon_start (daemon);
 
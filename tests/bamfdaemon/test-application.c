@@ -417,6 +417,57 @@ test_get_mime_types_none (void)
   g_object_unref (application);
 }
 
+static void
+on_mimes_changed_count (BamfApplication *application, const gchar **mimes, guint *count)
+{
+  ++(*count);
+}
+
+static gboolean
+state_has_mime_types (BamfApplication *application)
+{
+  GVariant *state, *properties;
+  gboolean found;
+
+  state = g_variant_ref_sink (bamf_view_get_state (BAMF_VIEW (application)));
+  properties = g_variant_get_child_value (state, 2);
+  found = g_variant_lookup (properties, "SupportedMimeTypes", "^as", NULL);
+
+  g_variant_unref (properties);
+  g_variant_unref (state);
+
+  return found;
+}
+
+static void
+test_get_mime_types_none_loaded_once (void)
+{
+  BamfApplication *application;
+  guint mimes_changed = 0;
+  gchar **mimes;
+
+  application = bamf_application_new_from_desktop_file (DESKTOP_FILE);
+  g_signal_connect (application, "supported-mimes-changed",
+                    G_CALLBACK (on_mimes_changed_count), &mimes_changed);
+
+  /* The state doesn't load the mime types, nor notifies about them */
+  g_assert (!state_has_mime_types (application));
+  g_assert_cmpuint (mimes_changed, ==, 0);
+
+  mimes = bamf_application_get_supported_mime_types (application);
+  g_assert (!mimes);
+  g_assert_cmpuint (mimes_changed, ==, 1);
+
+  mimes = bamf_application_get_supported_mime_types (application);
+  g_assert (!mimes);
+  g_assert_cmpuint (mimes_changed, ==, 1);
+
+  g_assert (state_has_mime_types (application));
+  g_assert_cmpuint (mimes_changed, ==, 1);
+
+  g_object_unref (application);
+}
+
 static void
 on_urgent_changed (BamfApplication *application, gboolean result, gpointer data)
 {
@@ -1486,6 +1537,7 @@ test_application_create_suite (GDBusConnection *connection)
   g_test_add_func (DOMAIN"/DesktopFile/Icon/FullPath/Invalid", test_icon_full_path_invalid);
   g_test_add_func (DOMAIN"/DesktopFile/MimeTypes/Valid", test_get_mime_types);
   g_test_add_func (DOMAIN"/DesktopFile/MimeTypes/None", test_get_mime_types_none);
+  g_test_add_func (DOMAIN"/DesktopFile/MimeTypes/None/LoadedOnce", test_get_mime_types_none_loaded_once);
   g_test_add_func (DOMAIN"/DesktopFile/MainChild", test_desktop_app_main_child);
   g_test_add_func (DOMAIN"/DesktopFile/MainChild/NotMatchEmblems", test_desktop_app_main_child_doesnt_match_emblems);
   g_test_add_func (DOMAIN"/DesktopFile/MainChild/NotUpdatesEmblems", test_desktop_app_main_child_doesnt_update_emblems);
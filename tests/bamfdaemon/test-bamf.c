@@ -29,8 +29,15 @@
 
 void test_application_create_suite (GDBusConnection *connection);
 void test_matcher_create_suite (GDBusConnection *connection);
+void test_desktop_cache_create_suite (void);
+void test_desktop_index_create_suite (void);
+void test_legacy_screen_xcb_create_suite (void);
+void test_legacy_window_create_suite (void);
+void test_process_info_create_suite (void);
+void test_stats_create_suite (void);
 void test_view_create_suite (GDBusConnection *connection);
 void test_window_create_suite (void);
+void test_xutils_create_suite (void);
 
 static int result = 1;
 
@@ -61,8 +68,15 @@ on_bus_acquired (GDBusConnection *connection, const gchar *name, gpointer data)
   gtk_icon_theme_prepend_search_path (icon_theme, TESTDIR"/data/icons");
 
   test_matcher_create_suite (connection);
+  test_desktop_cache_create_suite ();
+  test_desktop_index_create_suite ();
+  test_legacy_window_create_suite ();
+  test_legacy_screen_xcb_create_suite ();
+  test_process_info_create_suite ();
+  test_stats_create_suite ();
   test_view_create_suite (connection);
   test_window_create_suite ();
+  test_xutils_create_suite ();
   test_application_create_suite (connection);
 
   result = g_test_run ();
@@ -89,6 +103,7 @@ main (gint argc, gchar *argv[])
   tmp_dir = g_file_new_for_path (tmp_path);
   g_file_make_directory (tmp_dir, NULL, NULL);
   g_setenv ("XDG_DATA_HOME", tmp_path, TRUE);
+  g_setenv ("XDG_CACHE_HOME", tmp_path, TRUE);
   g_free (tmp_path);
 
   gtk_init (&argc, &argv);
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <utime.h>
+#include "bamf-desktop-cache.h"
+
+#define DATA_DIR TESTDIR "/data"
+
+static void test_save_and_load      (void);
+static void test_mtime_mismatch     (void);
+static void test_context_mismatch   (void);
+static void test_invalid_file       (void);
+static void test_directory_mtime    (void);
+
+void
+test_desktop_cache_create_suite (void)
+{
+#define DOMAIN "/DesktopCache"
+
+  g_test_add_func (DOMAIN"/SaveAndLoad", test_save_and_load);
+  g_test_add_func (DOMAIN"/MtimeMismatch", test_mtime_mismatch);
+  g_test_add_func (DOMAIN"/ContextMismatch", test_context_mismatch);
+  g_test_add_func (DOMAIN"/InvalidFile", test_invalid_file);
+  g_test_add_func (DOMAIN"/DirectoryMtime", test_directory_mtime);
+}
+
+static gchar *
+create_cache_file (const gchar *context, guint64 mtime)
+{
+  BamfDesktopCache *cache;
+  GPtrArray *entries;
+  gchar *cache_file;
+
+  cache_file = g_build_filename (g_get_user_cache_dir (), "bamf-test", BAMF_DESKTOP_CACHE_NAME, NULL);
+  g_unlink (cache_file);
+
+  entries = g_ptr_array_new_with_free_func ((GDestroyNotify) bamf_desktop_entry_free);
+  g_ptr_array_add (entries, bamf_desktop_entry_new (DATA_DIR"/test-bamf-app.desktop",
+                                                    "testbamfapp", "test-bamf-app",
+                                                    "test_bamf_app", FALSE));
+  g_ptr_array_add (entries, bamf_desktop_entry_new (DATA_DIR"/no-display.desktop",
+                                                    "nodisplay", "no-display",
+                                                    NULL, TRUE));
+
+  cache = bamf_desktop_cache_new (cache_file, context);
+  g_assert (bamf_desktop_cache_get_directory (cache, DATA_DIR, mtime) == NULL);
+  bamf_desktop_cache_set_directory (cache, DATA_DIR, mtime, entries);
+  g_assert (bamf_desktop_cache_save (cache, NULL));
+  g_assert (g_file_test (cache_file, G_FILE_TEST_EXISTS));
+
+  bamf_desktop_cache_free (cache);
+  g_ptr_array_unref (entries);
+
+  return cache_file;
+}
+
+static void
+test_save_and_load (void)
+{
+  BamfDesktopCache *cache;
+  BamfDesktopEntry *entry;
+  GPtrArray *entries;
+  gchar *cache_file;
+
+  cache_file = create_cache_file ("Unity", 1234);
+  cache = bamf_desktop_cache_new (cache_file, "Unity");
+  entries = bamf_desktop_cache_get_directory (cache, DATA_DIR, 1234);
+
+  g_assert (entries);
+  g_assert_cmpuint (entries->len, ==, 2);
+
+  entry = g_ptr_array_index (entries, 0);
+  g_assert_cmpstr (entry->path, ==, DATA_DIR"/test-bamf-app.desktop");
+  g_assert_cmpstr (entry->exec, ==, "testbamfapp");
+  g_assert_cmpstr (entry->desktop_id, ==, "test-bamf-app");
+  g_assert_cmpstr (entry->desktop_class, ==, "test_bamf_app");
+  g_assert (!entry->no_display);
+
+  entry = g_ptr_array_index (entries, 1);
+  g_assert_cmpstr (entry->path, ==, DATA_DIR"/no-display.desktop");
+  g_assert_cmpstr (entry->desktop_class, ==, NULL);
+  g_assert (entry->no_display);
+
+  g_assert (bamf_desktop_cache_get_directory (cache, TESTDIR, 1234) == NULL);
+
+  g_ptr_array_unref (entries);
+  bamf_desktop_cache_free (cache);
+  g_unlink (cache_file);
+  g_free (cache_file);
+}
+
+static void
+test_mtime_mismatch (void)
+{
+  BamfDesktopCache *cache;
+  gchar *cache_file;
+
+  cache_file = create_cache_file ("Unity", 1234);
+  cache = bamf_desktop_cache_new (cache_file, "Unity");
+
+  g_assert (bamf_desktop_cache_get_directory (cache, DATA_DIR, 4321) == NULL);
+  g_assert (bamf_desktop_cache_get_directory (cache, DATA_DIR, 0) == NULL);
+
+  bamf_desktop_cache_free (cache);
+  g_unlink (cache_file);
+  g_free (cache_file);
+}
+
+static void
+test_context_mismatch (void)
+{
+  BamfDesktopCache *cache;
+  gchar *cache_file;
+
+  cache_file = create_cache_file ("Unity", 1234);
+  cache = bamf_desktop_cache_new (cache_file, "GNOME");
+
+  g_assert (bamf_desktop_cache_get_directory (cache, DATA_DIR, 1234) == NULL);
+
+  bamf_desktop_cache_free (cache);
+  g_unlink (cache_file);
+  g_free (cache_file);
+}
+
+static void
+test_invalid_file (void)
+{
+  BamfDesktopCache *cache;
+  gchar *cache_file;
+
+  cache_file = create_cache_file ("Unity", 1234);
+  g_assert (g_file_set_contents (cache_file, "not a cache", -1, NULL));
+  cache = bamf_desktop_cache_new (cache_file, "Unity");
+
+  g_assert (bamf_desktop_cache_get_directory (cache, DATA_DIR, 1234) == NULL);
+
+  bamf_desktop_cache_free (cache);
+  g_unlink (cache_file);
+  g_free (cache_file);
+}
+
+static void
+set_file_mtime (const gchar *path, time_t mtime)
+{
+  struct utimbuf times;
+
+  times.actime = mtime;
+  times.modtime = mtime;
+  g_assert_cmpint (g_utime (path, &times), ==, 0);
+}
+
+static void
+test_directory_mtime (void)
+{
+  gchar *directory, *desktop_file, *subdir;
+  guint64 dir_mtime, mtime;
+
+  directory = g_dir_make_tmp ("bamf-desktop-cache-XXXXXX", NULL);
+  g_assert (directory);
+  desktop_file = g_build_filename (directory, "test.desktop", NULL);
+  subdir = g_build_filename (directory, "subdir", NULL);
+
+  g_assert (g_file_set_contents (desktop_file, "[Desktop Entry]\n", -1, NULL));
+  g_assert_cmpint (g_mkdir (subdir, 0700), ==, 0);
+  set_file_mtime (desktop_file, 1000);
+  set_file_mtime (directory, 2000);
+
+  dir_mtime = bamf_desktop_cache_get_mtime (directory);
+  mtime = bamf_desktop_cache_get_directory_mtime (directory);
+  g_assert_cmpuint (mtime, ==, dir_mtime);
+
+  /* Sub-directories don't affect the parent directory */
+  set_file_mtime (subdir, 3000);
+  g_assert_cmpuint (bamf_desktop_cache_get_directory_mtime (directory), ==, mtime);
+
+  /* A file edited in place doesn't change the directory mtime */
+  g_assert (g_file_set_contents (desktop_file, "[Desktop Entry]\nName=Test\n", -1, NULL));
+  set_file_mtime (desktop_file, 4000);
+  set_file_mtime (directory, 2000);
+
+  g_assert_cmpuint (bamf_desktop_cache_get_mtime (directory), ==, dir_mtime);
+  g_assert_cmpuint (bamf_desktop_cache_get_directory_mtime (directory), >, mtime);
+  g_assert_cmpuint (bamf_desktop_cache_get_directory_mtime (directory), ==,
+                    bamf_desktop_cache_get_mtime (desktop_file));
+
+  g_assert_cmpuint (bamf_desktop_cache_get_directory_mtime (subdir), !=, 0);
+  g_rmdir (subdir);
+  g_unlink (desktop_file);
+  g_rmdir (directory);
+
+  g_assert_cmpuint (bamf_desktop_cache_get_directory_mtime (directory), ==, 0);
+
+  g_free (subdir);
+  g_free (desktop_file);
+  g_free (directory);
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <glib.h>
+#include "bamf-desktop-index.h"
+
+#define DATA_DIR TESTDIR "/data"
+
+static void test_entry_from_file      (void);
+static void test_entry_from_line      (void);
+static void test_entry_invalid_line   (void);
+static void test_entry_line_roundtrip (void);
+static void test_entry_not_loaded     (void);
+static void test_entry_show_in        (void);
+
+void
+test_desktop_index_create_suite (void)
+{
+#define DOMAIN "/DesktopIndex"
+
+  g_test_add_func (DOMAIN"/Entry/FromFile", test_entry_from_file);
+  g_test_add_func (DOMAIN"/Entry/FromLine", test_entry_from_line);
+  g_test_add_func (DOMAIN"/Entry/InvalidLine", test_entry_invalid_line);
+  g_test_add_func (DOMAIN"/Entry/LineRoundtrip", test_entry_line_roundtrip);
+  g_test_add_func (DOMAIN"/Entry/NotLoaded", test_entry_not_loaded);
+  g_test_add_func (DOMAIN"/Entry/ShowIn", test_entry_show_in);
+}
+
+static void
+test_entry_from_file (void)
+{
+  BamfIndexEntry *entry;
+
+  entry = bamf_index_entry_new_from_file (DATA_DIR"/test-bamf-app.desktop");
+  g_assert (entry);
+  g_assert_cmpstr (entry->desktop_id, ==, "test-bamf-app.desktop");
+  g_assert_cmpstr (entry->exec, ==, "test-bamf-app");
+  g_assert_cmpstr (entry->desktop_class, ==, "test_bamf_app");
+  g_assert_cmpstr (entry->show_in, ==, NULL);
+  g_assert (!entry->no_display);
+  bamf_index_entry_free (entry);
+
+  entry = bamf_index_entry_new_from_file (DATA_DIR"/test-bamf-app-no-display.desktop");
+  g_assert (entry);
+  g_assert (entry->no_display);
+  bamf_index_entry_free (entry);
+
+  g_assert (!bamf_index_entry_new_from_file (DATA_DIR"/invalid-type.desktop"));
+  g_assert (!bamf_index_entry_new_from_file (DATA_DIR"/not-existing.desktop"));
+}
+
+static void
+test_entry_from_line (void)
+{
+  BamfIndexEntry *entry;
+
+  entry = bamf_index_entry_new_from_line ("foo.desktop\tfoo --bar\tFoo\tUnity;GNOME;\ttrue");
+  g_assert (entry);
+  g_assert_cmpstr (entry->desktop_id, ==, "foo.desktop");
+  g_assert_cmpstr (entry->exec, ==, "foo --bar");
+  g_assert_cmpstr (entry->desktop_class, ==, "Foo");
+  g_assert_cmpstr (entry->show_in, ==, "Unity;GNOME;");
+  g_assert (entry->no_display);
+  bamf_index_entry_free (entry);
+
+  entry = bamf_index_entry_new_from_line ("foo.desktop\tfoo\t\t\tfalse");
+  g_assert (entry);
+  g_assert_cmpstr (entry->desktop_class, ==, NULL);
+  g_assert_cmpstr (entry->show_in, ==, NULL);
+  g_assert (!entry->no_display);
+  bamf_index_entry_free (entry);
+}
+
+static void
+test_entry_invalid_line (void)
+{
+  g_assert (!bamf_index_entry_new_from_line (""));
+  g_assert (!bamf_index_entry_new_from_line ("foo.desktop"));
+  g_assert (!bamf_index_entry_new_from_line ("foo.desktop\t"));
+  g_assert (!bamf_index_entry_new_from_line (".desktop\tfoo"));
+  g_assert (!bamf_index_entry_new_from_line ("foo\tfoo\t\t\tfalse"));
+}
+
+static void
+test_entry_line_roundtrip (void)
+{
+  BamfIndexEntry *entry, *parsed;
+  gchar *line;
+
+  entry = bamf_index_entry_new_from_file (DATA_DIR"/test-bamf-app.desktop");
+  line = bamf_index_entry_to_line (entry);
+  g_assert_cmpstr (line, ==, "test-bamf-app.desktop\ttest-bamf-app\ttest_bamf_app\t\tfalse");
+
+  parsed = bamf_index_entry_new_from_line (line);
+  g_assert (bamf_index_entry_equal (entry, parsed));
+
+  bamf_index_entry_free (parsed);
+  bamf_index_entry_free (entry);
+  g_free (line);
+}
+
+static void
+test_entry_not_loaded (void)
+{
+  /* The entries that the daemon drops when parsing the files */
+  g_assert (!bamf_index_entry_new_from_file (DATA_DIR"/hidden.desktop"));
+  g_assert (!bamf_index_entry_new_from_file (DATA_DIR"/missing-try-exec.desktop"));
+}
+
+static void
+test_entry_show_in (void)
+{
+  BamfIndexEntry *entry, *parsed;
+  const gchar *unity[] = { "Unity", NULL };
+  const gchar *kde_unity[] = { "KDE", "Unity", NULL };
+  const gchar *gnome[] = { "GNOME", NULL };
+  gchar *line;
+
+  entry = bamf_index_entry_new_from_file (DATA_DIR"/not-show-in.desktop");
+  g_assert (entry);
+  g_assert_cmpstr (entry->show_in, ==, "Unity;");
+  g_assert_cmpstr (entry->not_show_in, ==, "KDE;");
+
+  line = bamf_index_entry_to_line (entry);
+  g_assert_cmpstr (line, ==, "not-show-in.desktop\ttest-bamf-app\t\tUnity;\tfalse\tKDE;");
+  parsed = bamf_index_entry_new_from_line (line);
+  g_assert (bamf_index_entry_equal (entry, parsed));
+
+  /* Same results of g_desktop_app_info_get_show_in */
+  g_assert (bamf_index_entry_get_show_in (parsed, unity));
+  g_assert (!bamf_index_entry_get_show_in (parsed, kde_unity));
+  g_assert (!bamf_index_entry_get_show_in (parsed, gnome));
+  g_assert (!bamf_index_entry_get_show_in (parsed, NULL));
+
+  bamf_index_entry_free (parsed);
+  bamf_index_entry_free (entry);
+  g_free (line);
+
+  entry = bamf_index_entry_new_from_file (DATA_DIR"/test-bamf-app.desktop");
+  g_assert (bamf_index_entry_get_show_in (entry, gnome));
+  g_assert (bamf_index_entry_get_show_in (entry, NULL));
+  bamf_index_entry_free (entry);
+}
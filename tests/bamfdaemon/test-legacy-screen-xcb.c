@@ -0,0 +1,411 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include "bamf-legacy-screen.h"
+#include "bamf-legacy-screen-private.h"
+#include "bamf-legacy-window-xcb.h"
+#include "bamf-xutils.h"
+
+#define SIGNAL_TIMEOUT 2000
+
+static void test_open_close              (void);
+static void test_destroyed_while_loading (void);
+static void test_active_window           (void);
+static void test_stacking_order          (void);
+static void test_window_properties       (void);
+static void test_inject_window           (void);
+static void test_initial_windows         (void);
+
+void
+test_legacy_screen_xcb_create_suite (void)
+{
+#define DOMAIN "/LegacyScreen/Xcb"
+
+  g_test_add_func (DOMAIN"/OpenClose", test_open_close);
+  g_test_add_func (DOMAIN"/DestroyedWhileLoading", test_destroyed_while_loading);
+  g_test_add_func (DOMAIN"/ActiveWindow", test_active_window);
+  g_test_add_func (DOMAIN"/StackingOrder", test_stacking_order);
+  g_test_add_func (DOMAIN"/WindowProperties", test_window_properties);
+  g_test_add_func (DOMAIN"/InjectWindow", test_inject_window);
+  g_test_add_func (DOMAIN"/InitialWindows", test_initial_windows);
+}
+
+typedef struct
+{
+  GMainLoop *loop;
+  gboolean emitted;
+} SignalWait;
+
+static void
+on_signal_emitted (SignalWait *wait)
+{
+  wait->emitted = TRUE;
+  g_main_loop_quit (wait->loop);
+}
+
+static gboolean
+on_signal_timeout (SignalWait *wait)
+{
+  g_main_loop_quit (wait->loop);
+  return FALSE;
+}
+
+/* Changes are made through another X connection, so we need to wait for the
+ * screen to get the events */
+static gboolean
+wait_for_signal (gpointer object, const char *signal)
+{
+  SignalWait wait = { g_main_loop_new (NULL, FALSE), FALSE };
+  gulong handler;
+  guint timeout;
+
+  handler = g_signal_connect_swapped (object, signal, G_CALLBACK (on_signal_emitted), &wait);
+  timeout = g_timeout_add (SIGNAL_TIMEOUT, (GSourceFunc) on_signal_timeout, &wait);
+
+  XSync (gdk_x11_get_default_xdisplay (), False);
+  g_main_loop_run (wait.loop);
+
+  if (wait.emitted)
+    g_source_remove (timeout);
+
+  g_signal_handler_disconnect (object, handler);
+  g_main_loop_unref (wait.loop);
+
+  return wait.emitted;
+}
+
+static Window
+create_window (void)
+{
+  Display *xdisplay = gdk_x11_get_default_xdisplay ();
+  Window xid;
+
+  xid = XCreateSimpleWindow (xdisplay, DefaultRootWindow (xdisplay), 0, 0, 10, 10, 0, 0, 0);
+  XSync (xdisplay, False);
+
+  return xid;
+}
+
+static void
+set_root_windows (const char *atom_name, Window *xids, guint n_xids)
+{
+  Display *xdisplay = gdk_x11_get_default_xdisplay ();
+
+  XChangeProperty (xdisplay, DefaultRootWindow (xdisplay), bamf_xutils_get_atom (atom_name),
+                   XA_WINDOW, 32, PropModeReplace, (unsigned char *) xids, n_xids);
+}
+
+static void
+set_stack (Window *xids, guint n_xids)
+{
+  set_root_windows ("_NET_CLIENT_LIST_STACKING", xids, n_xids);
+}
+
+static BamfLegacyScreen *
+create_screen (void)
+{
+  BamfLegacyScreen *screen;
+
+  set_stack (NULL, 0);
+  set_root_windows ("_NET_ACTIVE_WINDOW", NULL, 0);
+  XSync (gdk_x11_get_default_xdisplay (), False);
+
+  screen = _bamf_legacy_screen_new_xcb ();
+  g_assert (BAMF_IS_LEGACY_SCREEN (screen));
+
+  /* Let the screen load the (empty) initial client list */
+  while (g_main_context_iteration (NULL, FALSE));
+  g_assert (!bamf_legacy_screen_get_windows (screen));
+
+  return screen;
+}
+
+static BamfLegacyWindow *
+find_window (BamfLegacyScreen *screen, Window xid)
+{
+  GList *l;
+
+  for (l = bamf_legacy_screen_get_windows (screen); l; l = l->next)
+    {
+      if (bamf_legacy_window_get_xid (l->data) == xid)
+        return l->data;
+    }
+
+  return NULL;
+}
+
+static void
+test_open_close (void)
+{
+  BamfLegacyScreen *screen;
+  BamfLegacyWindow *window;
+  Window xids[2];
+
+  screen = create_screen ();
+  xids[0] = create_window ();
+  xids[1] = create_window ();
+
+  set_stack (xids, 2);
+  g_assert (wait_for_signal (screen, BAMF_LEGACY_SCREEN_SIGNAL_STACKING_CHANGED));
+  g_assert_cmpuint (g_list_length (bamf_legacy_screen_get_windows (screen)), ==, 2);
+
+  window = find_window (screen, xids[1]);
+  g_assert (BAMF_IS_LEGACY_WINDOW_XCB (window));
+  g_assert (!bamf_legacy_window_is_closed (window));
+
+  set_stack (xids, 1);
+  g_assert (wait_for_signal (screen, BAMF_LEGACY_SCREEN_SIGNAL_WINDOW_CLOSED));
+  g_assert_cmpuint (g_list_length (bamf_legacy_screen_get_windows (screen)), ==, 1);
+  g_assert (!find_window (screen, xids[1]));
+  g_assert (find_window (screen, xids[0]));
+
+  set_stack (NULL, 0);
+  g_assert (wait_for_signal (screen, BAMF_LEGACY_SCREEN_SIGNAL_WINDOW_CLOSED));
+  g_assert (!bamf_legacy_screen_get_windows (screen));
+
+  g_object_unref (screen);
+  XDestroyWindow (gdk_x11_get_default_xdisplay (), xids[0]);
+  XDestroyWindow (gdk_x11_get_default_xdisplay (), xids[1]);
+}
+
+static void
+on_window_opened (BamfLegacyScreen *screen, BamfLegacyWindow *window, guint *count)
+{
+  ++(*count);
+}
+
+static void
+test_destroyed_while_loading (void)
+{
+  BamfLegacyScreen *screen;
+  guint opened = 0;
+  Window xids[2];
+
+  screen = create_screen ();
+  g_signal_connect (screen, BAMF_LEGACY_SCREEN_SIGNAL_WINDOW_OPENED,
+                    G_CALLBACK (on_window_opened), &opened);
+
+  xids[0] = create_window ();
+  xids[1] = create_window ();
+  XDestroyWindow (gdk_x11_get_default_xdisplay (), xids[1]);
+
+  /* The window manager hasn't noticed the destruction yet */
+  set_stack (xids, 2);
+  g_assert (wait_for_signal (screen, BAMF_LEGACY_SCREEN_SIGNAL_STACKING_CHANGED));
+  g_assert_cmpuint (opened, ==, 1);
+  g_assert_cmpuint (g_list_length (bamf_legacy_screen_get_windows (screen)), ==, 1);
+  g_assert (find_window (screen, xids[0]));
+
+  g_object_unref (screen);
+  XDestroyWindow (gdk_x11_get_default_xdisplay (), xids[0]);
+}
+
+static void
+test_active_window (void)
+{
+  BamfLegacyScreen *screen;
+  Window xids[2];
+
+  screen = create_screen ();
+  xids[0] = create_window ();
+  xids[1] = create_window ();
+
+  set_stack (xids, 2);
+  g_assert (wait_for_signal (screen, BAMF_LEGACY_SCREEN_SIGNAL_STACKING_CHANGED));
+  g_assert (!bamf_legacy_screen_get_active_window (screen));
+
+  set_root_windows ("_NET_ACTIVE_WINDOW", &xids[1], 1);
+  g_assert (wait_for_signal (screen, BAMF_LEGACY_SCREEN_SIGNAL_ACTIVE_WINDOW_CHANGED));
+  g_assert (bamf_legacy_screen_get_active_window (screen) == find_window (screen, xids[1]));
+  g_assert (bamf_legacy_window_is_active (find_window (screen, xids[1])));
+  g_assert (!bamf_legacy_window_is_active (find_window (screen, xids[0])));
+
+  set_root_windows ("_NET_ACTIVE_WINDOW", &xids[0], 1);
+  g_assert (wait_for_signal (screen, BAMF_LEGACY_SCREEN_SIGNAL_ACTIVE_WINDOW_CHANGED));
+  g_assert (bamf_legacy_screen_get_active_window (screen) == find_window (screen, xids[0]));
+  g_assert (!bamf_legacy_window_is_active (find_window (screen, xids[1])));
+
+  g_object_unref (screen);
+  XDestroyWindow (gdk_x11_get_default_xdisplay (), xids[0]);
+  XDestroyWindow (gdk_x11_get_default_xdisplay (), xids[1]);
+}
+
+static void
+test_stacking_order (void)
+{
+  BamfLegacyScreen *screen;
+  GList *windows;
+  Window xids[3];
+  Window restacked[3];
+  guint i;
+
+  screen = create_screen ();
+
+  for (i = 0; i < G_N_ELEMENTS (xids); ++i)
+    xids[i] = create_window ();
+
+  set_stack (xids, G_N_ELEMENTS (xids));
+  g_assert (wait_for_signal (screen, BAMF_LEGACY_SCREEN_SIGNAL_STACKING_CHANGED));
+
+  for (windows = bamf_legacy_screen_get_windows (screen), i = 0; windows; windows = windows->next, ++i)
+    {
+      g_assert_cmpuint (bamf_legacy_window_get_xid (windows->data), ==, xids[i]);
+      g_assert_cmpint (bamf_legacy_window_get_stacking_position (windows->data), ==, i);
+    }
+
+  restacked[0] = xids[2];
+  restacked[1] = xids[0];
+  restacked[2] = xids[1];
+
+  set_stack (restacked, G_N_ELEMENTS (restacked));
+  g_assert (wait_for_signal (screen, BAMF_LEGACY_SCREEN_SIGNAL_STACKING_CHANGED));
+
+  for (windows = bamf_legacy_screen_get_windows (screen), i = 0; windows; windows = windows->next, ++i)
+    {
+      g_assert_cmpuint (bamf_legacy_window_get_xid (windows->data), ==, restacked[i]);
+      g_assert_cmpint (bamf_legacy_window_get_stacking_position (windows->data), ==, i);
+    }
+
+  g_assert_cmpuint (i, ==, G_N_ELEMENTS (restacked));
+
+  g_object_unref (screen);
+
+  for (i = 0; i < G_N_ELEMENTS (xids); ++i)
+    XDestroyWindow (gdk_x11_get_default_xdisplay (), xids[i]);
+}
+
+static void
+test_window_properties (void)
+{
+  Display *xdisplay = gdk_x11_get_default_xdisplay ();
+  BamfLegacyScreen *screen;
+  BamfLegacyWindow *window;
+  const char class_hint[] = "xcb-instance\0XcbClass";
+  const char *name = "XCB Window";
+  const char *new_name = "XCB Window Renamed";
+  Atom utf8_string = bamf_xutils_get_atom ("UTF8_STRING");
+  Atom net_wm_name = bamf_xutils_get_atom ("_NET_WM_NAME");
+  Window xid;
+
+  screen = create_screen ();
+  xid = create_window ();
+
+  XChangeProperty (xdisplay, xid, XA_WM_CLASS, XA_STRING, 8, PropModeReplace,
+                   (unsigned char *) class_hint, sizeof (class_hint));
+  XChangeProperty (xdisplay, xid, net_wm_name, utf8_string, 8, PropModeReplace,
+                   (unsigned char *) name, strlen (name));
+
+  set_stack (&xid, 1);
+  g_assert (wait_for_signal (screen, BAMF_LEGACY_SCREEN_SIGNAL_STACKING_CHANGED));
+
+  window = find_window (screen, xid);
+  g_assert (BAMF_IS_LEGACY_WINDOW_XCB (window));
+  g_assert_cmpstr (bamf_legacy_window_get_class_name (window), ==, "XcbClass");
+  g_assert_cmpstr (bamf_legacy_window_get_class_instance_name (window), ==, "xcb-instance");
+  g_assert_cmpstr (bamf_legacy_window_get_name (window), ==, name);
+  g_assert_cmpint (bamf_legacy_window_get_window_type (window), ==, BAMF_WINDOW_NORMAL);
+
+  XChangeProperty (xdisplay, xid, net_wm_name, utf8_string, 8, PropModeReplace,
+                   (unsigned char *) new_name, strlen (new_name));
+  g_assert (wait_for_signal (window, BAMF_LEGACY_WINDOW_SIGNAL_NAME_CHANGED));
+  g_assert_cmpstr (bamf_legacy_window_get_name (window), ==, new_name);
+
+  g_object_unref (screen);
+  XDestroyWindow (xdisplay, xid);
+}
+
+static void
+test_inject_window (void)
+{
+  BamfLegacyScreen *screen;
+  BamfLegacyWindow *window;
+  guint opened = 0;
+  Window xids[2];
+
+  screen = create_screen ();
+  xids[0] = create_window ();
+  xids[1] = create_window ();
+
+  set_stack (xids, 1);
+  g_assert (wait_for_signal (screen, BAMF_LEGACY_SCREEN_SIGNAL_STACKING_CHANGED));
+
+  g_signal_connect (screen, BAMF_LEGACY_SCREEN_SIGNAL_WINDOW_OPENED,
+                    G_CALLBACK (on_window_opened), &opened);
+
+  /* Known windows aren't added twice */
+  bamf_legacy_screen_inject_window (screen, xids[0]);
+  g_assert_cmpuint (opened, ==, 0);
+
+  /* Windows that aren't managed can't be injected */
+  bamf_legacy_screen_inject_window (screen, xids[1]);
+  g_assert_cmpuint (opened, ==, 0);
+  g_assert (!find_window (screen, xids[1]));
+
+  /* A closed window that is still managed is added again */
+  window = find_window (screen, xids[0]);
+  bamf_legacy_window_xcb_close (BAMF_LEGACY_WINDOW_XCB (window));
+  g_assert (!find_window (screen, xids[0]));
+
+  bamf_legacy_screen_inject_window (screen, xids[0]);
+  g_assert_cmpuint (opened, ==, 1);
+  window = find_window (screen, xids[0]);
+  g_assert (BAMF_IS_LEGACY_WINDOW_XCB (window));
+  g_assert (!bamf_legacy_window_is_closed (window));
+
+  g_object_unref (screen);
+  XDestroyWindow (gdk_x11_get_default_xdisplay (), xids[0]);
+  XDestroyWindow (gdk_x11_get_default_xdisplay (), xids[1]);
+}
+
+static void
+test_initial_windows (void)
+{
+  BamfLegacyScreen *screen;
+  guint opened = 0;
+  Window xids[2];
+
+  xids[0] = create_window ();
+  xids[1] = create_window ();
+  set_stack (xids, 2);
+  set_root_windows ("_NET_ACTIVE_WINDOW", &xids[0], 1);
+  XSync (gdk_x11_get_default_xdisplay (), False);
+
+  /* The windows that are already there are added only once the main loop
+   * runs, so that they can be noticed by who just got the screen */
+  screen = _bamf_legacy_screen_new_xcb ();
+  g_assert (BAMF_IS_LEGACY_SCREEN (screen));
+  g_assert (!bamf_legacy_screen_get_windows (screen));
+
+  g_signal_connect (screen, BAMF_LEGACY_SCREEN_SIGNAL_WINDOW_OPENED,
+                    G_CALLBACK (on_window_opened), &opened);
+
+  g_assert (wait_for_signal (screen, BAMF_LEGACY_SCREEN_SIGNAL_STACKING_CHANGED));
+  g_assert_cmpuint (opened, ==, 2);
+  g_assert (find_window (screen, xids[0]));
+  g_assert (find_window (screen, xids[1]));
+  g_assert (bamf_legacy_screen_get_active_window (screen) == find_window (screen, xids[0]));
+
+  g_object_unref (screen);
+  set_stack (NULL, 0);
+  set_root_windows ("_NET_ACTIVE_WINDOW", NULL, 0);
+  XDestroyWindow (gdk_x11_get_default_xdisplay (), xids[0]);
+  XDestroyWindow (gdk_x11_get_default_xdisplay (), xids[1]);
+}
@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include "bamf-legacy-window.h"
+#include "bamf-xutils.h"
+
+static void test_class_changed    (void);
+static void test_name_changed     (void);
+static void test_hint_changed     (void);
+static void test_hint_deleted     (void);
+static void test_new_batch        (void);
+
+void
+test_legacy_window_create_suite (void)
+{
+#define DOMAIN "/LegacyWindow"
+
+  g_test_add_func (DOMAIN"/ClassChanged", test_class_changed);
+  g_test_add_func (DOMAIN"/NameChanged", test_name_changed);
+  g_test_add_func (DOMAIN"/Hint/Changed", test_hint_changed);
+  g_test_add_func (DOMAIN"/Hint/Deleted", test_hint_deleted);
+  g_test_add_func (DOMAIN"/NewBatch", test_new_batch);
+}
+
+static void
+process_x_events (void)
+{
+  XSync (gdk_x11_get_default_xdisplay (), False);
+
+  while (g_main_context_iteration (NULL, FALSE));
+}
+
+static void
+set_client_list (Window *xids, guint n_xids)
+{
+  Display *xdisplay = gdk_x11_get_default_xdisplay ();
+  Window root = DefaultRootWindow (xdisplay);
+
+  XChangeProperty (xdisplay, root, bamf_xutils_get_atom ("_NET_CLIENT_LIST"),
+                   XA_WINDOW, 32, PropModeReplace, (unsigned char *) xids, n_xids);
+  XChangeProperty (xdisplay, root, bamf_xutils_get_atom ("_NET_CLIENT_LIST_STACKING"),
+                   XA_WINDOW, 32, PropModeReplace, (unsigned char *) xids, n_xids);
+}
+
+/* Without a window manager, windows are managed by wnck only once they're
+ * added to the root client lists */
+static GList *
+create_wnck_windows (Window *xids, guint n_xids)
+{
+  Display *xdisplay = gdk_x11_get_default_xdisplay ();
+  GList *wnck_windows = NULL;
+  WnckWindow *wnck_window;
+  guint i;
+
+  for (i = 0; i < n_xids; ++i)
+    xids[i] = XCreateSimpleWindow (xdisplay, DefaultRootWindow (xdisplay), 0, 0, 1, 1, 0, 0, 0);
+
+  set_client_list (xids, n_xids);
+  process_x_events ();
+  wnck_screen_force_update (wnck_screen_get_default ());
+
+  for (i = 0; i < n_xids; ++i)
+    {
+      wnck_window = wnck_window_get (xids[i]);
+      g_assert (WNCK_IS_WINDOW (wnck_window));
+      wnck_windows = g_list_append (wnck_windows, wnck_window);
+    }
+
+  return wnck_windows;
+}
+
+static BamfLegacyWindow *
+create_legacy_window (void)
+{
+  BamfLegacyWindow *window;
+  GList *wnck_windows;
+  Window xid;
+
+  wnck_windows = create_wnck_windows (&xid, 1);
+  window = bamf_legacy_window_new (wnck_windows->data);
+  g_list_free (wnck_windows);
+
+  return window;
+}
+
+static void
+destroy_legacy_window (BamfLegacyWindow *window)
+{
+  Display *xdisplay = gdk_x11_get_default_xdisplay ();
+  Window xid = bamf_legacy_window_get_xid (window);
+
+  g_object_unref (window);
+  set_client_list (NULL, 0);
+  XDestroyWindow (xdisplay, xid);
+  process_x_events ();
+  wnck_screen_force_update (wnck_screen_get_default ());
+}
+
+static void
+on_signal_count (BamfLegacyWindow *window, guint *count)
+{
+  ++(*count);
+}
+
+static void
+set_string_property (BamfLegacyWindow *window, const char *atom_name, Atom type,
+                     const char *value, gsize length)
+{
+  XChangeProperty (gdk_x11_get_default_xdisplay (), bamf_legacy_window_get_xid (window),
+                   bamf_xutils_get_atom (atom_name), type, 8, PropModeReplace,
+                   (unsigned char *) value, length);
+  process_x_events ();
+}
+
+static void
+test_class_changed (void)
+{
+  BamfLegacyWindow *window;
+  const char class_hint[] = "test-instance\0TestClass";
+  guint class_changed = 0;
+
+  window = create_legacy_window ();
+  g_signal_connect (window, BAMF_LEGACY_WINDOW_SIGNAL_CLASS_CHANGED,
+                    G_CALLBACK (on_signal_count), &class_changed);
+
+  g_assert_cmpstr (bamf_legacy_window_get_class_name (window), ==, NULL);
+  g_assert_cmpstr (bamf_legacy_window_get_class_instance_name (window), ==, NULL);
+
+  set_string_property (window, "WM_CLASS", XA_STRING, class_hint, sizeof (class_hint));
+  g_assert_cmpuint (class_changed, ==, 1);
+  g_assert_cmpstr (bamf_legacy_window_get_class_name (window), ==, "TestClass");
+  g_assert_cmpstr (bamf_legacy_window_get_class_instance_name (window), ==, "test-instance");
+
+  /* Setting the same value again isn't a change */
+  set_string_property (window, "WM_CLASS", XA_STRING, class_hint, sizeof (class_hint));
+  g_assert_cmpuint (class_changed, ==, 1);
+
+  destroy_legacy_window (window);
+}
+
+static void
+test_name_changed (void)
+{
+  BamfLegacyWindow *window;
+  const char name[] = "Test Window Name";
+  guint name_changed = 0;
+
+  window = create_legacy_window ();
+  g_signal_connect (window, BAMF_LEGACY_WINDOW_SIGNAL_NAME_CHANGED,
+                    G_CALLBACK (on_signal_count), &name_changed);
+
+  set_string_property (window, "_NET_WM_NAME", bamf_xutils_get_atom ("UTF8_STRING"),
+                       name, strlen (name));
+  g_assert_cmpuint (name_changed, >, 0);
+  g_assert_cmpstr (bamf_legacy_window_get_name (window), ==, name);
+
+  destroy_legacy_window (window);
+}
+
+static void
+test_hint_changed (void)
+{
+  BamfLegacyWindow *window;
+  const char *hint = "_BAMF_DESKTOP_FILE";
+  const char *value = "/usr/share/applications/test-hint.desktop";
+  char *cached;
+
+  window = create_legacy_window ();
+
+  cached = bamf_legacy_window_get_hint (window, hint);
+  g_assert_cmpstr (cached, ==, NULL);
+
+  /* Changed by another client, so the cached value must be invalidated */
+  set_string_property (window, hint, XA_STRING, value, strlen (value));
+  cached = bamf_legacy_window_get_hint (window, hint);
+  g_assert_cmpstr (cached, ==, value);
+  g_free (cached);
+
+  bamf_legacy_window_set_hint (window, hint, "other.desktop");
+  cached = bamf_legacy_window_get_hint (window, hint);
+  g_assert_cmpstr (cached, ==, "other.desktop");
+  g_free (cached);
+
+  destroy_legacy_window (window);
+}
+
+static void
+test_hint_deleted (void)
+{
+  BamfLegacyWindow *window;
+  const char *hint = "_GTK_APPLICATION_ID";
+  const char *value = "org.example.TestApplication";
+  char *cached;
+
+  window = create_legacy_window ();
+
+  set_string_property (window, hint, bamf_xutils_get_atom ("UTF8_STRING"), value, strlen (value));
+  cached = bamf_legacy_window_get_hint (window, hint);
+  g_assert_cmpstr (cached, ==, value);
+  g_free (cached);
+
+  XDeleteProperty (gdk_x11_get_default_xdisplay (), bamf_legacy_window_get_xid (window),
+                   bamf_xutils_get_atom (hint));
+  process_x_events ();
+
+  cached = bamf_legacy_window_get_hint (window, hint);
+  g_assert_cmpstr (cached, ==, NULL);
+
+  destroy_legacy_window (window);
+}
+
+static void
+test_new_batch (void)
+{
+  Display *xdisplay = gdk_x11_get_default_xdisplay ();
+  const char class_hint[] = "batch-instance\0BatchClass";
+  const char *desktop_file = "/usr/share/applications/batch.desktop";
+  GList *wnck_windows, *windows, *l;
+  Window xids[3];
+  char *hint;
+  guint i;
+
+  wnck_windows = create_wnck_windows (xids, G_N_ELEMENTS (xids));
+
+  XChangeProperty (xdisplay, xids[0], XA_WM_CLASS, XA_STRING, 8, PropModeReplace,
+                   (unsigned char *) class_hint, sizeof (class_hint));
+  XChangeProperty (xdisplay, xids[2], bamf_xutils_get_atom ("_BAMF_DESKTOP_FILE"),
+                   XA_STRING, 8, PropModeReplace, (unsigned char *) desktop_file,
+                   strlen (desktop_file));
+  XSync (xdisplay, False);
+
+  windows = bamf_legacy_window_new_batch (wnck_windows);
+  g_assert_cmpuint (g_list_length (windows), ==, G_N_ELEMENTS (xids));
+
+  for (l = windows, i = 0; l; l = l->next, ++i)
+    g_assert_cmpuint (bamf_legacy_window_get_xid (l->data), ==, xids[i]);
+
+  g_assert_cmpstr (bamf_legacy_window_get_class_name (windows->data), ==, "BatchClass");
+  g_assert_cmpstr (bamf_legacy_window_get_class_instance_name (windows->data), ==, "batch-instance");
+  g_assert_cmpstr (bamf_legacy_window_get_class_name (windows->next->data), ==, NULL);
+
+  hint = bamf_legacy_window_get_hint (g_list_last (windows)->data, "_BAMF_DESKTOP_FILE");
+  g_assert_cmpstr (hint, ==, desktop_file);
+  g_free (hint);
+
+  g_list_free_full (windows, g_object_unref);
+  g_list_free (wnck_windows);
+  set_client_list (NULL, 0);
+
+  for (i = 0; i < G_N_ELEMENTS (xids); ++i)
+    XDestroyWindow (xdisplay, xids[i]);
+
+  process_x_events ();
+  wnck_screen_force_update (wnck_screen_get_default ());
+}
@@ -20,11 +20,13 @@
 
 #include <glib.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include "bamf-matcher.h"
 #include "bamf-matcher-private.h"
 #include "bamf-legacy-screen-private.h"
 #include "bamf-legacy-window.h"
 #include "bamf-legacy-window-test.h"
+#include "bamf-tab.h"
 
 static GDBusConnection *gdbus_connection = NULL;
 
@@ -51,10 +53,8 @@ cleanup_matcher_tables (BamfMatcher *matcher)
 {
   g_return_if_fail (BAMF_IS_MATCHER (matcher));
 
-  g_hash_table_destroy (matcher->priv->desktop_file_table);
-  g_hash_table_destroy (matcher->priv->desktop_id_table);
-  g_hash_table_destroy (matcher->priv->desktop_class_table);
-  g_list_free (matcher->priv->no_display_desktop);
+  bamf_matcher_free_desktop_file_tables (matcher);
+  g_hash_table_remove_all (matcher->priv->possible_apps_cache);
 
   matcher->priv->desktop_file_table =
     g_hash_table_new_full ((GHashFunc) g_str_hash,
@@ -74,7 +74,17 @@ cleanup_matcher_tables (BamfMatcher *matcher)
                            (GDestroyNotify) g_free,
                            (GDestroyNotify) g_free);
 
-  matcher->priv->no_display_desktop = NULL;
+  matcher->priv->class_desktop_files_table =
+    g_hash_table_new_full ((GHashFunc) g_str_hash,
+                           (GEqualFunc) g_str_equal,
+                           (GDestroyNotify) g_free,
+                           NULL);
+
+  matcher->priv->desktop_file_refs_table =
+    g_hash_table_new_full ((GHashFunc) g_str_hash,
+                           (GEqualFunc) g_str_equal,
+                           (GDestroyNotify) g_free,
+                           NULL);
 }
 
 static BamfWindow *
@@ -152,6 +162,10 @@ test_load_desktop_file (void)
   const char *desktop = g_hash_table_lookup (priv->desktop_class_table, TEST_BAMF_APP_DESKTOP);
   g_assert_cmpstr (desktop, ==, "test_bamf_app");
 
+  l = g_hash_table_lookup (priv->class_desktop_files_table, "test_bamf_app");
+  g_assert (l);
+  g_assert_cmpstr (l->data, ==, TEST_BAMF_APP_DESKTOP);
+
   g_object_unref (matcher);
 }
 
@@ -246,6 +260,84 @@ test_register_desktop_for_pid_big_number (void)
   g_object_unref (matcher);
 }
 
+static void
+test_register_desktop_for_pid_parent (void)
+{
+  BamfMatcher *matcher;
+  BamfLegacyScreen *screen;
+  BamfLegacyWindowTest *test_win;
+  guint xid = g_random_int ();
+  char *hint;
+
+  screen = bamf_legacy_screen_get_default ();
+  matcher = bamf_matcher_get_default ();
+
+  cleanup_matcher_tables (matcher);
+  export_matcher_on_bus (matcher);
+  bamf_matcher_load_desktop_file (matcher, TEST_BAMF_APP_DESKTOP);
+
+  test_win = bamf_legacy_window_test_new (xid, "Child Window", NULL, "execution-binary");
+  test_win->pid = getpid ();
+  _bamf_legacy_screen_open_test_window (screen, test_win);
+
+  hint = bamf_legacy_window_get_hint (BAMF_LEGACY_WINDOW (test_win), _BAMF_DESKTOP_FILE);
+  g_assert_cmpstr (hint, ==, NULL);
+
+  /* The window process is a child of the registered one */
+  bamf_matcher_register_desktop_file_for_pid (matcher, TEST_BAMF_APP_DESKTOP, getppid ());
+
+  hint = bamf_legacy_window_get_hint (BAMF_LEGACY_WINDOW (test_win), _BAMF_DESKTOP_FILE);
+  g_assert_cmpstr (hint, ==, TEST_BAMF_APP_DESKTOP);
+  g_free (hint);
+
+  bamf_legacy_window_test_close (test_win);
+  g_hash_table_remove (matcher->priv->registered_pids, GUINT_TO_POINTER (getppid ()));
+  g_hash_table_remove (matcher->priv->registered_pids, GUINT_TO_POINTER (getpid ()));
+
+  g_object_unref (matcher);
+  g_object_unref (screen);
+}
+
+static void
+test_register_desktop_for_pid_desktop_window (void)
+{
+  BamfMatcher *matcher;
+  BamfLegacyScreen *screen;
+  BamfLegacyWindowTest *test_win;
+  guint xid = g_random_int ();
+  char *hint;
+
+  screen = bamf_legacy_screen_get_default ();
+  matcher = bamf_matcher_get_default ();
+
+  cleanup_matcher_tables (matcher);
+  export_matcher_on_bus (matcher);
+  bamf_matcher_load_desktop_file (matcher, TEST_BAMF_APP_DESKTOP);
+
+  test_win = bamf_legacy_window_test_new (xid, "Desktop", NULL, "execution-binary");
+  test_win->window_type = BAMF_WINDOW_DESKTOP;
+  test_win->pid = getpid ();
+  _bamf_legacy_screen_open_test_window (screen, test_win);
+  g_assert (!g_list_find (g_hash_table_lookup (matcher->priv->windows_by_pid, GUINT_TO_POINTER (getpid ())),
+                          test_win));
+
+  /* Desktop windows aren't matched, but still get the registered desktop file */
+  bamf_matcher_register_desktop_file_for_pid (matcher, TEST_BAMF_APP_DESKTOP, getppid ());
+
+  hint = bamf_legacy_window_get_hint (BAMF_LEGACY_WINDOW (test_win), _BAMF_DESKTOP_FILE);
+  g_assert_cmpstr (hint, ==, TEST_BAMF_APP_DESKTOP);
+  g_free (hint);
+
+  bamf_legacy_window_test_close (test_win);
+  g_assert (!g_list_find (matcher->priv->desktop_windows, test_win));
+
+  g_hash_table_remove (matcher->priv->registered_pids, GUINT_TO_POINTER (getppid ()));
+  g_hash_table_remove (matcher->priv->registered_pids, GUINT_TO_POINTER (getpid ()));
+
+  g_object_unref (matcher);
+  g_object_unref (screen);
+}
+
 static void
 test_register_desktop_for_pid_autostart (void)
 {
@@ -343,6 +435,546 @@ test_open_windows (void)
   g_object_unref (screen);
 }
 
+static void
+test_window_stack_for_monitor (void)
+{
+  BamfMatcher *matcher;
+  BamfLegacyScreen *screen;
+  BamfLegacyWindowTest *test_wins[3];
+  GVariant *stack;
+  const gchar **paths;
+  gsize length;
+  guint i;
+
+  screen = bamf_legacy_screen_get_default();
+  matcher = bamf_matcher_get_default ();
+
+  cleanup_matcher_tables (matcher);
+  export_matcher_on_bus (matcher);
+
+  for (i = 0; i < G_N_ELEMENTS (test_wins); ++i)
+    {
+      test_wins[i] = bamf_legacy_window_test_new (G_MAXUINT - i, "Stacked Window", "test-stack-class", "test-stack");
+      _bamf_legacy_screen_open_test_window (screen, test_wins[i]);
+    }
+
+  /* Test windows are added on top of the stack */
+  stack = bamf_matcher_get_window_stack_for_monitor (matcher, -1);
+  g_variant_get (stack, "(^a&s)", &paths);
+  length = g_strv_length ((gchar **) paths);
+  g_assert_cmpuint (length, >=, G_N_ELEMENTS (test_wins));
+
+  for (i = 0; i < G_N_ELEMENTS (test_wins); ++i)
+    {
+      BamfWindow *window = find_window_in_matcher (matcher, BAMF_LEGACY_WINDOW (test_wins[i]));
+      g_assert_cmpstr (paths[length - G_N_ELEMENTS (test_wins) + i], ==, bamf_view_get_path (BAMF_VIEW (window)));
+    }
+
+  g_free (paths);
+  g_variant_unref (stack);
+
+  g_assert_cmpint (bamf_legacy_window_get_stacking_position (BAMF_LEGACY_WINDOW (test_wins[1])), ==,
+                   bamf_legacy_window_get_stacking_position (BAMF_LEGACY_WINDOW (test_wins[0])) + 1);
+  g_assert_cmpint (bamf_legacy_window_get_stacking_position (BAMF_LEGACY_WINDOW (test_wins[2])), ==,
+                   bamf_legacy_window_get_stacking_position (BAMF_LEGACY_WINDOW (test_wins[0])) + 2);
+
+  _bamf_legacy_screen_close_test_window (screen, test_wins[1]);
+  g_assert_cmpint (bamf_legacy_window_get_stacking_position (BAMF_LEGACY_WINDOW (test_wins[2])), ==,
+                   bamf_legacy_window_get_stacking_position (BAMF_LEGACY_WINDOW (test_wins[0])) + 1);
+
+  stack = bamf_matcher_get_window_stack_for_monitor (matcher, -1);
+  g_variant_get (stack, "(^a&s)", &paths);
+  length = g_strv_length ((gchar **) paths);
+  g_assert_cmpstr (paths[length - 1], ==, bamf_view_get_path (BAMF_VIEW (find_window_in_matcher (matcher, BAMF_LEGACY_WINDOW (test_wins[2])))));
+  g_assert_cmpstr (paths[length - 2], ==, bamf_view_get_path (BAMF_VIEW (find_window_in_matcher (matcher, BAMF_LEGACY_WINDOW (test_wins[0])))));
+
+  g_free (paths);
+  g_variant_unref (stack);
+
+  _bamf_legacy_screen_close_test_window (screen, test_wins[0]);
+  _bamf_legacy_screen_close_test_window (screen, test_wins[2]);
+
+  g_object_unref (matcher);
+  g_object_unref (screen);
+}
+
+static void
+test_get_state (void)
+{
+  BamfMatcher *matcher;
+  BamfLegacyScreen *screen;
+  BamfLegacyWindowTest *test_win;
+  BamfApplication *app;
+  BamfView *window;
+  GVariant *state, *views, *properties;
+  GVariantIter iter;
+  const gchar *path, *type, *name;
+  const gchar **children;
+  gboolean found_window = FALSE;
+  gboolean found_app = FALSE;
+  guint32 xid;
+
+  screen = bamf_legacy_screen_get_default();
+  matcher = bamf_matcher_get_default ();
+
+  cleanup_matcher_tables (matcher);
+  export_matcher_on_bus (matcher);
+
+  test_win = bamf_legacy_window_test_new (G_MAXUINT, "State Window", "test-state-class", "test-state");
+  _bamf_legacy_screen_open_test_window (screen, test_win);
+
+  window = BAMF_VIEW (find_window_in_matcher (matcher, BAMF_LEGACY_WINDOW (test_win)));
+  app = bamf_matcher_get_application_by_xid (matcher, G_MAXUINT);
+  g_assert (BAMF_IS_WINDOW (window));
+  g_assert (BAMF_IS_APPLICATION (app));
+
+  state = g_variant_ref_sink (bamf_matcher_get_state (matcher));
+  g_assert (g_variant_is_of_type (state, G_VARIANT_TYPE ("(a(ssa{sv}as)t)")));
+
+  views = g_variant_get_child_value (state, 0);
+  g_variant_iter_init (&iter, views);
+
+  while (g_variant_iter_next (&iter, "(&s&s@a{sv}^a&s)", &path, &type, &properties, &children))
+    {
+      if (g_strcmp0 (path, bamf_view_get_path (window)) == 0)
+        {
+          g_assert_cmpstr (type, ==, "window");
+          g_assert (g_variant_lookup (properties, "Name", "&s", &name));
+          g_assert_cmpstr (name, ==, "State Window");
+          g_assert (g_variant_lookup (properties, "Xid", "u", &xid));
+          g_assert_cmpuint (xid, ==, G_MAXUINT);
+          found_window = TRUE;
+        }
+      else if (g_strcmp0 (path, bamf_view_get_path (BAMF_VIEW (app))) == 0)
+        {
+          g_assert_cmpstr (type, ==, "application");
+          g_assert (g_variant_lookup (properties, "DesktopFile", "&s", &name));
+          g_assert_cmpuint (g_strv_length ((gchar **) children), ==, 1);
+          g_assert_cmpstr (children[0], ==, bamf_view_get_path (window));
+          found_app = TRUE;
+        }
+
+      g_variant_unref (properties);
+      g_free (children);
+    }
+
+  g_assert (found_window);
+  g_assert (found_app);
+
+  g_variant_unref (views);
+  g_variant_unref (state);
+
+  _bamf_legacy_screen_close_test_window (screen, test_win);
+
+  g_object_unref (matcher);
+  g_object_unref (screen);
+}
+
+static GVariant *
+lookup_view_change (GVariant *changes, const gchar *view_path, const gchar **change)
+{
+  GVariant *changed_view, *properties;
+  GVariantIter iter;
+  const gchar *path;
+
+  g_variant_iter_init (&iter, changes);
+
+  while ((changed_view = g_variant_iter_next_value (&iter)))
+    {
+      g_variant_get (changed_view, "(&s&s&s@a{sv}asas)", &path, NULL, change, &properties, NULL, NULL);
+
+      if (g_strcmp0 (path, view_path) == 0)
+        {
+          g_variant_unref (changed_view);
+          return properties;
+        }
+
+      g_variant_unref (properties);
+      g_variant_unref (changed_view);
+    }
+
+  return NULL;
+}
+
+static void
+test_get_changes_since (void)
+{
+  BamfMatcher *matcher;
+  BamfLegacyScreen *screen;
+  BamfLegacyWindowTest *test_win1, *test_win2;
+  BamfView *window1, *window2;
+  GVariant *state, *result, *changes, *properties;
+  const gchar *change, *name;
+  gchar *window2_path;
+  guint64 generation, current_generation;
+  gboolean complete;
+
+  screen = bamf_legacy_screen_get_default();
+  matcher = bamf_matcher_get_default ();
+
+  cleanup_matcher_tables (matcher);
+  export_matcher_on_bus (matcher);
+
+  test_win1 = bamf_legacy_window_test_new (G_MAXUINT, "Delta Window", "test-delta-class", "test-delta");
+  _bamf_legacy_screen_open_test_window (screen, test_win1);
+  window1 = BAMF_VIEW (find_window_in_matcher (matcher, BAMF_LEGACY_WINDOW (test_win1)));
+  g_assert (BAMF_IS_WINDOW (window1));
+
+  state = g_variant_ref_sink (bamf_matcher_get_state (matcher));
+  g_variant_get (state, "(@a(ssa{sv}as)t)", NULL, &generation);
+  g_variant_unref (state);
+
+  bamf_view_set_name (window1, "First");
+  bamf_view_set_name (window1, "Second");
+
+  test_win2 = bamf_legacy_window_test_new (G_MAXUINT - 1, "Delta Window 2", "test-delta-class", "test-delta");
+  _bamf_legacy_screen_open_test_window (screen, test_win2);
+  window2 = BAMF_VIEW (find_window_in_matcher (matcher, BAMF_LEGACY_WINDOW (test_win2)));
+  window2_path = g_strdup (bamf_view_get_path (window2));
+
+  result = g_variant_ref_sink (bamf_matcher_get_changes_since (matcher, generation));
+  g_variant_get (result, "(tb@a(sssa{sv}asas))", &current_generation, &complete, &changes);
+  g_assert (complete);
+  g_assert_cmpuint (current_generation, >, generation);
+
+  /* Multiple changes of the same property are merged in the current value */
+  properties = lookup_view_change (changes, bamf_view_get_path (window1), &change);
+  g_assert (properties);
+  g_assert_cmpstr (change, ==, "changed");
+  g_assert (g_variant_lookup (properties, "Name", "&s", &name));
+  g_assert_cmpstr (name, ==, "Second");
+  g_assert (!g_variant_lookup_value (properties, "Urgent", NULL));
+  g_variant_unref (properties);
+
+  properties = lookup_view_change (changes, window2_path, &change);
+  g_assert (properties);
+  g_assert_cmpstr (change, ==, "opened");
+  g_assert (g_variant_lookup (properties, "Name", "&s", &name));
+  g_assert_cmpstr (name, ==, "Delta Window 2");
+  g_variant_unref (properties);
+
+  g_variant_unref (changes);
+  g_variant_unref (result);
+
+  /* Views opened and closed meanwhile are not reported at all */
+  _bamf_legacy_screen_close_test_window (screen, test_win2);
+
+  result = g_variant_ref_sink (bamf_matcher_get_changes_since (matcher, generation));
+  g_variant_get (result, "(tb@a(sssa{sv}asas))", NULL, &complete, &changes);
+  g_assert (complete);
+  g_assert (!lookup_view_change (changes, window2_path, &change));
+  g_variant_unref (changes);
+  g_variant_unref (result);
+
+  /* Closed views are reported to clients that knew about them */
+  result = g_variant_ref_sink (bamf_matcher_get_changes_since (matcher, current_generation));
+  g_variant_get (result, "(tb@a(sssa{sv}asas))", NULL, &complete, &changes);
+  g_assert (complete);
+  properties = lookup_view_change (changes, window2_path, &change);
+  g_assert (properties);
+  g_assert_cmpstr (change, ==, "closed");
+  g_variant_unref (properties);
+  g_variant_unref (changes);
+  g_variant_unref (result);
+
+  /* Unknown generations require the whole state to be fetched again */
+  result = g_variant_ref_sink (bamf_matcher_get_changes_since (matcher, G_MAXUINT64));
+  g_variant_get (result, "(tb@a(sssa{sv}asas))", NULL, &complete, &changes);
+  g_assert (!complete);
+  g_assert_cmpuint (g_variant_n_children (changes), ==, 0);
+  g_variant_unref (changes);
+  g_variant_unref (result);
+
+  _bamf_legacy_screen_close_test_window (screen, test_win1);
+  g_free (window2_path);
+
+  g_object_unref (matcher);
+  g_object_unref (screen);
+}
+
+static void
+test_get_changes_since_reopened (void)
+{
+  BamfMatcher *matcher;
+  BamfLegacyScreen *screen;
+  BamfLegacyWindowTest *test_win;
+  BamfView *window;
+  GVariant *state, *result, *changes, *properties;
+  const gchar *change;
+  gchar *window_path;
+  guint64 generation;
+  gboolean complete;
+
+  screen = bamf_legacy_screen_get_default();
+  matcher = bamf_matcher_get_default ();
+
+  cleanup_matcher_tables (matcher);
+  export_matcher_on_bus (matcher);
+
+  test_win = bamf_legacy_window_test_new (G_MAXUINT, "Reopened Window", "test-reopened-class", "test-reopened");
+  _bamf_legacy_screen_open_test_window (screen, test_win);
+  window = BAMF_VIEW (find_window_in_matcher (matcher, BAMF_LEGACY_WINDOW (test_win)));
+  g_assert (BAMF_IS_WINDOW (window));
+  window_path = g_strdup (bamf_view_get_path (window));
+
+  state = g_variant_ref_sink (bamf_matcher_get_state (matcher));
+  g_variant_get (state, "(@a(ssa{sv}as)t)", NULL, &generation);
+  g_variant_unref (state);
+
+  /* The same xid gets the same path, so the view seems to be opened again */
+  _bamf_legacy_screen_close_test_window (screen, test_win);
+  test_win = bamf_legacy_window_test_new (G_MAXUINT, "Reopened Window", "test-reopened-class", "test-reopened");
+  _bamf_legacy_screen_open_test_window (screen, test_win);
+  window = BAMF_VIEW (find_window_in_matcher (matcher, BAMF_LEGACY_WINDOW (test_win)));
+  g_assert_cmpstr (bamf_view_get_path (window), ==, window_path);
+  _bamf_legacy_screen_close_test_window (screen, test_win);
+
+  /* The view was known at the requested generation, so it must be closed */
+  result = g_variant_ref_sink (bamf_matcher_get_changes_since (matcher, generation));
+  g_variant_get (result, "(tb@a(sssa{sv}asas))", &generation, &complete, &changes);
+  g_assert (complete);
+  properties = lookup_view_change (changes, window_path, &change);
+  g_assert (properties);
+  g_assert_cmpstr (change, ==, "closed");
+  g_variant_unref (properties);
+  g_variant_unref (changes);
+  g_variant_unref (result);
+
+  /* Building the changes doesn't produce new ones */
+  result = g_variant_ref_sink (bamf_matcher_get_changes_since (matcher, generation));
+  g_variant_get (result, "(tb@a(sssa{sv}asas))", NULL, &complete, &changes);
+  g_assert (complete);
+  g_assert_cmpuint (g_variant_n_children (changes), ==, 0);
+  g_variant_unref (changes);
+  g_variant_unref (result);
+
+  g_free (window_path);
+
+  g_object_unref (matcher);
+  g_object_unref (screen);
+}
+
+static void
+on_views_changed (BamfMatcher *matcher, GVariant *changes, GVariant **last_changes)
+{
+  g_assert (!*last_changes);
+  *last_changes = g_variant_ref_sink (changes);
+}
+
+typedef BamfTab TestTab;
+typedef BamfTabClass TestTabClass;
+
+static GType test_tab_get_type (void);
+G_DEFINE_TYPE (TestTab, test_tab, BAMF_TYPE_TAB);
+
+static void
+test_tab_init (TestTab *self)
+{
+}
+
+static void
+test_tab_class_init (TestTabClass *klass)
+{
+}
+
+static void
+test_get_changes_since_tab_properties (void)
+{
+  BamfMatcher *matcher;
+  BamfLegacyScreen *screen;
+  BamfView *tab;
+  GVariant *state, *result, *changes, *properties;
+  const gchar *change, *location;
+  guint64 generation;
+  gboolean complete, foreground, starting;
+
+  screen = bamf_legacy_screen_get_default();
+  matcher = bamf_matcher_get_default ();
+
+  cleanup_matcher_tables (matcher);
+  export_matcher_on_bus (matcher);
+
+  tab = g_object_new (test_tab_get_type (), NULL);
+  bamf_matcher_register_view_stealing_ref (matcher, tab);
+  g_assert (bamf_view_get_path (tab));
+
+  state = g_variant_ref_sink (bamf_matcher_get_state (matcher));
+  g_variant_get (state, "(@a(ssa{sv}as)t)", NULL, &generation);
+  g_variant_unref (state);
+
+  g_object_set (tab, "location", "http://www.ubuntu.com", "is-foreground-tab", TRUE, NULL);
+  bamf_view_set_starting (tab, NULL, TRUE);
+
+  result = g_variant_ref_sink (bamf_matcher_get_changes_since (matcher, generation));
+  g_variant_get (result, "(tb@a(sssa{sv}asas))", NULL, &complete, &changes);
+  g_assert (complete);
+
+  properties = lookup_view_change (changes, bamf_view_get_path (tab), &change);
+  g_assert (properties);
+  g_assert_cmpstr (change, ==, "changed");
+  g_assert (g_variant_lookup (properties, "location", "&s", &location));
+  g_assert_cmpstr (location, ==, "http://www.ubuntu.com");
+  g_assert (g_variant_lookup (properties, "is-foreground-tab", "b", &foreground));
+  g_assert (foreground);
+  g_assert (g_variant_lookup (properties, "Starting", "b", &starting));
+  g_assert (starting);
+  g_assert (!g_variant_lookup_value (properties, "desktop-id", NULL));
+  g_variant_unref (properties);
+
+  g_variant_unref (changes);
+  g_variant_unref (result);
+
+  bamf_view_close (tab);
+
+  g_object_unref (matcher);
+  g_object_unref (screen);
+}
+
+static void
+test_views_changed_batching (void)
+{
+  BamfMatcher *matcher;
+  BamfLegacyScreen *screen;
+  BamfLegacyWindowTest *test_win;
+  BamfView *view;
+  GVariant *changes = NULL;
+  GVariant *props = NULL;
+  GVariantIter iter;
+  const gchar *path;
+  const gchar *name;
+
+  screen = bamf_legacy_screen_get_default();
+  matcher = bamf_matcher_get_default ();
+
+  cleanup_matcher_tables (matcher);
+  export_matcher_on_bus (matcher);
+
+  g_signal_connect (matcher, "views-changed", G_CALLBACK (on_views_changed), &changes);
+
+  test_win = bamf_legacy_window_test_new (G_MAXUINT, "Batched Window", "test-batch-class", "test-batch");
+  _bamf_legacy_screen_open_test_window (screen, test_win);
+  view = BAMF_VIEW (find_window_in_matcher (matcher, BAMF_LEGACY_WINDOW (test_win)));
+  g_assert (BAMF_IS_WINDOW (view));
+
+  /* Nothing is queued until a client subscribes */
+  bamf_view_set_name (view, "Unsubscribed");
+  g_assert_cmpuint (g_hash_table_size (matcher->priv->view_changes_table), ==, 0);
+
+  bamf_matcher_subscribe_views_changed (matcher, "test-subscriber");
+
+  bamf_view_set_urgent (view, TRUE);
+  bamf_view_set_name (view, "First");
+  bamf_view_set_name (view, "Second");
+  bamf_view_set_urgent (view, FALSE);
+  g_assert (!changes);
+
+  while (g_main_context_iteration (NULL, FALSE));
+
+  g_assert (changes);
+  g_variant_iter_init (&iter, changes);
+
+  while (g_variant_iter_next (&iter, "(&s@a{sv})", &path, &props))
+    {
+      if (g_strcmp0 (path, bamf_view_get_path (view)) == 0)
+        break;
+
+      g_variant_unref (props);
+      props = NULL;
+    }
+
+  /* Only the final value is notified, reverted changes are dropped */
+  g_assert (props);
+  g_assert (g_variant_lookup (props, "Name", "&s", &name));
+  g_assert_cmpstr (name, ==, "Second");
+  g_assert (!g_variant_lookup_value (props, "Urgent", NULL));
+
+  g_variant_unref (props);
+  g_clear_pointer (&changes, g_variant_unref);
+
+  bamf_matcher_unsubscribe_views_changed (matcher, "test-subscriber");
+  bamf_view_set_name (view, "Third");
+  g_assert_cmpuint (g_hash_table_size (matcher->priv->view_changes_table), ==, 0);
+  g_assert_cmpuint (matcher->priv->dispatch_view_changes_id, ==, 0);
+
+  _bamf_legacy_screen_close_test_window (screen, test_win);
+  g_signal_handlers_disconnect_by_func (matcher, on_views_changed, &changes);
+
+  g_object_unref (matcher);
+  g_object_unref (screen);
+}
+
+static void
+test_match_cached_possible_applications (void)
+{
+  BamfMatcher *matcher;
+  BamfLegacyScreen *screen;
+  BamfLegacyWindowTest *test_win;
+  BamfApplication *app;
+  guint xid;
+  const int window_count = 5;
+
+  screen = bamf_legacy_screen_get_default();
+  matcher = bamf_matcher_get_default ();
+
+  cleanup_matcher_tables (matcher);
+  export_matcher_on_bus (matcher);
+  bamf_matcher_load_desktop_file (matcher, TEST_BAMF_APP_DESKTOP);
+  g_assert_cmpuint (g_hash_table_size (matcher->priv->possible_apps_cache), ==, 0);
+
+  for (xid = G_MAXUINT; xid > G_MAXUINT-window_count; xid--)
+    {
+      test_win = bamf_legacy_window_test_new (xid, "Test Window", "test_bamf_app", "test-bamf-app");
+      _bamf_legacy_screen_open_test_window (screen, test_win);
+    }
+
+  /* All the windows share the same candidates */
+  g_assert_cmpuint (g_hash_table_size (matcher->priv->possible_apps_cache), ==, 1);
+
+  app = bamf_matcher_get_application_by_xid (matcher, G_MAXUINT);
+  g_assert (app);
+  g_assert (app == bamf_matcher_get_application_by_xid (matcher, G_MAXUINT-window_count+1));
+
+  bamf_matcher_load_desktop_file (matcher, DATA_DIR"/test-bamf-app-display.desktop");
+  g_assert_cmpuint (g_hash_table_size (matcher->priv->possible_apps_cache), ==, 0);
+
+  g_object_unref (matcher);
+  g_object_unref (screen);
+}
+
+static void
+test_match_cached_possible_applications_class_changed (void)
+{
+  BamfMatcher *matcher;
+  BamfLegacyScreen *screen;
+  BamfLegacyWindowTest *test_win;
+  guint xid = g_random_int ();
+
+  screen = bamf_legacy_screen_get_default();
+  matcher = bamf_matcher_get_default ();
+
+  cleanup_matcher_tables (matcher);
+  export_matcher_on_bus (matcher);
+  bamf_matcher_load_desktop_file (matcher, TEST_BAMF_APP_DESKTOP);
+
+  test_win = bamf_legacy_window_test_new (xid, "Test Window", "test_bamf_app", "test-bamf-app");
+  _bamf_legacy_screen_open_test_window (screen, test_win);
+  g_assert_cmpuint (g_hash_table_size (matcher->priv->possible_apps_cache), ==, 1);
+
+  /* The process values are computed once, but the class is always checked */
+  bamf_legacy_window_test_set_wmclass (test_win, "Other_Class", "other-instance");
+  g_assert_cmpuint (g_hash_table_size (matcher->priv->possible_apps_cache), ==, 2);
+
+  bamf_legacy_window_test_set_wmclass (test_win, "test_bamf_app", NULL);
+  g_assert_cmpuint (g_hash_table_size (matcher->priv->possible_apps_cache), ==, 2);
+  g_assert (bamf_matcher_get_application_by_desktop_file (matcher, TEST_BAMF_APP_DESKTOP) ==
+            bamf_matcher_get_application_by_xid (matcher, xid));
+
+  bamf_legacy_window_test_close (test_win);
+
+  g_object_unref (matcher);
+  g_object_unref (screen);
+}
+
 static void
 test_match_desktopless_application (void)
 {
@@ -489,6 +1121,156 @@ test_new_desktop_matches_unmatched_windows (void)
   g_object_unref (screen);
 }
 
+static void
+on_view_opened_count (BamfMatcher *matcher, const gchar *path, const gchar *type, guint *opened)
+{
+  if (g_strcmp0 (type, "application") == 0)
+    ++opened[0];
+  else if (g_strcmp0 (type, "window") == 0)
+    ++opened[1];
+}
+
+static void
+test_new_monitored_desktops_rematch_windows_once (void)
+{
+  BamfMatcher *matcher;
+  BamfLegacyScreen *screen;
+  BamfLegacyWindowTest *test_win;
+  BamfApplication *app;
+  GList *app_children, *l;
+  guint opened[2] = { 0, 0 };
+  guint first_xid = g_random_int_range (1, G_MAXINT32 - 10);
+  guint pid = g_random_int_range (100000, G_MAXINT32);
+  guint pending_id, xid;
+  const int window_count = 4;
+
+  screen = bamf_legacy_screen_get_default ();
+  matcher = bamf_matcher_get_default ();
+
+  cleanup_matcher_tables (matcher);
+  export_matcher_on_bus (matcher);
+
+  for (xid = first_xid; xid < first_xid + window_count; ++xid)
+    {
+      gchar *name = g_strdup_printf ("Test Window %u", xid);
+
+      test_win = bamf_legacy_window_test_new (xid, name, "test_bamf_app", "testbamfapp");
+      test_win->pid = pid;
+      _bamf_legacy_screen_open_test_window (screen, test_win);
+      g_assert (!bamf_application_get_desktop_file (bamf_matcher_get_application_by_xid (matcher, xid)));
+
+      g_free (name);
+    }
+
+  g_signal_connect (matcher, "view-opened", G_CALLBACK (on_view_opened_count), opened);
+
+  /* The files added in a short interval are re-matched in a single batch */
+  bamf_matcher_load_monitored_desktop_file (matcher, TEST_BAMF_APP_DESKTOP);
+  pending_id = matcher->priv->pending_rematch_id;
+  g_assert_cmpuint (pending_id, !=, 0);
+
+  bamf_matcher_load_monitored_desktop_file (matcher, DATA_DIR"/no-icon.desktop");
+  g_assert_cmpuint (matcher->priv->pending_rematch_id, ==, pending_id);
+  g_assert_cmpuint (g_hash_table_size (matcher->priv->pending_rematch_files), ==, 2);
+  g_assert (!bamf_matcher_get_application_by_desktop_file (matcher, TEST_BAMF_APP_DESKTOP));
+
+  while (matcher->priv->pending_rematch_id != 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert (!matcher->priv->pending_rematch_files);
+
+  app = bamf_matcher_get_application_by_desktop_file (matcher, TEST_BAMF_APP_DESKTOP);
+  g_assert (app);
+
+  app_children = bamf_view_get_children (BAMF_VIEW (app));
+  g_assert_cmpuint (g_list_length (app_children), ==, window_count);
+
+  for (xid = first_xid; xid < first_xid + window_count; ++xid)
+    g_assert (bamf_matcher_get_application_by_xid (matcher, xid) == app);
+
+  /* Each window has been re-matched only once, into the same application */
+  g_assert_cmpuint (opened[0], ==, 1);
+  g_assert_cmpuint (opened[1], ==, window_count);
+
+  g_signal_handlers_disconnect_by_func (matcher, on_view_opened_count, opened);
+  app_children = g_list_copy (app_children);
+
+  for (l = app_children; l; l = l->next)
+    bamf_legacy_window_test_close (BAMF_LEGACY_WINDOW_TEST (bamf_window_get_window (l->data)));
+
+  g_list_free (app_children);
+  g_object_unref (matcher);
+  g_object_unref (screen);
+}
+
+static void
+test_lazy_loading_queues_windows (void)
+{
+  BamfMatcher *matcher;
+  BamfLegacyScreen *screen;
+  BamfLegacyWindowTest *test_win;
+  guint xid = g_random_int ();
+
+  screen = bamf_legacy_screen_get_default ();
+
+  bamf_matcher_set_lazy_loading (TRUE);
+  matcher = bamf_matcher_get_default ();
+  bamf_matcher_set_lazy_loading (FALSE);
+
+  g_assert (!bamf_dbus_matcher_get_ready (BAMF_DBUS_MATCHER (matcher)));
+
+  test_win = bamf_legacy_window_test_new (xid, "Test Window", "test_bamf_app", "testbamfapp");
+  _bamf_legacy_screen_open_test_window (screen, test_win);
+  g_assert (!find_window_in_matcher (matcher, BAMF_LEGACY_WINDOW (test_win)));
+
+  while (!bamf_dbus_matcher_get_ready (BAMF_DBUS_MATCHER (matcher)))
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert (find_window_in_matcher (matcher, BAMF_LEGACY_WINDOW (test_win)));
+  g_assert (bamf_matcher_get_application_by_xid (matcher, xid));
+
+  g_object_unref (matcher);
+  g_object_unref (screen);
+}
+
+static void
+test_lazy_loading_register_desktop_for_pid (void)
+{
+  BamfMatcher *matcher;
+  BamfLegacyScreen *screen;
+  BamfLegacyWindowTest *test_win;
+  guint xid = g_random_int ();
+  char *hint;
+
+  screen = bamf_legacy_screen_get_default ();
+
+  bamf_matcher_set_lazy_loading (TRUE);
+  matcher = bamf_matcher_get_default ();
+  bamf_matcher_set_lazy_loading (FALSE);
+
+  test_win = bamf_legacy_window_test_new (xid, "Child Window", NULL, "execution-binary");
+  test_win->pid = getpid ();
+  _bamf_legacy_screen_open_test_window (screen, test_win);
+  g_assert (!find_window_in_matcher (matcher, BAMF_LEGACY_WINDOW (test_win)));
+
+  /* The queued window process is a child of the registered one */
+  bamf_matcher_register_desktop_file_for_pid (matcher, TEST_BAMF_APP_DESKTOP, getppid ());
+
+  hint = bamf_legacy_window_get_hint (BAMF_LEGACY_WINDOW (test_win), _BAMF_DESKTOP_FILE);
+  g_assert_cmpstr (hint, ==, TEST_BAMF_APP_DESKTOP);
+  g_free (hint);
+
+  while (!bamf_dbus_matcher_get_ready (BAMF_DBUS_MATCHER (matcher)))
+    g_main_context_iteration (NULL, TRUE);
+
+  bamf_legacy_window_test_close (test_win);
+  g_hash_table_remove (matcher->priv->registered_pids, GUINT_TO_POINTER (getppid ()));
+  g_hash_table_remove (matcher->priv->registered_pids, GUINT_TO_POINTER (getpid ()));
+
+  g_object_unref (matcher);
+  g_object_unref (screen);
+}
+
 static void
 test_match_libreoffice_windows (void)
 {
@@ -1252,6 +2034,42 @@ test_get_view_by_path (void)
   g_object_unref (screen);
 }
 
+static void
+test_get_application_by_desktop_file_updated (void)
+{
+  BamfMatcher *matcher;
+  BamfLegacyScreen *screen;
+  BamfLegacyWindowTest *lwin;
+  BamfApplication *app;
+  guint32 xid;
+
+  screen = bamf_legacy_screen_get_default();
+  matcher = bamf_matcher_get_default ();
+
+  cleanup_matcher_tables (matcher);
+  export_matcher_on_bus (matcher);
+
+  xid = g_random_int ();
+  lwin = bamf_legacy_window_test_new (xid, "Window", NULL, NULL);
+  _bamf_legacy_screen_open_test_window (screen, lwin);
+
+  app = bamf_matcher_get_application_by_xid (matcher, xid);
+  g_assert (BAMF_IS_APPLICATION (app));
+  g_assert (!bamf_matcher_get_application_by_desktop_file (matcher, TEST_BAMF_APP_DESKTOP));
+
+  bamf_application_set_desktop_file (app, TEST_BAMF_APP_DESKTOP);
+  g_assert (bamf_matcher_get_application_by_desktop_file (matcher, TEST_BAMF_APP_DESKTOP) == app);
+
+  bamf_application_set_desktop_file (app, NULL);
+  g_assert (!bamf_matcher_get_application_by_desktop_file (matcher, TEST_BAMF_APP_DESKTOP));
+
+  _bamf_legacy_screen_close_test_window (screen, lwin);
+  g_assert (!bamf_matcher_get_application_by_xid (matcher, xid));
+
+  g_object_unref (matcher);
+  g_object_unref (screen);
+}
+
 static void
 test_class_valid_name (void)
 {
@@ -1279,13 +2097,18 @@ test_matcher_create_suite (GDBusConnection *connection)
   g_test_add_func (DOMAIN"/AutostartDesktopFile/System", test_autostart_desktop_file_system);
   g_test_add_func (DOMAIN"/ClassValidName", test_class_valid_name);
   g_test_add_func (DOMAIN"/ExecStringTrimming", test_trim_exec_string);
+  g_test_add_func (DOMAIN"/GetApplicationByDesktopFile/Updated", test_get_application_by_desktop_file_updated);
   g_test_add_func (DOMAIN"/GetViewByPath", test_get_view_by_path);
+  g_test_add_func (DOMAIN"/LazyLoading/QueuesWindows", test_lazy_loading_queues_windows);
+  g_test_add_func (DOMAIN"/LazyLoading/RegisterDesktopForPid", test_lazy_loading_register_desktop_for_pid);
   g_test_add_func (DOMAIN"/LoadDesktopFile", test_load_desktop_file);
   g_test_add_func (DOMAIN"/LoadDesktopFile/Autostart", test_load_desktop_file_autostart);
   g_test_add_func (DOMAIN"/LoadDesktopFile/NoDisplay/SameID", test_load_desktop_file_no_display_has_lower_prio_same_id);
   g_test_add_func (DOMAIN"/LoadDesktopFile/NoDisplay/DifferentID", test_load_desktop_file_no_display_has_lower_prio_different_id);
   g_test_add_func (DOMAIN"/Matching/Application/DesktopLess", test_match_desktopless_application);
   g_test_add_func (DOMAIN"/Matching/Application/Desktop", test_match_desktop_application);
+  g_test_add_func (DOMAIN"/Matching/Application/CachedCandidates", test_match_cached_possible_applications);
+  g_test_add_func (DOMAIN"/Matching/Application/CachedCandidates/ClassChanged", test_match_cached_possible_applications_class_changed);
   g_test_add_func (DOMAIN"/Matching/Application/LibreOffice", test_match_libreoffice_windows);
   g_test_add_func (DOMAIN"/Matching/Application/UnityControlCenter", test_match_unity_control_center_panels);
   g_test_add_func (DOMAIN"/Matching/Application/JavaWebStart", test_match_javaws_windows);
@@ -1296,11 +2119,20 @@ test_matcher_create_suite (GDBusConnection *connection)
   g_test_add_func (DOMAIN"/Matching/Application/DesktopFileHintExec", test_match_desktop_file_hint_exec);
   g_test_add_func (DOMAIN"/Matching/Application/DesktopFileHintExec/Invalid", test_match_desktop_file_hint_exec_invalid);
   g_test_add_func (DOMAIN"/Matching/Windows/UnmatchedOnNewDesktop", test_new_desktop_matches_unmatched_windows);
+  g_test_add_func (DOMAIN"/Matching/Windows/UnmatchedOnNewMonitoredDesktops", test_new_monitored_desktops_rematch_windows_once);
   g_test_add_func (DOMAIN"/Matching/Windows/Transient", test_match_transient_windows);
   g_test_add_func (DOMAIN"/OpenWindows", test_open_windows);
+  g_test_add_func (DOMAIN"/WindowStackForMonitor", test_window_stack_for_monitor);
+  g_test_add_func (DOMAIN"/ViewsChanged/Batching", test_views_changed_batching);
+  g_test_add_func (DOMAIN"/GetState", test_get_state);
+  g_test_add_func (DOMAIN"/GetChangesSince", test_get_changes_since);
+  g_test_add_func (DOMAIN"/GetChangesSince/Reopened", test_get_changes_since_reopened);
+  g_test_add_func (DOMAIN"/GetChangesSince/TabProperties", test_get_changes_since_tab_properties);
   g_test_add_func (DOMAIN"/RegisterDesktopForPid", test_register_desktop_for_pid);
   g_test_add_func (DOMAIN"/RegisterDesktopForPid/BigNumber", test_register_desktop_for_pid_big_number);
   g_test_add_func (DOMAIN"/RegisterDesktopForPid/Autostart", test_register_desktop_for_pid_autostart);
   g_test_add_func (DOMAIN"/RegisterDesktopForPid/Display", test_register_desktop_for_pid_display);
   g_test_add_func (DOMAIN"/RegisterDesktopForPid/NoDisplay", test_register_desktop_for_pid_nodisplay);
+  g_test_add_func (DOMAIN"/RegisterDesktopForPid/Parent", test_register_desktop_for_pid_parent);
+  g_test_add_func (DOMAIN"/RegisterDesktopForPid/DesktopWindow", test_register_desktop_for_pid_desktop_window);
 }
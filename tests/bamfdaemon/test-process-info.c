@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <glib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "bamf-process-info.h"
+
+static void test_get_self        (void);
+static void test_get_invalid     (void);
+static void test_cached          (void);
+static void test_environ_value   (void);
+static void test_hold_invalid    (void);
+static void test_hold_shared     (void);
+static void test_parent          (void);
+static void test_parent_reparent (void);
+
+void
+test_process_info_create_suite (void)
+{
+#define DOMAIN "/ProcessInfo"
+
+  g_test_add_func (DOMAIN"/GetSelf", test_get_self);
+  g_test_add_func (DOMAIN"/GetInvalid", test_get_invalid);
+  g_test_add_func (DOMAIN"/Cached", test_cached);
+  g_test_add_func (DOMAIN"/EnvironValue", test_environ_value);
+  g_test_add_func (DOMAIN"/Hold/Invalid", test_hold_invalid);
+  g_test_add_func (DOMAIN"/Hold/Shared", test_hold_shared);
+  g_test_add_func (DOMAIN"/Parent", test_parent);
+  g_test_add_func (DOMAIN"/Parent/Reparented", test_parent_reparent);
+}
+
+static void
+test_get_self (void)
+{
+  BamfProcessInfo *info;
+
+  info = bamf_process_info_get (getpid ());
+  g_assert (info);
+  g_assert_cmpuint (bamf_process_info_get_pid (info), ==, getpid ());
+  g_assert_cmpuint (bamf_process_info_get_ppid (info), ==, getppid ());
+  g_assert_cmpuint (bamf_process_info_get_start_time (info), >, 0);
+  g_assert (bamf_process_info_get_name (info));
+  g_assert (bamf_process_info_get_exec_string (info));
+}
+
+static void
+test_get_invalid (void)
+{
+  g_assert (!bamf_process_info_get (0));
+  g_assert (!bamf_process_info_get (G_MAXINT));
+}
+
+static void
+test_cached (void)
+{
+  BamfProcessInfo *info;
+
+  g_assert (bamf_process_info_hold (getpid ()));
+  info = bamf_process_info_get (getpid ());
+  g_assert (info == bamf_process_info_get (getpid ()));
+  g_assert (bamf_process_info_get_exec_string (info) == bamf_process_info_get_exec_string (info));
+  bamf_process_info_release (getpid ());
+}
+
+static void
+test_environ_value (void)
+{
+  BamfProcessInfo *info;
+
+  /* The process environment is the one it was started with */
+  info = bamf_process_info_get (getpid ());
+  g_assert_cmpstr (bamf_process_info_get_environ_value (info, "BAMF_TEST_NOT_EXISTING_VAR"), ==, NULL);
+
+  if (g_getenv ("PATH"))
+    g_assert (bamf_process_info_get_environ_value (info, "PATH"));
+}
+
+static void
+test_hold_invalid (void)
+{
+  g_assert (!bamf_process_info_hold (0));
+  g_assert (!bamf_process_info_hold (G_MAXINT));
+}
+
+static void
+test_hold_shared (void)
+{
+  BamfProcessInfo *info;
+
+  g_assert (bamf_process_info_hold (getpid ()));
+  g_assert (bamf_process_info_hold (getpid ()));
+  info = bamf_process_info_get (getpid ());
+
+  /* The parent info isn't held, so it goes away with the last release */
+  g_assert (bamf_process_info_get (getppid ()));
+
+  bamf_process_info_release (getpid ());
+  g_assert (bamf_process_info_get (getpid ()) == info);
+
+  bamf_process_info_release (getpid ());
+}
+
+static void
+test_parent (void)
+{
+  BamfProcessInfo *info, *parent;
+
+  info = bamf_process_info_get (getpid ());
+  parent = bamf_process_info_get_parent (info);
+  g_assert (parent);
+  g_assert_cmpuint (bamf_process_info_get_pid (parent), ==, getppid ());
+  g_assert_cmpuint (bamf_process_info_get_start_time (parent), <=, bamf_process_info_get_start_time (info));
+}
+
+static void
+test_parent_reparent (void)
+{
+  BamfProcessInfo *info, *parent;
+  int pid_pipe[2], exit_pipe[2];
+  pid_t child, grand_child;
+  char c;
+
+  g_assert (pipe (pid_pipe) == 0);
+  g_assert (pipe (exit_pipe) == 0);
+
+  child = fork ();
+  g_assert (child >= 0);
+
+  if (child == 0)
+    {
+      grand_child = fork ();
+
+      if (grand_child == 0)
+        {
+          close (exit_pipe[0]);
+          close (exit_pipe[1]);
+          pause ();
+          _exit (0);
+        }
+
+      /* The child exits once the test closes the pipe, leaving its child */
+      close (exit_pipe[1]);
+      if (write (pid_pipe[1], &grand_child, sizeof (grand_child)) != sizeof (grand_child))
+        _exit (1);
+
+      _exit (read (exit_pipe[0], &c, 1) < 0);
+    }
+
+  close (exit_pipe[0]);
+  g_assert (read (pid_pipe[0], &grand_child, sizeof (grand_child)) == sizeof (grand_child));
+
+  g_assert (bamf_process_info_hold (grand_child));
+  info = bamf_process_info_get (grand_child);
+  g_assert_cmpuint (bamf_process_info_get_ppid (info), ==, child);
+
+  close (exit_pipe[1]);
+  g_assert (waitpid (child, NULL, 0) == child);
+
+  /* The held info has a stale ppid, that is fixed when getting the parent */
+  parent = bamf_process_info_get_parent (info);
+  g_assert_cmpuint (bamf_process_info_get_ppid (info), !=, child);
+
+  if (parent)
+    g_assert_cmpuint (bamf_process_info_get_pid (parent), ==, bamf_process_info_get_ppid (info));
+
+  bamf_process_info_release (grand_child);
+  kill (grand_child, SIGKILL);
+  close (pid_pipe[0]);
+  close (pid_pipe[1]);
+}
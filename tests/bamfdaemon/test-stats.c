@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <glib.h>
+#include "bamf-stats.h"
+
+static void test_timer_count      (void);
+static void test_timer_percentile (void);
+static void test_match_count      (void);
+
+void
+test_stats_create_suite (void)
+{
+#define DOMAIN "/Stats"
+
+  g_test_add_func (DOMAIN"/Timer/Count", test_timer_count);
+  g_test_add_func (DOMAIN"/Timer/Percentile", test_timer_percentile);
+  g_test_add_func (DOMAIN"/Match/Count", test_match_count);
+}
+
+static void
+test_timer_count (void)
+{
+  bamf_stats_reset ();
+  g_assert_cmpuint (bamf_stats_get_timer_count (BAMF_STATS_TIMER_HANDLE_WINDOW), ==, 0);
+  g_assert_cmpuint (bamf_stats_get_timer_percentile (BAMF_STATS_TIMER_HANDLE_WINDOW, 50), ==, 0);
+
+  bamf_stats_timer_stop (BAMF_STATS_TIMER_HANDLE_WINDOW, bamf_stats_timer_start ());
+  bamf_stats_timer_stop (BAMF_STATS_TIMER_HANDLE_WINDOW, bamf_stats_timer_start ());
+  g_assert_cmpuint (bamf_stats_get_timer_count (BAMF_STATS_TIMER_HANDLE_WINDOW), ==, 2);
+  g_assert_cmpuint (bamf_stats_get_timer_count (BAMF_STATS_TIMER_MONITOR_CHANGED), ==, 0);
+
+  bamf_stats_reset ();
+  g_assert_cmpuint (bamf_stats_get_timer_count (BAMF_STATS_TIMER_HANDLE_WINDOW), ==, 0);
+}
+
+static void
+test_timer_percentile (void)
+{
+  gint64 now;
+  int i;
+
+  bamf_stats_reset ();
+  now = bamf_stats_timer_start ();
+
+  /* 98 fast samples, and two of at least one second */
+  for (i = 0; i < 98; ++i)
+    bamf_stats_timer_stop (BAMF_STATS_TIMER_LOAD_DESKTOP_FILES, now + G_USEC_PER_SEC);
+
+  bamf_stats_timer_stop (BAMF_STATS_TIMER_LOAD_DESKTOP_FILES, now - G_USEC_PER_SEC);
+  bamf_stats_timer_stop (BAMF_STATS_TIMER_LOAD_DESKTOP_FILES, now - G_USEC_PER_SEC);
+
+  g_assert_cmpuint (bamf_stats_get_timer_percentile (BAMF_STATS_TIMER_LOAD_DESKTOP_FILES, 50), ==, 0);
+  g_assert_cmpuint (bamf_stats_get_timer_percentile (BAMF_STATS_TIMER_LOAD_DESKTOP_FILES, 99), >=, G_USEC_PER_SEC);
+  g_assert_cmpuint (bamf_stats_get_timer_percentile (BAMF_STATS_TIMER_LOAD_DESKTOP_FILES, 99), <, 2 * G_USEC_PER_SEC);
+
+  bamf_stats_reset ();
+}
+
+static void
+test_match_count (void)
+{
+  bamf_stats_reset ();
+
+  bamf_stats_add_match (BAMF_STATS_MATCH_HINT);
+  bamf_stats_add_match (BAMF_STATS_MATCH_HINT);
+  bamf_stats_add_match (BAMF_STATS_MATCH_NEW_APPLICATION);
+
+  g_assert_cmpuint (bamf_stats_get_match_count (BAMF_STATS_MATCH_HINT), ==, 2);
+  g_assert_cmpuint (bamf_stats_get_match_count (BAMF_STATS_MATCH_NEW_APPLICATION), ==, 1);
+  g_assert_cmpuint (bamf_stats_get_match_count (BAMF_STATS_MATCH_CLASS), ==, 0);
+
+  bamf_stats_reset ();
+}
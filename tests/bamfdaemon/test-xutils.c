@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include "bamf-xutils.h"
+
+static void test_parse_class_hints               (void);
+static void test_parse_class_hints_empty_instance (void);
+static void test_parse_class_hints_empty_class   (void);
+static void test_get_class_hints_empty_instance  (void);
+static void test_atom_names                      (void);
+static void test_atom_names_repeated_in_batch    (void);
+static void test_get_hints_multiple_windows      (void);
+
+void
+test_xutils_create_suite (void)
+{
+#define DOMAIN "/Xutils"
+
+  g_test_add_func (DOMAIN"/ParseClassHints", test_parse_class_hints);
+  g_test_add_func (DOMAIN"/ParseClassHints/EmptyInstance", test_parse_class_hints_empty_instance);
+  g_test_add_func (DOMAIN"/ParseClassHints/EmptyClass", test_parse_class_hints_empty_class);
+  g_test_add_func (DOMAIN"/GetClassHints/EmptyInstance", test_get_class_hints_empty_instance);
+  g_test_add_func (DOMAIN"/AtomNames", test_atom_names);
+  g_test_add_func (DOMAIN"/AtomNames/RepeatedInBatch", test_atom_names_repeated_in_batch);
+  g_test_add_func (DOMAIN"/GetStringWindowHints/MultipleWindows", test_get_hints_multiple_windows);
+}
+
+static Window
+create_window (Display *xdisplay)
+{
+  return XCreateSimpleWindow (xdisplay, DefaultRootWindow (xdisplay), 0, 0, 1, 1, 0, 0, 0);
+}
+
+static void
+test_parse_class_hints (void)
+{
+  const char value[] = "instance\0Class";
+  char *class_instance_name = NULL;
+  char *class_name = NULL;
+
+  bamf_xutils_parse_class_hints (value, sizeof (value), &class_instance_name, &class_name);
+  g_assert_cmpstr (class_instance_name, ==, "instance");
+  g_assert_cmpstr (class_name, ==, "Class");
+
+  g_free (class_instance_name);
+  g_free (class_name);
+}
+
+static void
+test_parse_class_hints_empty_instance (void)
+{
+  const char value[] = "\0Class";
+  char *class_instance_name = NULL;
+  char *class_name = NULL;
+
+  bamf_xutils_parse_class_hints (value, sizeof (value), &class_instance_name, &class_name);
+  g_assert_cmpstr (class_instance_name, ==, NULL);
+  g_assert_cmpstr (class_name, ==, "Class");
+
+  g_free (class_name);
+}
+
+static void
+test_parse_class_hints_empty_class (void)
+{
+  const char value[] = "instance\0";
+  char *class_instance_name = NULL;
+  char *class_name = NULL;
+
+  bamf_xutils_parse_class_hints (value, sizeof (value), &class_instance_name, &class_name);
+  g_assert_cmpstr (class_instance_name, ==, "instance");
+  g_assert_cmpstr (class_name, ==, NULL);
+
+  g_free (class_instance_name);
+}
+
+static void
+test_get_class_hints_empty_instance (void)
+{
+  Display *xdisplay = gdk_x11_get_default_xdisplay ();
+  const char value[] = "\0Class";
+  char *class_instance_name = NULL;
+  char *class_name = NULL;
+  Window xid;
+
+  xid = create_window (xdisplay);
+  XChangeProperty (xdisplay, xid, XA_WM_CLASS, XA_STRING, 8, PropModeReplace,
+                   (unsigned char *) value, sizeof (value));
+  XSync (xdisplay, False);
+
+  bamf_xutils_get_window_class_hints (xid, &class_instance_name, &class_name);
+  g_assert_cmpstr (class_instance_name, ==, NULL);
+  g_assert_cmpstr (class_name, ==, "Class");
+
+  /* As a single string the value is empty */
+  g_assert_cmpstr (bamf_xutils_get_string_window_hint (xid, "WM_CLASS"), ==, NULL);
+
+  g_free (class_name);
+  XDestroyWindow (xdisplay, xid);
+}
+
+static void
+test_atom_names (void)
+{
+  Atom atom;
+
+  atom = bamf_xutils_get_atom ("_BAMF_TEST_ATOM_NAME");
+  g_assert (atom != None);
+  g_assert (bamf_xutils_peek_atom ("_BAMF_TEST_ATOM_NAME") == atom);
+  g_assert_cmpstr (bamf_xutils_get_atom_name (atom), ==, "_BAMF_TEST_ATOM_NAME");
+
+  g_assert (bamf_xutils_peek_atom ("_BAMF_TEST_ATOM_NEVER_INTERNED") == None);
+  g_assert_cmpstr (bamf_xutils_get_atom_name (None), ==, NULL);
+}
+
+static void
+test_atom_names_repeated_in_batch (void)
+{
+  Display *xdisplay = gdk_x11_get_default_xdisplay ();
+  const char *atom_name = "_BAMF_TEST_ATOM_REPEATED";
+  BamfXutilsHintQuery queries[3];
+  Window xid;
+  Atom atom;
+  guint i;
+
+  /* Interned on the server, but not through the cache */
+  atom = XInternAtom (xdisplay, atom_name, False);
+  g_assert_cmpstr (bamf_xutils_get_atom_name (atom), ==, NULL);
+
+  xid = create_window (xdisplay);
+  XChangeProperty (xdisplay, xid, atom, XA_STRING, 8, PropModeReplace,
+                   (unsigned char *) "value", strlen ("value"));
+  XSync (xdisplay, False);
+
+  for (i = 0; i < G_N_ELEMENTS (queries); ++i)
+    {
+      queries[i].xid = xid;
+      queries[i].atom_name = atom_name;
+    }
+
+  bamf_xutils_get_string_window_hints (queries, G_N_ELEMENTS (queries));
+
+  for (i = 0; i < G_N_ELEMENTS (queries); ++i)
+    {
+      g_assert_cmpstr (queries[i].value, ==, "value");
+      g_free (queries[i].value);
+    }
+
+  g_assert (bamf_xutils_peek_atom (atom_name) == atom);
+  g_assert_cmpstr (bamf_xutils_get_atom_name (atom), ==, atom_name);
+
+  XDestroyWindow (xdisplay, xid);
+}
+
+static void
+test_get_hints_multiple_windows (void)
+{
+  Display *xdisplay = gdk_x11_get_default_xdisplay ();
+  BamfXutilsHintQuery queries[4];
+  Window xids[3];
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (xids); ++i)
+    xids[i] = create_window (xdisplay);
+
+  bamf_xutils_set_string_window_hint (xids[0], "_BAMF_DESKTOP_FILE", "first.desktop");
+  bamf_xutils_set_string_window_hint (xids[1], "_BAMF_DESKTOP_FILE", "second.desktop");
+  XDestroyWindow (xdisplay, xids[2]);
+  XSync (xdisplay, False);
+
+  queries[0].xid = xids[0];
+  queries[0].atom_name = "_BAMF_DESKTOP_FILE";
+  queries[1].xid = xids[1];
+  queries[1].atom_name = "_BAMF_DESKTOP_FILE";
+  queries[2].xid = xids[1];
+  queries[2].atom_name = "_GTK_APPLICATION_ID";
+  queries[3].xid = xids[2];
+  queries[3].atom_name = "_BAMF_DESKTOP_FILE";
+
+  /* The failure of a request doesn't affect the other ones */
+  g_test_expect_message (G_LOG_DOMAIN, G_LOG_LEVEL_WARNING, "Got an X error*");
+  bamf_xutils_get_string_window_hints (queries, G_N_ELEMENTS (queries));
+  g_test_assert_expected_messages ();
+
+  g_assert_cmpstr (queries[0].value, ==, "first.desktop");
+  g_assert_cmpuint (queries[0].length, ==, strlen ("first.desktop"));
+  g_assert_cmpstr (queries[1].value, ==, "second.desktop");
+  g_assert_cmpstr (queries[2].value, ==, NULL);
+  g_assert_cmpuint (queries[2].length, ==, 0);
+  g_assert_cmpstr (queries[3].value, ==, NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (queries); ++i)
+    g_free (queries[i].value);
+
+  XDestroyWindow (xdisplay, xids[0]);
+  XDestroyWindow (xdisplay, xids[1]);
+}
@@ -127,6 +127,50 @@ test_favorite_mime_type_empty (void)
   g_object_unref (application);
 }
 
+static void
+on_windows_ready (GObject *object, GAsyncResult *result, gpointer data)
+{
+  GError *error = NULL;
+  gboolean *done = data;
+
+  g_assert (!bamf_application_get_windows_finish (BAMF_APPLICATION (object), result, &error));
+  g_assert_no_error (error);
+  *done = TRUE;
+}
+
+static void
+on_xids_ready (GObject *object, GAsyncResult *result, gpointer data)
+{
+  GError *error = NULL;
+  gboolean *done = data;
+
+  g_assert (!bamf_application_get_xids_finish (BAMF_APPLICATION (object), result, &error));
+  g_assert_no_error (error);
+  *done = TRUE;
+}
+
+static void
+test_favorite_windows_async (void)
+{
+  BamfApplication *application;
+  gboolean windows_done = FALSE;
+  gboolean xids_done = FALSE;
+
+  application = bamf_application_new_favorite (DATA_DIR"/test-bamf-app.desktop");
+
+  /* Favorites have no remote counterpart, results are always delivered
+   * from the main loop, never from within the _async call */
+  bamf_application_get_windows_async (application, NULL, on_windows_ready, &windows_done);
+  bamf_application_get_xids_async (application, NULL, on_xids_ready, &xids_done);
+  g_assert (!windows_done);
+  g_assert (!xids_done);
+
+  while (!windows_done || !xids_done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_object_unref (application);
+}
+
 void
 test_application_create_suite (void)
 {
@@ -139,4 +183,5 @@ test_application_create_suite (void)
   g_test_add_func (DOMAIN"/Favorite/NoIcon", test_favorite_no_icon);
   g_test_add_func (DOMAIN"/Favorite/MimeType/Filled", test_favorite_mime_type_filled);
   g_test_add_func (DOMAIN"/Favorite/MimeType/Empty", test_favorite_mime_type_empty);
+  g_test_add_func (DOMAIN"/Favorite/Windows/Async", test_favorite_windows_async);
 }
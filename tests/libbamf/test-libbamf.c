@@ -25,6 +25,7 @@
 
 void test_matcher_create_suite (void);
 void test_application_create_suite (void);
+void test_window_create_suite (void);
 
 static gboolean
 not_fatal_log_handler (const gchar *log_domain, GLogLevelFlags log_level,
@@ -53,6 +54,7 @@ main (gint argc, gchar *argv[])
 
   test_matcher_create_suite ();
   test_application_create_suite ();
+  test_window_create_suite ();
 
   return g_test_run ();
 }
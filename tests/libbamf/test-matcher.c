@@ -69,6 +69,428 @@ test_singleton_after_unref (void)
   g_object_unref (matcher_new);
 }
 
+static void
+on_applications_ready (GObject *object, GAsyncResult *result, gpointer data)
+{
+  GError *error = NULL;
+  guint *pending = data;
+  GList *applications, *l;
+
+  applications = bamf_matcher_get_applications_finish (BAMF_MATCHER (object), result, &error);
+
+  if (error)
+    {
+      g_assert (!applications);
+      g_clear_error (&error);
+    }
+
+  for (l = applications; l; l = l->next)
+    g_assert (BAMF_IS_APPLICATION (l->data));
+
+  g_list_free (applications);
+  --(*pending);
+}
+
+static void
+on_windows_ready (GObject *object, GAsyncResult *result, gpointer data)
+{
+  GError *error = NULL;
+  guint *pending = data;
+  GList *windows, *l;
+
+  windows = bamf_matcher_get_windows_finish (BAMF_MATCHER (object), result, &error);
+
+  if (error)
+    {
+      g_assert (!windows);
+      g_clear_error (&error);
+    }
+
+  for (l = windows; l; l = l->next)
+    g_assert (BAMF_IS_WINDOW (l->data));
+
+  g_list_free (windows);
+  --(*pending);
+}
+
+static void
+test_views_async (void)
+{
+  BamfMatcher *matcher;
+  GDBusConnection *bus;
+  guint pending = 2;
+
+  /* The calls can't be made without a session bus */
+  bus = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, NULL);
+
+  if (!bus)
+    return;
+
+  ignore_fatal_errors();
+  matcher = bamf_matcher_get_default ();
+
+  /* Without a daemon the calls fail, but the callbacks are always called */
+  bamf_matcher_get_applications_async (matcher, NULL, on_applications_ready, &pending);
+  bamf_matcher_get_windows_async (matcher, NULL, on_windows_ready, &pending);
+  g_assert_cmpuint (pending, ==, 2);
+
+  while (pending > 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_object_unref (matcher);
+  g_object_unref (bus);
+}
+
+#define TEST_SERVICE_NAME "org.ayatana.bamf.Test"
+#define TEST_MATCHER_PATH "/org/ayatana/bamf/matcher"
+#define TEST_APPLICATION_PATH "/org/ayatana/bamf/test/application0"
+#define TEST_WINDOW_PATH "/org/ayatana/bamf/test/window0"
+
+static const gchar fake_matcher_xml[] =
+  "<node>"
+  "  <interface name='org.ayatana.bamf.matcher'>"
+  "    <method name='GetState'>"
+  "      <arg name='state' type='a(ssa{sv}as)' direction='out'/>"
+  "      <arg name='generation' type='t' direction='out'/>"
+  "    </method>"
+  "    <method name='ApplicationPaths'>"
+  "      <arg name='paths' type='as' direction='out'/>"
+  "    </method>"
+  "  </interface>"
+  "</node>";
+
+/* A daemon that only knows its state, running in its own thread and
+ * connection, so that the sync calls libbamf makes can be served */
+typedef struct
+{
+  GDBusConnection *connection;
+  GMainContext *context;
+  GMainLoop *loop;
+  GThread *thread;
+  guint registration_id;
+  gint get_state_calls;
+  gint view_calls;
+  gboolean hold_state;
+  GDBusMethodInvocation *held_state;
+} FakeDaemon;
+
+static GDBusMessage *
+fake_daemon_filter (GDBusConnection *connection, GDBusMessage *message,
+                    gboolean incoming, gpointer data)
+{
+  FakeDaemon *daemon = data;
+
+  if (!incoming || g_dbus_message_get_message_type (message) != G_DBUS_MESSAGE_TYPE_METHOD_CALL)
+    return message;
+
+  if (g_strcmp0 (g_dbus_message_get_path (message), TEST_MATCHER_PATH) != 0)
+    g_atomic_int_inc (&daemon->view_calls);
+  else if (g_strcmp0 (g_dbus_message_get_member (message), "GetState") == 0)
+    g_atomic_int_inc (&daemon->get_state_calls);
+
+  return message;
+}
+
+static GVariant *
+fake_daemon_build_state (void)
+{
+  GVariantBuilder builder, properties;
+  const gchar *app_children[] = { TEST_WINDOW_PATH, NULL };
+  const gchar *no_children[] = { NULL };
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ssa{sv}as)"));
+
+  g_variant_builder_init (&properties, G_VARIANT_TYPE_VARDICT);
+  g_variant_builder_add (&properties, "{sv}", "Name", g_variant_new_string ("Test Application"));
+  g_variant_builder_add (&properties, "{sv}", "Running", g_variant_new_boolean (TRUE));
+  g_variant_builder_add (&properties, "{sv}", "UserVisible", g_variant_new_boolean (TRUE));
+  g_variant_builder_add (&properties, "{sv}", "DesktopFile", g_variant_new_string ("/usr/share/applications/test.desktop"));
+  g_variant_builder_add (&properties, "{sv}", "ApplicationType", g_variant_new_string ("system"));
+  g_variant_builder_add (&properties, "{sv}", "ShowStubs", g_variant_new_boolean (TRUE));
+  g_variant_builder_add (&builder, "(ss@a{sv}^as)", TEST_APPLICATION_PATH, "application",
+                         g_variant_builder_end (&properties), app_children);
+
+  g_variant_builder_init (&properties, G_VARIANT_TYPE_VARDICT);
+  g_variant_builder_add (&properties, "{sv}", "Name", g_variant_new_string ("Test Window"));
+  g_variant_builder_add (&properties, "{sv}", "Running", g_variant_new_boolean (TRUE));
+  g_variant_builder_add (&properties, "{sv}", "Xid", g_variant_new_uint32 (123));
+  g_variant_builder_add (&properties, "{sv}", "Pid", g_variant_new_uint32 (456));
+  g_variant_builder_add (&properties, "{sv}", "WindowType", g_variant_new_uint32 (BAMF_WINDOW_NORMAL));
+  g_variant_builder_add (&properties, "{sv}", "Monitor", g_variant_new_int32 (1));
+  g_variant_builder_add (&properties, "{sv}", "Maximized", g_variant_new_int32 (BAMF_WINDOW_FLOATING));
+  g_variant_builder_add (&builder, "(ss@a{sv}^as)", TEST_WINDOW_PATH, "window",
+                         g_variant_builder_end (&properties), no_children);
+
+  return g_variant_new ("(@a(ssa{sv}as)t)", g_variant_builder_end (&builder), (guint64) 1);
+}
+
+static void
+fake_daemon_method_call (GDBusConnection *connection, const gchar *sender,
+                         const gchar *path, const gchar *interface, const gchar *method,
+                         GVariant *parameters, GDBusMethodInvocation *invocation,
+                         gpointer data)
+{
+  FakeDaemon *daemon = data;
+  const gchar *paths[] = { TEST_APPLICATION_PATH, NULL };
+
+  if (g_strcmp0 (method, "GetState") == 0 && daemon->hold_state)
+    daemon->held_state = invocation;
+  else if (g_strcmp0 (method, "GetState") == 0)
+    g_dbus_method_invocation_return_value (invocation, fake_daemon_build_state ());
+  else
+    g_dbus_method_invocation_return_value (invocation, g_variant_new ("(^as)", paths));
+}
+
+static const GDBusInterfaceVTable fake_daemon_vtable = { fake_daemon_method_call, NULL, NULL };
+
+static gpointer
+fake_daemon_thread (gpointer data)
+{
+  FakeDaemon *daemon = data;
+
+  g_main_context_push_thread_default (daemon->context);
+  g_main_loop_run (daemon->loop);
+  g_main_context_pop_thread_default (daemon->context);
+
+  return NULL;
+}
+
+static FakeDaemon *
+fake_daemon_new (void)
+{
+  FakeDaemon *daemon;
+  GDBusConnection *connection;
+  GDBusNodeInfo *info;
+  GVariant *reply;
+  gchar *address;
+  guint32 result = 0;
+
+  address = g_dbus_address_get_for_bus_sync (G_BUS_TYPE_SESSION, NULL, NULL);
+
+  if (!address)
+    return NULL;
+
+  connection = g_dbus_connection_new_for_address_sync (address,
+                                                       G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                                       G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                                       NULL, NULL, NULL);
+  g_free (address);
+
+  if (!connection)
+    return NULL;
+
+  /* DBUS_NAME_FLAG_DO_NOT_QUEUE, another daemon might be running */
+  reply = g_dbus_connection_call_sync (connection, "org.freedesktop.DBus", "/org/freedesktop/DBus",
+                                       "org.freedesktop.DBus", "RequestName",
+                                       g_variant_new ("(su)", TEST_SERVICE_NAME, 4),
+                                       G_VARIANT_TYPE ("(u)"), G_DBUS_CALL_FLAGS_NONE,
+                                       -1, NULL, NULL);
+
+  if (reply)
+    {
+      g_variant_get (reply, "(u)", &result);
+      g_variant_unref (reply);
+    }
+
+  /* DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER */
+  if (result != 1)
+    {
+      g_object_unref (connection);
+      return NULL;
+    }
+
+  daemon = g_new0 (FakeDaemon, 1);
+  daemon->connection = connection;
+  daemon->context = g_main_context_new ();
+  daemon->loop = g_main_loop_new (daemon->context, FALSE);
+
+  g_dbus_connection_add_filter (connection, fake_daemon_filter, daemon, NULL);
+
+  /* Method calls are dispatched to the thread default context at registration */
+  info = g_dbus_node_info_new_for_xml (fake_matcher_xml, NULL);
+  g_main_context_push_thread_default (daemon->context);
+  daemon->registration_id = g_dbus_connection_register_object (connection, TEST_MATCHER_PATH,
+                                                               info->interfaces[0],
+                                                               &fake_daemon_vtable,
+                                                               daemon, NULL, NULL);
+  g_main_context_pop_thread_default (daemon->context);
+  g_dbus_node_info_unref (info);
+
+  daemon->thread = g_thread_new ("fake-bamfdaemon", fake_daemon_thread, daemon);
+
+  return daemon;
+}
+
+static gboolean
+fake_daemon_release_state_cb (gpointer data)
+{
+  FakeDaemon *daemon = data;
+
+  daemon->hold_state = FALSE;
+
+  if (daemon->held_state)
+    g_dbus_method_invocation_return_value (daemon->held_state, fake_daemon_build_state ());
+
+  daemon->held_state = NULL;
+
+  return FALSE;
+}
+
+/* Replies to the GetState calls that have been held, from the daemon thread */
+static void
+fake_daemon_release_state (FakeDaemon *daemon)
+{
+  g_main_context_invoke (daemon->context, fake_daemon_release_state_cb, daemon);
+}
+
+static void
+fake_daemon_free (FakeDaemon *daemon)
+{
+  g_main_loop_quit (daemon->loop);
+  g_thread_join (daemon->thread);
+
+  g_dbus_connection_unregister_object (daemon->connection, daemon->registration_id);
+  g_dbus_connection_close_sync (daemon->connection, NULL, NULL);
+  g_object_unref (daemon->connection);
+
+  g_main_loop_unref (daemon->loop);
+  g_main_context_unref (daemon->context);
+  g_free (daemon);
+}
+
+static void
+test_state_seeding (void)
+{
+  FakeDaemon *daemon;
+  BamfMatcher *matcher;
+  BamfApplication *application;
+  BamfWindow *window;
+  GList *applications, *children;
+  gchar *name;
+
+  daemon = fake_daemon_new ();
+
+  /* No session bus to own the daemon name on */
+  if (!daemon)
+    return;
+
+  ignore_fatal_errors();
+  matcher = bamf_matcher_get_default ();
+
+  /* Nothing is fetched until a view is requested */
+  g_assert_cmpint (g_atomic_int_get (&daemon->get_state_calls), ==, 0);
+
+  applications = bamf_matcher_get_applications (matcher);
+  g_assert_cmpuint (g_list_length (applications), ==, 1);
+  g_assert_cmpint (g_atomic_int_get (&daemon->get_state_calls), ==, 1);
+
+  application = applications->data;
+  g_assert (BAMF_IS_APPLICATION (application));
+  g_assert_cmpstr (bamf_application_get_desktop_file (application), ==, "/usr/share/applications/test.desktop");
+  g_assert (bamf_view_is_running (BAMF_VIEW (application)));
+  g_assert (bamf_view_is_user_visible (BAMF_VIEW (application)));
+
+  name = bamf_view_get_name (BAMF_VIEW (application));
+  g_assert_cmpstr (name, ==, "Test Application");
+  g_free (name);
+
+  children = bamf_view_get_children (BAMF_VIEW (application));
+  g_assert_cmpuint (g_list_length (children), ==, 1);
+  g_assert (BAMF_IS_WINDOW (children->data));
+
+  window = children->data;
+  g_assert_cmpuint (bamf_window_get_xid (window), ==, 123);
+  g_assert_cmpuint (bamf_window_get_pid (window), ==, 456);
+  g_assert_cmpint (bamf_window_get_window_type (window), ==, BAMF_WINDOW_NORMAL);
+  g_assert_cmpint (bamf_window_get_monitor (window), ==, 1);
+  g_assert_cmpint (bamf_window_maximized (window), ==, BAMF_WINDOW_FLOATING);
+
+  name = bamf_view_get_name (BAMF_VIEW (window));
+  g_assert_cmpstr (name, ==, "Test Window");
+  g_free (name);
+
+  /* All the data has been served by the state, with no per-view call */
+  g_assert_cmpint (g_atomic_int_get (&daemon->view_calls), ==, 0);
+
+  /* The views are only created once */
+  g_list_free (applications);
+  applications = bamf_matcher_get_applications (matcher);
+  g_assert (applications->data == application);
+  g_assert_cmpint (g_atomic_int_get (&daemon->get_state_calls), ==, 1);
+
+  g_list_free (children);
+  g_list_free (applications);
+  g_object_unref (matcher);
+
+  while (g_main_context_iteration (NULL, FALSE));
+
+  fake_daemon_free (daemon);
+}
+
+static void
+on_seeded_applications_ready (GObject *object, GAsyncResult *result, gpointer data)
+{
+  GList **applications = data;
+  GError *error = NULL;
+
+  *applications = bamf_matcher_get_applications_finish (BAMF_MATCHER (object), result, &error);
+  g_assert_no_error (error);
+  g_assert (*applications);
+}
+
+static void
+test_state_seeding_async (void)
+{
+  FakeDaemon *daemon;
+  BamfMatcher *matcher;
+  BamfApplication *application;
+  GList *applications = NULL, *children;
+
+  daemon = fake_daemon_new ();
+
+  /* No session bus to own the daemon name on */
+  if (!daemon)
+    return;
+
+  ignore_fatal_errors();
+  daemon->hold_state = TRUE;
+  matcher = bamf_matcher_get_default ();
+
+  bamf_matcher_get_applications_async (matcher, NULL, on_seeded_applications_ready, &applications);
+
+  /* The main loop keeps running while the state is being fetched */
+  while (g_atomic_int_get (&daemon->get_state_calls) == 0)
+    g_main_context_iteration (NULL, FALSE);
+
+  g_assert (!applications);
+  fake_daemon_release_state (daemon);
+
+  while (!applications)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (g_list_length (applications), ==, 1);
+  application = applications->data;
+  g_assert (BAMF_IS_APPLICATION (application));
+  g_assert_cmpstr (bamf_application_get_desktop_file (application), ==, "/usr/share/applications/test.desktop");
+
+  children = bamf_view_get_children (BAMF_VIEW (application));
+  g_assert_cmpuint (g_list_length (children), ==, 1);
+  g_assert (BAMF_IS_WINDOW (children->data));
+  g_assert_cmpuint (bamf_window_get_xid (children->data), ==, 123);
+
+  /* The views have been created from the state and the prepared proxies */
+  g_assert_cmpint (g_atomic_int_get (&daemon->get_state_calls), ==, 1);
+  g_assert_cmpint (g_atomic_int_get (&daemon->view_calls), ==, 0);
+
+  g_list_free (children);
+  g_list_free (applications);
+  g_object_unref (matcher);
+
+  while (g_main_context_iteration (NULL, FALSE));
+
+  fake_daemon_free (daemon);
+}
+
 void
 test_matcher_create_suite (void)
 {
@@ -77,4 +499,7 @@ test_matcher_create_suite (void)
   g_test_add_func (DOMAIN"/Allocation", test_allocation);
   g_test_add_func (DOMAIN"/Singleton", test_singleton);
   g_test_add_func (DOMAIN"/SingletonUnref", test_singleton_after_unref);
+  g_test_add_func (DOMAIN"/Views/Async", test_views_async);
+  g_test_add_func (DOMAIN"/State/Seeding", test_state_seeding);
+  g_test_add_func (DOMAIN"/State/Seeding/Async", test_state_seeding_async);
 }
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include "libbamf.h"
+
+static void
+test_allocation (void)
+{
+  BamfWindow *window;
+
+  /* Check it allocates */
+  window = g_object_new (BAMF_TYPE_WINDOW, NULL);
+  g_assert (BAMF_IS_WINDOW (window));
+
+  g_object_unref (window);
+}
+
+static void
+on_pid_ready (GObject *object, GAsyncResult *result, gpointer data)
+{
+  GError *error = NULL;
+  guint *pending = data;
+
+  g_assert_cmpuint (bamf_window_get_pid_finish (BAMF_WINDOW (object), result, &error), ==, 0);
+  g_assert_no_error (error);
+  --(*pending);
+}
+
+static void
+on_utf8_prop_ready (GObject *object, GAsyncResult *result, gpointer data)
+{
+  GError *error = NULL;
+  guint *pending = data;
+
+  g_assert (!bamf_window_get_utf8_prop_finish (BAMF_WINDOW (object), result, &error));
+  g_assert_no_error (error);
+  --(*pending);
+}
+
+static void
+on_children_ready (GObject *object, GAsyncResult *result, gpointer data)
+{
+  GError *error = NULL;
+  guint *pending = data;
+
+  g_assert (!bamf_view_get_children_finish (BAMF_VIEW (object), result, &error));
+  g_assert_no_error (error);
+  --(*pending);
+}
+
+static void
+test_async_not_remote (void)
+{
+  BamfWindow *window;
+  guint pending = 3;
+
+  window = g_object_new (BAMF_TYPE_WINDOW, NULL);
+
+  /* Without a remote counterpart nothing is fetched, but results are still
+   * delivered from the main loop, never from within the _async call */
+  bamf_window_get_pid_async (window, NULL, on_pid_ready, &pending);
+  bamf_window_get_utf8_prop_async (window, "WM_WINDOW_ROLE", NULL, on_utf8_prop_ready, &pending);
+  bamf_view_get_children_async (BAMF_VIEW (window), NULL, on_children_ready, &pending);
+  g_assert_cmpuint (pending, ==, 3);
+
+  while (pending > 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_object_unref (window);
+}
+
+void
+test_window_create_suite (void)
+{
+#define DOMAIN "/Window"
+
+  g_test_add_func (DOMAIN"/Allocation", test_allocation);
+  g_test_add_func (DOMAIN"/Async/NotRemote", test_async_not_remote);
+}